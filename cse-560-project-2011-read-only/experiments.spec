@@ -0,0 +1,100 @@
+# Register file experiments 1-12, the projectRunscript-Experiment* loops as
+# one sim-exp spec.  Run from this directory:
+#
+#   sim-R10K/sim-exp experiments.spec
+#
+# Logs go to experiments-output/<experiment>/, the IPC of every run to
+# experiments-output/results.csv.  Re-running resumes where it stopped.
+
+stat      sim_IPC sim_CPI
+benchdir  benchmarks
+
+experiment Experiment1-PregNum
+sim       sim-R10K/sim-R10K
+args      -insn:limit 60000000
+bench     ammp bzip2 equake gcc lucas mesa parser vortex
+param     -rename:pregs:num 131..1027 step 128
+
+experiment Experiment1-PregNum
+sim       sim-R10K/sim-R10K-reg
+args      -insn:limit 60000000
+bench     ammp bzip2 equake gcc lucas mesa parser vortex
+param     -l1_pregfile:size 131..1027 step 128
+
+experiment Experiment2-Latency
+sim       sim-R10K/sim-R10K-reg
+args      -insn:limit 60000000
+bench     ammp bzip2 crafty equake gcc lucas mcf mesa mgrid parser vortex
+param     -l1_pregfile:lat 1..10
+
+experiment Experiment3-RWidth
+sim       sim-R10K/sim-R10K-reg
+args      -insn:limit 60000000
+bench     ammp bzip2 crafty equake gcc lucas mcf mesa mgrid parser vortex
+param     -l1_pregfile:rwidth 1..12
+
+experiment Experiment4-Wwidth
+sim       sim-R10K/sim-R10K-reg
+args      -insn:limit 60000000
+bench     ammp bzip2 crafty equake gcc lucas mcf mesa mgrid parser vortex
+param     -l1_pregfile:wwidth 1..12
+
+experiment Experiment5-PregRUUNum
+sim       sim-R10K/sim-R10K
+args      -insn:limit 60000000
+bench     ammp bzip2 equake gcc lucas mesa parser vortex
+param     -rename:pregs:num 131..1027 step 128  -sched:rob:size 64..960 step 128
+
+experiment Experiment5-PregRUUNum
+sim       sim-R10K/sim-R10K-reg
+args      -insn:limit 60000000
+bench     ammp bzip2 equake gcc lucas mesa parser vortex
+param     -l1_pregfile:size 131..1027 step 128  -sched:rob:size 64..960 step 128
+
+experiment Experiment6-RUUNum
+sim       sim-R10K/sim-R10K
+args      -insn:limit 60000000
+bench     ammp bzip2 equake gcc lucas mesa parser vortex
+param     -sched:rob:size 64..960 step 128
+
+experiment Experiment6-RUUNum
+sim       sim-R10K/sim-R10K-reg
+args      -insn:limit 60000000
+bench     ammp bzip2 equake gcc lucas mesa parser vortex
+param     -sched:rob:size 64..960 step 128
+
+experiment Experiment7-RegHierarchy
+sim       sim-R10K/sim-R10K-reg
+args      -insn:limit 60000000
+bench     ammp bzip2 crafty equake gcc lucas mcf mesa mgrid parser vortex
+param     -config config1.cfg,config2.cfg,config3.cfg,config4.cfg,config5.cfg,config6.cfg
+
+experiment Experiment8-L2Width
+sim       sim-R10K/sim-R10K-reg
+args      -insn:limit 60000000 -config exp8-base.cfg
+bench     ammp bzip2 crafty equake gcc lucas mcf mesa mgrid parser vortex
+param     -l2_pregfile:rwidth 1..4  -l2_pregfile:wwidth 1..4
+
+experiment Experiment9-L2Lat
+sim       sim-R10K/sim-R10K-reg
+args      -insn:limit 60000000 -config exp9-base.cfg
+bench     ammp bzip2 crafty equake gcc lucas mcf mesa mgrid parser vortex
+param     -l2_pregfile:lat 1..4
+
+experiment Experiment10-L2Width-Cache
+sim       sim-R10K/sim-R10K-reg
+args      -insn:limit 60000000 -config exp10-base.cfg
+bench     ammp bzip2 crafty equake gcc lucas mcf mesa mgrid parser vortex
+param     -l2_pregfile:rwidth 1..4  -l2_pregfile:wwidth 1..4
+
+experiment Experiment11-L2Lat-Cache
+sim       sim-R10K/sim-R10K-reg
+args      -insn:limit 60000000 -config exp11-base.cfg
+bench     ammp bzip2 crafty equake gcc lucas mcf mesa mgrid parser vortex
+param     -l2_pregfile:lat 1..4
+
+experiment Experiment12-L1-CacheSize
+sim       sim-R10K/sim-R10K-reg
+args      -insn:limit 60000000 -config exp12-base.cfg
+bench     ammp bzip2 crafty equake gcc lucas mcf mesa mgrid parser vortex
+param     -l1_pregfile:size 12..64 step 8
@@ -1,5 +1,6 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "machine.h"
 #include "options.h"
@@ -11,13 +12,25 @@ adisambig_check_options(struct adisambig_opt_t *opt)
   if (!mystricmp(opt->opt, "perfect")) opt->strategy = adisambig_PERFECT;
   else if (!mystricmp(opt->opt, "conservative")) opt->strategy = adisambig_CONSERVATIVE;
   else if (!mystricmp(opt->opt, "opportunistic")) opt->strategy = adisambig_OPPORTUNISTIC;
+  else if (!strncmp(opt->opt, "storesets:", 10))
+    {
+      opt->strategy = adisambig_STORESETS;
+      opt->clear_interval = 1000000;
+      if (sscanf(opt->opt, "storesets:%u:%u:%u",
+		 &opt->ssit_size, &opt->lfst_size, &opt->clear_interval) < 2)
+	fatal("bad store sets config, use: storesets:<ssit_size>:<lfst_size>[:<clear_cycles>]");
+      if (opt->ssit_size < 1 || !IS_POWEROF2(opt->ssit_size))
+	fatal("store sets SSIT size must be a positive power of 2");
+      if (opt->lfst_size < 1 || !IS_POWEROF2(opt->lfst_size))
+	fatal("store sets LFST size must be a positive power of 2");
+    }
   else if (sscanf(opt->opt, "%d:%d", &opt->n_sets, &opt->n_ways) == 2)
     {
       opt->strategy = adisambig_CHT;
       if (opt->n_sets < 1 || opt->n_ways < 1)
 	fatal("cht sets and ways must be positive!");
     }
-  else fatal("unknown memory disambiguation model: '%s'", opt);
+  else fatal("unknown memory disambiguation model: '%s'", opt->opt);
 }
 
 struct cht_ent_t 
@@ -91,6 +104,21 @@ cht_create(struct adisambig_opt_t *opt)
   return cht;
 }
 
+void
+cht_destroy(struct cht_t *cht)
+{
+  int i;
+
+  for (i = 0; i < cht->opt->n_sets; i++)
+    {
+      free(cht->sets[i].flist);
+      free(cht->sets[i].ht);
+      free(cht->sets[i].lht);
+    }
+  free(cht->sets);
+  free(cht);
+}
+
 static void
 cht_set_unchain_lru(struct cht_set_t *set,
 		    struct cht_ent_t *che)
@@ -221,3 +249,71 @@ cht_lookup(struct cht_t *cht,
 
   return 0;
 }
+
+struct storeset_t
+{
+  struct adisambig_opt_t *opt;
+
+  int *ssit;			/* store set ids, -1 invalid */
+};
+
+struct storeset_t *
+storeset_create(struct adisambig_opt_t *opt)
+{
+  struct storeset_t *ss;
+
+  ss = (struct storeset_t *)calloc(1, sizeof(struct storeset_t));
+  if (!ss)
+    fatal("out of virtual memory");
+  ss->opt = opt;
+
+  ss->ssit = (int *)calloc(opt->ssit_size, sizeof(int));
+  if (!ss->ssit)
+    fatal("cannot allocate store set id table");
+  storeset_clear(ss);
+
+  return ss;
+}
+
+void
+storeset_destroy(struct storeset_t *ss)
+{
+  free(ss->ssit);
+  free(ss);
+}
+
+int
+storeset_lookup(struct storeset_t *ss,
+		md_addr_t PC)
+{
+  return ss->ssit[MOD(SHIFT_PC(PC), ss->opt->ssit_size)];
+}
+
+void
+storeset_enter(struct storeset_t *ss,
+	       md_addr_t load_PC,
+	       md_addr_t store_PC)
+{
+  int *load_id = &ss->ssit[MOD(SHIFT_PC(load_PC), ss->opt->ssit_size)];
+  int *store_id = &ss->ssit[MOD(SHIFT_PC(store_PC), ss->opt->ssit_size)];
+
+  /* neither in a set => new set, else join the other's set, and merge
+     two sets into the one with the smaller id */
+  if (*load_id < 0 && *store_id < 0)
+    *load_id = *store_id = MOD(SHIFT_PC(load_PC), ss->opt->lfst_size);
+  else if (*load_id < 0)
+    *load_id = *store_id;
+  else if (*store_id < 0)
+    *store_id = *load_id;
+  else
+    *load_id = *store_id = MIN(*load_id, *store_id);
+}
+
+void
+storeset_clear(struct storeset_t *ss)
+{
+  int i;
+
+  for (i = 0; i < ss->opt->ssit_size; i++)
+    ss->ssit[i] = -1;
+}
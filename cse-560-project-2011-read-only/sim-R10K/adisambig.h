@@ -7,6 +7,7 @@ enum adisambig_t
   adisambig_CONSERVATIVE,
   adisambig_OPPORTUNISTIC,
   adisambig_CHT,
+  adisambig_STORESETS,
   adisambig_NUM
 };
 
@@ -17,9 +18,15 @@ struct adisambig_opt_t
 
   unsigned int n_ways;
   unsigned int n_sets;
+
+  /* store sets */
+  unsigned int ssit_size;	/* store set id table entries */
+  unsigned int lfst_size;	/* store sets, last fetched store table entries */
+  unsigned int clear_interval;	/* cycles between SSIT clears, 0 never */
 };
 
 struct cht_t;
+struct storeset_t;
 
 void 
 adisambig_check_options(struct adisambig_opt_t *opt);
@@ -27,6 +34,9 @@ adisambig_check_options(struct adisambig_opt_t *opt);
 struct cht_t *
 cht_create(struct adisambig_opt_t *opt);
 
+void
+cht_destroy(struct cht_t *cht);
+
 unsigned int
 cht_lookup(struct cht_t *cht,
 	   md_addr_t PC);
@@ -36,4 +46,30 @@ cht_enter(struct cht_t *cht,
 	  md_addr_t PC,
 	  unsigned int store_dist);
 
+/* store sets (Chrysos and Emer): the SSIT maps load and store PCs to
+   store set ids, the simulator keeps the LFST, the last fetched store
+   of each set, and has each load or store wait for the last fetched
+   store of its set */
+struct storeset_t *
+storeset_create(struct adisambig_opt_t *opt);
+
+void
+storeset_destroy(struct storeset_t *ss);
+
+/* store set id of the load or store at PC, -1 for none */
+int
+storeset_lookup(struct storeset_t *ss,
+		md_addr_t PC);
+
+/* put the load at LOAD_PC and the store at STORE_PC it collided with
+   in one store set */
+void
+storeset_enter(struct storeset_t *ss,
+	       md_addr_t load_PC,
+	       md_addr_t store_PC);
+
+/* forget all store sets, bounding the false dependences they build up */
+void
+storeset_clear(struct storeset_t *ss);
+
 #endif /* ADISAMBIG_H */
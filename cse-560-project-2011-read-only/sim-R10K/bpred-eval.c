@@ -0,0 +1,339 @@
+/* bpred-eval.c - replay branch traces through branch predictor configurations
+ *
+ * usage: bpred-eval [-j <threads>] [-o <file>] <configs> <trace>...
+ *
+ * Replays every branch trace (written by sim-func -btrace <file>) through
+ * every branch predictor configuration of the file <configs>, and writes
+ * one CSV line per configuration and benchmark to -o (default stdout):
+ *
+ *   config,bench,insn,branches,misses,mpki,cond_branches,cond_misses,cond_mpki
+ *
+ * <configs> is line oriented, `#' starts a comment, and each line is a
+ * configuration name followed by -bpred:* options, e.g.
+ *
+ *   gshare   -bpred:dir1 none -bpred:dirchooser none -bpred:dir2 4096:2:12:0
+ *   tage     -bpred:dirmethod tage
+ *   tage-it  -bpred:dirmethod tage -bpred:ittage 6:256:9:4:64
+ *
+ * Options not given keep the sim-R10K defaults.  The benchmark name is
+ * the trace file name up to its first `.'.  Traces are loaded into
+ * memory once and shared, and the configuration x benchmark runs are
+ * spread over -j worker threads (default the number of online CPUs).
+ * Each branch is predicted as in the functional warmup of the timing
+ * simulators: lookup, recover on a mis-prediction, then update.  A miss
+ * is a wrong next PC, a conditional miss a wrong direction.  Warmup
+ * records train the predictor but are not counted.  Only the final
+ * candidates then need the timing simulator.
+ *
+ * build: cc -o bpred-eval bpred-eval.c btrace.c bpred.c options.c stats.c
+ *        machine.c misc.c -lz -lm -lpthread
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "host.h"
+#include "misc.h"
+#include "machine.h"
+#include "options.h"
+#include "sim.h"
+#include "bpred.h"
+#include "btrace.h"
+
+#define MAX_ARGS		256
+
+/* predictor statistics count in sample mode */
+enum sample_mode_t sample_mode = sample_ON;
+
+/* one predictor configuration */
+struct eval_config_t
+{
+  char *name;
+  struct bpred_opt_t opt;
+};
+
+/* one loaded trace */
+struct eval_trace_t
+{
+  char *bench;
+  unsigned char *buf;
+  size_t len;
+};
+
+/* one configuration x trace run */
+struct eval_run_t
+{
+  struct eval_config_t *config;
+  struct eval_trace_t *trace;
+
+  counter_t insn;
+  counter_t branches;
+  counter_t misses;
+  counter_t cond_branches;
+  counter_t cond_misses;
+};
+
+static struct eval_config_t *configs = NULL;
+static int n_configs = 0;
+
+static struct eval_trace_t *traces = NULL;
+static int n_traces = 0;
+
+static struct eval_run_t *runs = NULL;
+static int n_runs = 0;
+
+/* next run to start */
+static int next_run = 0;
+static pthread_mutex_t next_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void
+usage(char *prog)
+{
+  fprintf(stderr,
+	  "usage: %s [-j <threads>] [-o <file>] <configs> <trace>...\n",
+	  prog);
+  exit(1);
+}
+
+/* read the predictor configurations of FNAME */
+static void
+read_configs(char *fname)
+{
+  FILE *fd;
+  char line[4096], *p, *tok[MAX_ARGS];
+  int n_tok, line_num = 0;
+  struct opt_odb_t *odb;
+  struct eval_config_t *c;
+
+  fd = fopen(fname, "r");
+  if (!fd)
+    fatal("could not open configuration file `%s'", fname);
+
+  while (fgets(line, sizeof(line), fd))
+    {
+      line_num++;
+      if ((p = strchr(line, '#')) != NULL)
+	*p = '\0';
+
+      /* tok[0] stands in for the program name */
+      tok[0] = "bpred-eval";
+      for (n_tok = 1, p = strtok(line, " \t\r\n"); p; p = strtok(NULL, " \t\r\n"))
+	{
+	  if (n_tok == MAX_ARGS)
+	    fatal("%s:%d: line too long", fname, line_num);
+	  tok[n_tok++] = mystrdup(p);
+	}
+      if (n_tok == 1)
+	continue;
+
+      configs = (struct eval_config_t *)
+	realloc(configs, (n_configs + 1) * sizeof(struct eval_config_t));
+      if (!configs)
+	fatal("out of virtual memory");
+      c = &configs[n_configs++];
+      memset(c, 0, sizeof(*c));
+      c->name = tok[1];
+
+      bpred_default_options(&c->opt);
+
+      odb = opt_new(NULL);
+      bpred_reg_options(odb, &c->opt);
+      /* skip the name, the options follow */
+      tok[1] = tok[0];
+      opt_process_options(odb, n_tok - 1, tok + 1);
+      bpred_check_options(&c->opt);
+    }
+  fclose(fd);
+
+  if (n_configs == 0)
+    fatal("no configurations in `%s'", fname);
+}
+
+/* load the trace FNAME into T */
+static void
+read_trace(char *fname, struct eval_trace_t *t)
+{
+  FILE *fd;
+  long len;
+  unsigned int version;
+  char *p;
+
+  fd = fopen(fname, "rb");
+  if (!fd)
+    fatal("could not open branch trace `%s'", fname);
+
+  if (fseek(fd, 0, SEEK_END) != 0 || (len = ftell(fd)) < 0)
+    fatal("could not size branch trace `%s'", fname);
+  rewind(fd);
+
+  t->len = (size_t)len;
+  t->buf = (unsigned char *)mycalloc(t->len + 1, sizeof(unsigned char));
+  if (fread(t->buf, 1, t->len, fd) != t->len)
+    fatal("could not read branch trace `%s'", fname);
+  fclose(fd);
+
+  if (t->len < 8
+      || (t->buf[0] | t->buf[1] << 8 | t->buf[2] << 16 | (unsigned)t->buf[3] << 24) != BTRACE_MAGIC)
+    fatal("`%s' is not a branch trace", fname);
+  version = t->buf[4] | t->buf[5] << 8 | t->buf[6] << 16 | (unsigned)t->buf[7] << 24;
+  if (version != BTRACE_VERSION)
+    fatal("`%s' is a version %u branch trace, expected version %u",
+	  fname, version, (unsigned)BTRACE_VERSION);
+
+  /* benchmark: file name up to the first `.' */
+  p = strrchr(fname, '/') ? strrchr(fname, '/') + 1 : fname;
+  t->bench = mystrdup(p);
+  if ((p = strchr(t->bench, '.')) != NULL && p != t->bench)
+    *p = '\0';
+}
+
+/* replay run R */
+static void
+eval_run(struct eval_run_t *r)
+{
+  struct bpred_t *bp;
+  struct bpred_state_t state;
+  struct btrace_cursor_t c;
+  struct btrace_rec_t rec;
+  md_addr_t ppc;
+  bool_t count;
+
+  bp = bpred_create(&r->config->opt);
+  btrace_cursor_init(&c, r->trace->buf, r->trace->len);
+
+  while (btrace_next(&c, &rec))
+    {
+      count = !(rec.flags & BTRACE_WARM);
+      if (count)
+	r->insn += rec.n_insn;
+      if (rec.flags & BTRACE_NOBR)
+	continue;
+
+      ppc = bpred_lookup(bp, rec.PC, rec.op, &state);
+      if (ppc != rec.NPC)
+	bpred_recover(bp, rec.PC, rec.op, rec.NPC, &state);
+      bpred_update(bp, rec.PC, rec.op, rec.NPC, rec.TPC, ppc, &state);
+
+      if (!count)
+	continue;
+
+      r->branches++;
+      if (ppc != rec.NPC)
+	r->misses++;
+      if (MD_OP_HASFLAGS(rec.op, F_COND))
+	{
+	  r->cond_branches++;
+	  if ((ppc != rec.PC + sizeof(md_inst_t)) != !!(rec.flags & BTRACE_TAKEN))
+	    r->cond_misses++;
+	}
+    }
+
+  bpred_delete(bp);
+}
+
+/* worker thread, replays runs until none are left */
+static void *
+eval_worker(void *arg)
+{
+  int i;
+
+  for (;;)
+    {
+      pthread_mutex_lock(&next_lock);
+      i = next_run++;
+      pthread_mutex_unlock(&next_lock);
+
+      if (i >= n_runs)
+	break;
+      eval_run(&runs[i]);
+    }
+  return NULL;
+}
+
+int
+main(int argc, char **argv)
+{
+  pthread_t *threads;
+  FILE *out = stdout;
+  char *out_name = NULL;
+  int i, j, n_threads;
+  struct eval_run_t *r;
+
+#ifdef _SC_NPROCESSORS_ONLN
+  n_threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#else
+  n_threads = 1;
+#endif
+  if (n_threads < 1)
+    n_threads = 1;
+
+  for (i = 1; i < argc && argv[i][0] == '-'; i++)
+    {
+      if (!strcmp(argv[i], "-j") && i + 1 < argc)
+	n_threads = atoi(argv[++i]);
+      else if (!strcmp(argv[i], "-o") && i + 1 < argc)
+	out_name = argv[++i];
+      else
+	usage(argv[0]);
+    }
+  if (argc - i < 2 || n_threads < 1)
+    usage(argv[0]);
+
+  read_configs(argv[i++]);
+
+  n_traces = argc - i;
+  traces = (struct eval_trace_t *)mycalloc(n_traces, sizeof(struct eval_trace_t));
+  for (j = 0; j < n_traces; j++)
+    read_trace(argv[i + j], &traces[j]);
+
+  /* benchmark-major, so the workers start on different configurations
+     of one trace while it is hot in the host caches */
+  n_runs = n_configs * n_traces;
+  runs = (struct eval_run_t *)mycalloc(n_runs, sizeof(struct eval_run_t));
+  for (i = 0; i < n_traces; i++)
+    for (j = 0; j < n_configs; j++)
+      {
+	runs[i * n_configs + j].config = &configs[j];
+	runs[i * n_configs + j].trace = &traces[i];
+      }
+
+  if (n_threads > n_runs)
+    n_threads = n_runs;
+  fprintf(stderr, "bpred-eval: %d configurations x %d traces, %d threads\n",
+	  n_configs, n_traces, n_threads);
+
+  threads = (pthread_t *)mycalloc(n_threads, sizeof(pthread_t));
+  for (i = 0; i < n_threads; i++)
+    if (pthread_create(&threads[i], NULL, eval_worker, NULL) != 0)
+      fatal("could not start worker thread");
+  for (i = 0; i < n_threads; i++)
+    pthread_join(threads[i], NULL);
+
+  if (out_name)
+    {
+      out = fopen(out_name, "w");
+      if (!out)
+	fatal("could not open `%s'", out_name);
+    }
+
+  fprintf(out, "config,bench,insn,branches,misses,mpki,cond_branches,cond_misses,cond_mpki\n");
+  for (j = 0; j < n_configs; j++)
+    for (i = 0; i < n_traces; i++)
+      {
+	r = &runs[i * n_configs + j];
+	fprintf(out, "%s,%s,%lld,%lld,%lld,%.4f,%lld,%lld,%.4f\n",
+		r->config->name, r->trace->bench, (long long)r->insn,
+		(long long)r->branches, (long long)r->misses,
+		r->insn ? 1000.0 * r->misses / r->insn : 0.0,
+		(long long)r->cond_branches, (long long)r->cond_misses,
+		r->insn ? 1000.0 * r->cond_misses / r->insn : 0.0);
+      }
+
+  if (out != stdout)
+    fclose(out);
+
+  return 0;
+}
@@ -104,6 +104,7 @@
 /* external definitions */
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 #include <assert.h>
 #include "machine.h"
@@ -121,6 +122,8 @@ str2bpclass(char *s)
   if (!mystricmp(s, "taken")) return bpclass_TAKEN;
   else if (!mystricmp(s, "nottaken")) return bpclass_NOTTAKEN;
   else if (!mystricmp(s, "dynamic")) return bpclass_DYNAMIC;
+  else if (!mystricmp(s, "tage")) return bpclass_TAGE;
+  else if (!mystricmp(s, "perceptron")) return bpclass_PERCEPTRON;
   else fatal("unknown bpred class");
 
   return bpclass_NUM;
@@ -130,22 +133,25 @@ str2bpclass(char *s)
 #define UPDATE_TAKEN(P,PBITS,TAKEN) \
    { if (TAKEN && P < ((1<<PBITS)-1)) { ++P; } else if (!TAKEN && P > 0) { --P; } }
 
-/* an entry in a BTB */
-struct bpred_btb_ent_t {
-  md_addr_t pc;		/* address of branch being tracked */
-  md_addr_t target;		/* last destination of branch when taken */
-  struct bpred_btb_ent_t *prev, *next; /* lru chaining pointers */
-};
-
-struct bpred_btb_set_t {
-  struct bpred_btb_ent_t *head, *tail;
-};
+/* a set-associative BTB, each set's ways are packed in consecutive
+   slots of the tag, target and age arrays.  a tag is the <tbits> PC
+   bits above the set index shifted over a valid bit, 32-bit tags keep
+   the way compare in vector registers.  sets are padded with invalid
+   ways to a multiple of BTB_ALIGN so the compare needs no scalar tail.
+   ages rank the ways of a set from 0 (MRU) to assoc-1 (LRU) */
+#define BTB_ALIGN	4
+#define BTB_TAG(BTB, PC) \
+  ((((unsigned int)(SHIFT_PC(PC) >> (BTB)->set_shift) & (BTB)->tag_mask) << 1) | 1)
 
 struct bpred_btb_t {
   struct bpred_btb_opt_t *opt;
-  md_addr_t tag_mask;
+  int ways;			/* assoc padded to BTB_ALIGN */
+  int set_shift;
+  unsigned int tag_mask;
   md_addr_t data_mask;
-  struct bpred_btb_set_t *sets;
+  unsigned int *tags;		/* nsets * ways tags */
+  md_addr_t *targets;		/* nsets * ways targets */
+  unsigned char *ages;		/* nsets * ways LRU ranks */
 };
 
 /* direction predictor def */
@@ -166,6 +172,141 @@ struct bpred_ras_t {
   struct bpred_ras_state_t s;
 };
 
+/* a TAGE tagged component entry */
+struct bpred_tage_ent_t {
+  unsigned short tag;
+  signed char ctr;		/* 3-bit signed counter, taken if >= 0 */
+  unsigned char u;		/* 2-bit useful counter */
+};
+
+#define TAGE_CTR_MAX		3
+#define TAGE_CTR_MIN		-4
+#define TAGE_U_MAX		3
+#define TAGE_USE_ALT_MAX	7
+#define TAGE_USE_ALT_MIN	-8
+
+/* useful bits are aged every 2^TAGE_U_RESET_LOG updates */
+#define TAGE_U_RESET_LOG	18
+
+/* branches that may be in flight, the slack in the history buffer past
+   the longest history and the size of the loop undo log (a power of 2) */
+#define TAGE_HIST_SLACK		4096
+
+/* a global history folded for the geometric history lengths of N
+   tagged components, shared by TAGE and ITTAGE */
+struct bpred_ghist_t {
+  int n;
+  int hlen[TAGE_MAX_TABLES];	/* history length of each component */
+  int log_size;			/* index bits */
+  int tbits;			/* tag bits */
+
+  unsigned char *hist;		/* history buffer */
+  unsigned int hmask;
+
+  struct bpred_tage_state_t s;
+};
+
+struct bpred_tage_t {
+  struct bpred_tage_opt_t *opt;
+  unsigned char *base;		/* bimodal 2-bit counters */
+  struct bpred_tage_ent_t *table[TAGE_MAX_TABLES];
+
+  int use_alt;			/* use the alternate on new entries if >= 0 */
+  counter_t n_updates;
+  int u_reset_lsb;		/* age the low, else the high, useful bit */
+
+  struct bpred_ghist_t h;
+};
+
+/* an ITTAGE entry */
+struct bpred_ittage_ent_t {
+  unsigned short tag;
+  unsigned char ctr;		/* 2-bit target confidence */
+  unsigned char u;		/* useful bit */
+  md_addr_t target;
+};
+
+#define ITTAGE_CTR_MAX		3
+
+struct bpred_ittage_t {
+  struct bpred_ittage_opt_t *opt;
+  struct bpred_ittage_ent_t *table[TAGE_MAX_TABLES];
+  counter_t n_updates;
+
+  struct bpred_ghist_t h;
+};
+
+/* an ITTAGE prediction, computed for lookup and again for update */
+struct bpred_ittage_pred_t {
+  int idx[TAGE_MAX_TABLES];
+  unsigned int tag[TAGE_MAX_TABLES];
+  int provider;			/* hitting component, or -1 */
+  int alt;			/* next hitting component, or -1 */
+  md_addr_t target;		/* 0 when no component hits */
+};
+
+/* a TAGE prediction, computed for lookup and again for update */
+struct bpred_tage_pred_t {
+  int idx[TAGE_MAX_TABLES];
+  unsigned int tag[TAGE_MAX_TABLES];
+  int bidx;
+  int provider;			/* hitting component, -1 for the base */
+  int alt;			/* next hitting component, -1 for the base */
+  bool_t pred;			/* provider prediction */
+  bool_t alt_pred;
+  bool_t tage_pred;		/* final TAGE prediction */
+};
+
+/* a loop predictor entry */
+struct bpred_loop_ent_t {
+  unsigned short tag;
+  unsigned short past_iter;	/* trip count */
+  unsigned short iter;		/* speculative iteration */
+  unsigned short nspec_iter;	/* non-speculative iteration */
+  unsigned char conf;
+  unsigned char age;
+  bool_t dir;			/* direction while looping */
+};
+
+#define LOOP_CONF_MAX		3
+#define LOOP_AGE_MAX		7
+#define LOOP_ITER_MAX		0xffff
+#define LOOP_USE_MAX		63
+#define LOOP_USE_MIN		-64
+
+/* speculative iteration changes, undone on recovery */
+struct bpred_loop_undo_t {
+  int ent;
+  unsigned short tag;
+  unsigned short iter;
+};
+
+struct bpred_loop_t {
+  struct bpred_loop_opt_t *opt;
+  struct bpred_loop_ent_t *ents;
+  int log_size;
+  int use;			/* loop beats TAGE if >= 0 */
+
+  struct bpred_loop_undo_t *undo;
+  unsigned int undo_ptr;
+};
+
+/* inputs per weight row are padded to a multiple of PERC_ALIGN */
+#define PERC_ALIGN		16
+
+struct bpred_perc_t {
+  struct bpred_perc_opt_t *opt;
+  signed char *weights;		/* SIZE rows of STRIDE weights */
+  int stride;
+  int log_size;
+
+  /* speculative inputs, +1/-1 for bias, global then path history, and 0
+     for padding */
+  signed char *x;
+
+  struct bpred_perc_state_t s;
+};
+
 /* branch predictor def */
 struct bpred_t 
 {
@@ -179,6 +320,16 @@ struct bpred_t
 
   struct bpred_ras_t *ras;        /* return address stack */
 
+  struct bpred_tage_t *tage;      /* TAGE direction predictor */
+  struct bpred_loop_t *loop;      /* TAGE loop predictor */
+
+  struct bpred_perc_t *perc;      /* perceptron direction predictor */
+
+  struct bpred_ittage_t *ittage;  /* indirect jump target predictor */
+
+  unsigned int seed;		  /* allocation coin flips, per predictor so
+				     concurrent instances are reproducible */
+
   /* stats */
   counter_t lookups;
   counter_t updates;
@@ -194,21 +345,61 @@ struct bpred_t
   counter_t uncond_addr_hits;
   counter_t ret_updates;
   counter_t ret_hits;	
+  counter_t indir_updates;
+  counter_t indir_hits;
+
+  counter_t tage_provider[TAGE_MAX_TABLES + 1];
+  counter_t tage_allocs;
+  counter_t loop_lookups;
+  counter_t loop_hits;
+  counter_t perc_trains;
+  counter_t ittage_provider[TAGE_MAX_TABLES + 1];
+  counter_t ittage_allocs;
 };
 
 void
 bpred_stats_print(const struct bpred_t *bp,
+		  counter_t n_insn,
 		  FILE *stream)
 {
   print_counter(stream, "bpred.lookups", bp->updates, "total bpred lookups");
   print_counter(stream, "bpred.hits", bp->addr_hits, "total bpred address hits");
-  print_rate(stream, "bpred.hit_rate", (double)bp->addr_hits/bp->updates, "bpred address hit-rate");
+  print_formula(stream, "bpred.hit_rate", 1.0, "bpred.hits", "bpred.lookups", "hit/lookup", "bpred address hit-rate");
   print_counter(stream, "bpred.cond_dir_lookups", bp->cond_updates, "bpred conditional branch direction lookups");
   print_counter(stream, "bpred.cond_dir_hits", bp->cond_dir_hits, "bpred conditional branch direction hits");
-  print_rate(stream, "bpred.cond_dir_hit_rate", (double)bp->cond_dir_hits/bp->cond_updates, "bpred conditional branch direction hit-rate");
+  print_formula(stream, "bpred.cond_dir_hit_rate", 1.0, "bpred.cond_dir_hits", "bpred.cond_dir_lookups", "hit/lookup", "bpred conditional branch direction hit-rate");
+  print_counter(stream, "bpred.cond_dir_misses", bp->cond_updates - bp->cond_dir_hits, "bpred conditional branch direction misses");
+  print_counter(stream, "bpred.insn", n_insn, "instructions, for the per 1000 instruction rates");
+  print_formula(stream, "bpred.cond_dir_mpki", 1000.0, "bpred.cond_dir_misses", "bpred.insn", "miss/kinsn", "bpred conditional branch direction misses per 1000 instructions");
   print_counter(stream, "bpred.ret_lookups", bp->ret_updates, "bpred return address lookups");
   print_counter(stream, "bpred.ret_hits", bp->ret_hits, "bpred return address hits");
-  print_rate(stream, "bpred.ret_hit_rate", (double)bp->ret_hits/bp->ret_updates, "bpred return address hit-rate");
+  print_formula(stream, "bpred.ret_hit_rate", 1.0, "bpred.ret_hits", "bpred.ret_lookups", "hit/lookup", "bpred return address hit-rate");
+  print_counter(stream, "bpred.indir_lookups", bp->indir_updates, "bpred indirect jump (not return) target lookups");
+  print_counter(stream, "bpred.indir_hits", bp->indir_hits, "bpred indirect jump target hits");
+  print_formula(stream, "bpred.indir_hit_rate", 1.0, "bpred.indir_hits", "bpred.indir_lookups", "hit/lookup", "bpred indirect jump target hit-rate");
+
+  if (bp->tage)
+    {
+      print_dist(stream, "bpred.tage_provider", bp->tage_provider, bp->tage->opt->ntables + 1, "bpred TAGE provider of conditional branches, base then shortest to longest history");
+      print_counter(stream, "bpred.tage_allocs", bp->tage_allocs, "bpred TAGE entries allocated");
+    }
+  if (bp->loop)
+    {
+      print_counter(stream, "bpred.loop_lookups", bp->loop_lookups, "bpred conditional branches predicted by the loop predictor");
+      print_counter(stream, "bpred.loop_hits", bp->loop_hits, "bpred loop predictor direction hits");
+      print_formula(stream, "bpred.loop_hit_rate", 1.0, "bpred.loop_hits", "bpred.loop_lookups", "hit/lookup", "bpred loop predictor direction hit-rate");
+    }
+  if (bp->perc)
+    {
+      print_counter(stream, "bpred.perc_theta", bp->opt->perc_opt.theta, "bpred perceptron training threshold");
+      print_counter(stream, "bpred.perc_trains", bp->perc_trains, "bpred perceptron weight updates");
+      print_formula(stream, "bpred.perc_train_rate", 1.0, "bpred.perc_trains", "bpred.cond_dir_lookups", "update/branch", "bpred perceptron weight updates per conditional branch");
+    }
+  if (bp->ittage)
+    {
+      print_dist(stream, "bpred.ittage_provider", bp->ittage_provider, bp->ittage->opt->ntables + 1, "bpred ITTAGE provider of indirect jumps, none (BTB) then shortest to longest history");
+      print_counter(stream, "bpred.ittage_allocs", bp->ittage_allocs, "bpred ITTAGE entries allocated");
+    }
 }
 
 /* create a branch direction predictor */
@@ -248,34 +439,24 @@ bpred_btb_create(struct bpred_btb_opt_t *opt)
     fatal("cannot allocate btb");
 
   btb->opt = opt;
-  btb->sets = (struct bpred_btb_set_t *) calloc 
-    (btb->opt->nsets, sizeof(struct bpred_btb_set_t)); 
-  if (!btb->sets)
+  btb->ways = (btb->opt->assoc + BTB_ALIGN - 1) & ~(BTB_ALIGN - 1);
+  btb->tags = (unsigned int *) calloc
+    (btb->opt->nsets * btb->ways, sizeof(unsigned int));
+  btb->targets = (md_addr_t *) calloc
+    (btb->opt->nsets * btb->ways, sizeof(md_addr_t));
+  btb->ages = (unsigned char *) calloc
+    (btb->opt->nsets * btb->ways, sizeof(unsigned char));
+  if (!btb->tags || !btb->targets || !btb->ages)
     fatal("cannot allocate btb data");
 
-  btb->tag_mask = UNSHIFT_PC((((md_addr_t)1 << btb->opt->tbits)-1) << log_base2(btb->opt->nsets));
+  btb->set_shift = log_base2(btb->opt->nsets);
+  btb->tag_mask = (1U << btb->opt->tbits) - 1;
   btb->data_mask = UNSHIFT_PC(((md_addr_t)1 << btb->opt->dbits)-1);
 
-  /* Initialize way lists */
+  /* all ways start invalid, in LRU order */
   for (i = 0; i < btb->opt->nsets; i++)
-    {
-      struct bpred_btb_set_t *set = &btb->sets[i];
-      set->head = set->tail = NULL;
-      
-      for (j = 0; j < btb->opt->assoc - 1; j++)
-	{
-	  struct bpred_btb_ent_t *ent;
-	  
-	  ent = (struct bpred_btb_ent_t *)calloc(1, sizeof(struct bpred_btb_ent_t));
-	  if (!ent)
-	    fatal("unable to allocate btb entry!");
-
-	  if (set->head) set->head->prev = ent;
-	  else set->tail = ent;
-	  ent->next = set->head;
-	  set->head = ent;
-	}
-    }
+    for (j = 0; j < btb->opt->assoc; j++)
+      btb->ages[i * btb->ways + j] = j;
 
   return btb;
 }
@@ -299,12 +480,166 @@ bpred_ras_create(struct bpred_ras_opt_t *opt)
   return ras;
 }
 
+static void
+bpred_ghist_init(struct bpred_ghist_t *h,
+		 int n,
+		 int size,
+		 int tbits,
+		 int minhist,
+		 int maxhist)
+{
+  unsigned int hsize;
+  int i;
+
+  h->n = n;
+  h->log_size = log_base2(size);
+  h->tbits = tbits;
+
+  /* geometric series from minhist to maxhist */
+  for (i = 0; i < n; i++)
+    {
+      if (n == 1)
+	h->hlen[i] = minhist;
+      else
+	h->hlen[i] = (int)(minhist * pow((double)maxhist / minhist, (double)i / (n - 1)) + 0.5);
+      if (i > 0 && h->hlen[i] <= h->hlen[i-1])
+	h->hlen[i] = h->hlen[i-1] + 1;
+    }
+
+  for (hsize = 1; hsize < maxhist + TAGE_HIST_SLACK; hsize <<= 1)
+    ;
+  h->hist = (unsigned char *) calloc (hsize, sizeof(unsigned char));
+  if (!h->hist)
+    fatal("cannot allocate global history");
+  h->hmask = hsize - 1;
+}
+
+static struct bpred_tage_t *
+bpred_tage_create(struct bpred_tage_opt_t *opt)
+{
+  struct bpred_tage_t *tage;
+  int i;
+
+  tage = (struct bpred_tage_t *) calloc (1, sizeof(struct bpred_tage_t));
+  if (!tage)
+    fatal("cannot allocate TAGE");
+
+  tage->opt = opt;
+
+  tage->base = (unsigned char *) calloc (opt->bsize, sizeof(unsigned char));
+  if (!tage->base)
+    fatal("cannot allocate TAGE base storage");
+  /* weakly taken */
+  for (i = 0; i < opt->bsize; i++)
+    tage->base[i] = 2;
+
+  for (i = 0; i < opt->ntables; i++)
+    {
+      tage->table[i] = (struct bpred_tage_ent_t *) calloc (opt->size, sizeof(struct bpred_tage_ent_t));
+      if (!tage->table[i])
+	fatal("cannot allocate TAGE component storage");
+    }
+
+  bpred_ghist_init(&tage->h, opt->ntables, opt->size, opt->tbits, opt->minhist, opt->maxhist);
+
+  return tage;
+}
+
+static struct bpred_ittage_t *
+bpred_ittage_create(struct bpred_ittage_opt_t *opt)
+{
+  struct bpred_ittage_t *ittage;
+  int i;
+
+  ittage = (struct bpred_ittage_t *) calloc (1, sizeof(struct bpred_ittage_t));
+  if (!ittage)
+    fatal("cannot allocate ITTAGE");
+
+  ittage->opt = opt;
+  for (i = 0; i < opt->ntables; i++)
+    {
+      ittage->table[i] = (struct bpred_ittage_ent_t *) calloc (opt->size, sizeof(struct bpred_ittage_ent_t));
+      if (!ittage->table[i])
+	fatal("cannot allocate ITTAGE component storage");
+    }
+
+  bpred_ghist_init(&ittage->h, opt->ntables, opt->size, opt->tbits, opt->minhist, opt->maxhist);
+
+  return ittage;
+}
+
+static struct bpred_loop_t *
+bpred_loop_create(struct bpred_loop_opt_t *opt)
+{
+  struct bpred_loop_t *loop;
+
+  loop = (struct bpred_loop_t *) calloc (1, sizeof(struct bpred_loop_t));
+  if (!loop)
+    fatal("cannot allocate loop predictor");
+
+  loop->opt = opt;
+  loop->log_size = log_base2(opt->size);
+  loop->ents = (struct bpred_loop_ent_t *) calloc (opt->size, sizeof(struct bpred_loop_ent_t));
+  if (!loop->ents)
+    fatal("cannot allocate loop predictor storage");
+  loop->undo = (struct bpred_loop_undo_t *) calloc (TAGE_HIST_SLACK, sizeof(struct bpred_loop_undo_t));
+  if (!loop->undo)
+    fatal("cannot allocate loop predictor undo log");
+
+  return loop;
+}
+
+static struct bpred_perc_t *
+bpred_perc_create(struct bpred_perc_opt_t *opt)
+{
+  struct bpred_perc_t *perc;
+  int i;
+
+  perc = (struct bpred_perc_t *) calloc (1, sizeof(struct bpred_perc_t));
+  if (!perc)
+    fatal("cannot allocate perceptron");
+
+  perc->opt = opt;
+  perc->log_size = log_base2(opt->size);
+  perc->stride = ((1 + opt->hbits + opt->pbits + PERC_ALIGN - 1) / PERC_ALIGN) * PERC_ALIGN;
+
+  perc->weights = (signed char *) calloc (opt->size * perc->stride, sizeof(signed char));
+  if (!perc->weights)
+    fatal("cannot allocate perceptron weights");
+
+  perc->x = (signed char *) calloc (perc->stride, sizeof(signed char));
+  if (!perc->x)
+    fatal("cannot allocate perceptron inputs");
+  perc->x[0] = 1;
+  for (i = 1; i < 1 + opt->hbits + opt->pbits; i++)
+    perc->x[i] = -1;
+
+  return perc;
+}
+
+/* the default predictor configuration, shared by the simulators and
+   bpred-eval so their runs stay comparable */
+void
+bpred_default_options(struct bpred_opt_t *opt)
+{
+  opt->opt = "dynamic";
+  opt->dir1_opt.opt = "1024:2:0:0";
+  opt->dir2_opt.opt = "1024:2:8:0";
+  opt->chooser_opt.opt = "1024:2";
+  opt->ras_opt.opt = "8";
+  opt->btb_opt.opt = "512:4:16:8";
+  opt->tage_opt.opt = "4096:7:1024:9:5:130";
+  opt->loop_opt.opt = "64";
+  opt->perc_opt.opt = "512:32:8:0";
+  opt->ittage_opt.opt = "none";
+}
+
 void
 bpred_reg_options(struct opt_odb_t *odb,
 		  struct bpred_opt_t *opt)
 {
   opt_reg_string(odb, "-bpred:dirmethod", 
-		 "predictor type {nottaken|taken|dynamic}",
+		 "predictor type {nottaken|taken|dynamic|tage|perceptron}",
                  &opt->opt, /* default */opt->opt,
                  /* print */TRUE, /* format */NULL);
  
@@ -332,12 +667,85 @@ bpred_reg_options(struct opt_odb_t *odb,
 		 "BTB config {none|<nsets>:<assoc>:<dbits>:<tbits>}",
 		 &opt->btb_opt.opt, /* default */opt->btb_opt.opt,
 		 /* print */TRUE, /* format */NULL);
+
+  opt_reg_string(odb, "-bpred:tage", 
+		 "TAGE config {<bsize>:<ntables>:<size>:<tbits>:<minhist>:<maxhist>}",
+		 &opt->tage_opt.opt, /* default */opt->tage_opt.opt,
+		 /* print */TRUE, /* format */NULL);
+
+  opt_reg_string(odb, "-bpred:loop", 
+		 "TAGE loop predictor config {none|<size>}",
+		 &opt->loop_opt.opt, /* default */opt->loop_opt.opt,
+		 /* print */TRUE, /* format */NULL);
+
+  opt_reg_string(odb, "-bpred:perceptron", 
+		 "perceptron config {<size>:<hbits>:<pbits>:<theta>}, theta 0 for 1.93 * inputs + 14",
+		 &opt->perc_opt.opt, /* default */opt->perc_opt.opt,
+		 /* print */TRUE, /* format */NULL);
+
+  opt_reg_string(odb, "-bpred:ittage", 
+		 "ITTAGE indirect target predictor config {none|<ntables>:<size>:<tbits>:<minhist>:<maxhist>}",
+		 &opt->ittage_opt.opt, /* default */opt->ittage_opt.opt,
+		 /* print */TRUE, /* format */NULL);
 }
 
 void
 bpred_check_options(struct bpred_opt_t *opt)
 {
   opt->bpclass = str2bpclass(opt->opt);
+
+  /* the perceptron replaces the two-level predictors */
+  if (opt->bpclass == bpclass_PERCEPTRON)
+    {
+      opt->dir1_opt.opt = opt->dir2_opt.opt = opt->chooser_opt.opt = "none";
+
+      if (sscanf(opt->perc_opt.opt, "%d:%d:%d:%d",
+		 &opt->perc_opt.size, &opt->perc_opt.hbits, &opt->perc_opt.pbits, &opt->perc_opt.theta) != 4)
+	fatal("bad bpred:perceptron parameters '%s'", opt->perc_opt.opt);
+      if (!IS_POWEROF2(opt->perc_opt.size))
+	fatal("bpred:perceptron <size> '%d' must be positive and a power of 2", opt->perc_opt.size);
+      if (opt->perc_opt.hbits < 0 || opt->perc_opt.hbits > PERC_MAX_HIST)
+	fatal("bpred:perceptron <hbits> '%d' must be >= 0 and <= %d", opt->perc_opt.hbits, PERC_MAX_HIST);
+      if (opt->perc_opt.pbits < 0 || opt->perc_opt.pbits > PERC_MAX_PATH)
+	fatal("bpred:perceptron <pbits> '%d' must be >= 0 and <= %d", opt->perc_opt.pbits, PERC_MAX_PATH);
+      if (opt->perc_opt.theta < 0)
+	fatal("bpred:perceptron <theta> '%d' must be >= 0", opt->perc_opt.theta);
+      if (opt->perc_opt.theta == 0)
+	opt->perc_opt.theta = (int)(1.93 * (opt->perc_opt.hbits + opt->perc_opt.pbits) + 14);
+    }
+
+  /* TAGE replaces the two-level predictors */
+  if (opt->bpclass == bpclass_TAGE)
+    {
+      opt->dir1_opt.opt = opt->dir2_opt.opt = opt->chooser_opt.opt = "none";
+
+      if (sscanf(opt->tage_opt.opt, "%d:%d:%d:%d:%d:%d",
+		 &opt->tage_opt.bsize, &opt->tage_opt.ntables, &opt->tage_opt.size,
+		 &opt->tage_opt.tbits, &opt->tage_opt.minhist, &opt->tage_opt.maxhist) != 6)
+	fatal("bad bpred:tage parameters '%s'", opt->tage_opt.opt);
+      if (!IS_POWEROF2(opt->tage_opt.bsize))
+	fatal("bpred:tage <bsize> '%d' must be positive and a power of 2", opt->tage_opt.bsize);
+      if (opt->tage_opt.ntables <= 0 || opt->tage_opt.ntables > TAGE_MAX_TABLES)
+	fatal("bpred:tage <ntables> '%d' must be > 0 and <= %d", opt->tage_opt.ntables, TAGE_MAX_TABLES);
+      if (!IS_POWEROF2(opt->tage_opt.size) || opt->tage_opt.size > (1 << 20))
+	fatal("bpred:tage <size> '%d' must be a power of 2 between 1 and 2^20", opt->tage_opt.size);
+      if (opt->tage_opt.tbits < 2 || opt->tage_opt.tbits > 16)
+	fatal("bpred:tage <tbits> '%d' must be >= 2 and <= 16", opt->tage_opt.tbits);
+      if (opt->tage_opt.minhist <= 0 || opt->tage_opt.maxhist < opt->tage_opt.minhist + opt->tage_opt.ntables - 1)
+	fatal("bpred:tage <minhist> must be positive and <maxhist> leave room for %d lengths", opt->tage_opt.ntables);
+      if (opt->tage_opt.maxhist > 2048)
+	fatal("bpred:tage <maxhist> '%d' must be <= 2048", opt->tage_opt.maxhist);
+
+      if (!mystricmp(opt->loop_opt.opt, "none"))
+	opt->loop_opt.size = 0;
+      else
+	{
+	  if (sscanf(opt->loop_opt.opt, "%d", &opt->loop_opt.size) != 1)
+	    fatal("bad bpred:loop parameters");
+	  if (!IS_POWEROF2(opt->loop_opt.size) || opt->loop_opt.size > (1 << 16))
+	    fatal("bpred:loop <size> '%d' must be a power of 2 between 1 and 2^16", opt->loop_opt.size);
+	}
+    }
   
   if (mystricmp(opt->dir1_opt.opt, "none"))
     {
@@ -398,12 +806,34 @@ bpred_check_options(struct bpred_opt_t *opt)
 
       if (opt->btb_opt.nsets <= 0 || !IS_POWEROF2(opt->btb_opt.nsets))
 	fatal("bpred:btb <nsets> '%d' must be positive and a power of 2", opt->btb_opt.nsets);
-      if (opt->btb_opt.assoc <= 0)
-	fatal("bpred:btb <assoc> '%d' must be positive", opt->btb_opt.assoc);
+      if (opt->btb_opt.assoc <= 0 || opt->btb_opt.assoc > 256)
+	fatal("bpred:btb <assoc> '%d' must be between 1 and 256", opt->btb_opt.assoc);
+      if (opt->btb_opt.tbits > 31)
+	fatal("bpred:btb <tbits> '%d' must be at most 31", opt->btb_opt.tbits);
       if (opt->btb_opt.assoc > 1 && !opt->btb_opt.tbits)
 	fatal("Cannot have a btb that is both associative and untagged");
     }
 
+  if (!mystricmp(opt->ittage_opt.opt, "none"))
+    opt->ittage_opt.ntables = 0;
+  else
+    {
+      if (sscanf(opt->ittage_opt.opt, "%d:%d:%d:%d:%d",
+		 &opt->ittage_opt.ntables, &opt->ittage_opt.size, &opt->ittage_opt.tbits,
+		 &opt->ittage_opt.minhist, &opt->ittage_opt.maxhist) != 5)
+	fatal("bad bpred:ittage parameters '%s'", opt->ittage_opt.opt);
+      if (opt->ittage_opt.ntables <= 0 || opt->ittage_opt.ntables > TAGE_MAX_TABLES)
+	fatal("bpred:ittage <ntables> '%d' must be > 0 and <= %d", opt->ittage_opt.ntables, TAGE_MAX_TABLES);
+      if (!IS_POWEROF2(opt->ittage_opt.size) || opt->ittage_opt.size > (1 << 20))
+	fatal("bpred:ittage <size> '%d' must be a power of 2 between 1 and 2^20", opt->ittage_opt.size);
+      if (opt->ittage_opt.tbits < 2 || opt->ittage_opt.tbits > 16)
+	fatal("bpred:ittage <tbits> '%d' must be >= 2 and <= 16", opt->ittage_opt.tbits);
+      if (opt->ittage_opt.minhist <= 0 || opt->ittage_opt.maxhist < opt->ittage_opt.minhist + opt->ittage_opt.ntables - 1)
+	fatal("bpred:ittage <minhist> must be positive and <maxhist> leave room for %d lengths", opt->ittage_opt.ntables);
+      if (opt->ittage_opt.maxhist > 2048)
+	fatal("bpred:ittage <maxhist> '%d' must be <= 2048", opt->ittage_opt.maxhist);
+    }
+
   if (!mystricmp(opt->ras_opt.opt, "none"))
     opt->ras_opt.size = 0;
   else 
@@ -427,6 +857,7 @@ bpred_create(struct bpred_opt_t *opt)
     fatal("out of virtual memory");
 
   bp->opt = opt;
+  bp->seed = 1;
 
   /* allocate direction predictors */
   if (mystricmp(bp->opt->dir1_opt.opt, "none"))
@@ -438,6 +869,19 @@ bpred_create(struct bpred_opt_t *opt)
   if (mystricmp(bp->opt->chooser_opt.opt, "none"))
     bp->chooser = bpred_dir_create(&bp->opt->chooser_opt);
 
+  if (bp->opt->bpclass == bpclass_TAGE)
+    {
+      bp->tage = bpred_tage_create(&bp->opt->tage_opt);
+      if (bp->opt->loop_opt.size > 0)
+	bp->loop = bpred_loop_create(&bp->opt->loop_opt);
+    }
+
+  if (bp->opt->bpclass == bpclass_PERCEPTRON)
+    bp->perc = bpred_perc_create(&bp->opt->perc_opt);
+
+  if (bp->opt->ittage_opt.ntables > 0)
+    bp->ittage = bpred_ittage_create(&bp->opt->ittage_opt);
+
   /* allocate ras */
   if (bp->opt->ras_opt.size > 0)
     bp->ras = bpred_ras_create(&bp->opt->ras_opt);
@@ -449,6 +893,65 @@ bpred_create(struct bpred_opt_t *opt)
   return bp;
 }
 
+static void
+bpred_dir_delete(struct bpred_dir_t *dir)
+{
+  free(dir->table);
+  free(dir);
+}
+
+void
+bpred_delete(struct bpred_t *bp)
+{
+  int i;
+
+  if (bp->dir1) bpred_dir_delete(bp->dir1);
+  if (bp->dir2) bpred_dir_delete(bp->dir2);
+  if (bp->chooser) bpred_dir_delete(bp->chooser);
+
+  if (bp->tage)
+    {
+      for (i = 0; i < bp->tage->opt->ntables; i++)
+	free(bp->tage->table[i]);
+      free(bp->tage->base);
+      free(bp->tage->h.hist);
+      free(bp->tage);
+    }
+  if (bp->loop)
+    {
+      free(bp->loop->ents);
+      free(bp->loop->undo);
+      free(bp->loop);
+    }
+  if (bp->perc)
+    {
+      free(bp->perc->weights);
+      free(bp->perc->x);
+      free(bp->perc);
+    }
+  if (bp->ittage)
+    {
+      for (i = 0; i < bp->ittage->opt->ntables; i++)
+	free(bp->ittage->table[i]);
+      free(bp->ittage->h.hist);
+      free(bp->ittage);
+    }
+  if (bp->ras)
+    {
+      free(bp->ras->stack);
+      free(bp->ras);
+    }
+  if (bp->btb)
+    {
+      free(bp->btb->tags);
+      free(bp->btb->targets);
+      free(bp->btb->ages);
+      free(bp->btb);
+    }
+
+  free(bp);
+}
+
 #define PC_HASH(PC, SIZE) SHIFT_PC(PC) & (SIZE - 1)
 
 /* returns a pointer to counter */
@@ -477,18 +980,38 @@ bpred_dir_spec_update(struct bpred_dir_t *dir,
   dir->s.history |= taken;
 }
 
+/* way of set SET holding TAG, -1 if none.  a set holds a tag at most
+   once, so summing the matching way numbers finds it without an early
+   exit and the blocked compare vectorizes */
+static inline int
+bpred_btb_find(struct bpred_btb_t *btb,
+	       int set,
+	       unsigned int tag)
+{
+  unsigned int *tags = &btb->tags[set * btb->ways];
+  unsigned int way = 0;
+  int w, k;
+
+  for (w = 0; w < btb->ways; w += BTB_ALIGN)
+    for (k = 0; k < BTB_ALIGN; k++)
+      way += tags[w + k] == tag ? (unsigned int)(w + k) + 1 : 0;
+
+  return (int)way - 1;
+}
+
 static md_addr_t
 bpred_btb_lookup(struct bpred_btb_t *btb,
 		 md_addr_t pc)
 
 {
-  struct bpred_btb_set_t *set = &btb->sets[MOD(SHIFT_PC(pc), btb->opt->nsets)];
-  struct bpred_btb_ent_t *ent;
-  for (ent = set->head; ent; ent = ent->next)
-    if ((ent->pc & btb->tag_mask) == (pc & btb->tag_mask))
-      return (pc & ~btb->data_mask) | (ent->target & btb->data_mask);
-  
-  return 0;
+  int set = MOD(SHIFT_PC(pc), btb->opt->nsets);
+  int way = bpred_btb_find(btb, set, BTB_TAG(btb, pc));
+
+  if (way < 0)
+    return 0;
+
+  return (pc & ~btb->data_mask)
+    | (btb->targets[set * btb->ways + way] & btb->data_mask);
 }
 
 static md_addr_t 
@@ -525,6 +1048,290 @@ bpred_ras_spec_update(struct bpred_ras_t *ras,
 
   ras->s.tos_entry = ras->stack[ras->s.tos];
 }
+
+/* fold a history of OLEN bits into CLEN bits: shift in NEWBIT and drop
+   OLDBIT, the bit just leaving the history */
+static unsigned int
+bpred_ghist_fold(unsigned int comp,
+		int clen,
+		int olen,
+		int newbit,
+		int oldbit)
+{
+  comp = (comp << 1) | newbit;
+  comp ^= oldbit << (olen % clen);
+  comp ^= comp >> clen;
+  return comp & ((1 << clen) - 1);
+}
+
+/* shift BIT into history H */
+static void
+bpred_ghist_push(struct bpred_ghist_t *h,
+		 int bit)
+{
+  struct bpred_tage_state_t *s = &h->s;
+  int i, olen, oldbit;
+
+  s->ptr = (s->ptr + 1) & h->hmask;
+  h->hist[s->ptr] = bit;
+
+  for (i = 0; i < h->n; i++)
+    {
+      olen = h->hlen[i];
+      oldbit = h->hist[(s->ptr - olen) & h->hmask];
+      s->ci[i] = bpred_ghist_fold(s->ci[i], h->log_size ? h->log_size : 1, olen, bit, oldbit);
+      s->ct0[i] = bpred_ghist_fold(s->ct0[i], h->tbits, olen, bit, oldbit);
+      s->ct1[i] = bpred_ghist_fold(s->ct1[i], h->tbits - 1, olen, bit, oldbit);
+    }
+}
+
+/* shift branch address PC into the path history of H */
+#define GHIST_PATH(H, PC) \
+  ((H)->s.phist = (((H)->s.phist << 1) | (SHIFT_PC(PC) & 1)) & 0xffff)
+
+/* index and tag of component I for PC, from history S */
+static void
+bpred_ghist_hash(struct bpred_ghist_t *h,
+		 md_addr_t pc,
+		 struct bpred_tage_state_t *s,
+		 int i,
+		 int *idx,
+		 unsigned int *tag)
+{
+  unsigned int spc = SHIFT_PC(pc);
+  unsigned int path = s->phist & ((1 << MIN(h->hlen[i], 16)) - 1);
+
+  *idx = (spc ^ (spc >> (i + 1)) ^ s->ci[i] ^ path ^ (path >> h->log_size))
+    & ((1 << h->log_size) - 1);
+  *tag = (spc ^ s->ct0[i] ^ (s->ct1[i] << 1)) & ((1 << h->tbits) - 1);
+}
+
+static void
+bpred_tage_predict(struct bpred_tage_t *tage,
+		   md_addr_t pc,
+		   struct bpred_tage_state_t *s,
+		   struct bpred_tage_pred_t *p)
+{
+  int i;
+
+  for (i = 0; i < tage->opt->ntables; i++)
+    bpred_ghist_hash(&tage->h, pc, s, i, &p->idx[i], &p->tag[i]);
+  p->bidx = SHIFT_PC(pc) & (tage->opt->bsize - 1);
+
+  p->provider = p->alt = -1;
+  for (i = tage->opt->ntables - 1; i >= 0; i--)
+    if (tage->table[i][p->idx[i]].tag == p->tag[i])
+      {
+	if (p->provider < 0)
+	  p->provider = i;
+	else
+	  {
+	    p->alt = i;
+	    break;
+	  }
+      }
+
+  p->alt_pred = (p->alt >= 0)
+    ? (tage->table[p->alt][p->idx[p->alt]].ctr >= 0)
+    : IS_TAKEN(tage->base[p->bidx], 2);
+
+  if (p->provider >= 0)
+    {
+      struct bpred_tage_ent_t *ent = &tage->table[p->provider][p->idx[p->provider]];
+
+      p->pred = (ent->ctr >= 0);
+      /* a weak, newly allocated entry is less accurate than the alternate */
+      p->tage_pred = ((ent->ctr == 0 || ent->ctr == -1) && ent->u == 0 && tage->use_alt >= 0)
+	? p->alt_pred : p->pred;
+    }
+  else
+    p->pred = p->tage_pred = p->alt_pred;
+}
+
+static void
+bpred_tage_spec_update(struct bpred_tage_t *tage,
+		       md_addr_t pc,
+		       enum md_opcode_t op,
+		       int taken)
+{
+  if (!MD_OP_HASFLAGS(op, F_COND))
+    return;
+
+  bpred_ghist_push(&tage->h, taken);
+  GHIST_PATH(&tage->h, pc);
+}
+
+static struct bpred_loop_ent_t *
+bpred_loop_ent(struct bpred_loop_t *loop,
+	       md_addr_t pc)
+{
+  struct bpred_loop_ent_t *ent = &loop->ents[SHIFT_PC(pc) & (loop->opt->size - 1)];
+
+  return (ent->tag == ((SHIFT_PC(pc) >> loop->log_size) & 0x3fff) && ent->age) ? ent : NULL;
+}
+
+/* predicted direction given speculative iteration ITER */
+#define LOOP_PRED(ENT, ITER) \
+  (((ITER) + 1 == (ENT)->past_iter) ? !(ENT)->dir : (ENT)->dir)
+
+static void
+bpred_loop_spec_update(struct bpred_loop_t *loop,
+		       md_addr_t pc,
+		       enum md_opcode_t op,
+		       int taken)
+{
+  struct bpred_loop_ent_t *ent;
+
+  if (!MD_OP_HASFLAGS(op, F_COND))
+    return;
+
+  if ((ent = bpred_loop_ent(loop, pc)))
+    {
+      loop->undo_ptr = (loop->undo_ptr + 1) & (TAGE_HIST_SLACK - 1);
+      loop->undo[loop->undo_ptr].ent = ent - loop->ents;
+      loop->undo[loop->undo_ptr].tag = ent->tag;
+      loop->undo[loop->undo_ptr].iter = ent->iter;
+
+      if (taken == ent->dir && ent->iter < LOOP_ITER_MAX)
+	ent->iter++;
+      else
+	ent->iter = 0;
+    }
+}
+
+#define PERC_INPUT(BIT)		((BIT) ? 1 : -1)
+
+static signed char *
+bpred_perc_row(struct bpred_perc_t *perc,
+	       md_addr_t pc)
+{
+  unsigned int spc = SHIFT_PC(pc);
+
+  return &perc->weights[((spc ^ (spc >> perc->log_size)) & (perc->opt->size - 1)) * perc->stride];
+}
+
+/* the dot product of weights W and inputs X, int8 so the compiler can
+   vectorize it */
+static int
+bpred_perc_output(struct bpred_perc_t *perc,
+		  signed char *w,
+		  signed char *x)
+{
+  int i, j, y = 0;
+
+  /* whole PERC_ALIGN blocks, no scalar tail */
+  for (i = 0; i < perc->stride; i += PERC_ALIGN)
+    for (j = 0; j < PERC_ALIGN; j++)
+      y += w[i + j] * x[i + j];
+
+  return y;
+}
+
+/* rebuild the inputs X from history S */
+static void
+bpred_perc_inputs(struct bpred_perc_t *perc,
+		  struct bpred_perc_state_t *s,
+		  signed char *x)
+{
+  int i, h = perc->opt->hbits;
+
+  x[0] = 1;
+  for (i = 0; i < h; i++)
+    x[1 + i] = PERC_INPUT((s->ghist >> i) & 1);
+  for (i = 0; i < perc->opt->pbits; i++)
+    x[1 + h + i] = PERC_INPUT((s->phist >> i) & 1);
+}
+
+static void
+bpred_perc_spec_update(struct bpred_perc_t *perc,
+		       md_addr_t pc,
+		       enum md_opcode_t op,
+		       int taken)
+{
+  int h = perc->opt->hbits, p = perc->opt->pbits;
+
+  if (!MD_OP_HASFLAGS(op, F_COND))
+    return;
+
+  perc->s.ghist = (perc->s.ghist << 1) | taken;
+  perc->s.phist = (perc->s.phist << 1) | (SHIFT_PC(pc) & 1);
+
+  /* shift the inputs rather than rebuild them */
+  if (h > 0)
+    {
+      memmove(perc->x + 2, perc->x + 1, h - 1);
+      perc->x[1] = PERC_INPUT(taken);
+    }
+  if (p > 0)
+    {
+      memmove(perc->x + 2 + h, perc->x + 1 + h, p - 1);
+      perc->x[1 + h] = PERC_INPUT(SHIFT_PC(pc) & 1);
+    }
+}
+
+static void
+bpred_ittage_predict(struct bpred_ittage_t *ittage,
+		     md_addr_t pc,
+		     struct bpred_tage_state_t *s,
+		     struct bpred_ittage_pred_t *p)
+{
+  struct bpred_ittage_ent_t *ent;
+  int i;
+
+  for (i = 0; i < ittage->opt->ntables; i++)
+    bpred_ghist_hash(&ittage->h, pc, s, i, &p->idx[i], &p->tag[i]);
+
+  p->provider = p->alt = -1;
+  for (i = ittage->opt->ntables - 1; i >= 0; i--)
+    if (ittage->table[i][p->idx[i]].tag == p->tag[i]
+	&& ittage->table[i][p->idx[i]].target)
+      {
+	if (p->provider < 0)
+	  p->provider = i;
+	else
+	  {
+	    p->alt = i;
+	    break;
+	  }
+      }
+
+  p->target = 0;
+  if (p->provider >= 0)
+    {
+      ent = &ittage->table[p->provider][p->idx[p->provider]];
+      /* a provider with no confidence defers to the alternate */
+      if (ent->ctr == 0 && p->alt >= 0)
+	p->target = ittage->table[p->alt][p->idx[p->alt]].target;
+      else
+	p->target = ent->target;
+    }
+}
+
+/* conditional branches shift in their direction, indirect jumps two
+   bits of a hash of their target (low target bits are often aligned) */
+static void
+bpred_ittage_spec_update(struct bpred_ittage_t *ittage,
+			 md_addr_t pc,
+			 enum md_opcode_t op,
+			 int taken,
+			 md_addr_t targ_pc)
+{
+  unsigned int t;
+
+  if (MD_OP_HASFLAGS(op, F_COND))
+    bpred_ghist_push(&ittage->h, taken);
+  else if (MD_OP_HASFLAGS(op, F_INDIRJMP))
+    {
+      t = SHIFT_PC(targ_pc);
+      t ^= (t >> 2) ^ (t >> 5);
+      bpred_ghist_push(&ittage->h, t & 1);
+      bpred_ghist_push(&ittage->h, (t >> 1) & 1);
+    }
+  else
+    return;
+
+  GHIST_PATH(&ittage->h, pc);
+}
 		      
 /* probe a predictor for a next fetch address, the predictor is probed
    with branch address BADDR, the branch target is BTARGET (used for
@@ -540,6 +1347,12 @@ bpred_checkpoint_state(struct bpred_t *bp,
   if (bp->dir1) pre_state->dir1_s = bp->dir1->s;
   if (bp->dir2) pre_state->dir2_s = bp->dir2->s;
   if (bp->ras) pre_state->ras_s = bp->ras->s;
+  if (bp->tage) pre_state->tage_s = bp->tage->h.s;
+  if (bp->perc) pre_state->perc_s = bp->perc->s;
+  if (bp->ittage) pre_state->ittage_s = bp->ittage->h.s;
+  if (bp->loop) pre_state->loop_undo_ptr = bp->loop->undo_ptr;
+  pre_state->loop_iter = -1;
+  pre_state->perc = 0;
 }
 
 md_addr_t				/* predicted branch target addr */
@@ -584,6 +1397,28 @@ bpred_lookup(struct bpred_t *bp,	/* branch predictor instance */
 	    }
 	}
       break;
+      case bpclass_TAGE:
+	{
+	  struct bpred_tage_pred_t p;
+	  struct bpred_loop_ent_t *ent;
+
+	  bpred_tage_predict(bp->tage, pc, &bp->tage->h.s, &p);
+	  taken = p.tage_pred;
+
+	  if (bp->loop && (ent = bpred_loop_ent(bp->loop, pc)))
+	    {
+	      pre_state->loop_iter = ent->iter;
+	      if (ent->conf == LOOP_CONF_MAX && bp->loop->use >= 0)
+		taken = LOOP_PRED(ent, ent->iter);
+	    }
+	}
+	break;
+      case bpclass_PERCEPTRON:
+	{
+	  pre_state->perc = bpred_perc_output(bp->perc, bpred_perc_row(bp->perc, pc), bp->perc->x);
+	  taken = (pre_state->perc >= 0);
+	}
+	break;
       case bpclass_TAKEN:
 	{
 	  taken = TRUE;
@@ -608,21 +1443,48 @@ bpred_lookup(struct bpred_t *bp,	/* branch predictor instance */
       /* Returns */
       if (op == RETN && bp->ras)
 	target = bpred_ras_lookup(bp->ras, pc, op);
-      /* Everything else */
-      else if (bp->btb)
-	target = bpred_btb_lookup(bp->btb, pc);
+      /* Everything else, indirect jumps try ITTAGE before the BTB */
       else
-	target = 0;
+	{
+	  target = 0;
+	  if (bp->ittage && MD_OP_HASFLAGS(op, F_INDIRJMP))
+	    {
+	      struct bpred_ittage_pred_t p;
+
+	      bpred_ittage_predict(bp->ittage, pc, &bp->ittage->h.s, &p);
+	      target = p.target;
+	    }
+	  if (!target && bp->btb)
+	    target = bpred_btb_lookup(bp->btb, pc);
+	}
     }
 
   /* Speculative updates of all state info */
   if (bp->dir1) bpred_dir_spec_update(bp->dir1, pc, op, taken, target);
   if (bp->dir2) bpred_dir_spec_update(bp->dir2, pc, op, taken, target);
   if (bp->ras) bpred_ras_spec_update(bp->ras, pc, op, taken, target);
+  if (bp->tage) bpred_tage_spec_update(bp->tage, pc, op, taken);
+  if (bp->loop) bpred_loop_spec_update(bp->loop, pc, op, taken);
+  if (bp->perc) bpred_perc_spec_update(bp->perc, pc, op, taken);
+  if (bp->ittage) bpred_ittage_spec_update(bp->ittage, pc, op, taken, target);
 
   return target;
 }
 
+int
+bpred_confidence(struct bpred_t *bp,
+		 struct bpred_state_t *pre_state)
+{
+  int y;
+
+  if (!bp->perc)
+    return 0;
+
+  /* the output magnitude, relative to the training threshold */
+  y = pre_state->perc < 0 ? -pre_state->perc : pre_state->perc;
+  return MIN(100, y * 100 / MAX(bp->opt->perc_opt.theta, 1));
+}
+
 /* Speculative execution can corrupt the ret-addr stack.  So for each
  * lookup we return the top-of-stack (TOS) at that point; a mispredicted
  * branch, as part of its recovery, restores the TOS using this value --
@@ -676,6 +1538,62 @@ bpred_ras_recover(struct bpred_ras_t *ras,
   ras->s.tos_entry = ras->stack[ras->s.tos];
 }
 
+static void
+bpred_tage_recover(struct bpred_tage_t *tage,
+		   md_addr_t pc,
+		   enum md_opcode_t op,
+		   md_addr_t next_pc,
+		   struct bpred_tage_state_t *tage_s)
+{
+  /* history older than the checkpoint is still in the buffer */
+  tage->h.s = *tage_s;
+  bpred_tage_spec_update(tage, pc, op, next_pc != pc + sizeof(md_inst_t));
+}
+
+static void
+bpred_loop_recover(struct bpred_loop_t *loop,
+		   md_addr_t pc,
+		   enum md_opcode_t op,
+		   md_addr_t next_pc,
+		   unsigned int undo_ptr)
+{
+  struct bpred_loop_undo_t *u;
+
+  /* undo the younger, squashed, iterations of every loop */
+  while (loop->undo_ptr != undo_ptr)
+    {
+      u = &loop->undo[loop->undo_ptr];
+      if (loop->ents[u->ent].tag == u->tag)
+	loop->ents[u->ent].iter = u->iter;
+      loop->undo_ptr = (loop->undo_ptr - 1) & (TAGE_HIST_SLACK - 1);
+    }
+
+  bpred_loop_spec_update(loop, pc, op, next_pc != pc + sizeof(md_inst_t));
+}
+
+static void
+bpred_perc_recover(struct bpred_perc_t *perc,
+		   md_addr_t pc,
+		   enum md_opcode_t op,
+		   md_addr_t next_pc,
+		   struct bpred_perc_state_t *perc_s)
+{
+  perc->s = *perc_s;
+  bpred_perc_inputs(perc, &perc->s, perc->x);
+  bpred_perc_spec_update(perc, pc, op, next_pc != pc + sizeof(md_inst_t));
+}
+
+static void
+bpred_ittage_recover(struct bpred_ittage_t *ittage,
+		     md_addr_t pc,
+		     enum md_opcode_t op,
+		     md_addr_t next_pc,
+		     struct bpred_tage_state_t *ittage_s)
+{
+  ittage->h.s = *ittage_s;
+  bpred_ittage_spec_update(ittage, pc, op, next_pc != pc + sizeof(md_inst_t), next_pc);
+}
+
 void
 bpred_recover(struct bpred_t *bp,	/* branch predictor instance */
 	      md_addr_t pc,	        /* branch address */
@@ -691,6 +1609,14 @@ bpred_recover(struct bpred_t *bp,	/* branch predictor instance */
     bpred_dir_recover(bp->dir1, pc, op, next_pc, &pre_state->dir1_s);
   if (bp->dir2)
     bpred_dir_recover(bp->dir2, pc, op, next_pc, &pre_state->dir2_s);
+  if (bp->tage)
+    bpred_tage_recover(bp->tage, pc, op, next_pc, &pre_state->tage_s);
+  if (bp->loop)
+    bpred_loop_recover(bp->loop, pc, op, next_pc, pre_state->loop_undo_ptr);
+  if (bp->perc)
+    bpred_perc_recover(bp->perc, pc, op, next_pc, &pre_state->perc_s);
+  if (bp->ittage)
+    bpred_ittage_recover(bp->ittage, pc, op, next_pc, &pre_state->ittage_s);
 }
 
 /* update the branch predictor, only useful for stateful predictors; updates
@@ -707,53 +1633,325 @@ bpred_btb_update(struct bpred_btb_t *btb,
 		 md_addr_t pc,
 		 md_addr_t targ_pc)
 {
-  struct bpred_btb_set_t *set = &btb->sets[MOD(SHIFT_PC(pc), btb->opt->nsets)];
-  struct bpred_btb_ent_t *ent = NULL;
-
-  if (btb->opt->assoc == 1)
+  int set = MOD(SHIFT_PC(pc), btb->opt->nsets);
+  unsigned int tag = BTB_TAG(btb, pc);
+  unsigned char *ages = &btb->ages[set * btb->ways];
+  int assoc = btb->opt->assoc;
+  int way, w, age;
+
+  way = bpred_btb_find(btb, set, tag);
+
+  /* miss, replace the LRU way */
+  if (way < 0)
+    for (way = 0; ages[way] != assoc - 1; way++)
+      /* nada */;
+
+  /* LRU, ways younger than WAY age by one */
+  age = ages[way];
+  if (age)
     {
-      ent = set->head;
+      for (w = 0; w < assoc; w++)
+	ages[w] += ages[w] < age;
+      ages[way] = 0;
     }
-  /* Associative btb, do LRU */
-  else 
+
+  btb->tags[set * btb->ways + way] = tag;
+  btb->targets[set * btb->ways + way] = targ_pc;
+}
+
+static void
+bpred_dir_update(struct bpred_dir_t *dir,
+		 md_addr_t pc,
+		 bool_t taken,
+		 struct bpred_dir_state_t *dir_s)
+{
+  int index = (dir_s->history & dir->hmask) ^ (SHIFT_PC(pc) << dir->opt->pcshift);
+  UPDATE_TAKEN(dir->table[MOD(index, dir->opt->size)],dir->opt->pbits,taken);
+}
+
+/* next pseudo-random number of BP's own generator */
+static inline unsigned int
+bpred_rand(struct bpred_t *bp)
+{
+  bp->seed = bp->seed * 1103515245 + 12345;
+  return bp->seed >> 16;
+}
+
+#define TAGE_UPDATE_CTR(C, TAKEN) \
+   { if ((TAKEN) && (C) < TAGE_CTR_MAX) { ++(C); } else if (!(TAKEN) && (C) > TAGE_CTR_MIN) { --(C); } }
+
+/* train TAGE with the prediction recomputed from the lookup history,
+   returns the TAGE prediction */
+static bool_t
+bpred_tage_update(struct bpred_t *bp,
+		  md_addr_t pc,
+		  bool_t taken,
+		  struct bpred_tage_state_t *tage_s)
+{
+  struct bpred_tage_t *tage = bp->tage;
+  struct bpred_tage_pred_t p;
+  struct bpred_tage_ent_t *ent;
+  int ntables = tage->opt->ntables, i, j;
+
+  bpred_tage_predict(tage, pc, tage_s, &p);
+
+  if (sample_mode == sample_ON) bp->tage_provider[p.provider + 1]++;
+
+  /* allocate on a mis-prediction, in a longer history component */
+  if (p.tage_pred != taken && p.provider < ntables - 1)
     {
-      for (ent = set->head; ent; ent = ent->next)
-	if (ent->pc == pc)
+      i = p.provider + 1;
+      /* spread allocations over the components */
+      if (i < ntables - 1 && (bpred_rand(bp) & 1))
+	i++;
+
+      for (j = i; j < ntables; j++)
+	if (tage->table[j][p.idx[j]].u == 0)
 	  break;
 
-      if (!ent)
-	ent = set->tail;
+      if (j < ntables)
+	{
+	  ent = &tage->table[j][p.idx[j]];
+	  ent->tag = p.tag[j];
+	  ent->ctr = taken ? 0 : -1;
+	  ent->u = 0;
+	  if (sample_mode == sample_ON) bp->tage_allocs++;
+	}
+      else
+	{
+	  for (j = p.provider + 1; j < ntables; j++)
+	    if (tage->table[j][p.idx[j]].u > 0)
+	      tage->table[j][p.idx[j]].u--;
+	}
+    }
+
+  if (p.provider >= 0)
+    {
+      ent = &tage->table[p.provider][p.idx[p.provider]];
+
+      /* learn whether new entries beat their alternate */
+      if ((ent->ctr == 0 || ent->ctr == -1) && ent->u == 0 && p.pred != p.alt_pred)
+	{
+	  if (p.alt_pred == taken && tage->use_alt < TAGE_USE_ALT_MAX)
+	    tage->use_alt++;
+	  else if (p.alt_pred != taken && tage->use_alt > TAGE_USE_ALT_MIN)
+	    tage->use_alt--;
+	}
 
-      /* LRU */
-      if (ent != set->head)
+      /* the alternate keeps learning until the provider proves useful */
+      if (ent->u == 0)
 	{
-	  /* Reset tail */
-	  if (ent == set->tail) set->tail = ent->prev;
+	  if (p.alt >= 0)
+	    TAGE_UPDATE_CTR(tage->table[p.alt][p.idx[p.alt]].ctr, taken)
+	  else
+	    UPDATE_TAKEN(tage->base[p.bidx], 2, taken)
+	}
 
-	  /* Unlink */
-	  if (ent->prev) ent->prev->next = ent->next;
-	  if (ent->next) ent->next->prev = ent->prev;
-      
-	  /* Link to head */
-	  ent->prev = NULL;
-	  set->head->prev = ent;
-	  ent->next = set->head;
-	  set->head = ent;
+      TAGE_UPDATE_CTR(ent->ctr, taken);
+
+      if (p.pred != p.alt_pred)
+	{
+	  if (p.pred == taken && ent->u < TAGE_U_MAX)
+	    ent->u++;
+	  else if (p.pred != taken && ent->u > 0)
+	    ent->u--;
 	}
     }
+  else
+    UPDATE_TAKEN(tage->base[p.bidx], 2, taken);
 
-  ent->pc = pc;
-  ent->target = targ_pc;
+  /* graceful aging of the useful bits */
+  if ((++tage->n_updates & ((1 << TAGE_U_RESET_LOG) - 1)) == 0)
+    {
+      for (i = 0; i < tage->opt->ntables; i++)
+	for (j = 0; j < tage->opt->size; j++)
+	  tage->table[i][j].u &= tage->u_reset_lsb ? 2 : 1;
+      tage->u_reset_lsb = !tage->u_reset_lsb;
+    }
+
+  return p.tage_pred;
 }
 
+/* train the loop predictor, LOOP_ITER is the speculative iteration at
+   lookup, TAGE_PRED the TAGE prediction */
 static void
-bpred_dir_update(struct bpred_dir_t *dir,
-		 md_addr_t pc,
-		 bool_t taken,
-		 struct bpred_dir_state_t *dir_s)
+bpred_loop_update(struct bpred_t *bp,
+		  md_addr_t pc,
+		  bool_t taken,
+		  bool_t tage_pred,
+		  int loop_iter)
 {
-  int index = (dir_s->history & dir->hmask) ^ (SHIFT_PC(pc) << dir->opt->pcshift);
-  UPDATE_TAKEN(dir->table[MOD(index, dir->opt->size)],dir->opt->pbits,taken);
+  struct bpred_loop_t *loop = bp->loop;
+  struct bpred_loop_ent_t *ent = bpred_loop_ent(loop, pc);
+  bool_t pred;
+
+  if (!ent)
+    {
+      /* allocate on a TAGE mis-prediction, presumably a loop exit */
+      if (tage_pred != taken)
+	{
+	  ent = &loop->ents[SHIFT_PC(pc) & (loop->opt->size - 1)];
+	  if (ent->age > 0)
+	    ent->age--;
+	  else
+	    {
+	      ent->tag = (SHIFT_PC(pc) >> loop->log_size) & 0x3fff;
+	      ent->past_iter = ent->iter = ent->nspec_iter = 0;
+	      ent->conf = 0;
+	      ent->age = LOOP_AGE_MAX;
+	      ent->dir = !taken;
+	    }
+	}
+      return;
+    }
+
+  if (loop_iter >= 0 && ent->conf == LOOP_CONF_MAX)
+    {
+      pred = LOOP_PRED(ent, loop_iter);
+      if (sample_mode == sample_ON && loop->use >= 0)
+	{
+	  bp->loop_lookups++;
+	  if (pred == taken) bp->loop_hits++;
+	}
+      if (pred != tage_pred)
+	{
+	  if (pred == taken && loop->use < LOOP_USE_MAX)
+	    loop->use++;
+	  else if (pred != taken && loop->use > LOOP_USE_MIN)
+	    loop->use--;
+	}
+    }
+
+  if (taken == ent->dir)
+    {
+      /* too long, or longer than the trip count */
+      if (ent->nspec_iter == LOOP_ITER_MAX
+	  || (ent->past_iter && ent->nspec_iter + 1 >= ent->past_iter))
+	{
+	  ent->age = 0;
+	  return;
+	}
+      ent->nspec_iter++;
+    }
+  else
+    {
+      if (ent->nspec_iter + 1 == ent->past_iter)
+	{
+	  if (ent->conf < LOOP_CONF_MAX)
+	    ent->conf++;
+	  if (ent->age < LOOP_AGE_MAX)
+	    ent->age++;
+	}
+      else if (ent->past_iter == 0)
+	{
+	  ent->past_iter = ent->nspec_iter + 1;
+	  ent->conf = 0;
+	}
+      else
+	/* trip count changed */
+	ent->age = 0;
+      ent->nspec_iter = 0;
+    }
+}
+
+/* train ITTAGE with indirect jump target TARG_PC, CORRECT if the
+   final (ITTAGE or BTB) target was */
+static void
+bpred_ittage_update(struct bpred_t *bp,
+		    md_addr_t pc,
+		    md_addr_t targ_pc,
+		    bool_t correct,
+		    struct bpred_tage_state_t *ittage_s)
+{
+  struct bpred_ittage_t *ittage = bp->ittage;
+  struct bpred_ittage_pred_t p;
+  struct bpred_ittage_ent_t *ent;
+  int ntables = ittage->opt->ntables, i, j;
+
+  bpred_ittage_predict(ittage, pc, ittage_s, &p);
+
+  if (sample_mode == sample_ON) bp->ittage_provider[p.provider + 1]++;
+
+  /* allocate on a mis-prediction, in a longer history component */
+  if (!correct && p.provider < ntables - 1)
+    {
+      i = p.provider + 1;
+      if (i < ntables - 1 && (bpred_rand(bp) & 1))
+	i++;
+
+      for (j = i; j < ntables; j++)
+	if (ittage->table[j][p.idx[j]].u == 0)
+	  break;
+
+      if (j < ntables)
+	{
+	  ent = &ittage->table[j][p.idx[j]];
+	  ent->tag = p.tag[j];
+	  ent->target = targ_pc;
+	  ent->ctr = 0;
+	  ent->u = 0;
+	  if (sample_mode == sample_ON) bp->ittage_allocs++;
+	}
+      else
+	{
+	  for (j = p.provider + 1; j < ntables; j++)
+	    ittage->table[j][p.idx[j]].u = 0;
+	}
+    }
+
+  if (p.provider >= 0)
+    {
+      ent = &ittage->table[p.provider][p.idx[p.provider]];
+
+      if (ent->target == targ_pc)
+	{
+	  if (ent->ctr < ITTAGE_CTR_MAX)
+	    ent->ctr++;
+	  /* useful if the alternate would have missed */
+	  if (p.alt < 0 || ittage->table[p.alt][p.idx[p.alt]].target != targ_pc)
+	    ent->u = 1;
+	}
+      else if (ent->ctr > 0)
+	ent->ctr--;
+      else
+	ent->target = targ_pc;
+    }
+
+  /* age the useful bits */
+  if ((++ittage->n_updates & ((1 << TAGE_U_RESET_LOG) - 1)) == 0)
+    {
+      for (i = 0; i < ntables; i++)
+	for (j = 0; j < ittage->opt->size; j++)
+	  ittage->table[i][j].u = 0;
+    }
+}
+
+/* train the perceptron on a mis-prediction or a weak output Y */
+static void
+bpred_perc_update(struct bpred_t *bp,
+		  md_addr_t pc,
+		  bool_t taken,
+		  int y,
+		  struct bpred_perc_state_t *perc_s)
+{
+  struct bpred_perc_t *perc = bp->perc;
+  signed char x[1 + PERC_MAX_HIST + PERC_MAX_PATH], *w;
+  int i, t = PERC_INPUT(taken), n = 1 + perc->opt->hbits + perc->opt->pbits;
+
+  if ((y >= 0) == taken && (y >= perc->opt->theta || y <= -perc->opt->theta))
+    return;
+
+  if (sample_mode == sample_ON) bp->perc_trains++;
+
+  bpred_perc_inputs(perc, perc_s, x);
+  w = bpred_perc_row(perc, pc);
+  for (i = 0; i < n; i++)
+    {
+      if (x[i] == t && w[i] < 127)
+	w[i]++;
+      else if (x[i] != t && w[i] > -128)
+	w[i]--;
+    }
 }
 
 void
@@ -808,6 +2006,13 @@ bpred_update(struct bpred_t *bp,     /* branch predictor instance */
 	  if (addr_correct)
 	    bp->uncond_addr_hits++;
 	}
+
+      if (MD_OP_HASFLAGS(op, F_INDIRJMP) && op != RETN)
+	{
+	  bp->indir_updates++;
+	  if (addr_correct)
+	    bp->indir_hits++;
+	}
     }
 
   if (MD_OP_HASFLAGS(op, F_COND))
@@ -826,8 +2031,22 @@ bpred_update(struct bpred_t *bp,     /* branch predictor instance */
       if (bp->chooser && pre_state->dir1 != pre_state->dir2)
 	bpred_dir_update(bp->chooser, pc, pre_state->dir2 == taken, &pre_state->chooser_s);
 
+      if (bp->tage)
+	{
+	  bool_t tage_pred = bpred_tage_update(bp, pc, taken, &pre_state->tage_s);
+
+	  if (bp->loop)
+	    bpred_loop_update(bp, pc, taken, tage_pred, pre_state->loop_iter);
+	}
+
+      if (bp->perc)
+	bpred_perc_update(bp, pc, taken, pre_state->perc, &pre_state->perc_s);
+
     }
 
+  if (bp->ittage && MD_OP_HASFLAGS(op, F_INDIRJMP) && !(op == RETN && bp->ras))
+    bpred_ittage_update(bp, pc, next_pc, addr_correct, &pre_state->ittage_s);
+
   /* No updates per se for returns, if there is a ras, otherwise may need to
      update BTB */
   if (bp->ras && op == RETN)
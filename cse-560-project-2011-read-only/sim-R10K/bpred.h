@@ -133,6 +133,8 @@ enum bpclass_t {
   bpclass_TAKEN, 
   bpclass_NOTTAKEN,
   bpclass_DYNAMIC,
+  bpclass_TAGE,
+  bpclass_PERCEPTRON,
   bpclass_NUM
 };
 
@@ -162,6 +164,62 @@ struct bpred_ras_opt_t
   unsigned int size;
 };
 
+/* TAGE: a bimodal base predictor and NTABLES tagged components indexed
+   with global histories of geometrically increasing length, from MINHIST
+   up to MAXHIST bits (Seznec and Michaud, "A case for (partially) TAgged
+   GEometric history length branch prediction") */
+#define TAGE_MAX_TABLES 12
+
+struct bpred_tage_opt_t
+{
+  char *opt;
+
+  unsigned int bsize;		/* base predictor entries */
+  unsigned int ntables;		/* tagged components */
+  unsigned int size;		/* entries per tagged component */
+  unsigned int tbits;		/* tag bits */
+  unsigned int minhist;
+  unsigned int maxhist;
+};
+
+/* loop predictor, overrides TAGE for loops with a constant trip count */
+struct bpred_loop_opt_t
+{
+  char *opt;
+  unsigned int size;
+};
+
+/* ITTAGE indirect jump target predictor beside the BTB: tagged
+   components of targets indexed with geometric global and path histories
+   (Seznec, "A 64-Kbytes ITTAGE indirect branch predictor") */
+struct bpred_ittage_opt_t
+{
+  char *opt;
+
+  unsigned int ntables;		/* tagged components */
+  unsigned int size;		/* entries per component */
+  unsigned int tbits;		/* tag bits */
+  unsigned int minhist;
+  unsigned int maxhist;
+};
+
+/* hashed perceptron: rows of int8 weights selected by a hash of the
+   branch address, with a bias weight and one weight per global and path
+   history input (Jimenez and Lin, "Dynamic branch prediction with
+   perceptrons") */
+#define PERC_MAX_HIST	64
+#define PERC_MAX_PATH	32
+
+struct bpred_perc_opt_t
+{
+  char *opt;
+
+  int size;			/* weight rows */
+  int hbits;			/* global history inputs */
+  int pbits;			/* path history inputs */
+  int theta;			/* training threshold */
+};
+
 struct bpred_opt_t
 {
   char *opt;
@@ -173,6 +231,12 @@ struct bpred_opt_t
 
   struct bpred_btb_opt_t btb_opt;
   struct bpred_ras_opt_t ras_opt;
+
+  struct bpred_tage_opt_t tage_opt;
+  struct bpred_loop_opt_t loop_opt;
+
+  struct bpred_perc_opt_t perc_opt;
+  struct bpred_ittage_opt_t ittage_opt;
 };
 
 /* Internal declarations, nobody on the outside needs to know what
@@ -190,9 +254,26 @@ struct bpred_dir_state_t {
   unsigned int history;
 };
 
+/* TAGE (and ITTAGE) global history, the history bits live in a circular buffer so
+   only its head and the folded (index and tag hash) histories need to
+   be checkpointed */
+struct bpred_tage_state_t {
+  unsigned int ptr;
+  unsigned int phist;			/* path history */
+  unsigned int ci[TAGE_MAX_TABLES];	/* folded index histories */
+  unsigned int ct0[TAGE_MAX_TABLES];	/* folded tag histories */
+  unsigned int ct1[TAGE_MAX_TABLES];
+};
+
+struct bpred_perc_state_t {
+  quad_t ghist;
+  unsigned int phist;		/* low address bits of recent branches */
+};
+
 struct bpred_state_t {
 
   int dir1, dir2, chooser;
+  int perc;			/* perceptron output */
 
   /* direction/path histories */
   struct bpred_dir_state_t dir1_s;
@@ -200,8 +281,18 @@ struct bpred_state_t {
   struct bpred_dir_state_t chooser_s;
 
   struct bpred_ras_state_t ras_s;
+
+  struct bpred_tage_state_t tage_s;
+  struct bpred_perc_state_t perc_s;
+  struct bpred_tage_state_t ittage_s;
+  int loop_iter;		/* loop iteration at lookup, or -1 */
+  unsigned int loop_undo_ptr;	/* loop iteration undo log head */
 };
 
+/* fill OPT with the default predictor configuration */
+void
+bpred_default_options(struct bpred_opt_t *opt);
+
 void
 bpred_reg_options(struct opt_odb_t *odb,
 		  struct bpred_opt_t *opt);
@@ -213,9 +304,14 @@ bpred_check_options(struct bpred_opt_t *opt);
 struct bpred_t *
 bpred_create(struct bpred_opt_t *opt);
 
-/* print predictor stats */
+/* free a predictor and all its state */
+void
+bpred_delete(struct bpred_t *bp);
+
+/* print predictor stats, misses per 1000 of N_INSN instructions */
 void 
 bpred_stats_print(const struct bpred_t *bp,
+		  counter_t n_insn,
 		  FILE *stream);
 
 void
@@ -235,6 +331,12 @@ bpred_lookup(struct bpred_t *pred,	/* branch predictor instance */
 	     enum md_opcode_t op, 
 	     struct bpred_state_t *pre_state);
 
+/* confidence of the direction predicted by the lookup that filled
+   PRE_STATE, from 0 to 100; classes without an estimate return 0 */
+int
+bpred_confidence(struct bpred_t *pred,
+		 struct bpred_state_t *pre_state);
+
 /* Speculative execution can corrupt the ret-addr stack.  So for each
  * lookup we return the top-of-stack (TOS) at that point; a mispredicted
  * branch, as part of its recovery, restores the TOS using this value --
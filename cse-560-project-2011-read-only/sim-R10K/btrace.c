@@ -0,0 +1,222 @@
+/* btrace.c - committed branch trace */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "host.h"
+#include "misc.h"
+#include "machine.h"
+#include "options.h"
+#include "sim.h"
+#include "predec.h"
+#include "btrace.h"
+
+/* output buffer size */
+#define BTRACE_BUF		(64 * 1024)
+
+/* largest record, three 64-bit varints, a 16-bit one and the flags */
+#define BTRACE_REC_MAX		(3 * 10 + 3 + 1)
+
+/* options */
+static char *btrace_fname = NULL;
+
+static FILE *btrace_fd = NULL;
+static unsigned char *btrace_buf = NULL;
+static int btrace_len = 0;
+
+static counter_t btrace_gap = 0;	/* instructions not yet recorded */
+static bool_t btrace_warm = FALSE;	/* sample mode of the gap */
+static md_addr_t btrace_npc = 0;	/* next PC of the last record */
+static counter_t n_rec = 0;
+
+void
+btrace_reg_options(struct opt_odb_t *odb)
+{
+  opt_reg_string(odb, "-btrace",
+		 "write a committed branch trace for bpred-eval to this file",
+		 &btrace_fname, /* default */NULL,
+		 /* !print */FALSE, /* format */NULL);
+}
+
+static void
+btrace_flush(void)
+{
+  if (btrace_len > 0)
+    fwrite(btrace_buf, 1, btrace_len, btrace_fd);
+  btrace_len = 0;
+}
+
+/* buffer the N byte little endian value VAL */
+static void
+btrace_put(unsigned long long val, int n)
+{
+  int i;
+
+  for (i = 0; i < n; i++, val >>= 8)
+    btrace_buf[btrace_len++] = (unsigned char)(val & 0xff);
+}
+
+/* buffer VAL as a varint */
+static void
+btrace_put_var(unsigned long long val)
+{
+  while (val >= 0x80)
+    {
+      btrace_buf[btrace_len++] = (unsigned char)(val | 0x80);
+      val >>= 7;
+    }
+  btrace_buf[btrace_len++] = (unsigned char)val;
+}
+
+/* buffer VAL as a zigzag signed varint */
+static void
+btrace_put_svar(long long val)
+{
+  btrace_put_var(((unsigned long long)val << 1) ^ (unsigned long long)(val >> 63));
+}
+
+void
+btrace_check_options(void)
+{
+  if (!btrace_fname)
+    return;
+
+  btrace_fd = fopen(btrace_fname, "wb");
+  if (!btrace_fd)
+    fatal("could not open branch trace file `%s'", btrace_fname);
+
+  btrace_buf = (unsigned char *)mycalloc(BTRACE_BUF, sizeof(unsigned char));
+  btrace_put(BTRACE_MAGIC, 4);
+  btrace_put(BTRACE_VERSION, 4);
+}
+
+bool_t
+btrace_enabled(void)
+{
+  return btrace_fd != NULL;
+}
+
+/* record the pending instructions without a branch */
+static void
+btrace_put_gap(void)
+{
+  if (btrace_len + BTRACE_REC_MAX > BTRACE_BUF)
+    btrace_flush();
+
+  btrace_put_var(btrace_gap);
+  btrace_put(BTRACE_NOBR | (btrace_warm ? BTRACE_WARM : 0), 1);
+  btrace_gap = 0;
+  n_rec++;
+}
+
+void
+btrace_insn(const struct predec_insn_t *pdi,
+	    md_addr_t PC, md_addr_t NPC, md_addr_t TPC)
+{
+  bool_t warm = (sample_mode == sample_WARM);
+  int flags;
+
+  if (!btrace_fd || pdi->iclass == ic_nop)
+    return;
+
+  /* the gap of a record belongs to one sample mode */
+  if (btrace_gap && warm != btrace_warm)
+    btrace_put_gap();
+  btrace_warm = warm;
+  btrace_gap++;
+
+  if (!MD_OP_HASFLAGS(pdi->poi.op, F_CTRL))
+    return;
+
+  if (btrace_len + BTRACE_REC_MAX > BTRACE_BUF)
+    btrace_flush();
+
+  flags = (NPC != PC + sizeof(md_inst_t) ? BTRACE_TAKEN : 0)
+    | (warm ? BTRACE_WARM : 0);
+
+  btrace_put_var(btrace_gap);
+  btrace_put(flags, 1);
+  btrace_put_var(pdi->poi.op);
+  btrace_put_svar((long long)(PC - btrace_npc));
+  btrace_put_svar((long long)(TPC - PC));
+
+  btrace_gap = 0;
+  btrace_npc = NPC;
+  n_rec++;
+}
+
+void
+btrace_close(void)
+{
+  if (!btrace_fd)
+    return;
+
+  if (btrace_gap)
+    btrace_put_gap();
+  btrace_flush();
+  fclose(btrace_fd);
+  btrace_fd = NULL;
+
+  fprintf(stderr, "sim: %lld branch trace records -> %s\n",
+	  (long long)n_rec, btrace_fname);
+}
+
+/* decode a varint at C */
+static unsigned long long
+btrace_get_var(struct btrace_cursor_t *c)
+{
+  unsigned long long val = 0;
+  int shift = 0;
+
+  do
+    {
+      if (c->p == c->end || shift > 63)
+	fatal("branch trace is truncated or corrupt");
+      val |= (unsigned long long)(*c->p & 0x7f) << shift;
+      shift += 7;
+    }
+  while (*c->p++ & 0x80);
+
+  return val;
+}
+
+static long long
+btrace_get_svar(struct btrace_cursor_t *c)
+{
+  unsigned long long val = btrace_get_var(c);
+
+  return (long long)(val >> 1) ^ -(long long)(val & 1);
+}
+
+void
+btrace_cursor_init(struct btrace_cursor_t *c,
+		   const unsigned char *buf, size_t len)
+{
+  c->p = buf + 8;
+  c->end = buf + len;
+  c->NPC = 0;
+}
+
+bool_t
+btrace_next(struct btrace_cursor_t *c, struct btrace_rec_t *rec)
+{
+  if (c->p == c->end)
+    return FALSE;
+
+  rec->n_insn = (counter_t)btrace_get_var(c);
+  if (c->p == c->end)
+    fatal("branch trace is truncated or corrupt");
+  rec->flags = *c->p++;
+  if (rec->flags & BTRACE_NOBR)
+    return TRUE;
+
+  rec->op = (enum md_opcode_t)btrace_get_var(c);
+  if (rec->op <= OP_NA || rec->op >= OP_MAX)
+    fatal("branch trace is truncated or corrupt");
+  rec->PC = c->NPC + (md_addr_t)btrace_get_svar(c);
+  rec->TPC = rec->PC + (md_addr_t)btrace_get_svar(c);
+  rec->NPC = (rec->flags & BTRACE_TAKEN) ? rec->TPC : rec->PC + sizeof(md_inst_t);
+  c->NPC = rec->NPC;
+
+  return TRUE;
+}
@@ -0,0 +1,76 @@
+#ifndef BTRACE_H
+#define BTRACE_H
+
+/* committed branch trace: sim-func -btrace <fname> writes every control
+   instruction it executes, with the instruction count between them, so
+   bpred-eval can replay the branch stream through many predictor
+   configurations without the timing simulator.  fast-forwarded
+   (sample off) instructions are not recorded, warmup instructions are
+   recorded but flagged, they train the predictors without counting.
+
+   file format, all values little endian, varints are LEB128 and signed
+   varints zigzag encoded:
+
+     header   "BTRC", version (u32)
+     records  instructions since the previous record, this one
+	      included (varint), flags (u8), then unless BTRACE_NOBR
+	      opcode (varint), PC less the previous record's next PC
+	      (signed varint) and target less PC (signed varint)
+
+   the target is the taken target, the next PC is the target when the
+   branch was taken and the fall through otherwise.  a BTRACE_NOBR
+   record only carries instructions, e.g. the tail of the trace */
+
+#define BTRACE_MAGIC			0x43525442	/* "BTRC" */
+#define BTRACE_VERSION			1
+
+/* record flags */
+#define BTRACE_TAKEN			0x01	/* branch taken */
+#define BTRACE_WARM			0x02	/* recorded during warmup */
+#define BTRACE_NOBR			0x04	/* instructions only */
+
+/* one record */
+struct btrace_rec_t
+{
+  counter_t n_insn;		/* instructions since the previous record */
+  int flags;
+  enum md_opcode_t op;
+  md_addr_t PC;
+  md_addr_t TPC;		/* taken target */
+  md_addr_t NPC;		/* next PC */
+};
+
+/* a position in an in-memory trace */
+struct btrace_cursor_t
+{
+  const unsigned char *p, *end;
+  md_addr_t NPC;		/* next PC of the previous record */
+};
+
+struct opt_odb_t;
+struct predec_insn_t;
+
+/* register/check the branch trace options */
+void btrace_reg_options(struct opt_odb_t *odb);
+void btrace_check_options(void);
+
+/* writing a branch trace? */
+bool_t btrace_enabled(void);
+
+/* record executed instruction PDI at PC, with next PC NPC and taken
+   target TPC, in the current sample mode */
+void btrace_insn(const struct predec_insn_t *pdi,
+		 md_addr_t PC, md_addr_t NPC, md_addr_t TPC);
+
+/* flush and close the file */
+void btrace_close(void);
+
+/* start cursor C on the LEN byte trace BUF, which must hold a valid
+   header */
+void btrace_cursor_init(struct btrace_cursor_t *c,
+			const unsigned char *buf, size_t len);
+
+/* decode the next record at C into REC, FALSE at the end of the trace */
+bool_t btrace_next(struct btrace_cursor_t *c, struct btrace_rec_t *rec);
+
+#endif /* BTRACE_H */
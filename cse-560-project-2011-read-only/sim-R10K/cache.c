@@ -87,6 +87,7 @@
 #include "cache.h"
 #include "stats.h"
 #include "sim.h"
+#include "hprof.h"
 
 void
 cache_reg_options(struct opt_odb_t *odb,
@@ -389,14 +390,16 @@ cache_stats_print(struct cache_t *cp,	/* cache instance */
   counter_t lookups = cp->lookups[mc_READ] + cp->lookups[mc_WRITE];
   counter_t misses = cp->misses[mc_READ] + cp->misses[mc_WRITE];
 
-  char buf[512];
+  char buf[512], num[512], den[512];
 
   sprintf(buf, "%s.accesses", cp->opt->name);
   print_counter(stream, buf, lookups, "total number of accesses");
   sprintf(buf, "%s.misses", cp->opt->name);
   print_counter(stream, buf, misses, "total number of misses");
   sprintf(buf, "%s.miss_rate", cp->opt->name);
-  print_rate(stream, buf, (double)misses/lookups, "miss rate");
+  sprintf(num, "%s.misses", cp->opt->name);
+  sprintf(den, "%s.accesses", cp->opt->name);
+  print_formula(stream, buf, 1.0, num, den, "miss/access", "miss rate");
 #ifdef GET_OUT
   sprintf(buf, "%s.reads", cp->opt->name);
   print_counter(stream, buf, cp->lookups[mc_READ], "total number of reads");
@@ -417,17 +420,27 @@ cache_stats_print(struct cache_t *cp,	/* cache instance */
 #endif /* GET_OUT */
 }
 
+/* running access and miss totals of cache CP */
+void
+cache_totals(struct cache_t *cp,	/* cache instance */
+	     counter_t *lookups,	/* total accesses */
+	     counter_t *misses)		/* total misses */
+{
+  *lookups = cp->lookups[mc_READ] + cp->lookups[mc_WRITE];
+  *misses = cp->misses[mc_READ] + cp->misses[mc_WRITE];
+}
+
 /* access a cache, perform a CMD operation on cache CP at address ADDR,
    on NBYTES of data, returns latency of operation if initiated
    at NOW */
-unsigned int				/* latency of access in cycles */
-cache_access(struct cache_t *cp,	/* cache to access */
-	     enum mem_cmd_t cmd,	/* access type, mc_READ or mc_WRITE */
-	     md_addr_t addr,		/* address of access */
-	     int nbytes,		/* number of bytes to access */
-	     tick_t now,                /* time of access */
-	     bool_t miss_info[ct_NUM],  /* miss info */
-	     miss_handler_t miss_handler)/* miss handler */
+static unsigned int			/* latency of access in cycles */
+cache_do_access(struct cache_t *cp,	/* cache to access */
+		enum mem_cmd_t cmd,	/* access type, mc_READ or mc_WRITE */
+		md_addr_t addr,		/* address of access */
+		int nbytes,		/* number of bytes to access */
+		tick_t now,                /* time of access */
+		bool_t miss_info[ct_NUM],  /* miss info */
+		miss_handler_t miss_handler)/* miss handler */
 {
   md_addr_t baddr = CACHE_BADDR(cp, addr);
 
@@ -606,6 +619,34 @@ cache_access(struct cache_t *cp,	/* cache to access */
   return (sample_mode == sample_ON) ? (int) MAX(cp->opt->hlat, (blk->ready - now)) : 0;
 }
 
+/* nesting depth of cache_access(), miss handlers access the next level */
+static int cache_depth = 0;
+
+/* access a cache, see cache_do_access(), the outermost access of a
+   hierarchy walk is charged to the host profile */
+unsigned int				/* latency of access in cycles */
+cache_access(struct cache_t *cp,	/* cache to access */
+	     enum mem_cmd_t cmd,	/* access type, mc_READ or mc_WRITE */
+	     md_addr_t addr,		/* address of access */
+	     int nbytes,		/* number of bytes to access */
+	     tick_t now,                /* time of access */
+	     bool_t miss_info[ct_NUM],  /* miss info */
+	     miss_handler_t miss_handler)/* miss handler */
+{
+  unsigned int lat;
+
+  if (!hprof_active || cache_depth > 0)
+    return cache_do_access(cp, cmd, addr, nbytes, now, miss_info, miss_handler);
+
+  cache_depth++;
+  HPROF_CALL(hp_CACHE,
+	     lat = cache_do_access(cp, cmd, addr, nbytes, now, miss_info,
+				   miss_handler));
+  cache_depth--;
+
+  return lat;
+}
+
 /* flush the entire cache, returns latency of the operation */
 unsigned int				/* latency of the flush operation */
 cache_flush(struct cache_t *cp,		/* cache instance to flush */
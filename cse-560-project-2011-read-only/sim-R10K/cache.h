@@ -173,6 +173,12 @@ void
 cache_stats_print(struct cache_t *cp,	/* cache instance */
 		  FILE *stream);
 
+/* running access and miss totals of cache CP */
+void
+cache_totals(struct cache_t *cp,	/* cache instance */
+	     counter_t *lookups,	/* total accesses */
+	     counter_t *misses);	/* total misses */
+
 /* access a cache, perform a CMD operation on cache CP at address ADDR,
    places NBYTES of data at *P, returns latency of operation if initiated
    at NOW, places pointer to block user data in *UDATA, *P is untouched if
@@ -0,0 +1,119 @@
+/* cpistack.c - commit slot stall attribution */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "host.h"
+#include "misc.h"
+#include "machine.h"
+#include "stats.h"
+#include "cpistack.h"
+
+enum cpi_cause_t cpi_rename_stall = cpi_NUM;
+enum cpi_cause_t cpi_fetch_stall = cpi_NUM;
+seq_t cpi_fetch_seq = 0;
+
+static int cpi_width = 0;
+static counter_t cpi_slots[cpi_NUM];
+static counter_t cpi_cycles = 0;
+static counter_t cpi_insn = 0;
+
+static char *cpi_name[cpi_NUM] = {
+  "base", "icache", "bmisp", "dcache", "fu", "regcache",
+  "chkpt", "rob", "lsq", "rs", "other"
+};
+
+static char *cpi_desc[cpi_NUM] = {
+  "committing",
+  "I-cache/I-TLB misses",
+  "branch mis-prediction recovery",
+  "D-cache/L2/D-TLB misses at the head",
+  "functional unit latency",
+  "register cache stalls",
+  "checkpoint exhaustion",
+  "ROB full",
+  "load/store queue full",
+  "reservation stations full",
+  "other stalls"
+};
+
+void
+cpi_init(int width)
+{
+  int i;
+
+  if (width < 1)
+    panic("bad commit width");
+
+  cpi_width = width;
+  for (i = 0; i < cpi_NUM; i++)
+    cpi_slots[i] = 0;
+  cpi_cycles = cpi_insn = 0;
+}
+
+void
+cpi_cycle(int n_commit, enum cpi_cause_t cause)
+{
+  int used = MIN(n_commit, cpi_width);
+
+  cpi_cycles++;
+  cpi_insn += n_commit;
+  cpi_slots[cpi_BASE] += used;
+  if (used < cpi_width)
+    cpi_slots[cause == cpi_BASE ? cpi_OTHER : cause] += cpi_width - used;
+}
+
+enum cpi_cause_t
+cpi_frontend(void)
+{
+  if (cpi_fetch_stall != cpi_NUM)
+    return cpi_fetch_stall;
+  if (cpi_rename_stall != cpi_NUM)
+    return cpi_rename_stall;
+  return cpi_OTHER;
+}
+
+enum cpi_cause_t
+cpi_backend(enum cpi_cause_t dflt)
+{
+  switch (cpi_rename_stall)
+    {
+    case cpi_CHKPT:
+    case cpi_ROB:
+    case cpi_LSQ:
+    case cpi_RS:
+      return cpi_rename_stall;
+    default:
+      return dflt;
+    }
+}
+
+void
+cpi_stats(FILE *stream)
+{
+  char name[64], desc[128];
+  double total = 0.0, cpi;
+  int i;
+
+  if (!cpi_width)
+    return;
+
+  print_counter(stream, "cpi_cycles", cpi_cycles, "cycles attributed to the CPI stack");
+  print_counter(stream, "cpi_insn", cpi_insn, "instructions committed in those cycles");
+
+  for (i = 0; i < cpi_NUM; i++)
+    {
+      cpi = cpi_insn ? (double)cpi_slots[i] / cpi_width / cpi_insn : 0.0;
+      total += cpi;
+
+      sprintf(name, "cpi_%s", cpi_name[i]);
+      sprintf(desc, "CPI component, %s", cpi_desc[i]);
+      print_rate(stream, name, cpi, desc);
+
+      sprintf(name, "cpi_%s_pct", cpi_name[i]);
+      sprintf(desc, "%% of commit slots, %s", cpi_desc[i]);
+      print_rate(stream, name, cpi_cycles ? 100.0 * cpi_slots[i] / ((double)cpi_cycles * cpi_width) : 0.0, desc);
+    }
+
+  print_rate(stream, "cpi_total", total, "sum of the CPI components");
+}
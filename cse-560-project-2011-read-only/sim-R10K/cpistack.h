@@ -0,0 +1,76 @@
+#ifndef CPISTACK_H
+#define CPISTACK_H
+
+/* CPI stack: every cycle each of the commit_width commit slots is either
+   used by a committing instruction (base) or charged to the reason the
+   oldest in-flight instruction could not commit, so the components sum
+   to the measured CPI.
+
+   the simulator classifies a stall cycle as follows:
+
+     window empty	the front end stall (cpi_fetch_stall), else the
+			rename stall (cpi_rename_stall), else other
+     head incomplete	mis-predicted branch, D-cache/D-TLB miss or
+			register cache stall at the head, else the rename
+			stall when the machine is full (ROB, LSQ, RS or
+			checkpoints), else functional unit latency */
+
+/* commit slot causes */
+enum cpi_cause_t {
+  cpi_BASE,		/* slot used */
+  cpi_ICACHE,		/* I-cache/I-TLB miss */
+  cpi_BMISP,		/* branch mis-prediction resolution and refill */
+  cpi_DCACHE,		/* D-cache/L2/D-TLB miss at the head */
+  cpi_FU,		/* functional unit latency and dependences */
+  cpi_REGCACHE,		/* register cache miss or write-back stall */
+  cpi_CHKPT,		/* no free checkpoint */
+  cpi_ROB,		/* ROB full */
+  cpi_LSQ,		/* load or store queue full */
+  cpi_RS,		/* no free reservation station */
+  cpi_OTHER,		/* anything else, e.g. system call drains */
+  cpi_NUM
+};
+
+/* why rename stopped short of its width this cycle, cpi_NUM if it did
+   not stop on a resource */
+extern enum cpi_cause_t cpi_rename_stall;
+
+/* why the front end is not delivering, cpi_ICACHE or cpi_BMISP, and the
+   last sequence number fetched before it stalled; cpi_NUM when fetch is
+   running */
+extern enum cpi_cause_t cpi_fetch_stall;
+extern seq_t cpi_fetch_seq;
+
+/* the front end stalled for CAUSE after fetching sequence number SEQ */
+#define CPI_FETCH_STALL(CAUSE, SEQ)					\
+  do {									\
+    cpi_fetch_stall = (CAUSE);						\
+    cpi_fetch_seq = (SEQ);						\
+  } while (0)
+
+/* rename accepted the instruction with sequence number SEQ, a front end
+   stall ends with the first instruction fetched after it */
+#define CPI_RENAMED(SEQ)						\
+  do {									\
+    if ((SEQ) > cpi_fetch_seq)						\
+      cpi_fetch_stall = cpi_NUM;					\
+  } while (0)
+
+/* initialize for a machine committing WIDTH instructions per cycle */
+void cpi_init(int width);
+
+/* account one cycle that committed N_COMMIT instructions, unused slots
+   are charged to CAUSE */
+void cpi_cycle(int n_commit, enum cpi_cause_t cause);
+
+/* cause of a stall cycle with an empty window */
+enum cpi_cause_t cpi_frontend(void);
+
+/* cause of a stall cycle with an incomplete head that is not itself
+   a long latency event: the full resource, else DFLT */
+enum cpi_cause_t cpi_backend(enum cpi_cause_t dflt);
+
+/* print the CPI stack */
+void cpi_stats(FILE *stream);
+
+#endif /* CPISTACK_H */
@@ -0,0 +1,254 @@
+/* critpath.c - dependence graph critical path analysis */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "host.h"
+#include "misc.h"
+#include "machine.h"
+#include "options.h"
+#include "stats.h"
+#include "critpath.h"
+
+/* graph nodes of an instruction, in topological order */
+enum critpath_node_t { cn_F, cn_D, cn_I, cn_E, cn_C };
+
+int critpath_window = 0;
+
+static struct critpath_insn_t *window = NULL;
+static int n_window = 0;
+
+static counter_t cp_cycles[cp_NUM];
+static counter_t cp_windows = 0;
+static counter_t cp_insn = 0;
+
+static char *cp_name[cp_NUM] = {
+  "fetch", "bmisp", "rename", "issue", "dcache", "fu", "commit", "bw"
+};
+
+static char *cp_desc[cp_NUM] = {
+  "fetch bandwidth and I-cache misses",
+  "branch mis-prediction recovery",
+  "fetch queue and rename latency",
+  "scheduling latency and issue contention",
+  "D-cache/D-TLB misses",
+  "functional unit latency",
+  "commit latency",
+  "in-order rename and commit bandwidth"
+};
+
+void
+critpath_reg_options(struct opt_odb_t *odb)
+{
+  opt_reg_int(odb, "-critpath",
+	      "critical path analysis window in committed insts (0 = off)",
+	      &critpath_window, /* default */0, /* print */TRUE, /* format */NULL);
+}
+
+void
+critpath_check_options(void)
+{
+  int i;
+
+  if (critpath_window < 0)
+    fatal("critical path window must be non-negative");
+  if (critpath_window == 1)
+    fatal("critical path window must hold at least 2 instructions");
+
+  for (i = 0; i < cp_NUM; i++)
+    cp_cycles[i] = 0;
+  cp_windows = cp_insn = 0;
+
+  if (window)
+    free(window);
+  window = NULL;
+  n_window = 0;
+  if (critpath_window)
+    window = (struct critpath_insn_t *)
+      mycalloc(critpath_window, sizeof(struct critpath_insn_t));
+}
+
+static int
+critpath_cmp(const void *a, const void *b)
+{
+  const struct critpath_insn_t *ca = a, *cb = b;
+
+  return ca->seq < cb->seq ? -1 : ca->seq > cb->seq;
+}
+
+/* index of the instruction with sequence number SEQ among the first N
+   of the window, -1 if it is not there */
+static int
+critpath_find(seq_t seq, int n)
+{
+  int lo = 0, hi = n - 1, mid;
+
+  if (seq == 0)
+    return -1;
+
+  while (lo <= hi)
+    {
+      mid = (lo + hi) / 2;
+      if (window[mid].seq == seq)
+	return mid;
+      if (window[mid].seq < seq)
+	lo = mid + 1;
+      else
+	hi = mid - 1;
+    }
+  return -1;
+}
+
+static tick_t
+critpath_time(struct critpath_insn_t *ci, enum critpath_node_t node)
+{
+  switch (node)
+    {
+    case cn_F: return ci->fetched;
+    case cn_D: return ci->renamed;
+    case cn_I: return ci->issued;
+    case cn_E: return ci->completed;
+    case cn_C: return ci->committed;
+    }
+  panic("bogus critical path node");
+  return 0;
+}
+
+/* walk the last arriving edges back from the window's final commit */
+static void
+critpath_analyze(void)
+{
+  struct critpath_insn_t *r = window;
+  enum critpath_node_t node = cn_C, pnode;
+  enum critpath_cause_t cause;
+  int i = n_window - 1, pi, p, dep;
+  tick_t t, pt;
+
+  /* commit order need not be program order */
+  qsort(window, n_window, sizeof(struct critpath_insn_t), critpath_cmp);
+
+  while (i > 0 || node != cn_F)
+    {
+      t = critpath_time(&r[i], node);
+      pi = i;
+
+      switch (node)
+	{
+	case cn_C:
+	  if (i > 0 && r[i-1].committed > r[i].completed && r[i-1].committed <= t)
+	    {
+	      pi = i - 1;
+	      pnode = cn_C;
+	      cause = cp_BW;
+	    }
+	  else
+	    {
+	      pnode = cn_E;
+	      cause = cp_COMMIT;
+	    }
+	  break;
+
+	case cn_E:
+	  pnode = cn_I;
+	  cause = r[i].f_dmiss ? cp_DCACHE : cp_FU;
+	  break;
+
+	case cn_I:
+	  /* the latest of dispatch and the producers, producers win ties */
+	  pnode = cn_D;
+	  cause = cp_ISSUE;
+	  pt = r[i].renamed;
+	  for (dep = 0; dep < DEP_INUM; dep++)
+	    {
+	      p = critpath_find(r[i].dep_seq[dep], i);
+	      if (p >= 0 && r[p].completed >= pt && r[p].completed <= t)
+		{
+		  pt = r[p].completed;
+		  pi = p;
+		  pnode = cn_E;
+		}
+	    }
+	  break;
+
+	case cn_D:
+	  if (i > 0 && r[i-1].renamed > r[i].fetched && r[i-1].renamed <= t)
+	    {
+	      pi = i - 1;
+	      pnode = cn_D;
+	      cause = cp_BW;
+	    }
+	  else
+	    {
+	      pnode = cn_F;
+	      cause = cp_RENAME;
+	    }
+	  break;
+
+	case cn_F:
+	default:
+	  pi = i - 1;
+	  if (r[pi].f_bmisp)
+	    {
+	      pnode = cn_E;
+	      cause = cp_BMISP;
+	    }
+	  else
+	    {
+	      pnode = cn_F;
+	      cause = cp_FETCH;
+	    }
+	  break;
+	}
+
+      /* timestamps that run backwards (e.g. system calls) cost nothing */
+      pt = critpath_time(&r[pi], pnode);
+      if (t > pt)
+	cp_cycles[cause] += t - pt;
+
+      i = pi;
+      node = pnode;
+    }
+
+  cp_windows++;
+  cp_insn += n_window;
+}
+
+void
+critpath_commit(struct critpath_insn_t *ci)
+{
+  window[n_window++] = *ci;
+  if (n_window == critpath_window)
+    {
+      critpath_analyze();
+      n_window = 0;
+    }
+}
+
+void
+critpath_stats(FILE *stream)
+{
+  char name[64], desc[128];
+  counter_t total = 0;
+  int i;
+
+  if (!critpath_window)
+    return;
+
+  for (i = 0; i < cp_NUM; i++)
+    total += cp_cycles[i];
+
+  print_counter(stream, "critpath_windows", cp_windows, "critical path windows analyzed");
+  print_counter(stream, "critpath_insn", cp_insn, "instructions in analyzed windows");
+  print_counter(stream, "critpath_cycles", total, "cycles on the critical paths");
+
+  for (i = 0; i < cp_NUM; i++)
+    {
+      sprintf(name, "critpath_%s", cp_name[i]);
+      sprintf(desc, "critical path cycles, %s", cp_desc[i]);
+      print_counter(stream, name, cp_cycles[i], desc);
+
+      sprintf(name, "critpath_%s_pct", cp_name[i]);
+      sprintf(desc, "%% of the critical path, %s", cp_desc[i]);
+      print_rate(stream, name, total ? 100.0 * cp_cycles[i] / total : 0.0, desc);
+    }
+}
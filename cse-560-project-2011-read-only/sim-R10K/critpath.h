@@ -0,0 +1,70 @@
+#ifndef CRITPATH_H
+#define CRITPATH_H
+
+/* dependence graph critical path analysis (after Fields, Rubin and
+   Bodik, "Focusing processor policies via critical-path prediction").
+
+   committed instructions are collected in windows of -critpath
+   instructions.  each instruction contributes the nodes
+
+     F  fetched	    D  renamed	   I  issued	E  completed   C  committed
+
+   with the edges
+
+     F(i-1) -> F(i)	fetch order: fetch bandwidth, I-cache misses
+     E(b)   -> F(b+1)	branch mis-prediction recovery
+     F(i)   -> D(i)	fetch queue and rename latency
+     D(i-1) -> D(i)	in-order rename bandwidth
+     D(i)   -> I(i)	scheduling latency and issue contention
+     E(p)   -> I(i)	data dependence on producer p, same
+     I(i)   -> E(i)	execution: D-cache miss or functional unit
+     E(i)   -> C(i)	commit latency
+     C(i-1) -> C(i)	in-order commit bandwidth
+
+   node times are the recorded timestamps, so every node's last
+   arriving incoming edge is the one with the latest source.  walking
+   last arriving edges back from the window's final commit gives its
+   critical path, and each edge's cycles are charged to its cause.  edges
+   from before a window are ignored, and a final partial window is
+   dropped */
+
+/* critical path edge causes */
+enum critpath_cause_t {
+  cp_FETCH,		/* F -> F */
+  cp_BMISP,		/* E -> F */
+  cp_RENAME,		/* F -> D */
+  cp_ISSUE,		/* D -> I, E -> I */
+  cp_DCACHE,		/* I -> E, D-cache/D-TLB miss */
+  cp_FU,		/* I -> E, otherwise */
+  cp_COMMIT,		/* E -> C */
+  cp_BW,		/* D -> D, C -> C */
+  cp_NUM
+};
+
+/* a committed instruction */
+struct critpath_insn_t
+{
+  seq_t seq;
+  seq_t dep_seq[DEP_INUM];	/* producers in flight at rename, or 0 */
+  tick_t fetched, renamed, issued, completed, committed;
+  bool_t f_bmisp;		/* mis-predicted, resolved at completion */
+  bool_t f_dmiss;		/* load missed in the D-cache/D-TLB */
+};
+
+struct opt_odb_t;
+
+/* instructions per analysis window, 0 when the analysis is off */
+extern int critpath_window;
+
+/* register/check the critical path options, checking also resets the
+   analysis (e.g. in a -sweep child) */
+void critpath_reg_options(struct opt_odb_t *odb);
+void critpath_check_options(void);
+
+/* record committed instruction CI, analyzing each full window */
+void critpath_commit(struct critpath_insn_t *ci);
+
+/* print the critical path breakdown */
+void critpath_stats(FILE *stream);
+
+#endif /* CRITPATH_H */
@@ -0,0 +1,197 @@
+/* eio-index.c - convert an EIO trace into an indexed, binary EIO trace
+ *
+ * usage: eio-index [-stride <n>] <in.eio> <out.eio>
+ *
+ * The header and initial checkpoint of <in.eio> are copied in text form,
+ * the transactions are written in the binary encoding of eiobin.h, every
+ * <n> transactions in a separate gzip member.  The offset and first
+ * instruction count of each member are written to <out.eio>.idx, which
+ * lets eio_seek() jump to any checkpoint location without replaying the
+ * transactions before it.  The output file is still a valid gzip stream.
+ *
+ * build: cc -o eio-index eio-index.c eiobin.c misc.c libexo.a -lz
+ *
+ * indexing the benchmark traces, for each benchmarks/<bench>.eio:
+ *   eio-index benchmarks/<bench>.eio benchmarks/<bench>.idx.eio
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "host.h"
+#include "misc.h"
+#include "machine.h"
+#include "memory.h"
+#include "libexo.h"
+#include "eio.h"
+#include "eiobin.h"
+
+#define EIO_FILE_HEADER							\
+  "/* This is a SimpleScalar EIO file - DO NOT MOVE OR EDIT THIS LINE! */\n"
+
+/* number of fixed checkpoint terms preceding the memory pages */
+#define EIO_CHKPT_TERMS			8
+
+/* return the size of file FNAME in bytes */
+static long long
+file_size(char *fname)
+{
+  FILE *fd;
+  long long size;
+
+  fd = fopen(fname, "rb");
+  if (!fd)
+    fatal("unable to open `%s'", fname);
+  fseek(fd, 0, SEEK_END);
+  size = (long long)ftell(fd);
+  fclose(fd);
+
+  return size;
+}
+
+static void
+usage(char *prog)
+{
+  fprintf(stderr, "usage: %s [-stride <n>] <in.eio> <out.eio>\n", prog);
+  exit(1);
+}
+
+int
+main(int argc, char **argv)
+{
+  gzFile in, out;
+  FILE *idx;
+  char *in_fname, *out_fname, *idx_fname;
+  int i, stride = EIO_INDEX_STRIDE, page_count = -1, n_ent = 0, max_ent = 64;
+  counter_t n_trans = 0;
+  struct exo_term_t *exo, *elt, *pending;
+  struct eio_index_ent_t *ents;
+  struct eio_index_hdr_t hdr;
+
+  if (argc == 5 && !strcmp(argv[1], "-stride"))
+    {
+      stride = atoi(argv[2]);
+      argv += 2;
+      argc -= 2;
+    }
+  if (argc != 3 || stride < 1)
+    usage(argv[0]);
+
+  in_fname = argv[1];
+  out_fname = argv[2];
+
+  in = gzopen(in_fname, "r");
+  if (!in)
+    fatal("unable to open EIO file `%s'", in_fname);
+
+  /* read and check the EIO header list: format, version, endian[, chksum] */
+  exo = exo_read(in);
+  if (!exo
+      || exo->ec != ec_list
+      || !(elt = exo->as_list.head)
+      || !elt->next
+      || elt->next->ec != ec_integer)
+    fatal("could not read EIO file header of `%s'", in_fname);
+  if (elt->next->as_integer.val != EIO_FILE_VERSION)
+    fatal("EIO file `%s' is not a text EIO trace", in_fname);
+
+  /* header and initial checkpoint, in text form */
+  out = gzopen(out_fname, "wb");
+  if (!out)
+    fatal("unable to create EIO file `%s'", out_fname);
+
+  gzprintf(out, "%s\n", EIO_FILE_HEADER);
+  elt->next->as_integer.val = EIO_BIN_FILE_VERSION;
+  exo_print(exo, out);
+  gzprintf(out, "\n\n");
+  exo_delete(exo);
+
+  for (i=0; page_count < 0 || i < EIO_CHKPT_TERMS + page_count; i++)
+    {
+      exo = exo_read(in);
+      if (!exo)
+	fatal("could not read initial checkpoint of `%s'", in_fname);
+
+      /* the fifth term holds the number of memory pages that follow */
+      if (i == 4)
+	{
+	  if (exo->ec != ec_list
+	      || !exo->as_list.head
+	      || exo->as_list.head->ec != ec_integer)
+	    fatal("could not read EIO memory config of `%s'", in_fname);
+	  page_count = (int)exo->as_list.head->as_integer.val;
+	}
+
+      exo_print(exo, out);
+      gzprintf(out, "\n\n");
+      exo_delete(exo);
+    }
+  gzclose(out);
+
+  /* transactions, STRIDE per gzip member */
+  ents = (struct eio_index_ent_t *)
+    mycalloc(max_ent, sizeof(struct eio_index_ent_t));
+
+  pending = exo_read(in);
+  while (pending)
+    {
+      if (pending->ec != ec_list
+	  || !pending->as_list.head
+	  || pending->as_list.head->ec != ec_integer)
+	fatal("cannot read EIO transaction %lld of `%s'",
+	      (long long)n_trans, in_fname);
+
+      if (n_ent == max_ent)
+	{
+	  max_ent *= 2;
+	  ents = (struct eio_index_ent_t *)
+	    realloc(ents, max_ent * sizeof(struct eio_index_ent_t));
+	  if (!ents)
+	    fatal("out of virtual memory");
+	}
+      ents[n_ent].icnt = (counter_t)pending->as_list.head->as_integer.val;
+      ents[n_ent].offset = file_size(out_fname);
+      n_ent++;
+
+      out = gzopen(out_fname, "ab");
+      if (!out)
+	fatal("unable to append to EIO file `%s'", out_fname);
+
+      for (i=0; i < stride && pending; i++)
+	{
+	  eiobin_write(pending, out);
+	  exo_delete(pending);
+	  n_trans++;
+
+	  pending = exo_read(in);
+	}
+      gzclose(out);
+    }
+  gzclose(in);
+
+  /* write the index sidecar */
+  idx_fname = (char *)mycalloc(strlen(out_fname) + strlen(EIO_INDEX_SUFFIX) + 1,
+			       sizeof(char));
+  strcpy(idx_fname, out_fname);
+  strcat(idx_fname, EIO_INDEX_SUFFIX);
+
+  idx = fopen(idx_fname, "wb");
+  if (!idx)
+    fatal("unable to create EIO index `%s'", idx_fname);
+
+  hdr.magic = EIO_INDEX_MAGIC;
+  hdr.version = EIO_INDEX_VERSION;
+  hdr.stride = stride;
+  hdr.n_ent = n_ent;
+  if (fwrite(&hdr, sizeof(hdr), 1, idx) != 1
+      || (n_ent > 0
+	  && fwrite(ents, sizeof(struct eio_index_ent_t), n_ent, idx) != n_ent))
+    fatal("could not write EIO index `%s'", idx_fname);
+  fclose(idx);
+
+  fprintf(stderr, "%s: %lld transactions, %d index entries -> %s\n",
+	  out_fname, (long long)n_trans, n_ent, idx_fname);
+
+  return 0;
+}
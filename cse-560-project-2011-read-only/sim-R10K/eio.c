@@ -66,10 +66,13 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <fcntl.h>
 #ifdef _MSC_VER
 #include <io.h>
 #else /* !_MSC_VER */
 #include <unistd.h>
+#include <pthread.h>
+#include <sys/time.h>
 #endif /* _MSC_VER */
 
 #include "/filespace/people/c/cabaj/sim-R10K-lib/include/zlib.h"
@@ -83,7 +86,9 @@
 #include "syscall.h"
 #include "sim.h"
 #include "endian.h"
+#include "stats.h"
 #include "eio.h"
+#include "eiobin.h"
 
 #ifdef _MSC_VER
 #define write		_write
@@ -122,6 +127,274 @@ int verify_register_checksum = 0;
 /* verify that it is a register checksum just by shape */
 int eio_is_chksum(struct exo_term_t *exo);
 
+/* binary (indexed) EIO trace state: the open stream, its file name and
+   its index, transactions on this stream are read in binary form */
+static gzFile eio_bin_fd = NULL;
+static char *eio_bin_fname = NULL;
+static struct eio_index_ent_t *eio_bin_index = NULL;
+static int eio_bin_n_index = 0;
+
+/* read the next EIO transaction from stream FD, on the caller's thread */
+static struct exo_term_t *
+eio_read_exo_direct(gzFile fd)
+{
+  if (fd != NULL && fd == eio_bin_fd)
+    return eiobin_read(fd);
+  else
+    return exo_read(fd);
+}
+
+/* EIO prefetch state: a helper thread inflates and parses transactions
+   of stream EIO_PF_FD ahead of the simulator into a ring, and sleeps
+   while the ring is full.  consumed terms travel back to the helper on a
+   second ring while it runs, and are freed by the simulator once it has
+   exited.  both rings are guarded by EIO_PF_LOCK.  libexo keeps global
+   lexer and allocator state, so while the helper runs no other libexo
+   call may be made on the simulator thread (see eio_pf_check()) */
+static gzFile eio_pf_fd = NULL;
+static unsigned int eio_pf_size = 0;
+static struct exo_term_t **eio_pf_ring = NULL;
+static struct exo_term_t **eio_pf_free_ring = NULL;
+static unsigned int eio_pf_head = 0, eio_pf_tail = 0;
+static unsigned int eio_pf_free_head = 0, eio_pf_free_tail = 0;
+static int eio_pf_stop = FALSE;		/* helper is asked to exit */
+static int eio_pf_done = FALSE;		/* helper has exited */
+static int eio_pf_eof = FALSE;		/* end-of-file marker consumed */
+
+/* EIO prefetch statistics */
+static counter_t eio_pf_n_pop = 0;
+static counter_t eio_pf_n_wait = 0;
+static counter_t eio_pf_n_full = 0;
+static double eio_pf_wait_time = 0.0;
+
+#ifndef _MSC_VER
+static pthread_t eio_pf_thread;
+static pthread_mutex_t eio_pf_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t eio_pf_wake_helper = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t eio_pf_wake_sim = PTHREAD_COND_INITIALIZER;
+
+/* current host time in seconds */
+static double
+eio_pf_now(void)
+{
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+  return (double)tv.tv_sec + (double)tv.tv_usec / 1.0e6;
+}
+
+/* release terms returned by the simulator, helper thread only, called
+   and returns with EIO_PF_LOCK held */
+static void
+eio_pf_drain_free(void)
+{
+  struct exo_term_t *exo;
+
+  while (eio_pf_free_head != eio_pf_free_tail)
+    {
+      exo = eio_pf_free_ring[MOD(eio_pf_free_head, eio_pf_size)];
+      eio_pf_free_head++;
+
+      pthread_mutex_unlock(&eio_pf_lock);
+      exo_delete(exo);
+      pthread_mutex_lock(&eio_pf_lock);
+    }
+  pthread_cond_signal(&eio_pf_wake_sim);
+}
+
+/* helper thread: read transactions until end-of-file or stop */
+static void *
+eio_pf_main(void *arg)
+{
+  gzFile fd = (gzFile)arg;
+  struct exo_term_t *exo;
+
+  pthread_mutex_lock(&eio_pf_lock);
+  for (;;)
+    {
+      eio_pf_drain_free();
+      if (eio_pf_stop)
+	break;
+
+      if (eio_pf_tail - eio_pf_head == eio_pf_size)
+	{
+	  /* sleep until the simulator pops or returns a term */
+	  eio_pf_n_full++;
+	  pthread_cond_wait(&eio_pf_wake_helper, &eio_pf_lock);
+	  continue;
+	}
+
+      pthread_mutex_unlock(&eio_pf_lock);
+      exo = eio_read_exo_direct(fd);
+      pthread_mutex_lock(&eio_pf_lock);
+
+      eio_pf_ring[MOD(eio_pf_tail, eio_pf_size)] = exo;
+      eio_pf_tail++;
+      pthread_cond_signal(&eio_pf_wake_sim);
+
+      /* NULL marks end-of-file for the simulator, nothing follows it */
+      if (!exo)
+	break;
+    }
+
+  /* terms returned from now on are freed by the simulator */
+  eio_pf_drain_free();
+  eio_pf_done = TRUE;
+  pthread_cond_signal(&eio_pf_wake_sim);
+  pthread_mutex_unlock(&eio_pf_lock);
+
+  return NULL;
+}
+#endif /* !_MSC_VER */
+
+/* libexo may not be called on the simulator thread to WHAT while an EIO
+   stream is being prefetched */
+static void
+eio_pf_check(char *what)
+{
+  if (eio_pf_fd != NULL)
+    fatal("cannot %s while an EIO stream is being prefetched", what);
+}
+
+/* read the next EIO transaction from stream FD */
+static struct exo_term_t *
+eio_read_exo(gzFile fd)
+{
+  struct exo_term_t *exo = NULL;
+
+  if (fd == NULL || fd != eio_pf_fd)
+    {
+      eio_pf_check("read another EIO stream");
+      return eio_read_exo_direct(fd);
+    }
+
+  /* end-of-file stays end-of-file, as when reading directly */
+  if (eio_pf_eof)
+    return NULL;
+
+#ifndef _MSC_VER
+  pthread_mutex_lock(&eio_pf_lock);
+  if (eio_pf_head == eio_pf_tail)
+    {
+      double start = eio_pf_now();
+
+      eio_pf_n_wait++;
+      while (eio_pf_head == eio_pf_tail)
+	pthread_cond_wait(&eio_pf_wake_sim, &eio_pf_lock);
+      eio_pf_wait_time += eio_pf_now() - start;
+    }
+
+  exo = eio_pf_ring[MOD(eio_pf_head, eio_pf_size)];
+  eio_pf_head++;
+  eio_pf_n_pop++;
+  pthread_cond_signal(&eio_pf_wake_helper);
+  pthread_mutex_unlock(&eio_pf_lock);
+#endif /* !_MSC_VER */
+
+  if (!exo)
+    eio_pf_eof = TRUE;
+
+  return exo;
+}
+
+/* release EIO transaction EXO read from stream FD */
+static void
+eio_release_exo(gzFile fd, struct exo_term_t *exo)
+{
+  if (!exo)
+    return;
+
+  if (fd == NULL || fd != eio_pf_fd)
+    {
+      exo_delete(exo);
+      return;
+    }
+
+#ifndef _MSC_VER
+  pthread_mutex_lock(&eio_pf_lock);
+
+  /* the helper drains this ring, so it cannot stay full for long */
+  while (!eio_pf_done && eio_pf_free_tail - eio_pf_free_head == eio_pf_size)
+    pthread_cond_wait(&eio_pf_wake_sim, &eio_pf_lock);
+
+  if (!eio_pf_done)
+    {
+      eio_pf_free_ring[MOD(eio_pf_free_tail, eio_pf_size)] = exo;
+      eio_pf_free_tail++;
+      pthread_cond_signal(&eio_pf_wake_helper);
+      pthread_mutex_unlock(&eio_pf_lock);
+      return;
+    }
+  pthread_mutex_unlock(&eio_pf_lock);
+#endif /* !_MSC_VER */
+
+  /* the helper has exited, libexo is ours again */
+  exo_delete(exo);
+}
+
+/* start reading EIO stream FD ahead of the simulator, DEPTH transactions
+   deep, on a helper thread */
+void
+eio_prefetch_start(gzFile fd, int depth)
+{
+  if (eio_pf_fd != NULL)
+    fatal("EIO prefetch is already running");
+  if (depth < 1 || !IS_POWEROFTWO(depth))
+    fatal("EIO prefetch depth `%d' must be a positive power of two", depth);
+
+#ifdef _MSC_VER
+  fatal("EIO prefetch is not supported on this host");
+#else /* !_MSC_VER */
+  eio_pf_size = depth;
+  eio_pf_ring = (struct exo_term_t **)mycalloc(depth, sizeof(struct exo_term_t *));
+  eio_pf_free_ring = (struct exo_term_t **)mycalloc(depth, sizeof(struct exo_term_t *));
+  eio_pf_head = eio_pf_tail = 0;
+  eio_pf_free_head = eio_pf_free_tail = 0;
+  eio_pf_stop = eio_pf_done = eio_pf_eof = FALSE;
+  eio_pf_fd = fd;
+
+  if (pthread_create(&eio_pf_thread, NULL, eio_pf_main, (void *)fd) != 0)
+    fatal("could not start EIO prefetch thread");
+#endif /* _MSC_VER */
+}
+
+/* stop the EIO prefetch thread, buffered transactions are discarded */
+void
+eio_prefetch_stop(void)
+{
+  if (eio_pf_fd == NULL)
+    return;
+
+#ifndef _MSC_VER
+  pthread_mutex_lock(&eio_pf_lock);
+  eio_pf_stop = TRUE;
+  pthread_cond_signal(&eio_pf_wake_helper);
+  pthread_mutex_unlock(&eio_pf_lock);
+  pthread_join(eio_pf_thread, NULL);
+#endif /* !_MSC_VER */
+
+  while (eio_pf_head != eio_pf_tail)
+    {
+      if (eio_pf_ring[MOD(eio_pf_head, eio_pf_size)])
+	exo_delete(eio_pf_ring[MOD(eio_pf_head, eio_pf_size)]);
+      eio_pf_head++;
+    }
+  free(eio_pf_ring);
+  free(eio_pf_free_ring);
+  eio_pf_ring = eio_pf_free_ring = NULL;
+  eio_pf_fd = NULL;
+}
+
+/* print EIO prefetch statistics to STREAM */
+void
+eio_prefetch_stats(FILE *stream)
+{
+  print_counter(stream, "eio_pf_trans", eio_pf_n_pop, "EIO transactions read through the prefetch queue");
+  print_counter(stream, "eio_pf_waits", eio_pf_n_wait, "EIO reads that found the prefetch queue empty");
+  print_rate(stream, "eio_pf_wait_time", eio_pf_wait_time, "seconds spent waiting on the EIO prefetch thread");
+  print_counter(stream, "eio_pf_full", eio_pf_n_full, "EIO prefetch thread stalls on a full queue");
+}
+
 gzFile 
 eio_create(char *fname)
 {
@@ -129,6 +402,7 @@ eio_create(char *fname)
   struct exo_term_t *exo;
   int target_big_endian;
 
+  eio_pf_check("create an EIO file");
   target_big_endian = (endian_host_byte_order() == endian_big);
 
   fd = gzopen(fname, "w");
@@ -161,6 +435,7 @@ eio_open(char *fname)
   struct exo_term_t *exo;
   int file_format, file_version, big_endian, target_big_endian;
 
+  eio_pf_check("open an EIO file");
   target_big_endian = (endian_host_byte_order() == endian_big);
 
   fd = gzopen(fname, "r");
@@ -198,9 +473,23 @@ eio_open(char *fname)
   if (file_format != MD_EIO_FILE_FORMAT)
     fatal("EIO file `%s' has incompatible format", fname);
 
-  if (file_version != EIO_FILE_VERSION)
+  if (file_version != EIO_FILE_VERSION && file_version != EIO_BIN_FILE_VERSION)
     fatal("EIO file `%s' has incompatible version", fname);
 
+  /* binary transactions are only reachable through the index */
+  if (file_version == EIO_BIN_FILE_VERSION)
+    {
+      if (eio_bin_fd != NULL)
+	fatal("only one binary EIO file may be open at a time");
+
+      eio_bin_n_index = eio_index_load(fname, &eio_bin_index);
+      if (eio_bin_n_index == 0)
+	fatal("binary EIO file `%s' has no index", fname);
+
+      eio_bin_fd = fd;
+      eio_bin_fname = mystrdup(fname);
+    }
+
 #if (!defined(TARGET_ALPHA) || !defined(BYTES_BIG_ENDIAN))
   if (!!big_endian != !!target_big_endian)
     fatal("EIO file `%s' has incompatible endian format", fname);
@@ -238,6 +527,10 @@ eio_valid(char *fname)
 void
 eio_close(gzFile fd)
 {
+  if (fd == eio_pf_fd)
+    eio_prefetch_stop();
+  if (fd == eio_bin_fd)
+    eio_bin_fd = NULL;
   gzclose(fd);
 }
 
@@ -252,6 +545,8 @@ eio_write_chkpt(struct regs_t *regs,		/* regs to dump */
   struct exo_term_t *exo;
   struct mem_pte_t *pte;
 
+  eio_pf_check("write an EIO checkpoint");
+
   mygzprintf(fd, "/* ** start checkpoint @ %n... */\n\n", (int)eio_trans_icnt);
 
   mygzprintf(fd, "/* EIO file pointer: %n... */\n", (int)eio_trans_icnt);
@@ -351,6 +646,8 @@ eio_read_chkpt(struct regs_t *regs,		/* regs to dump */
   counter_t trans_icnt;
   struct exo_term_t *exo, *elt;
 
+  eio_pf_check("read an EIO checkpoint");
+
   /* read the EIO file pointer */
   exo = exo_read(fd);
   if (!exo
@@ -620,6 +917,8 @@ eio_write_trace(gzFile eio_fd,			/* EIO stream file desc */
   int i;
   struct exo_term_t *exo;
 
+  eio_pf_check("write an EIO trace");
+
   /* write syscall register inputs ($r2..$r7) */
   input_regs = exo_new(ec_list, NULL);
   for (i=MD_FIRST_IN_REG; i <= MD_LAST_IN_REG; i++)
@@ -698,7 +997,7 @@ eio_read_trace(gzFile eio_fd,			/* EIO stream file desc */
     }
 
   /* else, read the external I/O (EIO) transaction */
-  exo = exo_read(eio_fd);
+  exo = eio_read_exo(eio_fd);
 
   while (eio_is_chksum(exo)) {
 	 /* there was a register checksum -- this is okay as long as we
@@ -707,10 +1006,10 @@ eio_read_trace(gzFile eio_fd,			/* EIO stream file desc */
 		panic("unverified register checksum");
 	 }
 	 /* release the register checksum */
-	 exo_delete(exo);
+	 eio_release_exo(eio_fd, exo);
 	 
 	 /* grab another eio transaction */
-	 exo = exo_read(eio_fd);
+	 exo = eio_read_exo(eio_fd);
   }
 
   /* one more transaction processed */
@@ -878,7 +1177,33 @@ eio_read_trace(gzFile eio_fd,			/* EIO stream file desc */
     }
 
   /* release the EIO EXO node */
-  exo_delete(exo);
+  eio_release_exo(eio_fd, exo);
+}
+
+/* skip the initial checkpoint of text EIO stream FD, the fifth term
+   holds the number of memory pages that follow the fixed terms */
+static void
+eio_skip_chkpt(gzFile fd)
+{
+  int i, page_count = -1;
+  struct exo_term_t *exo;
+
+  for (i=0; page_count < 0 || i < 8 + page_count; i++)
+    {
+      exo = exo_read(fd);
+      if (!exo)
+	fatal("could not skip EIO checkpoint");
+
+      if (i == 4)
+	{
+	  if (exo->ec != ec_list
+	      || !exo->as_list.head
+	      || exo->as_list.head->ec != ec_integer)
+	    fatal("could not read EIO memory config");
+	  page_count = (int)exo->as_list.head->as_integer.val;
+	}
+      exo_delete(exo);
+    }
 }
 
 /* fast forward EIO trace EIO_FD to the transaction just after ICNT */
@@ -890,7 +1215,7 @@ eio_fast_forward(gzFile eio_fd, counter_t icnt)
   do
     {
       /* read the next external I/O (EIO) transaction */
-      exo = exo_read(eio_fd);
+      exo = eio_read_exo(eio_fd);
 
       if (!exo)
 	fatal("could not fast forward to EIO checkpoint");
@@ -910,6 +1235,72 @@ eio_fast_forward(gzFile eio_fd, counter_t icnt)
   /* found it! */
 }
 
+/* position EIO trace EIO_FD just after the transaction at ICNT (or at
+   the first transaction if ICNT is -1), returns the stream to continue
+   reading from.  indexed (binary) traces are reopened at the gzip member
+   holding ICNT, so only the transactions within that member are parsed,
+   text traces fall back to eio_fast_forward() */
+gzFile
+eio_seek(gzFile eio_fd, counter_t icnt)
+{
+  int i, fd;
+  struct eio_index_ent_t *ent;
+
+  if (eio_fd != NULL && eio_fd == eio_pf_fd)
+    fatal("cannot seek an EIO stream while it is being prefetched");
+
+  if (eio_fd != eio_bin_fd)
+    {
+      if (icnt != -1)
+	eio_fast_forward(eio_fd, icnt);
+      return eio_fd;
+    }
+
+  /* find the last gzip member starting at or before ICNT */
+  ent = &eio_bin_index[0];
+  for (i=1; i < eio_bin_n_index && icnt != -1; i++)
+    {
+      if (eio_bin_index[i].icnt > icnt)
+	break;
+      ent = &eio_bin_index[i];
+    }
+
+  /* reopen the trace at the start of that member */
+  gzclose(eio_fd);
+  fd = open(eio_bin_fname, O_RDONLY);
+  if (fd < 0)
+    fatal("unable to reopen EIO file `%s'", eio_bin_fname);
+  if (lseek(fd, (off_t)ent->offset, SEEK_SET) != (off_t)ent->offset)
+    fatal("could not seek EIO file `%s' to offset %lld",
+	  eio_bin_fname, ent->offset);
+  eio_bin_fd = gzdopen(fd, "rb");
+  if (!eio_bin_fd)
+    fatal("unable to reopen EIO file `%s'", eio_bin_fname);
+
+  if (icnt != -1)
+    eio_fast_forward(eio_bin_fd, icnt);
+
+  return eio_bin_fd;
+}
+
+/* reopen EIO stream EIO_FD of file FNAME just after the last transaction
+   read from it, so that a forked process does not share the file offset
+   of its parent */
+gzFile
+eio_reopen(gzFile eio_fd, char *fname)
+{
+  gzFile fd;
+  counter_t icnt = eio_trans_icnt;
+
+  eio_close(eio_fd);
+
+  fd = eio_open(fname);
+  if (fd != eio_bin_fd)
+    eio_skip_chkpt(fd);
+
+  return eio_seek(fd, icnt);
+}
+
 /* write a register checksum into the trace */
 void
 eio_write_chksum(gzFile eio_fd,			/* EIO stream file desc */
@@ -918,6 +1309,8 @@ eio_write_chksum(gzFile eio_fd,			/* EIO stream file desc */
 {
   struct exo_term_t *exo;
 
+  eio_pf_check("write an EIO checksum");
+
   exo = exo_new(ec_list,
 	  /*icnt*/exo_new(ec_integer, (exo_integer_t)sim_num_insn),	
 	  /*CHKSUM*/exo_new(ec_integer, (exo_integer_t)chksum),
@@ -940,7 +1333,7 @@ eio_verify_chksum(gzFile eio_fd,			/* EIO stream file desc */
   struct exo_term_t *exo;
 
   /* else, read the external I/O (EIO) transaction */
-  exo = exo_read(eio_fd);
+  exo = eio_read_exo(eio_fd);
 
   if (!eio_is_chksum(exo)) 
 	 panic("expected register checksum at icnt: ", icnt);
@@ -958,7 +1351,7 @@ eio_verify_chksum(gzFile eio_fd,			/* EIO stream file desc */
   eio_trans_icnt = icnt;
 
   /* release input storage */
-  exo_delete(exo);
+  eio_release_exo(eio_fd, exo);
 }
 
 /* verify that it is a register checksum just by shape */
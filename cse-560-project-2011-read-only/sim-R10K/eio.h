@@ -69,6 +69,10 @@
 /* EIO file version */
 #define EIO_FILE_VERSION		3
 
+/* EIO file version with binary transactions (see eiobin.h), the header
+   and initial checkpoint stay in text form */
+#define EIO_BIN_FILE_VERSION		4
+
 gzFile eio_create(char *fname);
 
 gzFile eio_open(char *fname);
@@ -117,6 +121,26 @@ eio_read_trace(gzFile eio_fd,			/* EIO stream file desc */
 /* fast forward EIO trace EIO_FD to the transaction just after ICNT */
 void eio_fast_forward(gzFile eio_fd, counter_t icnt);
 
+/* position EIO trace EIO_FD just after the transaction at ICNT (or at
+   the first transaction if ICNT is -1), returns the stream to continue
+   reading from, indexed traces seek instead of replaying transactions */
+gzFile eio_seek(gzFile eio_fd, counter_t icnt);
+
+/* reopen EIO stream EIO_FD of file FNAME just after the last transaction
+   read from it, so that a forked process does not share the file offset
+   of its parent */
+gzFile eio_reopen(gzFile eio_fd, char *fname);
+
+/* start reading EIO stream FD ahead of the simulator, DEPTH transactions
+   deep, on a helper thread */
+void eio_prefetch_start(gzFile fd, int depth);
+
+/* stop the EIO prefetch thread, buffered transactions are discarded */
+void eio_prefetch_stop(void);
+
+/* print EIO prefetch statistics to STREAM */
+void eio_prefetch_stats(FILE *stream);
+
 /* write a register checksum into the trace */
 void 
 eio_write_chksum(gzFile eio_fd,			/* EIO stream file desc */
@@ -0,0 +1,176 @@
+/* eiobin.c - binary EXO encoding and index sidecar for EIO traces */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "host.h"
+#include "misc.h"
+#include "machine.h"
+#include "libexo.h"
+#include "eiobin.h"
+
+/* write N byte little endian value VAL to stream FD */
+static void
+eiobin_put(gzFile fd, quad_t val, int n)
+{
+  unsigned char buf[8];
+  int i;
+
+  for (i=0; i < n; i++, val >>= 8)
+    buf[i] = (unsigned char)(val & 0xff);
+
+  if (gzwrite(fd, buf, n) != n)
+    fatal("could not write binary EIO term");
+}
+
+/* read N byte little endian value from stream FD into *VAL, returns
+   FALSE at end-of-file */
+static int
+eiobin_get(gzFile fd, quad_t *val, int n)
+{
+  unsigned char buf[8];
+  int i, nread;
+
+  nread = gzread(fd, buf, n);
+  if (nread == 0)
+    return FALSE;
+  if (nread != n)
+    fatal("truncated binary EIO term");
+
+  for (*val=0, i=n-1; i >= 0; i--)
+    *val = (*val << 8) | buf[i];
+
+  return TRUE;
+}
+
+/* write EXO term EXO to stream FD in binary form */
+void
+eiobin_write(struct exo_term_t *exo, gzFile fd)
+{
+  struct exo_term_t *elt;
+  int n;
+
+  eiobin_put(fd, (quad_t)exo->ec, 1);
+  switch (exo->ec)
+    {
+    case ec_integer:
+      eiobin_put(fd, (quad_t)exo->as_integer.val, 8);
+      break;
+
+    case ec_address:
+      eiobin_put(fd, (quad_t)exo->as_address.val, 8);
+      break;
+
+    case ec_list:
+      for (n=0, elt=exo->as_list.head; elt != NULL; elt=elt->next)
+	n++;
+      eiobin_put(fd, (quad_t)n, 4);
+      for (elt=exo->as_list.head; elt != NULL; elt=elt->next)
+	eiobin_write(elt, fd);
+      break;
+
+    case ec_blob:
+      eiobin_put(fd, (quad_t)exo->as_blob.size, 4);
+      if (exo->as_blob.size > 0
+	  && gzwrite(fd, exo->as_blob.data, exo->as_blob.size)
+	     != exo->as_blob.size)
+	fatal("could not write binary EIO blob");
+      break;
+
+    default:
+      fatal("EXO class `%s' not supported in binary EIO files",
+	    exo_class_str[exo->ec]);
+    }
+}
+
+/* read one binary EXO term from stream FD, returns NULL at end-of-file */
+struct exo_term_t *
+eiobin_read(gzFile fd)
+{
+  struct exo_term_t *exo, *elt, *tail;
+  quad_t ec, val;
+  int i;
+
+  if (!eiobin_get(fd, &ec, 1))
+    return NULL;
+
+  switch ((enum exo_class_t)ec)
+    {
+    case ec_integer:
+    case ec_address:
+      if (!eiobin_get(fd, &val, 8))
+	fatal("truncated binary EIO term");
+      exo = exo_new((enum exo_class_t)ec, (exo_integer_t)val);
+      break;
+
+    case ec_list:
+      if (!eiobin_get(fd, &val, 4))
+	fatal("truncated binary EIO list");
+      exo = exo_new(ec_list, NULL);
+      for (tail=NULL, i=0; i < (int)val; i++)
+	{
+	  if (!(elt = eiobin_read(fd)))
+	    fatal("truncated binary EIO list");
+	  if (tail)
+	    tail->next = elt;
+	  else
+	    exo->as_list.head = elt;
+	  tail = elt;
+	}
+      break;
+
+    case ec_blob:
+      if (!eiobin_get(fd, &val, 4))
+	fatal("truncated binary EIO blob");
+      exo = exo_new(ec_blob, (int)val, NULL);
+      if ((int)val > 0
+	  && gzread(fd, exo->as_blob.data, (int)val) != (int)val)
+	fatal("truncated binary EIO blob");
+      break;
+
+    default:
+      fatal("bad binary EIO term class `%d'", (int)ec);
+    }
+
+  return exo;
+}
+
+/* load the index sidecar of EIO file FNAME, returns the number of
+   entries (0 if there is no index), the entry array is put in *ENTS */
+int
+eio_index_load(char *fname, struct eio_index_ent_t **ents)
+{
+  FILE *fd;
+  char *idx_fname;
+  struct eio_index_hdr_t hdr;
+
+  *ents = NULL;
+
+  idx_fname = (char *)mycalloc(strlen(fname) + strlen(EIO_INDEX_SUFFIX) + 1,
+			       sizeof(char));
+  strcpy(idx_fname, fname);
+  strcat(idx_fname, EIO_INDEX_SUFFIX);
+
+  fd = fopen(idx_fname, "rb");
+  free(idx_fname);
+  if (!fd)
+    return 0;
+
+  if (fread(&hdr, sizeof(hdr), 1, fd) != 1
+      || hdr.magic != EIO_INDEX_MAGIC
+      || hdr.version != EIO_INDEX_VERSION)
+    fatal("EIO index for `%s' is corrupt or out of date", fname);
+
+  if (hdr.n_ent > 0)
+    {
+      *ents = (struct eio_index_ent_t *)
+	mycalloc(hdr.n_ent, sizeof(struct eio_index_ent_t));
+      if (fread(*ents, sizeof(struct eio_index_ent_t), hdr.n_ent, fd)
+	  != hdr.n_ent)
+	fatal("EIO index for `%s' is truncated", fname);
+    }
+  fclose(fd);
+
+  return (int)hdr.n_ent;
+}
@@ -0,0 +1,50 @@
+#ifndef EIOBIN_H
+#define EIOBIN_H
+
+/* binary EXO term encoding used for the transactions of indexed EIO
+   files.  every term is a one byte class tag followed by its payload:
+
+     ec_integer, ec_address    8 byte value (little endian)
+     ec_list                   4 byte element count, then the elements
+     ec_blob                   4 byte size, then the raw bytes
+
+   no other EXO classes appear in EIO transactions */
+
+/* EIO index sidecar file (<eio file>.idx) */
+#define EIO_INDEX_SUFFIX		".idx"
+#define EIO_INDEX_MAGIC			0x58444945	/* "EIDX" */
+#define EIO_INDEX_VERSION		1
+
+/* default number of EIO transactions per seekable gzip member */
+#define EIO_INDEX_STRIDE		256
+
+/* index sidecar header */
+struct eio_index_hdr_t
+{
+  unsigned int magic;
+  unsigned int version;
+  unsigned int stride;
+  unsigned int n_ent;
+};
+
+/* index entry: first transaction of a gzip member and its byte offset */
+struct eio_index_ent_t
+{
+  counter_t icnt;
+  long long offset;
+};
+
+/* write EXO term EXO to stream FD in binary form */
+void
+eiobin_write(struct exo_term_t *exo, gzFile fd);
+
+/* read one binary EXO term from stream FD, returns NULL at end-of-file */
+struct exo_term_t *
+eiobin_read(gzFile fd);
+
+/* load the index sidecar of EIO file FNAME, returns the number of
+   entries (0 if there is no index), the entry array is put in *ENTS */
+int
+eio_index_load(char *fname, struct eio_index_ent_t **ents);
+
+#endif /* EIOBIN_H */
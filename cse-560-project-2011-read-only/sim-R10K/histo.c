@@ -0,0 +1,155 @@
+/* histo.c - log2 occupancy and latency histograms */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "host.h"
+#include "misc.h"
+#include "machine.h"
+#include "options.h"
+#include "stats.h"
+#include "histo.h"
+
+int histo_active = FALSE;
+
+static struct histo_t *histo_list = NULL, *histo_tail = NULL;
+
+void
+histo_reg_options(struct opt_odb_t *odb)
+{
+  opt_reg_flag(odb, "-histo",
+	       "sample the occupancy and load latency histograms every cycle",
+	       &histo_active, /* default */FALSE, /* print */TRUE, /* format */NULL);
+}
+
+/* bucket of value VAL in a histogram with N buckets */
+static int
+histo_bucket(counter_t val, int n)
+{
+  int b = 0;
+
+  while (val > 0 && b < n - 1)
+    {
+      val >>= 1;
+      b++;
+    }
+  return b;
+}
+
+void
+histo_init(struct histo_t *h, char *name, char *desc, counter_t size)
+{
+  struct histo_t *p;
+  int i;
+
+  if (size < 0)
+    panic("negative histogram size");
+
+  h->name = name;
+  h->desc = desc;
+  h->size = size;
+  if (size)
+    h->n_buckets = MIN(histo_bucket(size, HISTO_MAX_BUCKETS) + 1,
+		       HISTO_MAX_BUCKETS);
+  else
+    h->n_buckets = HISTO_LAT_BUCKETS;
+  h->n = h->sum = h->max = h->full = 0;
+  for (i = 0; i < HISTO_MAX_BUCKETS; i++)
+    h->bucket[i] = 0;
+
+  /* re-initialized, e.g. by a -sweep child */
+  for (p = histo_list; p; p = p->next)
+    if (p == h)
+      return;
+
+  h->next = NULL;
+  if (histo_tail)
+    histo_tail->next = h;
+  else
+    histo_list = h;
+  histo_tail = h;
+}
+
+void
+histo_sample(struct histo_t *h, counter_t val)
+{
+  h->n++;
+  h->sum += val;
+  if (val > h->max)
+    h->max = val;
+  if (h->size && val >= h->size)
+    h->full++;
+  h->bucket[histo_bucket(val, h->n_buckets)]++;
+}
+
+/* the P-th fraction percentile of H, interpolated within its bucket */
+static double
+histo_percentile(struct histo_t *h, double p)
+{
+  counter_t target, cum = 0;
+  double lo, hi;
+  int b;
+
+  if (h->n == 0)
+    return 0.0;
+
+  target = (counter_t)(p * h->n);
+  if (target >= h->n)
+    target = h->n - 1;
+
+  for (b = 0; b < h->n_buckets; b++)
+    {
+      if (cum + h->bucket[b] > target)
+	break;
+      cum += h->bucket[b];
+    }
+  if (b == 0)
+    return 0.0;
+
+  lo = (double)((counter_t)1 << (b - 1));
+  hi = b == h->n_buckets - 1 ? (double)h->max : (double)(((counter_t)1 << b) - 1);
+  hi = MIN(hi, (double)h->max);
+  return lo + (hi - lo) * (double)(target - cum) / (double)h->bucket[b];
+}
+
+void
+histo_stats(FILE *stream)
+{
+  struct histo_t *h;
+  char name[128], desc[256];
+
+  for (h = histo_list; h; h = h->next)
+    {
+      sprintf(name, "%s_mean", h->name);
+      sprintf(desc, "%s, mean", h->desc);
+      print_rate(stream, name, h->n ? (double)h->sum / h->n : 0.0, desc);
+
+      sprintf(name, "%s_p50", h->name);
+      sprintf(desc, "%s, median (log2 bucket interpolated)", h->desc);
+      print_rate(stream, name, histo_percentile(h, 0.50), desc);
+
+      sprintf(name, "%s_p90", h->name);
+      sprintf(desc, "%s, 90th percentile", h->desc);
+      print_rate(stream, name, histo_percentile(h, 0.90), desc);
+
+      sprintf(name, "%s_p99", h->name);
+      sprintf(desc, "%s, 99th percentile", h->desc);
+      print_rate(stream, name, histo_percentile(h, 0.99), desc);
+
+      sprintf(name, "%s_max", h->name);
+      sprintf(desc, "%s, maximum", h->desc);
+      print_counter(stream, name, h->max, desc);
+
+      if (h->size)
+	{
+	  sprintf(name, "%s_full", h->name);
+	  sprintf(desc, "%s, fraction of cycles at capacity (%lld)",
+		  h->desc, (long long)h->size);
+	  print_rate(stream, name, h->n ? (double)h->full / h->n : 0.0, desc);
+	}
+
+      sprintf(name, "%s_dist", h->name);
+      sprintf(desc, "%s, log2 buckets 0, 1, 2-3, 4-7, ...", h->desc);
+      print_dist(stream, name, h->bucket, h->n_buckets, desc);
+    }
+}
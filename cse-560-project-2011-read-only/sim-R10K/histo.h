@@ -0,0 +1,51 @@
+#ifndef HISTO_H
+#define HISTO_H
+
+/* log2 histograms for queue occupancy and latency stats.  bucket 0
+   counts samples of 0, bucket B > 0 samples in [2^(B-1), 2^B - 1]; the
+   last bucket also takes anything larger.  occupancies are sampled once
+   per cycle, so by Little's law the mean is the average number of
+   entries in use, and the full fraction is the share of cycles the
+   structure was at capacity */
+
+#define HISTO_MAX_BUCKETS	24
+
+/* buckets of a histogram without a capacity, values up to 2^15 - 1 */
+#define HISTO_LAT_BUCKETS	16
+
+struct opt_odb_t;
+
+/* -histo: the simulators sample their histograms only when set */
+extern int histo_active;
+
+/* register the histogram options */
+void histo_reg_options(struct opt_odb_t *odb);
+
+struct histo_t
+{
+  char *name;
+  char *desc;
+  counter_t size;		/* capacity, 0 for none */
+  int n_buckets;
+
+  counter_t n;			/* samples */
+  counter_t sum;
+  counter_t max;
+  counter_t full;		/* samples at capacity */
+  counter_t bucket[HISTO_MAX_BUCKETS];
+
+  struct histo_t *next;		/* all histograms, in stats order */
+};
+
+/* (re)initialize histogram H for a structure with SIZE entries (0 for a
+   latency), it prints as NAME_* */
+void histo_init(struct histo_t *h, char *name, char *desc, counter_t size);
+
+/* record sample VAL */
+void histo_sample(struct histo_t *h, counter_t val);
+
+/* print the mean, percentiles, maximum, full fraction and distribution
+   of every initialized histogram */
+void histo_stats(FILE *stream);
+
+#endif /* HISTO_H */
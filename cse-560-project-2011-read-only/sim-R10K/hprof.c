@@ -0,0 +1,149 @@
+/* hprof.c - host-side profile of the timing simulator */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+
+#include "host.h"
+#include "misc.h"
+#include "machine.h"
+#include "options.h"
+#include "stats.h"
+#include "sim.h"
+#include "hprof.h"
+
+/* -prof:host */
+static int hprof_opt = FALSE;
+
+int hprof_active = FALSE;
+struct hprof_ctr_t hprof_ctr[hp_NUM];
+
+static char *hprof_name[hp_NUM] = {
+  "commit", "writeback", "schedule", "rename", "fetch",
+  "sched_enqueue", "exec", "cache", "bpred", "syscall"
+};
+
+static char *hprof_work[hp_NUM] = {
+  NULL, NULL, NULL, NULL, NULL,
+  "ready list nodes walked", NULL, NULL, NULL, NULL
+};
+
+/* totals over the profiled stretches of timing simulation */
+static counter_t hprof_ticks = 0;
+static counter_t hprof_usec = 0;
+static counter_t hprof_insn = 0;
+
+/* start of the current stretch */
+static counter_t start_ticks;
+static struct timeval start_tv;
+static counter_t start_insn;
+
+void
+hprof_reg_options(struct opt_odb_t *odb)
+{
+  opt_reg_flag(odb, "-prof:host",
+	       "profile host cycles spent per pipeline stage",
+	       &hprof_opt, /* default */FALSE, /* print */TRUE, /* format */NULL);
+}
+
+#if !(defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__)))
+counter_t
+hprof_clock(void)
+{
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+  return (counter_t)tv.tv_sec * 1000000000 + (counter_t)tv.tv_usec * 1000;
+}
+#endif
+
+void
+hprof_resume(void)
+{
+  struct sim_sample_t totals;
+
+  if (!hprof_opt || hprof_active)
+    return;
+
+  sim_sample_totals(&totals);
+  start_insn = totals.n_insn;
+  gettimeofday(&start_tv, NULL);
+  HPROF_NOW(start_ticks);
+
+  hprof_active = TRUE;
+}
+
+void
+hprof_pause(void)
+{
+  struct sim_sample_t totals;
+  struct timeval tv;
+  counter_t now;
+
+  if (!hprof_active)
+    return;
+
+  HPROF_NOW(now);
+  gettimeofday(&tv, NULL);
+  sim_sample_totals(&totals);
+
+  hprof_ticks += now - start_ticks;
+  hprof_usec += (counter_t)(tv.tv_sec - start_tv.tv_sec) * 1000000
+    + (tv.tv_usec - start_tv.tv_usec);
+  hprof_insn += totals.n_insn - start_insn;
+
+  hprof_active = FALSE;
+}
+
+void
+hprof_stats(FILE *stream)
+{
+  struct hprof_ctr_t *ctr;
+  char name[64], desc[128];
+  bool_t f_active = hprof_active;
+  int i;
+
+  if (!hprof_opt)
+    return;
+
+  /* account for the stretch in progress */
+  if (f_active)
+    {
+      hprof_pause();
+      hprof_resume();
+    }
+
+  print_counter(stream, "prof_host_insn", hprof_insn, "instructions committed while profiled");
+  print_rate(stream, "prof_host_sec", hprof_usec / 1.0e6, "host seconds in timing simulation");
+  print_rate(stream, "prof_host_KIPS", hprof_usec ? (double)hprof_insn / hprof_usec * 1.0e3 : 0.0, "simulation speed (thousands of insts/sec)");
+  print_counter(stream, "prof_host_ticks", hprof_ticks, "host cycles in timing simulation");
+  print_rate(stream, "prof_host_ticks_per_insn", hprof_insn ? (double)hprof_ticks / hprof_insn : 0.0, "host cycles per committed instruction");
+
+  for (i = 0; i < hp_NUM; i++)
+    {
+      ctr = &hprof_ctr[i];
+
+      sprintf(name, "prof_%s_ticks", hprof_name[i]);
+      sprintf(desc, "host cycles in %s", hprof_name[i]);
+      print_counter(stream, name, ctr->ticks, desc);
+
+      sprintf(name, "prof_%s_pct", hprof_name[i]);
+      sprintf(desc, "%% of timing simulation host cycles in %s", hprof_name[i]);
+      print_rate(stream, name, hprof_ticks ? 100.0 * ctr->ticks / hprof_ticks : 0.0, desc);
+
+      sprintf(name, "prof_%s_calls", hprof_name[i]);
+      sprintf(desc, "calls of %s", hprof_name[i]);
+      print_counter(stream, name, ctr->calls, desc);
+
+      sprintf(name, "prof_%s_ticks_per_call", hprof_name[i]);
+      sprintf(desc, "host cycles per %s call", hprof_name[i]);
+      print_rate(stream, name, ctr->calls ? (double)ctr->ticks / ctr->calls : 0.0, desc);
+
+      if (hprof_work[i])
+	{
+	  sprintf(name, "prof_%s_work_per_call", hprof_name[i]);
+	  sprintf(desc, "%s per %s call", hprof_work[i], hprof_name[i]);
+	  print_rate(stream, name, ctr->calls ? (double)ctr->work / ctr->calls : 0.0, desc);
+	}
+    }
+}
@@ -0,0 +1,85 @@
+#ifndef HPROF_H
+#define HPROF_H
+
+/* host-side profile of the timing simulator itself (-prof:host): host
+   cycles (rdtsc) spent per pipeline stage and helper, call counts and
+   work per call, and the resulting simulation speed in KIPS.  times are
+   inclusive, e.g. cache accesses made by the scheduler count both in
+   `schedule' and in `cache' */
+
+/* profiled items */
+enum hprof_item_t {
+  hp_COMMIT,		/* commit_stage() */
+  hp_WRITEBACK,		/* writeback_stage() */
+  hp_SCHEDULE,		/* schedule_stage() */
+  hp_RENAME,		/* rename_stage() */
+  hp_FETCH,		/* fetch_stage() */
+  hp_SCHED_ENQUEUE,	/* scheduler_enqueue(), work: nodes walked */
+  hp_EXEC,		/* exec_insn() */
+  hp_CACHE,		/* cache_access(), outermost calls */
+  hp_BPRED,		/* bpred_lookup() */
+  hp_SYSCALL,		/* sys_syscall() */
+  hp_NUM
+};
+
+struct hprof_ctr_t
+{
+  counter_t ticks;			/* host cycles */
+  counter_t calls;
+  counter_t work;			/* item specific work units */
+};
+
+/* profiling the current stretch of timing simulation? */
+extern int hprof_active;
+
+extern struct hprof_ctr_t hprof_ctr[hp_NUM];
+
+struct opt_odb_t;
+
+/* register the profiler options */
+void hprof_reg_options(struct opt_odb_t *odb);
+
+/* bracket each stretch of timing simulation */
+void hprof_resume(void);
+void hprof_pause(void);
+
+/* print the profile */
+void hprof_stats(FILE *stream);
+
+/* read the host cycle counter into T */
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+#define HPROF_NOW(T)							\
+  do {									\
+    unsigned int __lo, __hi;						\
+    __asm__ __volatile__ ("rdtsc" : "=a" (__lo), "=d" (__hi));		\
+    (T) = ((counter_t)__hi << 32) | __lo;				\
+  } while (0)
+#else /* no rdtsc, nanoseconds */
+counter_t hprof_clock(void);
+#define HPROF_NOW(T)		((T) = hprof_clock())
+#endif
+
+/* execute statement STMT, charging its host cycles to ITEM */
+#define HPROF_CALL(ITEM, STMT)						\
+  do {									\
+    if (hprof_active)							\
+      {									\
+	counter_t __t0, __t1;						\
+	HPROF_NOW(__t0);						\
+	STMT;								\
+	HPROF_NOW(__t1);						\
+	hprof_ctr[(ITEM)].ticks += __t1 - __t0;				\
+	hprof_ctr[(ITEM)].calls++;					\
+      }									\
+    else								\
+      STMT;								\
+  } while (0)
+
+/* charge N units of work to ITEM */
+#define HPROF_WORK(ITEM, N)						\
+  do {									\
+    if (hprof_active)							\
+      hprof_ctr[(ITEM)].work += (N);					\
+  } while (0)
+
+#endif /* HPROF_H */
@@ -168,6 +168,7 @@ ld_load_prog(char *fname,		/* program to load */
   int i;
   quad_t temp;
   md_addr_t sp, data_break = 0, null_ptr = 0, argv_addr, envp_addr;
+  counter_t restore_icnt;
 
   if (eio_valid(fname))
     {
@@ -189,10 +190,9 @@ ld_load_prog(char *fname,		/* program to load */
 	fatal("bad initial checkpoint in EIO file");
 
       /* load checkpoint? */
+      restore_icnt = -1;
       if (sim_chkpt_fname != NULL)
 	{
-	  counter_t restore_icnt;
-
 	  FILE *chkpt_fd;
 
 	  fprintf(stderr, "sim: loading checkpoint file: %s\n",
@@ -211,9 +211,16 @@ ld_load_prog(char *fname,		/* program to load */
 	  /* fast forward the baseline EIO trace to checkpoint location */
 	  fprintf(stderr, "sim: fast forwarding to instruction %d\n",
 		  (int)restore_icnt);
-	  eio_fast_forward(sim_eio_fd, restore_icnt);
 	}
 
+      /* position the EIO trace, indexed traces seek directly to the
+	 checkpoint location */
+      sim_eio_fd = eio_seek(sim_eio_fd, restore_icnt);
+
+      /* read the trace ahead of the simulator? */
+      if (sim_eio_prefetch > 0)
+	eio_prefetch_start(sim_eio_fd, sim_eio_prefetch);
+
       /* computed state... */
       ld_environ_base = regs->regs[MD_REG_SP].q;
       ld_prog_entry = regs->PC;
@@ -91,6 +91,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <math.h>
 #include <time.h>
 #include <setjmp.h>
 #include <signal.h>
@@ -98,6 +99,7 @@
 #ifndef _MSC_VER
 #include <unistd.h>
 #include <sys/time.h>
+#include <sys/wait.h>
 #endif
 #ifdef BFD_LOADER
 #include <bfd.h>
@@ -112,7 +114,11 @@
 #include "stats.h"
 #include "memory.h"
 #include "loader.h"
+#include "eio.h"
 #include "sim.h"
+#include "predec.h"
+#include "simpoint.h"
+#include "hprof.h"
 
 /* stats signal handler */
 static void
@@ -162,6 +168,14 @@ char *sim_eio_fname = NULL;
 char *sim_chkpt_fname = NULL;
 FILE *sim_eio_fd = NULL;
 
+/* EIO transactions to read ahead on a helper thread, 0 reads inline */
+int sim_eio_prefetch = 0;
+
+/* configuration sweep: one timing run per line of the sweep file, forked
+   from the state reached after the first fast-forward and warmup */
+static char *sim_sweep_fname;
+static int sim_sweep_jobs;
+
 /* track first argument orphan, this is the program to execute */
 static int exec_index = -1;
 
@@ -187,6 +201,21 @@ unsigned long long insn_sample_first[sample_NUM];
 
 enum sample_mode_t sample_mode;
 
+/* sampling controller: stop once the IPC confidence interval is within
+   INSN_SAMPLE_ERROR percent of the mean */
+static float insn_sample_error;
+static float insn_sample_z;
+static int insn_sample_min;
+static char *insn_sample_dumpfile;
+static FILE *fsample;
+
+/* per-sample IPC (running mean and sum of squared deviations) and
+   L1 D-cache miss rate */
+static counter_t sample_n;
+static double sample_ipc_mean;
+static double sample_ipc_m2;
+static double sample_miss_mean;
+
 static void
 insn_reg_options(struct opt_odb_t * odb)
 {
@@ -202,6 +231,18 @@ insn_reg_options(struct opt_odb_t * odb)
   opt_reg_string(odb, "-insn:sample:first",
                  "first sample parameters i.e. {no|<off>:<warm>:<on>}",
 		 &insn_sample_first_str, "no", /* print */TRUE, /* format */NULL);
+  opt_reg_float(odb, "-insn:sample:error",
+		"stop sampling when the IPC confidence interval is within +/- <pct>% of the mean (0 = never)",
+		&insn_sample_error, /* default */0.0, /* print */TRUE, /* format */NULL);
+  opt_reg_float(odb, "-insn:sample:z",
+		"IPC confidence interval in standard deviations (3.0 = 99.7%)",
+		&insn_sample_z, /* default */3.0, /* print */TRUE, /* format */NULL);
+  opt_reg_int(odb, "-insn:sample:min",
+	      "minimum number of samples before sampling may stop",
+	      &insn_sample_min, /* default */30, /* print */TRUE, /* format */NULL);
+  opt_reg_string(odb, "-insn:sample:dump",
+                 "per-sample IPC and miss rate file {<filename>|none}",
+                 &insn_sample_dumpfile, "none", /* print */TRUE, NULL);
   opt_reg_string(odb, "-insn:dumpfile",
                  "rundump file {<filename>|none}",
                  &insn_dumpfile, "none", /* print */TRUE, NULL);
@@ -239,6 +280,101 @@ insn_check_options(void)
 		 &insn_sample_first[sample_OFF], &insn_sample_first[sample_WARM], &insn_sample_first[sample_ON]) != 3)
 	fatal("unrecognized sampling format '%s'", insn_sample_first);
     }
+
+  if (insn_sample_error < 0.0)
+    fatal("sampling error bound must be non-negative");
+  if (insn_sample_error > 0.0 && !insn_sample[sample_ON])
+    fatal("-insn:sample:error needs an -insn:sample on period");
+  if (insn_sample_z <= 0.0)
+    fatal("confidence interval width must be positive");
+
+  if (!mystricmp(insn_sample_dumpfile, "none"))
+    fsample = NULL;
+  else if (!(fsample = fopen(insn_sample_dumpfile, "w")))
+    fatal("could not open sample file `%s'", insn_sample_dumpfile);
+}
+
+/* record one measured sample, between running totals BEFORE and AFTER */
+static void
+sample_record(struct sim_sample_t *before, struct sim_sample_t *after)
+{
+  counter_t n_insn = after->n_insn - before->n_insn;
+  counter_t n_cycle = after->n_cycle - before->n_cycle;
+  counter_t n_access = after->n_dl1_access - before->n_dl1_access;
+  counter_t n_miss = after->n_dl1_miss - before->n_dl1_miss;
+  double ipc, miss_rate, delta;
+
+  /* nothing to measure without timing */
+  if (n_cycle <= 0)
+    return;
+
+  ipc = (double)n_insn / n_cycle;
+  miss_rate = n_access ? (double)n_miss / n_access : 0.0;
+
+  sample_n++;
+  delta = ipc - sample_ipc_mean;
+  sample_ipc_mean += delta / sample_n;
+  sample_ipc_m2 += delta * (ipc - sample_ipc_mean);
+  sample_miss_mean += (miss_rate - sample_miss_mean) / sample_n;
+
+  if (fsample)
+    fprintf(fsample, "%lld %lld %.4f %.4f\n",
+	    (long long)sample_n, (long long)sim_num_insn, ipc, miss_rate);
+}
+
+/* IPC sample variance */
+static double
+sample_ipc_var(void)
+{
+  return sample_n > 1 ? sample_ipc_m2 / (sample_n - 1) : 0.0;
+}
+
+/* half-width of the IPC confidence interval relative to the mean */
+static double
+sample_error(void)
+{
+  if (sample_n < 2 || sample_ipc_mean <= 0.0)
+    return 1.0;
+
+  return insn_sample_z * sqrt(sample_ipc_var() / sample_n) / sample_ipc_mean;
+}
+
+/* has the IPC estimate met the requested error bound? */
+static bool_t
+sample_converged(void)
+{
+  return (insn_sample_error > 0.0
+	  && sample_n >= insn_sample_min
+	  && sample_error() <= insn_sample_error / 100.0);
+}
+
+/* print sampling controller stats */
+static void
+sample_stats(FILE *stream)
+{
+  double cv;
+  counter_t n_required;
+
+  if (sample_n == 0)
+    return;
+
+  cv = sample_ipc_mean > 0.0 ? sqrt(sample_ipc_var()) / sample_ipc_mean : 0.0;
+
+  print_counter(stream, "sample_num", sample_n, "measured samples");
+  print_rate(stream, "sample_IPC_mean", sample_ipc_mean, "mean of per-sample IPC");
+  print_rate(stream, "sample_IPC_cv", cv, "coefficient of variation of per-sample IPC");
+  print_rate(stream, "sample_IPC_ci", insn_sample_z * sqrt(sample_ipc_var() / sample_n), "IPC confidence interval half-width");
+  print_rate(stream, "sample_IPC_error", sample_error(), "IPC confidence interval half-width relative to the mean");
+  print_rate(stream, "sample_dl1_miss_rate_mean", sample_miss_mean, "mean of per-sample L1 D-cache miss rate");
+
+  if (insn_sample_error > 0.0)
+    {
+      /* n = (z * cv / error)^2 samples meet the bound */
+      n_required = (counter_t)ceil(pow(insn_sample_z * cv * 100.0 / insn_sample_error, 2.0));
+      n_required = MAX(n_required, insn_sample_min);
+      print_counter(stream, "sample_num_required", n_required, "samples needed for the requested error bound");
+      print_counter(stream, "sample_period_suggested", sim_num_insn / n_required, "suggested sampling period (insts) for a run of this length");
+    }
 }
 
 static int
@@ -270,13 +406,11 @@ usage(FILE *fd, int argc, char **argv)
 
 static int running = FALSE;
 
-/* print all simulator stats */
-void
-sim_print_stats(FILE *fd)		/* output stream */
+/* print all simulator stats, F_PROGRESS for -insn:progress dumps */
+static void
+sim_stats_dump(FILE *fd,		/* output stream */
+	       bool_t f_progress)	/* progress dump? */
 {
-  char *s;
-  time_t sim_current_time;
-
 #if 0 /* not portable... :-( */
   extern char etext, *sbrk(int);
 #endif
@@ -284,7 +418,8 @@ sim_print_stats(FILE *fd)		/* output stream */
   if (!running)
     return;
 
-  if (fdump)
+  /* progress dumps keep tracing */
+  if (fdump && !f_progress)
     fclose(fdump);
 
   /* get stats time */
@@ -297,15 +432,31 @@ sim_print_stats(FILE *fd)		/* output stream */
 #endif
 
   /* print simulation stats */
-  sim_current_time = time((time_t *)NULL);
-  s = ctime(&sim_current_time);
-  if (s[strlen(s)-1] == '\n')
-    s[strlen(s)-1] = '\0';
-
-  fprintf(fd, "\nsim: ** simulation statistics @ %s **\n", s);
+  stats_dump_begin(fd, f_progress ? "progress statistics" : "simulation statistics",
+		   f_progress);
 
   sim_aux_stats(fd);
-  fprintf(fd, "\n");
+  sample_stats(fd);
+  simpoint_stats(fd);
+  hprof_stats(fd);
+  if (sim_eio_prefetch > 0)
+    eio_prefetch_stats(fd);
+
+  stats_dump_end(fd);
+}
+
+/* print all simulator stats */
+void
+sim_print_stats(FILE *fd)		/* output stream */
+{
+  sim_stats_dump(fd, FALSE);
+}
+
+/* print the -insn:progress stats */
+void
+sim_print_progress(FILE *fd)		/* output stream */
+{
+  sim_stats_dump(fd, TRUE);
 }
 
 /* print stats, uninitialize simulator components, and exit w/ exitcode */
@@ -323,17 +474,145 @@ exit_now(int exit_code)
 }
 
 
+#ifndef _MSC_VER
+#define MAX_SWEEP_ARGS		256
+
+/* set up sweep child N for configuration LINE: redirect its output to
+   <sweep file>.<N>, apply the options on LINE and give it a private EIO
+   stream */
+static void
+sweep_child(int n, char *line)
+{
+  char *fname, *p, *largv[MAX_SWEEP_ARGS];
+  int largc;
+
+  fname = (char *)mycalloc(strlen(sim_sweep_fname) + 16, sizeof(char));
+  sprintf(fname, "%s.%d", sim_sweep_fname, n);
+  if (!freopen(fname, "w", stderr))
+    exit(1);
+
+  fprintf(stderr, "sim: sweep configuration %d: %s\n", n, line);
+
+  /* option values may point into the line, so it must stay around */
+  largv[0] = sim_sweep_fname;
+  largc = 1;
+  for (p = strtok(mystrdup(line), " \t"); p != NULL; p = strtok(NULL, " \t"))
+    {
+      if (largc == MAX_SWEEP_ARGS)
+	fatal("sweep configuration %d is too complex", n);
+      largv[largc++] = p;
+    }
+  opt_process_options(sim_odb, largc, largv);
+
+  /* re-check the timing options, warm state is kept */
+  sim_sweep_options(largc, largv);
+
+  if (sim_eio_fd != NULL)
+    sim_eio_fd = eio_reopen(sim_eio_fd, sim_eio_fname);
+
+  fprintf(stderr, "\nsim: sweep configuration %d options follow:\n", n);
+  opt_print_options(sim_odb, stderr, /* short */TRUE, /* notes */TRUE);
+  fprintf(stderr, "\n");
+
+  /* rate stats only cover this configuration */
+  sim_start_time = time((time_t *)NULL);
+}
+
+/* fork one child per configuration in the sweep file, at most
+   SIM_SWEEP_JOBS at a time.  returns only in the children, the parent
+   waits for all of them and exits */
+static void
+sweep_fork(void)
+{
+  FILE *fd;
+  char line[1024], *p;
+  int n_config = 0, n_running = 0, n_failed = 0, status;
+  pid_t pid;
+
+  fd = fopen(sim_sweep_fname, "r");
+  if (!fd)
+    fatal("could not open sweep file `%s'", sim_sweep_fname);
+
+  /* don't let the children flush the parent's buffered output */
+  fflush(stdout);
+  fflush(stderr);
+
+  while (fgets(line, sizeof(line), fd))
+    {
+      if (line[0] != '\0' && line[strlen(line)-1] == '\n')
+	line[strlen(line)-1] = '\0';
+
+      /* ignore empty lines and comments */
+      for (p = line; *p == ' ' || *p == '\t'; p++)
+	/* nada */;
+      if (*p == '\0' || *p == '#')
+	continue;
+
+      if (n_running == sim_sweep_jobs)
+	{
+	  if (wait(&status) > 0 && (!WIFEXITED(status) || WEXITSTATUS(status) != 0))
+	    n_failed++;
+	  n_running--;
+	}
+
+      pid = fork();
+      if (pid < 0)
+	fatal("could not fork sweep configuration %d", n_config);
+      if (pid == 0)
+	{
+	  fclose(fd);
+	  sweep_child(n_config, p);
+	  return;
+	}
+
+      fprintf(stderr, "sim: sweep configuration %d (pid %d): %s\n",
+	      n_config, (int)pid, p);
+      n_config++;
+      n_running++;
+    }
+  fclose(fd);
+
+  while (n_running > 0)
+    {
+      if (wait(&status) > 0 && (!WIFEXITED(status) || WEXITSTATUS(status) != 0))
+	n_failed++;
+      n_running--;
+    }
+
+  fprintf(stderr, "sim: sweep done, %d configurations, %d failed\n",
+	  n_config, n_failed);
+  exit(n_failed ? 1 : 0);
+}
+#endif /* !_MSC_VER */
+
 void
 sim_main(void)
 {
   sim_start();
 
+  /* simulation points replace the sampling schedule */
+  if (simpoint_driven)
+    {
+      simpoint_run();
+      return;
+    }
+
   if (insn_sample_first[sample_OFF] && !sim_sample_off(insn_sample_first[sample_OFF]))
     return;
 
   if (insn_sample_first[sample_WARM] && !sim_sample_warmup(insn_sample_first[sample_WARM]))
     return;
 
+  /* fork the sweep configurations from the warm state */
+  if (mystricmp(sim_sweep_fname, "none"))
+    {
+#ifndef _MSC_VER
+      sweep_fork();
+#else /* _MSC_VER */
+      fatal("-sweep is not supported on this host");
+#endif /* !_MSC_VER */
+    }
+
   if (insn_sample_first[sample_ON] && !sim_sample_on(insn_sample_first[sample_ON]))
     return;
 
@@ -347,8 +626,26 @@ sim_main(void)
           if (insn_sample[sample_WARM] && !sim_sample_warmup(insn_sample[sample_WARM]))
             return;
 
-          if (insn_sample[sample_ON] && !sim_sample_on(insn_sample[sample_ON]))
-            return;
+          if (insn_sample[sample_ON])
+            {
+              struct sim_sample_t before, after;
+              bool_t f_more;
+
+              sim_sample_totals(&before);
+              f_more = sim_sample_on(insn_sample[sample_ON]);
+              sim_sample_totals(&after);
+              sample_record(&before, &after);
+
+              if (!f_more)
+                return;
+
+              if (sample_converged())
+                {
+                  fprintf(stderr, "sim: sampling converged after %lld samples, IPC %.4f +/- %.2f%%\n",
+                          (long long)sample_n, sample_ipc_mean, 100.0 * sample_error());
+                  return;
+                }
+            }
         }
     }
 
@@ -391,9 +688,21 @@ main(int argc, char **argv, char **envp)
 	      &rand_seed, /* default */1, /* print */TRUE, NULL);
   opt_reg_string(sim_odb, "-chkpt", "restore EIO trace execution from <fname>",
 		 &sim_chkpt_fname, /* default */NULL, /* !print */FALSE, NULL);
+  opt_reg_int(sim_odb, "-eio:prefetch",
+	      "EIO transactions to read ahead on a helper thread (0 = off)",
+	      &sim_eio_prefetch, /* default */0, /* print */TRUE, NULL);
+  opt_reg_string(sim_odb, "-sweep",
+		 "fork one timing run per line of <fname> after the first fast-forward and warmup {<fname>|none}",
+		 &sim_sweep_fname, /* default */"none", /* print */TRUE, NULL);
+  opt_reg_int(sim_odb, "-sweep:jobs",
+	      "sweep configurations to run in parallel",
+	      &sim_sweep_jobs, /* default */1, /* print */TRUE, NULL);
 
   /* register instruction execution options */
   insn_reg_options(sim_odb);
+  stats_reg_options(sim_odb);
+  simpoint_reg_options(sim_odb);
+  hprof_reg_options(sim_odb);
 
   /* register all simulator-specific options */
   sim_reg_options(sim_odb);
@@ -440,10 +749,22 @@ main(int argc, char **argv, char **envp)
 
   /* need options */
   insn_check_options();
+  stats_check_options();
+  simpoint_check_options();
 
   /* check simulator-specific options */
   sim_check_options();
 
+  if (mystricmp(sim_sweep_fname, "none"))
+    {
+      if (sim_sweep_jobs < 1)
+	fatal("need at least 1 sweep job");
+      if (sim_eio_prefetch > 0)
+	fatal("-sweep cannot be combined with -eio:prefetch");
+      if (simpoint_driven)
+	fatal("-sweep cannot be combined with -simpoint:regions");
+    }
+
   /* default architected value... */
   sim_num_insn = 0;
 
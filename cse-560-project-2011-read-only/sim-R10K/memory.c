@@ -276,7 +276,7 @@ void
 mem_print_stats(struct mem_t *mem,	/* memory space to declare */
 		FILE *stream)	/* stats data base */
 {
-  char buf[512];
+  char buf[512], num[512], den[512];
 
   sprintf(buf, "%s.page_count", mem->name);
   print_counter(stream, buf, mem->page_count, "memory pages allocated");
@@ -287,7 +287,9 @@ mem_print_stats(struct mem_t *mem,	/* memory space to declare */
   sprintf(buf, "%s.ptab_accesses", mem->name);
   print_counter(stream, buf, mem->ptab_accesses, "page table accesses");
   sprintf(buf, "%s.ptab_miss_rate", mem->name);
-  print_rate(stream, buf, (double)mem->ptab_misses/mem->ptab_accesses, "first level page table miss rate");
+  sprintf(num, "%s.ptab_misses", mem->name);
+  sprintf(den, "%s.ptab_accesses", mem->name);
+  print_formula(stream, buf, 1.0, num, den, "miss/access", "first level page table miss rate");
 
   print_counter(stream, "sim_num_unaligned_accs", sim_num_unaligned_accs, "unaligned accesses");
 }
@@ -0,0 +1,117 @@
+/* pcstat-csv.c - export a -pcstat:dump profile as CSV
+ *
+ * usage: pcstat-csv <file>
+ *
+ * Prints one line per static instruction with any profile event: its PC,
+ * instruction word and every counter, followed by the mis-prediction,
+ * D-cache miss and L2 miss rates per execution.  The file format is
+ * described in predec.h.
+ *
+ * build: cc -o pcstat-csv pcstat-csv.c misc.c -lz
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "host.h"
+#include "misc.h"
+#include "machine.h"
+#include "options.h"
+#include "predec.h"
+
+static FILE *fd;
+static char *fname;
+
+static char *pcstat_name[pc_NUM] = {
+  "exec", "misp", "dl1_miss", "l2_miss", "squash", "revert"
+};
+
+/* read an N byte little endian value, FALSE at end-of-file */
+static int
+get(unsigned long long *val, int n)
+{
+  unsigned char buf[8];
+  int i, nread;
+
+  nread = fread(buf, 1, n, fd);
+  if (nread == 0)
+    return FALSE;
+  if (nread != n)
+    fatal("`%s' is truncated", fname);
+
+  for (*val = 0, i = n - 1; i >= 0; i--)
+    *val = (*val << 8) | buf[i];
+  return TRUE;
+}
+
+static unsigned long long
+must_get(int n)
+{
+  unsigned long long val;
+
+  if (!get(&val, n))
+    fatal("`%s' is truncated", fname);
+  return val;
+}
+
+/* RATE per execution, empty without executions */
+static void
+print_per_exec(unsigned long long count, unsigned long long n_exec)
+{
+  if (n_exec == 0)
+    printf(",");
+  else
+    printf(",%.6g", (double)count / (double)n_exec);
+}
+
+int
+main(int argc, char **argv)
+{
+  unsigned long long val, pc, inst, ctr[pc_NUM];
+  int k, n_ctr, n_insn = 0;
+
+  if (argc != 2)
+    {
+      fprintf(stderr, "usage: %s <file>\n", argv[0]);
+      exit(1);
+    }
+  fname = argv[1];
+
+  fd = fopen(fname, "rb");
+  if (!fd)
+    fatal("could not open -pcstat:dump file `%s'", fname);
+
+  if (!get(&val, 4) || val != PCSTAT_MAGIC)
+    fatal("`%s' is not a -pcstat:dump file", fname);
+  if (must_get(4) != PCSTAT_VERSION)
+    fatal("`%s' has an unsupported version", fname);
+  n_ctr = (int)must_get(4);
+  if (n_ctr != pc_NUM)
+    fatal("`%s' has %d counters, expected %d", fname, n_ctr, pc_NUM);
+
+  printf("pc,inst");
+  for (k = 0; k < pc_NUM; k++)
+    printf(",%s", pcstat_name[k]);
+  printf(",misp_rate,dl1_miss_rate,l2_miss_rate\n");
+
+  while (get(&pc, 8))
+    {
+      inst = must_get(4);
+      for (k = 0; k < pc_NUM; k++)
+	ctr[k] = must_get(8);
+
+      printf("0x%llx,0x%08llx", pc, inst);
+      for (k = 0; k < pc_NUM; k++)
+	printf(",%llu", ctr[k]);
+      print_per_exec(ctr[pc_MISP], ctr[pc_EXEC]);
+      print_per_exec(ctr[pc_DL1_MISS], ctr[pc_EXEC]);
+      print_per_exec(ctr[pc_L2_MISS], ctr[pc_EXEC]);
+      printf("\n");
+      n_insn++;
+    }
+  fclose(fd);
+
+  fprintf(stderr, "%s: %d static instructions\n", fname, n_insn);
+
+  return 0;
+}
@@ -0,0 +1,187 @@
+/* pipetrace.c - binary pipeline trace */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "host.h"
+#include "misc.h"
+#include "machine.h"
+#include "options.h"
+#include "pipetrace.h"
+
+/* largest counter value, no boundary is ever reached */
+#define PTRACE_NEVER		((counter_t)(~0ULL >> 1))
+
+/* output buffer size */
+#define PTRACE_BUF		(64 * 1024)
+
+/* bytes per record */
+#define PTRACE_REC_SIZE		(8 + 8 + 8 + 4 + 4 * pt_NUM + 4 + 1 + 1)
+
+/* options */
+static char *ptrace_opts[2];
+static int ptrace_nelt = 0;
+
+bool_t ptrace_active = FALSE;
+counter_t ptrace_next = PTRACE_NEVER;
+int ptrace_unit = pu_INSN;
+
+static FILE *ptrace_fd = NULL;
+static counter_t ptrace_start = 0;
+static counter_t ptrace_end = PTRACE_NEVER;
+
+static unsigned char *ptrace_buf = NULL;
+static int ptrace_len = 0;
+static counter_t n_rec = 0;
+
+void
+ptrace_reg_options(struct opt_odb_t *odb)
+{
+  opt_reg_string_list(odb, "-ptrace",
+		      "write a binary pipetrace, i.e., <fname> <range>, range "
+		      "is [<start>]:[<end>] insts or @[<start>]:[<end>] cycles",
+		      ptrace_opts, /* arr_sz */2, &ptrace_nelt, /* default */NULL,
+		      /* !print */FALSE, /* format */NULL, /* !accrue */FALSE);
+}
+
+/* parse range bound S, DFLT when empty */
+static counter_t
+ptrace_bound(char *s, char *end, counter_t dflt)
+{
+  char *p;
+  counter_t val;
+
+  if (s == end)
+    return dflt;
+
+  val = (counter_t)strtoll(s, &p, 0);
+  if (p != end || val < 0)
+    fatal("bad -ptrace range bound `%.*s'", (int)(end - s), s);
+  return val;
+}
+
+static void
+ptrace_flush(void)
+{
+  if (ptrace_len > 0)
+    fwrite(ptrace_buf, 1, ptrace_len, ptrace_fd);
+  ptrace_len = 0;
+}
+
+/* buffer the N byte little endian value VAL */
+static void
+ptrace_put(unsigned long long val, int n)
+{
+  int i;
+
+  for (i = 0; i < n; i++, val >>= 8)
+    ptrace_buf[ptrace_len++] = (unsigned char)(val & 0xff);
+}
+
+void
+ptrace_check_options(void)
+{
+  char *range, *colon;
+
+  if (ptrace_nelt == 0)
+    return;
+  if (ptrace_nelt != 2)
+    fatal("bad pipetrace args, use: <fname> <range>");
+
+  range = ptrace_opts[1];
+  if (*range == '@')
+    {
+      ptrace_unit = pu_CYCLES;
+      range++;
+    }
+  else
+    ptrace_unit = pu_INSN;
+
+  colon = strchr(range, ':');
+  if (!colon)
+    fatal("bad -ptrace range `%s', use: [<start>]:[<end>]", ptrace_opts[1]);
+  ptrace_start = ptrace_bound(range, colon, 0);
+  ptrace_end = ptrace_bound(colon + 1, colon + strlen(colon), PTRACE_NEVER);
+  if (ptrace_end <= ptrace_start)
+    fatal("empty -ptrace range `%s'", ptrace_opts[1]);
+
+  ptrace_fd = fopen(ptrace_opts[0], "wb");
+  if (!ptrace_fd)
+    fatal("could not open pipetrace file `%s'", ptrace_opts[0]);
+
+  ptrace_buf = (unsigned char *)mycalloc(PTRACE_BUF, sizeof(unsigned char));
+  ptrace_put(PTRACE_MAGIC, 4);
+  ptrace_put(PTRACE_VERSION, 4);
+  ptrace_put(pt_NUM, 4);
+
+  ptrace_next = ptrace_start;
+}
+
+bool_t
+ptrace_enabled(void)
+{
+  return ptrace_fd != NULL;
+}
+
+void
+ptrace_range(counter_t insn, tick_t cycle)
+{
+  counter_t now = ptrace_unit == pu_CYCLES ? (counter_t)cycle : insn;
+
+  if (!ptrace_fd)
+    return;
+
+  if (!ptrace_active && now < ptrace_end)
+    {
+      ptrace_active = TRUE;
+      ptrace_next = ptrace_end;
+    }
+  else
+    {
+      ptrace_active = FALSE;
+      ptrace_next = PTRACE_NEVER;
+    }
+}
+
+void
+ptrace_write(struct ptrace_rec_t *rec)
+{
+  tick_t base = 0;
+  int i;
+
+  if (ptrace_len + PTRACE_REC_SIZE > PTRACE_BUF)
+    ptrace_flush();
+
+  for (i = 0; i < pt_NUM; i++)
+    if (rec->when[i] != 0 && (base == 0 || rec->when[i] < base))
+      base = rec->when[i];
+
+  ptrace_put(rec->seq, 8);
+  ptrace_put(rec->PC, 8);
+  ptrace_put(base, 8);
+  ptrace_put(rec->inst, 4);
+  for (i = 0; i < pt_NUM; i++)
+    ptrace_put(rec->when[i] ? rec->when[i] - base + 1 : 0, 4);
+  ptrace_put((unsigned)rec->checkpoint, 4);
+  ptrace_put(rec->iclass, 1);
+  ptrace_put(rec->flags, 1);
+
+  n_rec++;
+}
+
+void
+ptrace_close(void)
+{
+  if (!ptrace_fd)
+    return;
+
+  ptrace_flush();
+  fclose(ptrace_fd);
+  ptrace_fd = NULL;
+  ptrace_active = FALSE;
+  ptrace_next = PTRACE_NEVER;
+
+  fprintf(stderr, "sim: %lld pipetrace records -> %s\n",
+	  (long long)n_rec, ptrace_opts[0]);
+}
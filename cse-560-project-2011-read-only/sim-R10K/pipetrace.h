@@ -0,0 +1,96 @@
+#ifndef PIPETRACE_H
+#define PIPETRACE_H
+
+/* binary pipeline trace: -ptrace <fname> <range> writes one record per
+   instruction leaving the machine (committed or squashed) while the
+   range is open.  ptrace-view shows it as a pipeline diagram or exports
+   it for Konata or the Chrome trace viewer.
+
+   the range is <start>:<end> in committed instructions, or @<start>:<end>
+   in cycles; either bound may be omitted.
+
+   file format, all values little endian:
+
+     header   "PTRC", version (u32), pt_NUM (u32)
+     records  seq (u64), PC (u64), base cycle (u64), instruction word
+	      (u32), per timestamp its offset from the base plus one, 0
+	      when never reached (u32 each), checkpoint (i32, -1 none),
+	      instruction class (u8) and flags (u8)
+
+   the base is the earliest timestamp of the record */
+
+#define PTRACE_MAGIC			0x43525450	/* "PTRC" */
+#define PTRACE_VERSION			1
+
+/* timestamps, in pipeline order */
+enum ptrace_when_t {
+  pt_PREDICTED,		/* branch predicted */
+  pt_FETCHED,		/* fetched */
+  pt_RENAMED,		/* put into the window */
+  pt_REGREAD,		/* operands read */
+  pt_READY,		/* operands ready */
+  pt_ISSUED,		/* issued */
+  pt_COMPLETED,		/* result written back */
+  pt_RESOLVED,		/* branch resolved */
+  pt_COMMITTED,		/* committed */
+  pt_FREED,		/* left the machine */
+  pt_NUM
+};
+
+/* record flags */
+#define PTRACE_WRONG_PATH		0x01	/* fetched down a wrong path */
+#define PTRACE_COMMITTED		0x02	/* committed, else squashed */
+#define PTRACE_BMISP			0x04	/* mis-predicted branch */
+#define PTRACE_DMISS			0x08	/* load missed in the D-cache */
+
+/* one instruction */
+struct ptrace_rec_t
+{
+  seq_t seq;
+  md_addr_t PC;
+  md_inst_t inst;
+  int iclass;
+  int checkpoint;
+  int flags;
+  tick_t when[pt_NUM];		/* 0 when never reached */
+};
+
+/* range units */
+enum ptrace_unit_t { pu_INSN, pu_CYCLES };
+
+struct opt_odb_t;
+
+/* in the trace range now? */
+extern bool_t ptrace_active;
+
+/* next range boundary (in the range unit), the maximum counter value
+   when there is none */
+extern counter_t ptrace_next;
+extern int ptrace_unit;
+
+/* register/check the pipetrace options */
+void ptrace_reg_options(struct opt_odb_t *odb);
+void ptrace_check_options(void);
+
+/* writing a pipetrace? */
+bool_t ptrace_enabled(void);
+
+/* open or close the range at a boundary, INSN committed instructions
+   at CYCLE */
+void ptrace_range(counter_t insn, tick_t cycle);
+
+/* write record REC */
+void ptrace_write(struct ptrace_rec_t *rec);
+
+/* flush and close the file */
+void ptrace_close(void);
+
+/* check for a range boundary, once per simulated cycle */
+#define PTRACE_TICK(CYCLE, INSN)					\
+  do {									\
+    if ((ptrace_unit == pu_CYCLES ? (counter_t)(CYCLE) : (counter_t)(INSN))\
+	>= ptrace_next)							\
+      ptrace_range((INSN), (CYCLE));					\
+  } while (0)
+
+#endif /* PIPETRACE_H */
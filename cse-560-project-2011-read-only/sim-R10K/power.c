@@ -47,6 +47,7 @@
 #include <assert.h>
 #include "machine.h"
 #include "options.h"
+#include "stats.h"
 #include "cacti3/cacti_params.h"
 #include "power.h"
 
@@ -584,6 +585,7 @@ static char * ps2str[ps_NUM] = {
                                   "select",
                                   "rstation",
                                   "regfile",
+                                  "regcache",
                                   "ialu",
                                   "falu",
 				  "agen",
@@ -634,6 +636,7 @@ static enum proc_bigstruct_t ps2pbs[ps_NUM] = {
          /* ps_SELECT */pbs_WINDOW,
          /* ps_RSTATION */pbs_WINDOW,
          /* ps_REGFILE */pbs_REGFILE,
+         /* ps_REGCACHE */pbs_REGFILE,
          /* ps_IALU */pbs_ALU,
          /* ps_FALU */pbs_ALU,
 	 /* ps_AGEN */pbs_LSQ,
@@ -852,7 +855,7 @@ void power_stats_print(tick_t ncycle,
    pwst->energy_cg_byportidle = pwstnc->energy_cg_byportidle + pwsc->energy_cg_byportidle;
 
 #ifdef GET_OUT
-   fprintf(stream, "----------------\n");
+   print_separator(stream);
    print_rate(stream, "total_energy_cg_none", power_structs[ps_TOTAL].energy_cg_none, "");
    for (ps = 0; ps < ps_NUM; ps++)
    {
@@ -863,7 +866,7 @@ void power_stats_print(tick_t ncycle,
    }
 
 
-   fprintf(stream, "----------------\n");
+   print_separator(stream);
    print_rate(stream, "total_energy_cg_allornone", power_structs[ps_TOTAL].energy_cg_allornone, "");
    for (ps = 0; ps < ps_NUM; ps++)
    {
@@ -873,7 +876,7 @@ void power_stats_print(tick_t ncycle,
       print_rate(stream, buf, pws->energy_cg_allornone/ncycle, buf2);
    }
 
-   fprintf(stream, "----------------\n");
+   print_separator(stream);
    print_rate(stream, "total_energy_cg_byport", power_structs[ps_TOTAL].energy_cg_byport, "");
    for (ps = 0; ps < ps_NUM; ps++)
    {
@@ -883,7 +886,7 @@ void power_stats_print(tick_t ncycle,
       print_rate(stream, buf, pws->energy_cg_byport/ncycle, buf2);
    }
 #endif /* GET_OUT */
-   fprintf(stream, "----------------\n");
+   print_separator(stream);
    print_rate(stream, "total_energy_cg_byportidle", power_structs[ps_TOTAL].energy_cg_byportidle, "");
    for (ps = 0; ps < ps_NUM; ps++)
    {
@@ -896,7 +899,7 @@ void power_stats_print(tick_t ncycle,
       print_rate(stream, buf, pws->energy_cg_byportidle/ncycle, buf2);
    }
 
-   fprintf(stream, "----------------\n");
+   print_separator(stream);
    for (ps = 0; ps < ps_NUM; ps++)
    {
       struct power_struct_t *pws = &power_structs[ps];
@@ -908,7 +911,7 @@ void power_stats_print(tick_t ncycle,
       print_counter(stream, buf, pws->raccs, buf2);
    }
 
-   fprintf(stream, "----------------\n");
+   print_separator(stream);
    for (ps = 0; ps < ps_NUM; ps++)
    {
       struct power_struct_t *pws = &power_structs[ps];
@@ -920,7 +923,7 @@ void power_stats_print(tick_t ncycle,
       print_counter(stream, buf, pws->waccs, buf2);
    }
 
-   fprintf(stream, "----------------\n");
+   print_separator(stream);
 }
 
 
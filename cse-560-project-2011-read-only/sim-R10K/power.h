@@ -196,6 +196,7 @@ enum proc_struct_t
   ps_SELECT,
   ps_RSTATION,
   ps_REGFILE,
+  ps_REGCACHE,
   ps_IALU,
   ps_FALU,
   ps_AGEN,
@@ -216,7 +217,7 @@ enum proc_bigstruct_t
   pbs_LSQ, /* ps_SQADDR + ps_SQDATA + ps_LQADDR + ps_LQDATA + ps_DDSQADDR + ps_DDSQDATA + ps_DL1 + ps_DTLB */
   pbs_DMEM, /* ps_DL1 + ps_DTLB */
   pbs_WINDOW, /* ps_WAKEUP + ps_SELECT + ps_RSTATION + ps_RESULTBUS */
-  pbs_REGFILE, /* ps_REGFILE */
+  pbs_REGFILE, /* ps_REGFILE + ps_REGCACHE */
   pbs_ROB, /* ps_ROB */
   pbs_L2, /* ps_L2 */
   pbs_TOTALNOCLOCK,
@@ -1,6 +1,7 @@
 /* standard includes */
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 /* external definitions */
 #include "host.h"
 #include "options.h"
@@ -14,16 +15,35 @@
 static int predec_insn_htsize = 1024 * 1024;
 static struct predec_insn_t **predec_insn_ht = NULL;
 
+/* -pcstat options */
+static int pcstat_top;
+static char *pcstat_fname;
+
+static char *pcstat_name[pc_NUM] = {
+  "exec", "misp", "dl1_miss", "l2_miss", "squash", "revert"
+};
+
+static char *pcstat_desc[pc_NUM] = {
+  "executions", "mis-predictions", "D-cache load misses",
+  "L2 load misses", "load squashes", "checkpoint reverts"
+};
+
 void 
 predec_reg_options(struct opt_odb_t *odb)
 {
-  /* nothing here */
+  opt_reg_int(odb, "-pcstat",
+	      "report the top <n> static instructions per profile counter (0 = off)",
+	      &pcstat_top, /* default */0, /* print */TRUE, /* format */NULL);
+  opt_reg_string(odb, "-pcstat:dump",
+		 "dump every static instruction's profile counters to <fname> {<fname>|none}",
+		 &pcstat_fname, /* default */"none", /* print */TRUE, /* format */NULL);
 }
 
 void
 predec_check_options(void)
 {
-  /* hence, nothing here */
+  if (pcstat_top < 0)
+    fatal("-pcstat must be non-negative");
 }
 
 void
@@ -154,3 +174,128 @@ predec_lookup(md_addr_t PC)
   return NULL;
 }
 
+/* static instructions with any profile event, and the counter they are
+   sorted by */
+static struct predec_insn_t **pcstat_vec = NULL;
+static int pcstat_num = 0;
+static enum pcstat_t pcstat_key;
+
+static int
+pcstat_cmp(const void *a, const void *b)
+{
+  counter_t x = (*(struct predec_insn_t **)a)->pcstat[pcstat_key];
+  counter_t y = (*(struct predec_insn_t **)b)->pcstat[pcstat_key];
+
+  if (x != y)
+    return x < y ? 1 : -1;
+
+  /* ties by address, so the report is stable */
+  return (*(struct predec_insn_t **)a)->poi.PC < (*(struct predec_insn_t **)b)->poi.PC ? -1 : 1;
+}
+
+static void
+pcstat_collect(void)
+{
+  struct predec_insn_t *pdi;
+  int i, k, n = 0;
+
+  for (i = 0; i < predec_insn_htsize; i++)
+    for (pdi = predec_insn_ht[i]; pdi; pdi = pdi->next)
+      n++;
+
+  if (pcstat_vec)
+    free(pcstat_vec);
+  pcstat_vec = (struct predec_insn_t **)mycalloc(MAX(n, 1), sizeof(struct predec_insn_t *));
+  pcstat_num = 0;
+
+  for (i = 0; i < predec_insn_htsize; i++)
+    for (pdi = predec_insn_ht[i]; pdi; pdi = pdi->next)
+      for (k = 0; k < pc_NUM; k++)
+	if (pdi->pcstat[k])
+	  {
+	    pcstat_vec[pcstat_num++] = pdi;
+	    break;
+	  }
+}
+
+/* write the N byte little endian value VAL */
+static void
+pcstat_put(FILE *fd, unsigned long long val, int n)
+{
+  int i;
+
+  for (i = 0; i < n; i++, val >>= 8)
+    fputc((int)(val & 0xff), fd);
+}
+
+static void
+pcstat_dump(void)
+{
+  FILE *fd;
+  int i, k;
+
+  fd = fopen(pcstat_fname, "wb");
+  if (!fd)
+    fatal("could not open -pcstat:dump file `%s'", pcstat_fname);
+
+  pcstat_put(fd, PCSTAT_MAGIC, 4);
+  pcstat_put(fd, PCSTAT_VERSION, 4);
+  pcstat_put(fd, pc_NUM, 4);
+  for (i = 0; i < pcstat_num; i++)
+    {
+      pcstat_put(fd, (unsigned long long)pcstat_vec[i]->poi.PC, 8);
+      pcstat_put(fd, (unsigned long long)pcstat_vec[i]->inst, 4);
+      for (k = 0; k < pc_NUM; k++)
+	pcstat_put(fd, (unsigned long long)pcstat_vec[i]->pcstat[k], 8);
+    }
+  fclose(fd);
+}
+
+void
+predec_stats(FILE *stream)
+{
+  struct predec_insn_t *pdi;
+  counter_t total;
+  char name[64], desc[256];
+  int i, k, n;
+
+  if (pcstat_top == 0 && !mystricmp(pcstat_fname, "none"))
+    return;
+
+  pcstat_collect();
+
+  for (k = 0; k < pc_NUM && pcstat_top > 0; k++)
+    {
+      for (total = 0, i = 0; i < pcstat_num; i++)
+	total += pcstat_vec[i]->pcstat[k];
+
+      sprintf(name, "pcstat_%s", pcstat_name[k]);
+      sprintf(desc, "total %s", pcstat_desc[k]);
+      print_counter(stream, name, total, desc);
+
+      pcstat_key = k;
+      qsort(pcstat_vec, pcstat_num, sizeof(struct predec_insn_t *), pcstat_cmp);
+
+      for (i = 0, n = MIN(pcstat_top, pcstat_num); i < n; i++)
+	{
+	  pdi = pcstat_vec[i];
+	  if (!pdi->pcstat[k])
+	    break;
+
+	  sprintf(name, "pcstat_%s_0x%llx", pcstat_name[k],
+		  (unsigned long long)pdi->poi.PC);
+	  if (k == pc_EXEC)
+	    sprintf(desc, "%s, %.2f%% of %s", MD_OP_NAME(pdi->poi.op),
+		    100.0 * pdi->pcstat[k] / total, pcstat_desc[k]);
+	  else
+	    sprintf(desc, "%s, %.2f%% of %s, %.4f per execution",
+		    MD_OP_NAME(pdi->poi.op), 100.0 * pdi->pcstat[k] / total,
+		    pcstat_desc[k], pdi->pcstat[pc_EXEC]
+		    ? (double)pdi->pcstat[k] / pdi->pcstat[pc_EXEC] : 0.0);
+	  print_counter(stream, name, pdi->pcstat[k], desc);
+	}
+    }
+
+  if (mystricmp(pcstat_fname, "none"))
+    pcstat_dump();
+}
@@ -16,6 +16,18 @@ struct predec_poi_t
   int imm;
 };
 
+/* per static instruction profile counters (-pcstat), updated by the
+   timing simulators */
+enum pcstat_t {
+  pc_EXEC,		/* correct path executions */
+  pc_MISP,		/* branch mis-predictions */
+  pc_DL1_MISS,		/* load D-cache misses */
+  pc_L2_MISS,		/* load L2 misses */
+  pc_SQUASH,		/* load mis-speculation squashes */
+  pc_REVERT,		/* checkpoint reverts */
+  pc_NUM
+};
+
 struct predec_insn_t
 {
   struct predec_insn_t *next;
@@ -29,8 +41,20 @@ struct predec_insn_t
   /* instance counter, comes in handy occasionally.  must be updated
      externally */
   counter_t n_inst;
+
+  counter_t pcstat[pc_NUM];
 };
 
+/* count one KIND event of pre-decoded instruction PDI */
+#define PCSTAT_INC(PDI, KIND)						\
+  (((struct predec_insn_t *)(PDI))->pcstat[(KIND)]++)
+
+/* -pcstat:dump file format, all values little endian: "PCST", version
+   (u32), pc_NUM (u32), then per instruction with any event its PC (u64),
+   instruction word (u32) and pc_NUM counts (u64 each) */
+#define PCSTAT_MAGIC		0x54534350	/* "PCST" */
+#define PCSTAT_VERSION		1
+
 void
 predec_init(void);
 
@@ -46,4 +70,8 @@ predec_reg_options(struct opt_odb_t *odb);
 void
 predec_check_options(void);
 
+/* print the -pcstat top-N report and write the -pcstat:dump file */
+void
+predec_stats(FILE *stream);
+
 #endif /* PREDEC_H */
@@ -0,0 +1,450 @@
+/* ptrace-view.c - show or export a -ptrace pipetrace
+ *
+ * usage: ptrace-view [-konata|-chrome] [-from <cycle>] [-n <insts>]
+ *                    [-w <cycles>] <file>
+ *
+ * By default prints a pipeline diagram, one line per instruction in
+ * program order, with one column per cycle:
+ *
+ *   F fetched   N renamed   R operands read   D operands ready
+ *   I issued    C completed B branch resolved M committed
+ *   X squashed  . in flight
+ *
+ * and a flag column: w wrong path, b mis-predicted branch, d D-cache
+ * miss, x squashed.  -konata writes a Kanata log for the Konata viewer,
+ * -chrome a Chrome trace (chrome://tracing, Perfetto) with one cycle per
+ * microsecond.  -from skips instructions that left the machine before
+ * the given cycle, -n limits the instruction count (200 for the diagram,
+ * all for the exports) and -w the diagram width.  The file format is
+ * described in pipetrace.h.
+ *
+ * build: cc -o ptrace-view ptrace-view.c misc.c -lz
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "host.h"
+#include "misc.h"
+#include "machine.h"
+#include "pipetrace.h"
+
+static FILE *fd;
+static char *fname;
+
+static char *class_name[ic_NUM] = {
+  "nop", "pref", "load", "store", "ctrl", "icomp",
+  "icompl", "fcomp", "fcompl", "sys", "other"
+};
+
+/* diagram marks per timestamp, later ones win within a cycle */
+static char when_mark[pt_NUM] = {
+  0, 'F', 'N', 'R', 'D', 'I', 'C', 'B', 'M', 'X'
+};
+
+/* pipeline stages for the exports, each starts at its timestamp and
+   ends at the start of the next one reached */
+#define N_STAGES	6
+
+static int stage_when[N_STAGES] = {
+  pt_FETCHED, pt_RENAMED, pt_REGREAD, pt_READY, pt_ISSUED, pt_COMPLETED
+};
+
+static char *stage_name[N_STAGES] = {
+  "F",		/* in the fetch queue */
+  "Dp",		/* renamed, reading operands */
+  "Wt",		/* waiting for operands */
+  "Rd",		/* ready, waiting for issue */
+  "Ex",		/* executing */
+  "Cw"		/* complete, waiting to commit */
+};
+
+/* lanes of the Chrome trace, instructions share them round robin */
+#define CHROME_LANES	64
+
+static struct ptrace_rec_t *recs = NULL;
+static int n_recs = 0, max_recs = 0;
+
+/* read an N byte little endian value, FALSE at end-of-file */
+static int
+get(unsigned long long *val, int n)
+{
+  unsigned char buf[8];
+  int i, nread;
+
+  nread = fread(buf, 1, n, fd);
+  if (nread == 0)
+    return FALSE;
+  if (nread != n)
+    fatal("`%s' is truncated", fname);
+
+  for (*val = 0, i = n - 1; i >= 0; i--)
+    *val = (*val << 8) | buf[i];
+  return TRUE;
+}
+
+static unsigned long long
+must_get(int n)
+{
+  unsigned long long val;
+
+  if (!get(&val, n))
+    fatal("`%s' is truncated", fname);
+  return val;
+}
+
+/* read the next record into REC, FALSE at end-of-file */
+static int
+get_rec(struct ptrace_rec_t *rec)
+{
+  unsigned long long val, base, off;
+  int i;
+
+  if (!get(&val, 8))
+    return FALSE;
+  rec->seq = (seq_t)val;
+  rec->PC = (md_addr_t)must_get(8);
+  base = must_get(8);
+  rec->inst = (md_inst_t)must_get(4);
+  for (i = 0; i < pt_NUM; i++)
+    {
+      off = must_get(4);
+      rec->when[i] = off ? (tick_t)(base + off - 1) : 0;
+    }
+  rec->checkpoint = (int)(unsigned)must_get(4);
+  rec->iclass = (int)must_get(1);
+  rec->flags = (int)must_get(1);
+
+  if (rec->iclass < 0 || rec->iclass >= ic_NUM)
+    rec->iclass = ic_other;
+  return TRUE;
+}
+
+static int
+rec_cmp(const void *a, const void *b)
+{
+  const struct ptrace_rec_t *ra = a, *rb = b;
+
+  return ra->seq < rb->seq ? -1 : ra->seq > rb->seq;
+}
+
+/* start cycles of the stages of REC, -1 for stages never reached */
+static void
+rec_stages(struct ptrace_rec_t *rec, tick_t *start)
+{
+  tick_t t, last = 0, freed = rec->when[pt_FREED];
+  int s, prev = -1;
+
+  for (s = 0; s < N_STAGES; s++)
+    {
+      start[s] = -1;
+      t = rec->when[stage_when[s]];
+      /* squashed instructions may carry timestamps in the future */
+      if (t == 0 || t < last || t >= freed)
+	continue;
+      /* drop stages that took no time */
+      if (prev >= 0 && t == last)
+	start[prev] = -1;
+      start[s] = last = t;
+      prev = s;
+    }
+}
+
+/* end cycle of stage S of REC */
+static tick_t
+rec_stage_end(struct ptrace_rec_t *rec, tick_t *start, int s)
+{
+  for (s++; s < N_STAGES; s++)
+    if (start[s] >= 0)
+      return start[s];
+  return (rec->flags & PTRACE_COMMITTED) && rec->when[pt_COMMITTED]
+    ? rec->when[pt_COMMITTED] : rec->when[pt_FREED];
+}
+
+static void
+print_diagram(int width)
+{
+  struct ptrace_rec_t *rec;
+  tick_t from = -1, t;
+  char *line;
+  int i, k;
+
+  for (i = 0; i < n_recs; i++)
+    {
+      t = recs[i].when[pt_FETCHED] ? recs[i].when[pt_FETCHED]
+	: recs[i].when[pt_FREED];
+      if (from < 0 || t < from)
+	from = t;
+    }
+  line = (char *)mycalloc(width + 1, sizeof(char));
+
+  printf("cycle %lld +\n", (long long)from);
+  for (i = 0; i < n_recs; i++)
+    {
+      rec = &recs[i];
+
+      memset(line, ' ', width);
+      if (rec->when[pt_FETCHED])
+	for (t = MAX(rec->when[pt_FETCHED], from);
+	     t < rec->when[pt_FREED] && t - from < width; t++)
+	  line[t - from] = '.';
+      for (k = 0; k < pt_NUM; k++)
+	{
+	  t = rec->when[k];
+	  if (!when_mark[k] || t == 0 || t < from || t - from >= width)
+	    continue;
+	  if (k == pt_FREED && (rec->flags & PTRACE_COMMITTED))
+	    continue;
+	  if (t > rec->when[pt_FREED])
+	    continue;
+	  if (k == pt_RESOLVED && rec->iclass != ic_ctrl)
+	    continue;
+	  line[t - from] = when_mark[k];
+	}
+
+      printf("%10lld 0x%08llx %-6s %4d %c%c%c%c |%s|\n",
+	     (long long)rec->seq, (unsigned long long)rec->PC,
+	     class_name[rec->iclass], rec->checkpoint,
+	     (rec->flags & PTRACE_WRONG_PATH) ? 'w' : '-',
+	     (rec->flags & PTRACE_BMISP) ? 'b' : '-',
+	     (rec->flags & PTRACE_DMISS) ? 'd' : '-',
+	     (rec->flags & PTRACE_COMMITTED) ? '-' : 'x',
+	     line);
+    }
+  free(line);
+}
+
+/* a Kanata command at a cycle */
+struct kev_t
+{
+  tick_t cycle;
+  int id;
+  int order;		/* within the instruction */
+  char cmd;		/* I, L, S, E or R */
+  int arg;		/* stage, or flush flag */
+};
+
+static int
+kev_cmp(const void *a, const void *b)
+{
+  const struct kev_t *ka = a, *kb = b;
+
+  if (ka->cycle != kb->cycle)
+    return ka->cycle < kb->cycle ? -1 : 1;
+  if (ka->id != kb->id)
+    return ka->id - kb->id;
+  return ka->order - kb->order;
+}
+
+static struct kev_t *ev = NULL;
+static int n_ev = 0;
+
+/* add command CMD of instruction ID at CYCLE, in program order */
+static void
+kev_add(tick_t cycle, int id, char cmd, int arg)
+{
+  static int last_id = -1, order = 0;
+
+  if (id != last_id)
+    {
+      last_id = id;
+      order = 0;
+    }
+  ev[n_ev].cycle = cycle;
+  ev[n_ev].id = id;
+  ev[n_ev].order = order++;
+  ev[n_ev].cmd = cmd;
+  ev[n_ev].arg = arg;
+  n_ev++;
+}
+
+static void
+print_konata(void)
+{
+  struct ptrace_rec_t *rec;
+  tick_t start[N_STAGES], first, cycle = -1;
+  int i, s, n_retired = 0;
+
+  ev = (struct kev_t *)mycalloc((2 * N_STAGES + 3) * (n_recs + 1),
+				sizeof(struct kev_t));
+  for (i = 0; i < n_recs; i++)
+    {
+      rec = &recs[i];
+      rec_stages(rec, start);
+
+      first = rec->when[pt_FREED];
+      for (s = 0; s < N_STAGES; s++)
+	if (start[s] >= 0)
+	  {
+	    first = start[s];
+	    break;
+	  }
+
+      kev_add(first, i, 'I', 0);
+      kev_add(first, i, 'L', 0);
+      for (s = 0; s < N_STAGES; s++)
+	if (start[s] >= 0)
+	  {
+	    kev_add(start[s], i, 'S', s);
+	    kev_add(rec_stage_end(rec, start, s), i, 'E', s);
+	  }
+      kev_add(rec_stage_end(rec, start, N_STAGES - 1), i, 'R',
+	      !(rec->flags & PTRACE_COMMITTED));
+    }
+  qsort(ev, n_ev, sizeof(struct kev_t), kev_cmp);
+
+  printf("Kanata\t0004\n");
+  for (i = 0; i < n_ev; i++)
+    {
+      rec = &recs[ev[i].id];
+      if (cycle < 0)
+	printf("C=\t%lld\n", (long long)ev[i].cycle);
+      else if (ev[i].cycle > cycle)
+	printf("C\t%lld\n", (long long)(ev[i].cycle - cycle));
+      cycle = ev[i].cycle;
+
+      switch (ev[i].cmd)
+	{
+	case 'I':
+	  printf("I\t%d\t%lld\t0\n", ev[i].id, (long long)rec->seq);
+	  break;
+	case 'L':
+	  printf("L\t%d\t0\t0x%08llx: %s 0x%08x\n", ev[i].id,
+		 (unsigned long long)rec->PC, class_name[rec->iclass],
+		 (unsigned)rec->inst);
+	  printf("L\t%d\t1\tseq %lld chkpt %d%s%s%s\n", ev[i].id,
+		 (long long)rec->seq, rec->checkpoint,
+		 (rec->flags & PTRACE_WRONG_PATH) ? " wrong-path" : "",
+		 (rec->flags & PTRACE_BMISP) ? " mispredicted" : "",
+		 (rec->flags & PTRACE_DMISS) ? " dcache-miss" : "");
+	  break;
+	case 'S':
+	case 'E':
+	  printf("%c\t%d\t0\t%s\n", ev[i].cmd, ev[i].id, stage_name[ev[i].arg]);
+	  break;
+	case 'R':
+	  printf("R\t%d\t%d\t%d\n", ev[i].id,
+		 ev[i].arg ? 0 : n_retired++, ev[i].arg);
+	  break;
+	}
+    }
+  free(ev);
+}
+
+static void
+print_chrome(void)
+{
+  struct ptrace_rec_t *rec;
+  tick_t start[N_STAGES], end;
+  int i, s, first = TRUE;
+
+  printf("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+  for (i = 0; i < n_recs; i++)
+    {
+      rec = &recs[i];
+      rec_stages(rec, start);
+      for (s = 0; s < N_STAGES; s++)
+	{
+	  if (start[s] < 0)
+	    continue;
+	  end = rec_stage_end(rec, start, s);
+	  printf("%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,"
+		 "\"tid\":%d,\"ts\":%lld,\"dur\":%lld,\"args\":{\"seq\":%lld,"
+		 "\"pc\":\"0x%08llx\",\"class\":\"%s\",\"chkpt\":%d,"
+		 "\"flags\":%d}}",
+		 first ? "" : ",\n", stage_name[s],
+		 (rec->flags & PTRACE_COMMITTED) ? "committed" : "squashed",
+		 i % CHROME_LANES, (long long)start[s],
+		 (long long)(end - start[s]), (long long)rec->seq,
+		 (unsigned long long)rec->PC, class_name[rec->iclass],
+		 rec->checkpoint, rec->flags);
+	  first = FALSE;
+	}
+    }
+  printf("\n]}\n");
+}
+
+int
+main(int argc, char **argv)
+{
+  enum { m_DIAGRAM, m_KONATA, m_CHROME } mode = m_DIAGRAM;
+  struct ptrace_rec_t rec;
+  unsigned long long val;
+  long long from = 0;
+  int i, max_n = -1, width = 100;
+
+  for (i = 1; i < argc - 1; i++)
+    {
+      if (!strcmp(argv[i], "-konata"))
+	mode = m_KONATA;
+      else if (!strcmp(argv[i], "-chrome"))
+	mode = m_CHROME;
+      else if (!strcmp(argv[i], "-from") && i + 1 < argc - 1)
+	from = atoll(argv[++i]);
+      else if (!strcmp(argv[i], "-n") && i + 1 < argc - 1)
+	max_n = atoi(argv[++i]);
+      else if (!strcmp(argv[i], "-w") && i + 1 < argc - 1)
+	width = atoi(argv[++i]);
+      else
+	break;
+    }
+  if (i != argc - 1 || width < 1)
+    {
+      fprintf(stderr, "usage: %s [-konata|-chrome] [-from <cycle>] "
+	      "[-n <insts>] [-w <cycles>] <file>\n", argv[0]);
+      exit(1);
+    }
+  fname = argv[i];
+  if (max_n < 0)
+    max_n = mode == m_DIAGRAM ? 200 : 0;
+
+  fd = fopen(fname, "rb");
+  if (!fd)
+    fatal("could not open pipetrace file `%s'", fname);
+
+  if (!get(&val, 4) || val != PTRACE_MAGIC)
+    fatal("`%s' is not a -ptrace file", fname);
+  if (must_get(4) != PTRACE_VERSION)
+    fatal("`%s' has an unsupported version", fname);
+  if (must_get(4) != pt_NUM)
+    fatal("`%s' has an unexpected timestamp count", fname);
+
+  while (get_rec(&rec))
+    {
+      if (rec.when[pt_FREED] < from)
+	continue;
+      if (max_n > 0 && n_recs == max_n)
+	break;
+      if (n_recs == max_recs)
+	{
+	  max_recs = max_recs ? 2 * max_recs : 4096;
+	  recs = (struct ptrace_rec_t *)
+	    realloc(recs, max_recs * sizeof(struct ptrace_rec_t));
+	  if (!recs)
+	    fatal("out of virtual memory");
+	}
+      recs[n_recs++] = rec;
+    }
+  fclose(fd);
+
+  /* records are written as instructions leave, show them in order */
+  qsort(recs, n_recs, sizeof(struct ptrace_rec_t), rec_cmp);
+
+  switch (mode)
+    {
+    case m_DIAGRAM:
+      print_diagram(width);
+      break;
+    case m_KONATA:
+      print_konata();
+      break;
+    case m_CHROME:
+      print_chrome();
+      break;
+    }
+
+  fprintf(stderr, "%s: %d instructions\n", fname, n_recs);
+
+  return 0;
+}
@@ -68,6 +68,7 @@
 #include <assert.h>
 #include "machine.h"
 #include "options.h"
+#include "stats.h"
 /* Local definitions */
 #include "resource.h"
 /* Implementation definitions */
@@ -109,23 +110,23 @@ fuclass_check_options()
   enum fuclass_t fu;
   for (fu = fuclass_IALU; fu < fuclass_NUM; fu++)
     if (fuclass_opt[fu].execlat == 0)
-      fatal("%s execution latency must be positive");
+      fatal("%s execution latency must be positive", fuclass_opt[fu].name);
 }
 
 /* resource pool indices */
 static enum resclass_t mp_fuclass2resclass[fuclass_NUM] = {
-  resclass_NA, /* FUClass_NA */	  
-  resclass_IALU, /* IntALU */ 
-  resclass_IMULT, /* IntMULT */
-  resclass_IMULT, /* IntDIV */
-  resclass_FPALU, /* FloatADD */
-  resclass_FPALU, /* FloatCMP */
-  resclass_FPALU, /* FloatCVT */
-  resclass_FPMULT, /* FloatMULT */
-  resclass_FPMULT, /* FloatDIV */
-  resclass_FPMULT, /* FloatSQRT */
-  resclass_MEMPORT, /* RdPort */
-  resclass_MEMPORT, /* WrPort */
+  resclass_NA, /* fuclass_NA */
+  resclass_IALU, /* fuclass_IALU */
+  resclass_IALU, /* fuclass_ISHIFT */
+  resclass_IALU, /* fuclass_IBRANCH */
+  resclass_IMULT, /* fuclass_IMULT */
+  resclass_IMULT, /* fuclass_IDIV */
+  resclass_FPALU, /* fuclass_FADD */
+  resclass_FPALU, /* fuclass_FBRANCH */
+  resclass_FPALU, /* fuclass_FCVT */
+  resclass_FPMULT, /* fuclass_FMULT */
+  resclass_FPMULT, /* fuclass_FDIV */
+  resclass_FPMULT, /* fuclass_FSQRT */
 };
 
 static char *mp_resclass2str[resclass_NUM] = 
@@ -134,10 +135,13 @@ static char *mp_resclass2str[resclass_NUM] =
   "ialu",
   "imult",
   "fpalu",
-  "fpmult",
-  "cacheport"
+  "fpmult"
 };
 
+/* -respool:cacheport:num, still accepted so existing command lines work,
+   memory ports are limited by the load and store scheduling widths */
+static int respool_cacheport_num;
+
 void
 respool_reg_options(struct opt_odb_t *odb,
 		    struct respool_opt_t *opt)
@@ -156,6 +160,11 @@ respool_reg_options(struct opt_odb_t *odb,
 		  &opt->res_num[rc], /* default */4,
 		  /* print */TRUE, /* format */NULL);
     }
+
+  opt_reg_int(odb, "-respool:cacheport:num",
+	      "ignored, deprecated (memory ports are limited by the load/store scheduling widths)",
+	      &respool_cacheport_num, /* default */4,
+	      /* !print */FALSE, /* format */NULL);
 }
 
 void
@@ -165,47 +174,109 @@ respool_check_options(struct respool_opt_t *opt)
   for (rc = resclass_IALU; rc < resclass_NUM; rc++)
     if (opt->res_num[rc] < 1)
       fatal("need at least 1 '%s'", mp_resclass2str[rc]);
+    else if (opt->res_num[rc] > MAX_INSTS_PER_CLASS)
+      fatal("at most %d '%s's supported", MAX_INSTS_PER_CLASS, mp_resclass2str[rc]);
 }
 
 
+
+/* the units of a class, bit i of the free mask is unit i */
+struct respool_class_t
+{
+  struct res_t *res;		/* the units, with their ready times */
+  unsigned long long free;	/* units ready at cycle NOW */
+  tick_t now;			/* cycle of the free mask */
+  tick_t next_ready;		/* earliest ready time of a busy unit */
+
+  counter_t n_issue;		/* operations issued */
+  counter_t n_busy;		/* unit cycles spent issuing them */
+  counter_t n_stall;		/* requests refused, no free unit */
+};
+
 struct respool_t
 {
   struct respool_opt_t *opt;
-  struct res_t *res_heads[resclass_NUM];
-  struct res_t *res_tails[resclass_NUM];
+  struct respool_class_t rc[resclass_NUM];
 };
 
+/* index of the lowest set bit of MASK, which must be non-zero */
+static INLINE int
+respool_ffs(unsigned long long mask)
+{
+#ifdef __GNUC__
+  return __builtin_ctzll(mask);
+#else /* !__GNUC__ */
+  int i;
+
+  for (i = 0; !(mask & 1); i++, mask >>= 1) ;
+  return i;
+#endif /* !__GNUC__ */
+}
+
+static INLINE int
+respool_popcount(unsigned long long mask)
+{
+#ifdef __GNUC__
+  return __builtin_popcountll(mask);
+#else /* !__GNUC__ */
+  int n;
+
+  for (n = 0; mask; mask &= mask - 1, n++) ;
+  return n;
+#endif /* !__GNUC__ */
+}
+
+/* bring the free mask of class C up to cycle NOW; units only become
+   busy through respool_get_res, so the units are only rescanned in
+   cycles in which a busy unit becomes ready */
+static INLINE void
+respool_refresh(struct respool_class_t *c, int n, tick_t now)
+{
+  int i;
+
+  if (now == c->now)
+    return;
+  c->now = now;
+
+  if (now < c->next_ready)
+    return;
+
+  c->free = 0;
+  c->next_ready = (tick_t)-1;
+  for (i = 0; i < n; i++)
+    {
+      if (c->res[i].ready <= now)
+	c->free |= 1ULL << i;
+      else if (c->res[i].ready < c->next_ready)
+	c->next_ready = c->res[i].ready;
+    }
+}
 
 /* create a resource pool */
 struct respool_t *
 respool_create(struct respool_opt_t *opt)
 {
   enum resclass_t rc;
-  int j;
   struct respool_t *pool;
 
   pool = (struct respool_t *) calloc (1, sizeof(struct respool_t));
+  if (!pool)
+    fatal("out of virtual memory");
   pool->opt = opt;
 
   for (rc = resclass_IALU; rc < resclass_NUM; rc++)
     {
-      for (j = 0; j < pool->opt->res_num[rc]; j++)
-	{
-	  struct res_t * fu;
-	  fu = (struct res_t *) calloc (1, sizeof(struct res_t));
-
-	  /* attach to next element */
-	  if (pool->res_heads[rc])
-	    pool->res_heads[rc]->prev = fu;
-	  fu->next = pool->res_heads[rc];
-
-	  /* Attach to head */
-	  pool->res_heads[rc] = fu;
-
-	  /* Attach to tail */
-	  if (pool->res_tails[rc] == 0) 
-	    pool->res_tails[rc] = fu;
-	}
+      struct respool_class_t *c = &pool->rc[rc];
+      int n = pool->opt->res_num[rc];
+
+      c->res = (struct res_t *) calloc (n, sizeof(struct res_t));
+      if (!c->res)
+	fatal("out of virtual memory");
+
+      /* all units free */
+      c->free = (n == 64) ? ~0ULL : (1ULL << n) - 1;
+      c->now = 0;
+      c->next_ready = (tick_t)-1;
     }
 
   return pool;
@@ -213,70 +284,39 @@ respool_create(struct respool_opt_t *opt)
 
 /* get a free resource from resource pool POOL that can execute a
    operation of class CLASS, returns a pointer to the resource template,
-   returns NULL, if there are currently no free resources available,
-   follow the MASTER link to the master resource descriptor;
-   NOTE: caller is responsible for reseting the busy flag in the beginning
-   of the cycle when the resource can once again accept a new operation */
+   returns NULL, if there are currently no free resources available;
+   the unit is busy for the operation's issue latency */
 struct res_t *
 respool_get_res(struct respool_t *pool, 
 		enum fuclass_t fu_class, 
 		tick_t now)
 {
-  enum resclass_t res_class;
-  struct res_t * fu, *pfu, *nfu;
+  enum resclass_t res_class = mp_fuclass2resclass[fu_class];
+  struct respool_class_t *c = &pool->rc[res_class];
+  struct res_t *fu;
+  int i;
+
+  respool_refresh(c, pool->opt->res_num[res_class], now);
 
-  res_class = mp_fuclass2resclass[fu_class];
-  fu = pool->res_heads[res_class];
-  
   /* No resource ready */
-  if (fu->ready > now)
-    return NULL;
+  if (!c->free)
+    {
+      c->n_stall++;
+      return NULL;
+    }
 
+  i = respool_ffs(c->free);
+  fu = &c->res[i];
   fu->execlat = fuclass_opt[fu_class].execlat;
   fu->ready = now + fuclass_opt[fu_class].issuelat;
 
-  /* Detach from resource list */
-  if (fu->next) 
-    fu->next->prev = NULL;
-  pool->res_heads[res_class] = fu->next;
-  if (!pool->res_heads[res_class])
-    pool->res_tails[res_class] = NULL;
-
-  /* Reinsert fu into list, from the back, in order of readyness */
-  for (nfu = NULL, pfu = pool->res_tails[res_class]; 
-       pfu; 
-       nfu = pfu, pfu = pfu->prev)
-    if (pfu->ready <= fu->ready)
-      break;
-
-  /* insert in the back */
-  if (!nfu)
-    {
-      if (pool->res_tails[res_class])
-	pool->res_tails[res_class]->next = fu;
-      else
-	pool->res_heads[res_class] = fu;
-      fu->prev = pool->res_tails[res_class];
-      pool->res_tails[res_class] = fu;
-    }
-  /* insert in the front */
-  else if (!pfu)
-    {
-      if (pool->res_heads[res_class])
-	pool->res_heads[res_class]->prev = fu;
-      else
-	pool->res_tails[res_class] = fu;
-      fu->next = pool->res_heads[res_class];
-      pool->res_heads[res_class] = fu;
-    }
-  /* insert in the middle */
-  else
-    {
-      pfu->next = fu;
-      nfu->prev = fu;
-      fu->next = nfu;
-      fu->prev = pfu;
-    }
+  /* busy until ready */
+  c->free &= ~(1ULL << i);
+  if (fu->ready < c->next_ready)
+    c->next_ready = fu->ready;
+
+  c->n_issue++;
+  c->n_busy += fuclass_opt[fu_class].issuelat;
 
   return fu;
 }
@@ -287,31 +327,51 @@ respool_free_res(struct respool_t *pool,
 		 enum fuclass_t fu_class,
 		 tick_t now)
 {
-  int free = 0;
   enum resclass_t res_class = mp_fuclass2resclass[fu_class];
-  struct res_t *fu;
+  struct respool_class_t *c = &pool->rc[res_class];
 
-  for (fu = pool->res_heads[res_class]; 
-       fu && fu->ready <= now; 
-       fu = fu->next, free++) ;
-    
-  return free;
+  respool_refresh(c, pool->opt->res_num[res_class], now);
+  return respool_popcount(c->free);
 }
 
 void
 respool_dump(struct respool_t *pool,
 	     FILE *stream)
 {
-  int i;
-  struct res_t * fu;
+  int i, j;
 
-  for (i = 0; i < resclass_NUM; i++)
+  for (i = resclass_IALU; i < resclass_NUM; i++)
     {
       fprintf(stream, "%s(%d)", mp_resclass2str[i], pool->opt->res_num[i]);
-      for (fu = pool->res_heads[i]; fu; fu = fu->next)
-	fprintf(stream, " %9u", (unsigned int)fu->ready);
+      for (j = 0; j < pool->opt->res_num[i]; j++)
+	fprintf(stream, " %9u", (unsigned int)pool->rc[i].res[j].ready);
       fprintf(stream, "\n");
     }
 }
 
+void
+respool_stats(struct respool_t *pool,
+	      FILE *stream,
+	      tick_t cycles)
+{
+  char name[64], desc[128];
+  enum resclass_t rc;
+
+  for (rc = resclass_IALU; rc < resclass_NUM; rc++)
+    {
+      struct respool_class_t *c = &pool->rc[rc];
+      int n = pool->opt->res_num[rc];
+
+      sprintf(name, "respool_%s_issue", mp_resclass2str[rc]);
+      sprintf(desc, "operations issued to %s's", mp_resclass2str[rc]);
+      print_counter(stream, name, c->n_issue, desc);
 
+      sprintf(name, "respool_%s_util", mp_resclass2str[rc]);
+      sprintf(desc, "%s utilization, busy unit cycles per unit per cycle", mp_resclass2str[rc]);
+      print_rate(stream, name, cycles ? (double)c->n_busy / ((double)cycles * n) : 0.0, desc);
+
+      sprintf(name, "respool_%s_stall", mp_resclass2str[rc]);
+      sprintf(desc, "issue attempts refused, all %s's busy", mp_resclass2str[rc]);
+      print_counter(stream, name, c->n_stall, desc);
+    }
+}
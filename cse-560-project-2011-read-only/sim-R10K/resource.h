@@ -77,8 +77,9 @@ struct fuclass_opt_t fuclass_opt[fuclass_NUM];
 /* maximum number of resource classes supported */
 #define MAX_RES_CLASSES		16
 
-/* maximum number of resource instances for a class supported */
-#define MAX_INSTS_PER_CLASS	8
+/* maximum number of resource instances for a class supported, one bit
+   of a class's free unit mask each */
+#define MAX_INSTS_PER_CLASS	64
 
 enum resclass_t {
   resclass_NA,
@@ -86,15 +87,12 @@ enum resclass_t {
   resclass_IMULT,
   resclass_FPALU,
   resclass_FPMULT,
-  resclass_MEMPORT,
   resclass_NUM
 };
 
 struct res_t {
   int execlat;
   tick_t ready;
-  struct res_t *next;
-  struct res_t *prev;
 };
 
 /* resource pool: one entry per resource instance */
@@ -123,6 +121,7 @@ respool_get_res(struct respool_t *pool,
 		tick_t now);
 
 
+/* number of free units of the class that executes CLASS operations */
 int 
 respool_free_res(struct respool_t *pool, 
 		 enum fuclass_t fuclass, 
@@ -142,4 +141,11 @@ respool_check_options(struct respool_opt_t *opt);
 struct respool_t *
 respool_create(struct respool_opt_t *opt);
 
+/* print per class utilization over CYCLES cycles and structural hazard
+   stalls */
+void
+respool_stats(struct respool_t *pool,
+	      FILE *stream,
+	      tick_t cycles);
+
 #endif /* RESOURCE_H */
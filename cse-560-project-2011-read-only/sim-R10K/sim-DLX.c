@@ -200,11 +200,7 @@ sim_reg_options(struct opt_odb_t *odb)	/* options database */
 	       &tlb_mlat, /* default */30, 
 	       /* print */TRUE, /* format */NULL);
 
-  bpred_opt.opt = "dynamic";
-  bpred_opt.dir1_opt.opt = "1024:2:0:0";
-  bpred_opt.dir2_opt.opt = "1024:2:8:0";
-  bpred_opt.chooser_opt.opt = "1024:2";
-  bpred_opt.ras_opt.opt = "8";
+  bpred_default_options(&bpred_opt);
   bpred_opt.btb_opt.opt = "512:4:16:16";
   bpred_reg_options(odb, &bpred_opt);
 
@@ -307,15 +303,22 @@ sim_aux_config(FILE *stream)		/* output stream */
   /* nada */
 }
 
+/* re-check timing options in a -sweep child */
+void
+sim_sweep_options(int argc, char **argv)	/* sweep configuration options */
+{
+  fatal("-sweep is not supported by this simulator");
+}
+
 /* dump simulator-specific auxiliary simulator statistics */
 void
 sim_aux_stats(FILE *stream)		/* output stream */
 {
   /* nada */
   print_counter(stream, "sim_elapsed_time", sim_elapsed_time, "simulation time in seconds");
-  print_rate(stream, "sim_insn_rate", (double)sim_num_insn/sim_elapsed_time, "simulation speed (insts/sec)");
 
   print_counter(stream, "sim_num_insn", sim_num_insn, "instructions simulated (fast-forwarding included)");
+  print_formula(stream, "sim_insn_rate", 1.0, "sim_num_insn", "sim_elapsed_time", "insn/s", "simulation speed (insts/sec)");
   print_counter(stream, "sim_sample_insn", sim_sample_insn, "instructions (in sample)");
   print_counter(stream, "sim_sample_int", sim_sample_insn_split[ic_icomp] + sim_sample_insn_split[ic_icomplong], "integer operations");
   print_counter(stream, "sim_sample_load", sim_sample_insn_split[ic_load], "loads");
@@ -326,8 +329,8 @@ sim_aux_stats(FILE *stream)		/* output stream */
   print_counter(stream, "sim_sample_sys", sim_sample_insn_split[ic_sys], "syscalls");
 
   print_counter(stream, "sim_cycle", sim_cycle, "cycles simulated");
-  print_rate(stream, "sim_CPI", (double)sim_cycle/sim_sample_insn, "CPI");
-  print_rate(stream, "sim_IPC", (double)sim_sample_insn/sim_cycle, "IPC");
+  print_formula(stream, "sim_CPI", 1.0, "sim_cycle", "sim_sample_insn", "cycle/insn", "CPI");
+  print_formula(stream, "sim_IPC", 1.0, "sim_sample_insn", "sim_cycle", "insn/cycle", "IPC");
 
   /* register cache stats */
   if (cache_dl1)
@@ -342,7 +345,18 @@ sim_aux_stats(FILE *stream)		/* output stream */
     cache_stats_print(cache_l2, stream);
 
  if (bpred)
-   bpred_stats_print(bpred, stream);
+   bpred_stats_print(bpred, sim_num_insn, stream);
+}
+
+/* fill in the running totals of the timing model */
+void
+sim_sample_totals(struct sim_sample_t *totals)
+{
+  totals->n_insn = sim_sample_insn;
+  totals->n_cycle = sim_cycle;
+  totals->n_dl1_access = totals->n_dl1_miss = 0;
+  if (cache_dl1)
+    cache_totals(cache_dl1, &totals->n_dl1_access, &totals->n_dl1_miss);
 }
 
 void
@@ -654,7 +668,7 @@ sim_sample(unsigned int n_insn)
       
       if (insn_progress && sim_sample_insn >= insn_progress)
 	{
-	  sim_print_stats(stderr);
+	  sim_print_progress(stderr);
 	  fflush(stderr);
 	  while (sim_sample_insn >= insn_progress)
 	    insn_progress += insn_progress_update;
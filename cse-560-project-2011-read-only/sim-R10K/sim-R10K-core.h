@@ -0,0 +1,6191 @@
+#ifndef SIM_R10K_CORE_H
+#define SIM_R10K_CORE_H
+
+/* the sim-R10K out-of-order timing core, shared by the sim-R10K
+   simulators.
+
+   like sim-R10K-lsq.h this is not a separately compiled module: each
+   simulator (sim-R10K.c, sim-R10K-reg.c, sim-R10K-power.c,
+   sim-R10K-reg-power.c) defines the features it wants and includes
+   this file once.  features that are not defined are preprocessed
+   away, so they add no work to the per-cycle pipeline stages.
+
+   build time features, defined by the including simulator:
+
+     SIM_R10K_CPR	checkpoint (CPR) commit, replaces the reorder
+			buffer with the checkpoint buffer
+     SIM_R10K_REGCACHE	two level physical register file, with an L1
+			register cache in front of the L2 register file
+     SIM_R10K_POWER	per access power accounting (see power.h)
+
+   CPR commit cannot be combined with the other features. */
+
+#if defined(SIM_R10K_CPR) && (defined(SIM_R10K_REGCACHE) || defined(SIM_R10K_POWER))
+#error SIM_R10K_CPR cannot be combined with SIM_R10K_REGCACHE or SIM_R10K_POWER
+#endif
+
+// #define RENAME_DEBUG
+#define INLINE
+#define STATIC
+#ifdef SIM_R10K_CPR
+#define SIZE 2048
+#endif /* SIM_R10K_CPR */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+#include <signal.h>
+
+#include "host.h"
+#include "misc.h"
+#include "machine.h"
+
+#ifndef TARGET_ALPHA
+#error This simulator is targeted to ALPHA ISA only
+#endif /* TARGET_ALPHA */
+
+#include "stats.h"
+#include "options.h"
+#include "memory.h"
+#include "cache.h"
+#include "loader.h"
+#include "syscall.h"
+#include "resource.h"
+#include "sim.h"
+#include "predec.h"
+#include "bpred.h"
+#include "adisambig.h"
+#include "fastfwd.h"
+#include "tseries.h"
+#include "pipetrace.h"
+#include "hprof.h"
+#include "cpistack.h"
+#include "histo.h"
+#include "critpath.h"
+#ifdef SIM_R10K_POWER
+#include "power.h"
+#endif /* SIM_R10K_POWER */
+#ifdef SIM_R10K_CPR
+
+//our function prototypes
+void CHECK_Init();
+int CHECK_Allocate(regnum_t *mapTable, md_addr_t checkpointPC);
+void CHECK_RemoveInstruction(int checkpoint, int insnType);
+void CHECK_tryCommit();
+void CHECK_erase(int checkpoint);
+void CHECK_getActiveMaps();
+void CHECK_revert(int checkpoint);
+int CHECK_isInUse(int checkpoint);
+void CHECK_dumpElements();
+void CHECK_dumpBuffer();
+void CHECK_dump();
+void REGS_add_regs_free_list (int checkpoint);
+void REGS_update_regs_checkpoint (int checkpoint);
+void REGS_revert_checkpoint (int checkpoint, regnum_t *map_table);
+#endif /* SIM_R10K_CPR */
+
+/* simulated registers */
+static struct regs_t regs;
+
+/* simulated memory */
+static struct mem_t *mem = NULL;
+
+/* simulator options */
+
+/* instruction fetch parameters */
+static int fetch_width;
+static int fetch_bpred_width;
+static int fetch_lat;
+
+/* rename parameters */
+static int rename_pregs_num;
+static int rename_lat;
+static int rename_width;
+#ifndef SIM_R10K_REGCACHE
+
+/* physical register file ports and read latency */
+static int pregfile_rwidth;
+static int pregfile_wwidth;
+static int pregfile_lat;
+#else /* SIM_R10K_REGCACHE */
+
+/* Physical Register Scheme */
+static bool_t l1_pregfile_cache;
+
+/* L1 register cache replacement policy */
+enum regcache_repl_t
+{
+  regcache_LRU,		/* least recently used */
+  regcache_USECOUNT,	/* fewest remaining consumers among the LRU ways */
+  regcache_NOBYPASS	/* LRU, values without pending readers are not cached at write */
+};
+static char *regcache_repl_opt;
+static enum regcache_repl_t regcache_repl;
+
+/* fill the L1 register cache with L2 resident source operands at rename */
+static bool_t regcache_prefetch;
+
+/* L1 Physical Register */
+static unsigned int l1_pregfile_size;
+static unsigned int l1_pregfile_rwidth;
+static unsigned int l1_pregfile_wwidth;
+static unsigned int l1_pregfile_lat;
+
+/* L2 Physical Register */
+static unsigned int l2_pregfile_size;
+static unsigned int l2_pregfile_rwidth;
+static unsigned int l2_pregfile_wwidth;
+static unsigned int l2_pregfile_lat;
+#endif /* SIM_R10K_REGCACHE */
+
+/* scheduling paramters */
+static bool_t sched_inorder;
+static bool_t sched_spec;
+static int sched_lat;
+static int sched_agen_lat;
+static int sched_fwd_lat;
+static int sched_width[sclass_NUM];
+static int sched_rs_num;
+
+/* memory disambiguation */
+static struct adisambig_opt_t sched_adisambig_opt;
+
+#ifndef SIM_R10K_CPR
+/* writeback parameters */
+static int writeback_width;
+static int writeback_ctrl_width;
+#endif /* !SIM_R10K_CPR */
+
+/* commit parameters */
+static int commit_width;
+static int commit_store_width;
+#ifndef SIM_R10K_CPR
+static int commit_ctrl_width;
+#endif /* !SIM_R10K_CPR */
+
+/* recover paramters */
+static int recover_width;
+#ifdef SIM_R10K_CPR
+
+/* allocate checkpoints at branches below this bpred confidence */
+static int recover_conf;
+#endif /* SIM_R10K_CPR */
+
+/* functional unit parameters (internal to module) */
+static struct respool_opt_t respool_opt;
+
+/* memory hierarchy parameters */
+static struct cache_opt_t cache_dl1_opt;
+static struct cache_opt_t cache_il1_opt;
+static struct cache_opt_t cache_l2_opt;
+static struct cache_opt_t dtlb_opt;
+static struct cache_opt_t itlb_opt;
+static int tlb_miss_lat;
+static int mem_lat;
+
+/* branch predictor parameters */
+static struct bpred_opt_t bpred_opt;
+
+/* counters and statistics */
+tick_t sim_cycle = 1;
+counter_t sim_num_insn = 0;
+#ifdef SIM_R10K_REGCACHE
+
+int l1_preg_readNum = 0, l2_preg_readNum = 0;
+int l1_preg_writeNum = 0, l2_preg_writeNum = 0;
+#endif /* SIM_R10K_REGCACHE */
+
+static counter_t n_insn_commit_sum;
+static counter_t n_insn_commit[ic_NUM];
+
+static counter_t n_insn_fetch;
+static counter_t n_insn_rename;
+static counter_t n_insn_exec[ic_NUM];
+
+static counter_t n_branch_misp;
+static counter_t n_load_squash;
+static counter_t n_load_dep_stall;
+static counter_t n_load_false_dep_stall;
+#ifdef SIM_R10K_REGCACHE
+
+static counter_t n_reg_read          = 0;
+static counter_t n_reg_writes       = 0;
+static counter_t n_reg_read_miss    = 0;
+static counter_t n_reg_writes_miss  = 0;
+static counter_t n_reg_evict        = 0;
+static counter_t n_reg_prefetch     = 0;
+static counter_t n_reg_prefetch_useful  = 0;
+static counter_t n_reg_prefetch_useless = 0;
+#endif /* SIM_R10K_REGCACHE */
+
+/* simulator structures */
+
+/* PREG_link_t: link to physical register.  Used to create transient
+   event and dependence lists.  Tag is used to invalidate a link on
+   the fly without checking the lists.  When a link is created,
+   link->tag is set equal to link->preg->tag.  If preg->tag is
+   incremented, all links to that preg become invalid. */
+struct PREG_link_t {
+  struct PREG_link_t *next;
+  struct preg_t *preg;
+  tag_t tag;
+
+  union {
+    tick_t when;
+    seq_t seq;
+    int opnum;
+  } x;
+};
+#ifdef SIM_R10K_CPR
+
+void PLINK_freeCheckpoint_list(struct PREG_link_t **queue, struct PREG_link_t *l, int checkpoint);
+#endif /* SIM_R10K_CPR */
+
+/* physical register: holds R10000 renamed values and dependence links
+   for register scheduling.  preg_np_t and preg_list_t are structure
+   for managing lists of pregs */
+struct preg_np_t 
+{
+  struct preg_t *next, *prev;
+};
+
+struct preg_list_t
+{
+  struct preg_t *head, *tail;
+  int num;
+};
+#ifdef SIM_R10K_REGCACHE
+
+enum reg_file_enum
+{
+  L1_PREG_FILE = 1,
+  L2_PREG_FILE = 2
+};
+#endif /* SIM_R10K_REGCACHE */
+
+struct preg_t
+{
+  /* free list */
+  struct preg_np_t flist;
+
+  regnum_t pregnum;
+  tag_t tag;
+
+  bool_t f_allocated;
+
+  /* these are the values */
+  union val_t val;
+
+  enum md_fault_t fault;
+
+  struct INSN_station_t *is;
+
+  tick_t when_written;
+#ifdef SIM_R10K_REGCACHE
+
+  bool_t             dirty;
+  bool_t             bypassValue;
+  int                latency;
+  struct preg_np_t   lru;		/* L1 register cache replacement order */
+  bool_t             f_prefetch;	/* prefetched into the L1, not read yet */
+  enum reg_file_enum regFile;
+  regnum_t           regCache;
+#endif /* SIM_R10K_REGCACHE */
+
+  struct PREG_link_t *odeps_head;
+  struct PREG_link_t *odeps_tail;
+#ifdef SIM_R10K_CPR
+
+  /* use counter */
+  int use;
+  /* unmapped flag */
+  int unmapped;
+
+  /* checkpoint associated with the physical register. When the checkpoint commits, check if the register can be freed */
+  int checkpoint;
+
+  /* count the number of instructions reading from this register. If this is 0, checkoint has committed and a new link from the logical register exist, free this register */
+  int read_counter;
+#endif /* SIM_R10K_CPR */
+};
+
+/* INSN_station_t are instruction descriptors, which are used as slot
+   occupiers in the IFQ and ROB */
+struct INSN_station_t
+{
+  struct INSN_station_t *prev;
+  struct INSN_station_t *next;
+  struct INSN_station_t *fnext;
+
+  const struct predec_insn_t *pdi;      /* decoded instruction */
+  md_addr_t PC;			        /* inst PC  */
+  md_addr_t NPC;		        /* next PC */
+  md_addr_t TPC;                        /* target PC */
+  md_addr_t PPC;		        /* predicted PC */
+
+  bool_t f_wrong_path;
+
+  struct LDST_station_t *ls;            /* LSQ entry */
+
+  bool_t f_rs;                          /* has a reservation station? */
+  bool_t f_sched;                       /* on the scheduler queue? */
+
+  bool_t f_bmisp;			/* mis-speculated branch */
+  bool_t f_mispredicted;		/* f_bmisp, but kept after resolution */
+  bool_t f_dmiss;			/* load missed in the D-cache/D-TLB */
+  struct bpred_state_t bp_pre_state;	/* bpred direction update info */
+
+  bool_t idep_ready[DEP_INUM];		/* input operand ready? */
+  tick_t time_ready[DEP_INUM];		/* input operand time */
+  regnum_t pregnums[DEP_NUM];       /* physical register holding result */
+  regnum_t fregnum;       /* physical register to free or commit */
+  seq_t dep_seq[DEP_INUM];		/* producers in flight at rename */
+
+  tag_t tag;			        /* RUU slot tag, increment to squash */
+  seq_t seq;			        /* used to sort the ready list
+                                           and tag inst */
+#ifdef SIM_R10K_REGCACHE
+
+  int    insnStall;
+  int    regReadLatency[DEP_INUM];
+  int    regWriteLatency[DEP_NUM];
+#endif /* SIM_R10K_REGCACHE */
+#ifdef SIM_R10K_CPR
+  bool_t allocate;
+  int checkpoint;
+#endif /* SIM_R10K_CPR */
+
+  struct
+  {
+    tick_t predicted;          /* branch predicted */
+    tick_t fetched;            /* fetched */
+    tick_t renamed;            /* put into window */
+    tick_t regread;
+    tick_t ready;
+    tick_t issued;
+    tick_t completed;
+    tick_t resolved;          /* resolved */
+    tick_t committed;          /* committed */
+  } when;         /* when did each of the timestamp  */
+};
+#ifdef SIM_R10K_CPR
+
+void REGS_removeReader(struct INSN_station_t *is);
+#endif /* SIM_R10K_CPR */
+
+/* Queue of INSN_station_t: used to implement the ROB and IFQ */
+struct INSN_queue_t 
+{
+  struct INSN_station_t *head, *tail;
+  int num, size;
+  counter_t count;
+};
+
+#include "sim-R10K-lsq.h"
+#ifdef SIM_R10K_CPR
+
+int hasSystemCall = FALSE;
+struct INSN_station_t *systemCallAddress;
+
+struct CHECK_element{
+  regnum_t *mapTable;
+  md_addr_t checkpointPC;
+  int numberOfInstructions;
+  int commitReady;
+  int inUse;
+  int total;
+  int insnTypeCounter[ic_NUM];
+  int insnCounter;
+};
+
+struct CHECK_buff{
+  int tail;       //points to the next free buffer entry.
+  int buffer[8];  //the actual buffer.
+};
+
+/* Simulator state */
+
+/* checkpoint buffer and elements */
+static struct CHECK_element checkpoint_elements[8];
+static struct CHECK_buff CHECK_buffer;
+#endif /* SIM_R10K_CPR */
+
+/* Simulator state */
+
+/* INSN_station_t freelist (simulator only, does not exist in actual procesor) */
+static struct INSN_station_t *INSN_flist = NULL;
+static int INSN_num = 0;
+
+/* PREG_link_t freelist (simulator only, does not exist in actual processor) */
+#define MAX_PREG_LINKS                    4096
+static struct PREG_link_t *plink_free_list;
+static int n_plink = 0;
+static int plink_num = 0;
+static int n_plink_asserts = 0;
+
+/* fetch state */
+static md_addr_t commit_NPC;
+static bool_t f_wrong_path;
+static md_addr_t fetch_PC;
+static tick_t fetch_resume;
+static tick_t rename_resume;
+
+/* logical registers (map table) */
+static regnum_t *lregs;
+
+/* physical register array and freelist (mirrors the one in the actual microarchitecture) */
+static struct preg_t *pregs;
+static struct preg_list_t pregs_flist;
+#ifdef SIM_R10K_REGCACHE
+static struct preg_list_t l1_pregs_flist;
+static struct preg_list_t l2_pregs_flist;
+
+/* L1 register cache entries in use, least recently used first */
+static struct preg_list_t l1_regcache_lru;
+#endif /* SIM_R10K_REGCACHE */
+
+/* reservation station tracker */
+static int rs_num;
+
+/* instruction fetch queue (IFQ) */
+static struct INSN_queue_t IFQ;
+#ifndef SIM_R10K_CPR
+/* reorder buffer (ROB) */
+static struct INSN_queue_t ROB;
+#endif /* !SIM_R10K_CPR */
+
+/* the ready instruction queue (queue from which instructions are scheduled) */
+static struct PREG_link_t *scheduler_queue = NULL;
+
+/* instructions on the scheduler queue, whose squashed nodes are only
+   dropped lazily, kept only for the -histo occupancy histogram */
+static int scheduler_num = 0;
+
+/* IS leaves the scheduler queue, with its reservation station when it
+   issues or is squashed */
+#define SCHED_LEAVE(IS)							\
+  { if ((IS)->f_sched) { (IS)->f_sched = FALSE; scheduler_num--; } }
+
+/* pending writeback event queue, sorted from soonest to latest event (in time), NOTE:
+   PREG_link nodes are used for the list so that it need not be updated during squash events */
+static struct PREG_link_t *writeback_queue = NULL;
+
+/* global sequence counter */
+static seq_t seq;
+
+/* caches and tlbs */
+static struct cache_t *cache_il1 = NULL;
+static struct cache_t *cache_dl1 = NULL;
+static struct cache_t *cache_l2 = NULL;
+static struct cache_t *itlb = NULL;
+static struct cache_t *dtlb = NULL;
+
+/* branch predictor */
+static struct bpred_t *bpred = NULL;
+
+static struct respool_t *respool = NULL;
+
+/* address disambiguation collision history table */
+static struct cht_t *cht = NULL;
+
+/* simulator implementation */
+
+/* INSN_station_t freelist and queue management functions */
+STATIC void
+INSN_init(void)
+{
+  int i;
+#ifdef SIM_R10K_CPR
+  int INSN_size = IFQ.size + SIZE + 1;
+#else /* !SIM_R10K_CPR */
+  int INSN_size = IFQ.size + ROB.size + 1;
+#endif /* SIM_R10K_CPR */
+
+  INSN_flist = (struct INSN_station_t *)mycalloc(INSN_size, sizeof(struct INSN_station_t));
+
+  for (i = 0; i < INSN_size - 1; i++)
+    INSN_flist[i].fnext = &INSN_flist[i+1];
+}
+
+STATIC INLINE struct INSN_station_t *
+INSN_alloc(void)
+{
+  struct INSN_station_t *is = INSN_flist;
+
+  if (is)
+    {
+      INSN_flist = is->fnext;
+      is->fnext = NULL;
+      INSN_num++;
+    }
+
+  return is;
+}
+
+/* write the pipetrace record of IS, which is leaving the machine */
+STATIC void
+INSN_ptrace(struct INSN_station_t *is)
+{
+  struct ptrace_rec_t rec;
+
+  rec.seq = is->seq;
+  rec.PC = is->PC;
+  rec.inst = is->pdi ? is->pdi->inst : 0;
+  rec.iclass = is->pdi ? is->pdi->iclass : ic_other;
+#ifdef SIM_R10K_CPR
+  rec.checkpoint = is->checkpoint;
+#else /* !SIM_R10K_CPR */
+  rec.checkpoint = -1;
+#endif /* SIM_R10K_CPR */
+  rec.flags = ((is->f_wrong_path ? PTRACE_WRONG_PATH : 0)
+               | (is->when.committed ? PTRACE_COMMITTED : 0)
+               | (is->f_mispredicted ? PTRACE_BMISP : 0)
+               | (is->f_dmiss ? PTRACE_DMISS : 0));
+  rec.when[pt_PREDICTED] = is->when.predicted;
+  rec.when[pt_FETCHED] = is->when.fetched;
+  rec.when[pt_RENAMED] = is->when.renamed;
+  rec.when[pt_REGREAD] = is->when.regread;
+  rec.when[pt_READY] = is->when.ready;
+  rec.when[pt_ISSUED] = is->when.issued;
+  rec.when[pt_COMPLETED] = is->when.completed;
+  rec.when[pt_RESOLVED] = is->when.resolved;
+  rec.when[pt_COMMITTED] = is->when.committed;
+  rec.when[pt_FREED] = sim_cycle;
+  ptrace_write(&rec);
+}
+
+/* record committed instruction IS for the critical path analysis */
+STATIC void
+INSN_critpath(struct INSN_station_t *is)
+{
+  struct critpath_insn_t ci;
+  int dep;
+
+  ci.seq = is->seq;
+  for (dep = DEP_I1; dep < DEP_INUM; dep++)
+    ci.dep_seq[dep] = is->dep_seq[dep];
+  ci.fetched = is->when.fetched;
+  ci.renamed = is->when.renamed;
+  ci.issued = is->when.issued;
+  ci.completed = is->when.completed;
+  ci.committed = is->when.committed;
+  ci.f_bmisp = is->f_mispredicted;
+  ci.f_dmiss = is->f_dmiss;
+  critpath_commit(&ci);
+}
+
+STATIC INLINE void
+INSN_free(struct INSN_station_t *is)
+{
+  tag_t tag = is->tag;
+  assert(is->prev == NULL && is->next == NULL);
+  if (ptrace_active)
+    INSN_ptrace(is);
+  memset((byte_t*)is, 0, sizeof(struct INSN_station_t));
+  is->tag = tag+1; /* squash */
+
+  is->fnext = INSN_flist;
+  INSN_flist = is;
+  INSN_num--;
+}
+
+STATIC INLINE void 
+INSN_enqueue(struct INSN_queue_t *q,
+	     struct INSN_station_t *is)
+{
+  is->prev = q->tail;
+  if (q->tail) q->tail->next = is;
+  else q->head = is;
+  q->tail = is;
+  
+  q->num++; 
+}
+
+STATIC INLINE void
+INSN_remove(struct INSN_queue_t *q,
+	   struct INSN_station_t *is)
+{
+  if (is->prev) is->prev->next = is->next;
+  if (is->next) is->next->prev = is->prev;
+
+  if (q->head == is) q->head = is->next;
+  if (q->tail == is) q->tail = is->prev;
+
+  is->next = is->prev = NULL;
+
+  q->num--;
+}
+#ifdef SIM_R10K_CPR
+
+STATIC INLINE void
+LDST_print(struct LDST_queue_t *q){
+  struct LDST_station_t *ls;
+  if(q){
+    fprintf(stdout,"~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~\n");
+    fprintf(stdout,"\n\nPRINTING LOAD STORE QUEUE POINTER: %p \n\n",q);
+  }
+  else{
+    fprintf(stdout,"QUEUE POINTER EMPTY!\n");
+    fprintf(stdout,"~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~\n");
+    return;
+  }
+  ls = q->head->next;
+  int i = 0;
+  while(ls){
+    fprintf(stdout,"PRINTING LDST ELEMENT: %d\n",i);
+    fprintf(stdout,"\tIS POINTER: %p\n",ls->is);
+    fprintf(stdout,"\t\tCHECKPOINT: %d\n",ls->is->checkpoint);
+    fprintf(stdout,"\t\tIS TYPE: %d\n",ls->is->pdi->iclass);
+    fprintf(stdout,"\t\tIS PC: %d\n",ls->is->PC);
+    i++;
+    ls=ls->next;
+  }
+  fprintf(stdout,"~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~\n");
+
+}
+/* setting all commits of stores */
+STATIC INLINE void
+ST_commits(struct LDST_queue_t *q, int checkpoint)
+{
+  /* head of LSQ */
+  struct LDST_station_t *ls = q->head;
+
+  /* traversing LSQ */
+  while(ls != NULL)
+  {
+    /* if we're no longer looking at the checkpoint, break */
+    if(ls->is->checkpoint != checkpoint)
+      break;
+    /*otherwise, set the commit of the store */
+    else
+      ls->commit = TRUE;
+    /* go to next element */
+    ls = ls->next;
+  }
+}
+
+/* remove invalid stores on checkpoint recovery */
+STATIC INLINE void
+ST_remove(struct LDST_queue_t *q, int checkpoint)
+{
+  /* head of LSQ */
+  struct LDST_station_t *ls = q->head;
+  struct LDST_station_t *lf;
+
+  /* looking for first instruction to remove */
+  while(ls != NULL)
+  {
+    if((ls->is->checkpoint == checkpoint) && (ls->commit == FALSE))
+      break;
+    else
+      ls = ls->next;
+  }
+
+  /* making sure to remove through the tail */
+  while(ls)
+  {
+	lf = ls;
+    /* remove from LSQ and go to next element */
+    ls = lf->next;
+    LDST_remove(q, lf, lf->is->pdi->iclass == ic_store);
+  }
+}
+
+STATIC INLINE void
+CHECK_Init(){
+
+  int i;
+  int n;
+  for ( i = 0; i<8; i++){
+    CHECK_buffer.buffer[i] = -1;
+    checkpoint_elements[i].mapTable = malloc(MD_TOTAL_REGS*sizeof(regnum_t));
+    checkpoint_elements[i].checkpointPC = 0;
+    checkpoint_elements[i].numberOfInstructions = 0;
+    checkpoint_elements[i].commitReady = FALSE;
+    checkpoint_elements[i].inUse = FALSE;
+    checkpoint_elements[i].total = 0;
+    checkpoint_elements[i].insnCounter = 0;
+
+    for (n=0;n<ic_NUM;n++){
+      checkpoint_elements[i].insnTypeCounter[n] = 0;
+    }
+
+  }
+  CHECK_buffer.tail = 0;
+  //      CHECK_buffer.buffer[0] = 0;
+  CHECK_Allocate(lregs, 0);
+}
+
+static int failures = 0;
+
+STATIC INLINE int
+CHECK_Allocate(regnum_t *mapTable, md_addr_t checkpointPC){
+  if (checkpoint_elements[CHECK_buffer.buffer[CHECK_buffer.tail-1]].numberOfInstructions == 0 && CHECK_buffer.tail-1 >= 0){
+    return TRUE;
+  }
+  fprintf(stdout, "ALLOCATING CHECKPOINT AND STUFF\n");
+  if(CHECK_buffer.tail <= 7){
+    int i;
+    for (i = 0;i<8;i++){
+      if (checkpoint_elements[i].inUse == FALSE){
+        CHECK_buffer.buffer[CHECK_buffer.tail] = i;
+        CHECK_erase(i);
+        CHECK_buffer.tail ++;
+        checkpoint_elements[i].inUse = TRUE;
+        //copy the map table.
+        memcpy(checkpoint_elements[i].mapTable,mapTable,MD_TOTAL_REGS*sizeof(regnum_t));
+        checkpoint_elements[i].checkpointPC = checkpointPC;
+
+        //update the physical register file to reflect new checkpoint numbers.
+        REGS_update_regs_checkpoint(i);
+        break;
+      }
+    }
+    fprintf(stdout, "CHECKPOINT %d ALLOCATED\n", CHECK_buffer.buffer[CHECK_buffer.tail-1]);
+    return TRUE;
+  }
+  else{
+    //The buffer is full.  Add to already allocated checkpoint.
+    fprintf(stdout, "CHECKPOINT ALLOCATE FULL\n");
+    failures++;
+    if(failures >10){
+      CHECK_dump();
+      panic("CHECKPOINT ALLOCATE FAILURE");
+    }
+    return FALSE;
+  }
+}
+
+STATIC INLINE int
+CHECK_AddInstruction(int insnType, struct INSN_station_t *insn){  //try to add the instruction to the current chkpnt.  If it doesn't work try to make another one.
+
+  //if(insnType != ic_store){
+    fprintf(stdout,"TYPE OF INSTRUCTION ADDED: %d\n",insnType);
+    if (insnType != ic_sys){
+      if (checkpoint_elements[CHECK_buffer.buffer[CHECK_buffer.tail-1]].numberOfInstructions >=256 || CHECK_buffer.tail == 0){
+        return -1;
+      }
+
+      checkpoint_elements[CHECK_buffer.buffer[CHECK_buffer.tail-1]].total++;
+      checkpoint_elements[CHECK_buffer.buffer[CHECK_buffer.tail-1]].numberOfInstructions++;
+      checkpoint_elements[CHECK_buffer.buffer[CHECK_buffer.tail-1]].commitReady=FALSE;
+
+    }
+    else{
+      hasSystemCall = TRUE;
+      systemCallAddress = insn;
+    }
+
+    fprintf(stdout,"INSTRUCTION CHECKPOINT: %d\n", CHECK_buffer.buffer[CHECK_buffer.tail-1]);
+    return CHECK_buffer.buffer[CHECK_buffer.tail-1];
+  //}
+}
+
+STATIC INLINE void
+CHECK_RemoveInstruction(int checkpoint, int insnType){
+
+  //if (insnType != ic_sys){
+    checkpoint_elements[checkpoint].numberOfInstructions--;
+
+    if(insnType != ic_load && insnType != ic_store && insnType != ic_prefetch){
+
+      checkpoint_elements[checkpoint].insnTypeCounter[insnType]++;
+      checkpoint_elements[checkpoint].insnCounter++;
+    }
+
+    if (checkpoint_elements[checkpoint].numberOfInstructions == 0){
+      //if(CHECK_AllStores(checkpoint)){
+        fprintf(stdout, "COMMIT TIME, CHECKPOINT: %d\n", checkpoint);
+        checkpoint_elements[checkpoint].commitReady = TRUE;
+        CHECK_tryCommit();
+      //}
+    }
+  //}
+}
+
+/*STATIC INLINE int
+CHECK_AllStores(int checkpoint){
+  struct LDST_station_t *l = LSQ.head;
+
+  while(l){
+    if((l->is->checkpoint == checkpoint) && (l->is->pdi->iclass == ic_store)){
+      if(!STORE_ADDR_READY(l) || !STORE_DATA_READY(l)){
+        return FALSE;
+      }
+    }
+    l = l->next;
+  }
+  return TRUE;
+}*/
+
+STATIC INLINE void
+CHECK_tryCommit(){
+  CHECK_dumpBuffer();
+  if (checkpoint_elements[CHECK_buffer.buffer[0]].commitReady == TRUE){
+    //commit the first checkpoint
+    //Tell LSQ to start committing.
+    ST_commits(&LSQ, CHECK_buffer.buffer[0]);
+    //Free the Registers associated with this checkpoint.
+    fprintf(stdout,"CHECKPOINT %d COMMITTED\n",CHECK_buffer.buffer[0]);
+
+
+    //update the counters for the number of instructions committed.
+    int n;
+    for (n=0;n<ic_NUM;n++){
+      n_insn_commit[n] += checkpoint_elements[CHECK_buffer.buffer[0]].insnTypeCounter[n];
+    }
+
+    sim_num_insn += checkpoint_elements[CHECK_buffer.buffer[0]].insnCounter;
+    n_insn_commit_sum+= checkpoint_elements[CHECK_buffer.buffer[0]].insnCounter;
+
+    CHECK_erase(CHECK_buffer.buffer[0]);
+
+    //remove checkpoint tags from the register and reclaim them if we can.
+    REGS_add_regs_free_list(CHECK_buffer.buffer[0]);
+
+    //update the map checkpoint buffer and the checkpoint itself.
+    int i;
+    for (i = 1;i<CHECK_buffer.tail;i++){
+      CHECK_buffer.buffer[i-1] = CHECK_buffer.buffer[i];
+      fprintf(stdout,"REORDER BUFFER: \n");
+
+    }
+    CHECK_buffer.buffer[CHECK_buffer.tail-1] = -1;
+    CHECK_buffer.tail--;
+
+    CHECK_tryCommit();
+  }
+  else{
+    //oldest checkpoint can't be committed yet.
+    //wait.
+  }
+}
+
+STATIC INLINE void
+CHECK_erase(int checkpoint){
+  checkpoint_elements[checkpoint].inUse = FALSE;
+  checkpoint_elements[checkpoint].numberOfInstructions = 0;
+  checkpoint_elements[checkpoint].commitReady = FALSE;
+  checkpoint_elements[checkpoint].insnCounter = 0;
+  checkpoint_elements[checkpoint].checkpointPC = 0;
+  int i;
+  for (i=0;i<ic_NUM;i++){
+    checkpoint_elements[checkpoint].insnTypeCounter[i] = 0;
+  }
+
+  checkpoint_elements[checkpoint].total = 0;
+}
+
+STATIC INLINE void
+CHECK_getActiveMaps(){
+  //this will return all active registers if we need it.  Not sure that we will, though.
+}
+
+
+
+STATIC INLINE void
+CHECK_revert(int checkpoint){
+  fprintf(stdout,"CHECKPOINT %d REVERTED\n",checkpoint);
+  //Tell the LSQ to kill everything passed this checkpoint.
+  ST_remove(&LSQ, checkpoint);
+  CHECK_dumpBuffer();
+  //Tell the register file to erase everything but this map table (and previous ones).
+  //Previous ones can be figured out with isInUse(int checkpoint);
+  REGS_revert_checkpoint(checkpoint,checkpoint_elements[checkpoint].mapTable);
+  int newTail = 0;
+  //update the checkpoint buffer.
+  int found = FALSE;
+  int i;
+  for (i =0;i<CHECK_buffer.tail;i++){
+
+    if (found==TRUE){
+      //Squash instructions for this checkpoint.
+      CHECK_erase(CHECK_buffer.buffer[i]);
+      PLINK_freeCheckpoint_list(&scheduler_queue, scheduler_queue,CHECK_buffer.buffer[i]);
+      PLINK_freeCheckpoint_list(&writeback_queue, writeback_queue,CHECK_buffer.buffer[i]);
+      CHECK_buffer.buffer[i] = -1;
+
+
+    }
+
+    if (CHECK_buffer.buffer[i] == checkpoint){
+      checkpoint_elements[checkpoint].commitReady = FALSE;
+      fprintf(stdout, "COMMIT READY: %d\n", checkpoint_elements[checkpoint].commitReady);
+      fetch_PC = checkpoint_elements[checkpoint].checkpointPC;
+
+      //Squash instructions
+      PLINK_freeCheckpoint_list(&scheduler_queue, scheduler_queue,CHECK_buffer.buffer[i]);;
+      PLINK_freeCheckpoint_list(&writeback_queue, writeback_queue,CHECK_buffer.buffer[i]);
+
+      newTail = i+1;
+      found = TRUE;
+      checkpoint_elements[checkpoint].insnCounter = 0;
+      checkpoint_elements[checkpoint].numberOfInstructions = 0;
+
+      hasSystemCall = FALSE;
+      systemCallAddress = NULL;
+    }
+
+
+  }
+  CHECK_buffer.tail = newTail;
+  if (found == FALSE){
+    panic("Checkpoint to revert %d not found!!",checkpoint);
+  }
+  CHECK_dumpBuffer();
+}
+
+STATIC INLINE int
+CHECK_isInUse(int checkpoint){
+
+  return checkpoint_elements[checkpoint].inUse;
+
+}
+
+//print everything!
+STATIC INLINE void
+CHECK_dumpElements(){
+  int i;
+  for (i = 0;i<8;i++){
+    fprintf(stdout,"checkpoint %d:\n", i);
+    fprintf(stdout,"map Table: (unimplemented)\n" );
+    fprintf(stdout,"checkpoint PC %d\n", checkpoint_elements[i].checkpointPC);
+    fprintf(stdout,"checkpoint number of instructions: %d\n", checkpoint_elements[i].numberOfInstructions);
+    fprintf(stdout,"checkpoint commit ready: %d\n", checkpoint_elements[i].commitReady);
+    fprintf(stdout,"checkpoint in use: %d\n", checkpoint_elements[i].inUse);
+    fprintf(stdout,"total instructions in checkpoint: %d\n", checkpoint_elements[i].total);
+  }
+}
+
+STATIC INLINE void
+CHECK_dumpBuffer(){
+  int i;
+  fprintf(stdout,"\n\nCheckpoint Buffer:\n");
+  fprintf(stdout,"Tail: %d\n",CHECK_buffer.tail);
+  for (i = 0;i<8;i++){
+    fprintf(stdout, "%d\n", CHECK_buffer.buffer[i]);
+  }
+}
+
+STATIC INLINE void
+CHECK_dump(){
+  CHECK_dumpElements();
+  CHECK_dumpBuffer();
+}
+#endif /* SIM_R10K_CPR */
+
+
+/* PREG_link_t management functions */
+#define PLINK_set(LINK, PREG)                                       \
+  { (LINK)->next = NULL; (LINK)->preg = (PREG); if (PREG) { (LINK)->tag = (PREG)->tag; } }          
+
+#define PLINK_valid(LINK)                                          \
+  ((LINK)->preg && (LINK)->tag == (LINK)->preg->tag)
+
+STATIC void
+PLINK_assert(void)
+{
+  int n_free_link = 0;
+  int n_reg_link = 0, n_valid_reg_link = 0;
+  int n_writeback_link = 0, n_valid_writeback_link = 0;
+  int n_scheduler_link = 0, n_valid_scheduler_link = 0;
+
+  regnum_t pregnum;
+  struct PREG_link_t *l;
+
+  n_plink_asserts++;
+
+  for (l = plink_free_list; l; l = l->next, n_free_link++);
+  if (n_free_link != n_plink)
+    panic("IS_link screwup!");
+    
+  for (pregnum = 0; pregnum < rename_pregs_num; pregnum++)
+    for (l = pregs[pregnum].odeps_head; l; l = l->next, n_reg_link++)
+      if (PLINK_valid(l)) n_valid_reg_link++;
+  
+  for (l = writeback_queue; l; l = l->next, n_writeback_link++)
+    if (PLINK_valid(l)) n_valid_writeback_link++;
+
+  for (l = scheduler_queue; l; l = l->next, n_scheduler_link++)
+    if (PLINK_valid(l)) n_valid_scheduler_link++;
+
+  if (n_reg_link + n_writeback_link + n_scheduler_link + n_plink != MAX_PREG_LINKS)
+    panic("leaking IS_links");
+}
+
+/* free an IS link record */
+STATIC INLINE void
+PLINK_free(struct PREG_link_t *l)
+{ 
+  l->preg = NULL; l->tag = 0;
+  l->next = plink_free_list;
+  plink_free_list = l;
+  n_plink++;
+  plink_num--;
+}
+
+/* free an IS link list */
+STATIC INLINE void
+PLINK_free_list(struct PREG_link_t *l)
+{  
+  struct PREG_link_t *lf;
+  while (l)
+    {
+      lf = l;
+      l = l->next;
+      PLINK_free(lf);
+    }
+}
+#ifdef SIM_R10K_CPR
+
+/*
+STATIC int
+temp(struct PREG_link_t *lc)
+{
+  fprintf(stdout, "aasdfadlfasdf: %d\n", lc->preg->is->checkpoint);
+  return lc->preg->is->checkpoint;
+
+}*/
+
+STATIC INLINE void
+PLINK_printList(struct PREG_link_t *l){
+
+
+  int i = 0;
+  fprintf(stdout,"~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~\n");
+
+  if (!l){
+    fprintf(stdout,"LIST IS EMPTY.\n");
+    fprintf(stdout,"~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~\n");
+    return;
+  }
+  else{
+    fprintf(stdout,"PRINTING LIST WITH POINTER: %p\n",l);
+  }
+
+  if (l==writeback_queue){
+    fprintf(stdout,"THIS APPEARS TO BE THE WRITEBACK QUEUE:\n");
+  }
+  if (l==scheduler_queue){
+    fprintf(stdout,"THIS APPEARS TO BE THE SCHEDULER QUEUE:\n");
+  }
+  while(l){
+    fprintf(stdout,"\n\tLIST ELEMENT: %d WITH POINTER: %p\n",i,l);
+    fprintf(stdout,"\tNEXT ELEMENT POINTER: %p\n",l->next);
+    fprintf(stdout,"\t\tPREG POINTER: %p\n",l->preg);
+    if (l->preg){
+      fprintf(stdout,"\t\t\tIS POINTER: %p\n",l->preg->is);
+      if(l->preg->is){
+        fprintf(stdout,"\t\t\t\tIS CHECKPOINT: %d\n",l->preg->is->checkpoint);
+        fprintf(stdout,"\t\t\t\tIS TYPE: %d\n",l->preg->is->pdi->iclass);
+        fprintf(stdout,"\t\t\t\tIS PC: %d\n",l->preg->is->PC);
+      }
+      else{
+        fprintf(stdout,"\t\t\t\tIS NOT VALID.\n");
+      }
+    }
+    else{
+      fprintf(stdout,"\t\t\tPREG NOT VALID.\n");
+      break;
+    }
+
+    i++;
+    l = l->next;
+  }
+  fprintf(stdout,"~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~\n");
+}
+
+STATIC INLINE void
+PLINK_freeCheckpoint_list(struct PREG_link_t **queue, struct PREG_link_t *l, int checkpoint)
+{
+  struct PREG_link_t *lf;
+  struct PREG_link_t *lc = l;
+  struct PREG_link_t *head;
+  int currentCheckpoint;
+  currentCheckpoint = -1;
+
+  fprintf(stdout,"\n\nPLINK_freeCheckpoint REVERTING: %d\n",checkpoint);
+
+  if(l)
+  {
+
+
+    if(lc->preg){
+      currentCheckpoint = lc->preg->is->checkpoint;
+    }
+    else{
+      currentCheckpoint = checkpoint;
+    }
+
+    if(currentCheckpoint == checkpoint)
+    {
+      lf = lc;
+      lc = lc->next;
+      PLINK_free(lf);
+      while(lc)
+      {
+        lf = lc;
+
+        if(lc->preg){
+          currentCheckpoint = lc->preg->is->checkpoint;
+        }
+        else{
+          currentCheckpoint = checkpoint;
+
+        }
+
+        if(currentCheckpoint == checkpoint)
+        {
+          lc = lc->next;
+          PLINK_free(lf);
+
+          if(!lc){
+
+            *queue = NULL;
+
+            return;
+          }
+        }
+        else
+        {
+          *queue = lc->next;
+
+          break;
+        }
+      }
+    }
+
+    if(!lc)
+    {
+      *queue = NULL;
+      return;
+    }
+
+    while (lc->next)
+    {
+
+      lf = lc->next;
+      if(lf){
+        if(lf->preg){
+          currentCheckpoint = lf->preg->is->checkpoint;
+        }
+        else{
+          currentCheckpoint = checkpoint;
+        }
+      }
+
+      if(lf && currentCheckpoint == checkpoint)
+      {
+        lc->next = lf->next;
+        lf = lc;
+        PLINK_free(lf);
+      }
+      else
+      {
+        lf = lc;
+        lc = lc->next;
+      }
+    }
+
+    if(lc->preg){
+      currentCheckpoint = lc->preg->is->checkpoint;
+    }
+    else{
+      currentCheckpoint = checkpoint;
+    }
+
+    if(lc && lc->preg->is->checkpoint == checkpoint)
+    {
+
+      lf->next = NULL;
+      PLINK_free(lc);
+    }
+  }
+
+}
+#endif /* SIM_R10K_CPR */
+
+STATIC void
+PLINK_purge(void)
+{
+  regnum_t pregnum;
+  struct  PREG_link_t *l, *pl, *nl;
+
+  for (pregnum = 0; pregnum < rename_pregs_num; pregnum++)
+    for (pl = NULL, l = pregs[pregnum].odeps_head; l; l = nl)
+      {
+	nl = l->next;
+	if (!PLINK_valid(l))
+	  {
+	    if (pl) pl->next = nl;
+	    else pregs[pregnum].odeps_head = nl;
+
+	    if (l == pregs[pregnum].odeps_tail)
+	      pregs[pregnum].odeps_tail = pl;
+
+	    PLINK_free(l);
+	  }
+	else
+	  {
+	    /* advance trailing pointer */
+	    pl = l;
+	  }
+      }
+
+  for (pl = NULL, l = writeback_queue; l; l = nl)
+    {
+      nl = l->next;
+      if (!PLINK_valid(l))
+	{
+	  if (pl) pl->next = nl;
+	  else writeback_queue = nl;
+	  PLINK_free(l);
+	}
+      else
+	{
+	  pl = l;
+	}
+    }
+
+  for (pl = NULL, l = scheduler_queue; l; l = nl)
+    {
+      nl = l->next;
+      if (!PLINK_valid(l))
+	{
+	  if (pl) pl->next = nl;
+	  else scheduler_queue = nl;
+	  PLINK_free(l);
+	}
+      else
+	{
+	  pl = l;
+	}
+    }
+
+  PLINK_assert();
+}
+
+/* get a new IS link record */
+STATIC INLINE struct PREG_link_t *
+PLINK_new(void)			
+{ 
+  struct PREG_link_t *l;
+
+  if (!plink_free_list)
+    {
+      PLINK_purge();
+      if (!plink_free_list)
+	panic("out of is links");
+    }
+  l = plink_free_list;
+
+  plink_free_list = l->next;
+  l->next = NULL;
+  n_plink--;
+  plink_num++;
+  return l;
+}
+
+/* initialize the free IS_LINK pool */
+STATIC void
+PLINK_init(int nlinks)			/* total number of IS_LINK available */
+{
+  int i;
+
+  plink_free_list = (struct PREG_link_t *) mycalloc (nlinks, sizeof(struct PREG_link_t));
+  if (!plink_free_list)
+    fatal("out of virtual memory");
+    
+  for (i=0; i < nlinks - 1; i++)
+    plink_free_list[i].next = &plink_free_list[i+1];
+
+  n_plink = nlinks;
+}
+
+
+
+
+/* a reservation station link: this structure links elements of a RUU
+   reservation station list; used for ready instruction queue, event queue, and
+   output dependency lists; each RS_LINK node contains a pointer to the RUU
+   entry it references along with an instance tag, the RS_LINK is only valid if
+   the instruction instance tag matches the instruction RUU entry instance tag;
+   this strategy allows entries in the RUU can be squashed and reused without
+   updating the lists that point to it, which significantly improves the
+   performance of (all to frequent) squash events */
+
+#define LE_IN_LIST(LE, LNAME, LIST) \
+   ((LIST)->num > 0 && ((LE)->LNAME.prev || (LE)->LNAME.next || (LE) == (LIST)->head || (LE) == (LIST)->tail))
+
+#define LE_UNCHAIN(LE, LNAME, LIST) \
+   { \
+   if (!LE_IN_LIST(LE, LNAME, LIST)) panic("not in ht"); \
+   if ((LE)->LNAME.prev) (LE)->LNAME.prev->LNAME.next = (LE)->LNAME.next; \
+   if ((LE)->LNAME.next) (LE)->LNAME.next->LNAME.prev = (LE)->LNAME.prev; \
+   if ((LE) == (LIST)->head) (LIST)->head = (LE)->LNAME.next; \
+   if ((LE) == (LIST)->tail) (LIST)->tail = (LE)->LNAME.prev; \
+   (LE)->LNAME.next = (LE)->LNAME.prev = NULL; \
+   (LIST)->num--; \
+   if ((LIST)->num < 0) panic("list->num < 0"); \
+   }
+
+#define LE_CHAIN(LE, LNAME, LIST) \
+   { \
+   if (LE_IN_LIST(LE, LNAME, LIST)) panic("le already in list"); \
+   if ((LIST)->tail) (LIST)->tail->LNAME.next = (LE); \
+   (LE)->LNAME.prev = (LIST)->tail; \
+   (LIST)->tail = (LE); \
+   if (!(LIST)->head) (LIST)->head = (LE); \
+   (LIST)->num++; \
+   } 
+
+
+
+/*
+ * cache/TLB miss handlers
+ */
+
+STATIC unsigned int		        /* latency of block access */
+null_miss_handler(enum mem_cmd_t cmd,	/* access cmd, Read or Write */
+		  md_addr_t baddr,	/* block address to access */
+		  unsigned int bsize,	/* size of block to access */
+		  tick_t when,
+		  bool_t miss_info[ct_NUM])	
+{
+  return 0;
+}
+
+STATIC unsigned int		        /* latency of block access */
+tlb_miss_handler(enum mem_cmd_t cmd,	/* access cmd, Read or Write */
+		 md_addr_t baddr,	/* block address to access */
+		 unsigned int bsize,	/* size of block to access */
+		 tick_t when,
+		 bool_t miss_info[ct_NUM])
+{
+  /* fake translation, for now.  Return tlb miss latency */
+  return tlb_miss_lat;
+}
+
+STATIC unsigned int		        /* latency of block access */
+l2_miss_handler(enum mem_cmd_t cmd,	/* access cmd, Read or Write */
+		md_addr_t baddr,	/* block address to access */
+		unsigned int bsize,	/* size of block to access */
+		tick_t when,
+		bool_t miss_info[ct_NUM])
+{
+#ifdef SIM_R10K_POWER
+  int i;
+
+  power_count_access(ps_L2_TAG, /* write_f */cmd != mc_WRITE, /* hard_count_f */FALSE);
+  for (i = 0; i < (bsize * 8) / /* bus_l3_opt.width */MD_VADDR_SIZE; i++)
+    power_count_access(ps_L2_DATA, /* write_f */cmd != mc_WRITE, /* hard_count_f */FALSE);
+#endif /* SIM_R10K_POWER */
+
+  return cmd == mc_READ ? mem_lat : 0;
+}
+
+STATIC unsigned int		        /* latency of block access */
+l1_miss_handler(enum mem_cmd_t cmd,	/* access cmd, Read or Write */
+		md_addr_t baddr,	/* block address to access */
+		unsigned int bsize,	/* size of block to access */
+		tick_t when,
+		bool_t miss_info[ct_NUM])
+{
+  int lat = 0;
+
+  if (cache_l2)
+    lat = cache_access(cache_l2, cmd, baddr, bsize, when + lat, miss_info, l2_miss_handler);
+  else
+    lat = mem_lat;
+
+  return cmd == mc_READ ? lat : 0;
+}
+
+#ifdef SIM_R10K_POWER
+/* the power build wraps the L1 and TLB miss handlers to count the
+   refill accesses, the latencies are those of the handlers above */
+
+STATIC unsigned int		        /* latency of block access */
+il1_miss_handler(enum mem_cmd_t cmd,	/* access cmd, Read or Write */
+		 md_addr_t baddr,	/* block address to access */
+		 unsigned int bsize,	/* size of block to access */
+		 tick_t when,
+		 bool_t miss_info[ct_NUM])
+{
+  int i;
+  unsigned int lat = l1_miss_handler(cmd, baddr, bsize, when, miss_info);
+
+  if (cache_l2)
+    {
+      power_count_access(ps_L2_TAG, /* write_f */FALSE, /* hard_count_f */FALSE);
+      for (i = 0; i < (bsize * 8) / MD_VADDR_SIZE; i++)
+	power_count_access(ps_L2_DATA, /* write_f */FALSE, /* hard_count_f */FALSE);
+    }
+
+  power_count_access(ps_IL1_TAG, /* write_f */TRUE, /* hard_count_f */FALSE);
+  for (i = 0; i < (bsize * 8) / MD_VADDR_SIZE; i++)
+    power_count_access(ps_IL1_DATA, /* write_f */TRUE, /* hard_count_f */FALSE);
+
+  return lat;
+}
+
+STATIC unsigned int		        /* latency of block access */
+dl1_miss_handler(enum mem_cmd_t cmd,	/* access cmd, Read or Write */
+		 md_addr_t baddr,	/* block address to access */
+		 unsigned int bsize,	/* size of block to access */
+		 tick_t when,
+		 bool_t miss_info[ct_NUM])
+{
+  int i;
+  unsigned int lat = l1_miss_handler(cmd, baddr, bsize, when, miss_info);
+
+  /* writebacks write the L2 and read the L1, refills the reverse */
+  if (cache_l2)
+    {
+      power_count_access(ps_L2_TAG, /* write_f */FALSE, /* hard_count_f */FALSE);
+      for (i = 0; i < (bsize * 8) / MD_VADDR_SIZE; i++)
+	power_count_access(ps_L2_DATA, /* write_f */cmd == mc_WRITE, /* hard_count_f */FALSE);
+    }
+
+  power_count_access(ps_DL1_TAG, /* write_f */cmd != mc_WRITE, /* hard_count_f */FALSE);
+  for (i = 0; i < (bsize * 8) / MD_VADDR_SIZE; i++)
+    power_count_access(ps_DL1_DATA, /* write_f */cmd != mc_WRITE, /* hard_count_f */FALSE);
+
+  return lat;
+}
+
+STATIC unsigned int		        /* latency of block access */
+itlb_miss_handler(enum mem_cmd_t cmd,	/* access cmd, Read or Write */
+		  md_addr_t baddr,	/* block address to access */
+		  unsigned int bsize,	/* size of block to access */
+		  tick_t when,
+		  bool_t miss_info[ct_NUM])
+{
+  if (cache_l2)
+    {
+      power_count_access(ps_L2_TAG, /* write_f */FALSE, /* hard_count_f */FALSE);
+      power_count_access(ps_L2_DATA, /* write_f */FALSE, /* hard_count_f */FALSE);
+    }
+
+  power_count_access(ps_ITLB, /* write_f */TRUE, /* hard_count_f */TRUE);
+  return tlb_miss_handler(cmd, baddr, bsize, when, miss_info);
+}
+
+STATIC unsigned int		        /* latency of block access */
+dtlb_miss_handler(enum mem_cmd_t cmd,	/* access cmd, Read or Write */
+		  md_addr_t baddr,	/* block address to access */
+		  unsigned int bsize,	/* size of block to access */
+		  tick_t when,
+		  bool_t miss_info[ct_NUM])
+{
+  if (cache_l2)
+    {
+      power_count_access(ps_L2_TAG, /* write_f */FALSE, /* hard_count_f */FALSE);
+      power_count_access(ps_L2_DATA, /* write_f */FALSE, /* hard_count_f */FALSE);
+    }
+
+  power_count_access(ps_DTLB, /* write_f */TRUE, /* hard_count_f */FALSE);
+  return tlb_miss_handler(cmd, baddr, bsize, when, miss_info);
+}
+#else /* !SIM_R10K_POWER */
+#define il1_miss_handler	l1_miss_handler
+#define dl1_miss_handler	l1_miss_handler
+#define itlb_miss_handler	tlb_miss_handler
+#define dtlb_miss_handler	tlb_miss_handler
+#endif /* SIM_R10K_POWER */
+
+
+/* miss handlers for the cache warmup phases */
+STATIC unsigned int		        /* latency of block access */
+warmup_l1_miss_handler(enum mem_cmd_t cmd,	/* access cmd, Read or Write */
+		       md_addr_t baddr,	/* block address to access */
+		       unsigned int bsize,	/* size of block to access */
+		       tick_t when,
+		       bool_t miss_info[ct_NUM])	
+{
+  if (cache_l2)
+    cache_access(cache_l2, cmd, baddr, bsize, when, NULL, null_miss_handler);
+
+  return 0;
+}
+
+STATIC void 
+warmup_handler(const struct predec_insn_t *pdi)
+{
+  if (cache_il1)
+    cache_access(cache_il1, mc_READ, regs.PC, sizeof(md_inst_t), 0, NULL, warmup_l1_miss_handler);
+
+  if (itlb)
+    cache_access(itlb, mc_READ, regs.PC, sizeof(md_inst_t), 0, NULL, null_miss_handler);
+
+  if (pdi->iclass == ic_load || pdi->iclass == ic_store || pdi->iclass == ic_prefetch)
+    {
+      enum mem_cmd_t dl1_cmd = (pdi->iclass == ic_load) ? mc_READ : (pdi->iclass == ic_store ? mc_WRITE : mc_PREFETCH);
+      enum mem_cmd_t dtlb_cmd = (pdi->iclass == ic_load || pdi->iclass == ic_store) ? mc_READ : mc_PREFETCH;
+      if (cache_dl1)
+	cache_access(cache_dl1, dl1_cmd, regs.addr, regs.dsize, 0, NULL, warmup_l1_miss_handler);
+      if (dtlb)
+	cache_access(dtlb, dtlb_cmd, regs.addr, regs.dsize, 0, NULL, null_miss_handler);
+    }
+  else if (pdi->iclass == ic_ctrl)
+    {
+      if (bpred)
+	{
+	  struct bpred_state_t bpred_pre_state;
+	  md_addr_t ppc;
+	  ppc = bpred_lookup(bpred, regs.PC, pdi->poi.op, &bpred_pre_state);
+	  if (ppc != regs.NPC)
+	    bpred_recover(bpred, regs.PC, pdi->poi.op, regs.NPC, &bpred_pre_state);
+	  
+	  bpred_update(bpred, regs.PC, pdi->poi.op, regs.NPC, regs.TPC, ppc, &bpred_pre_state);
+	}
+    }
+}
+
+/* the power build keeps its bandwidth and register file port limits by
+   default, the power model sizes its structures with them */
+#ifdef SIM_R10K_POWER
+#define POWER_DEFAULT(N)	(N)
+#else /* !SIM_R10K_POWER */
+#define POWER_DEFAULT(N)	0
+#endif /* SIM_R10K_POWER */
+
+/* register simulator-specific options */
+void
+sim_reg_options(struct opt_odb_t *odb)
+{
+  opt_reg_header(odb,
+		 "sim-R10K: This simulator implements an out-of-order issue\n"
+		 "superscalar processor with a two-level memory system and speculative\n"
+		 "execution.  This simulator is a performance simulator, tracking the\n"
+		 "latency of all pipeline operations.\n"
+		 );
+
+  /* branch predictor options */
+  bpred_default_options(&bpred_opt);
+  bpred_reg_options(odb, &bpred_opt);
+
+  /* memory hierarchy options */
+
+  /* caches & tlbs */
+  cache_dl1_opt.ct = ct_L1;
+  cache_dl1_opt.name = "dl1";
+  cache_dl1_opt.opt = "512:32:2:l";
+  cache_reg_options(odb, &cache_dl1_opt);
+
+  dtlb_opt.ct = ct_TLB;
+  dtlb_opt.name = "dtlb";
+  dtlb_opt.opt = "32:4096:4:l";
+  cache_reg_options(odb, &dtlb_opt);
+
+  cache_il1_opt.ct = ct_L1;
+  cache_il1_opt.name = "il1";
+  cache_il1_opt.opt = "512:32:2:l";
+  cache_reg_options(odb, &cache_il1_opt);
+
+  itlb_opt.ct = ct_TLB;
+  itlb_opt.name = "itlb";
+  itlb_opt.opt = "32:4096:4:l";
+  cache_reg_options(odb, &itlb_opt);
+
+  cache_l2_opt.ct = ct_L2;
+  cache_l2_opt.name = "l2";
+  cache_l2_opt.opt = "1024:128:8:l";
+  cache_reg_options(odb, &cache_l2_opt);
+
+  /* TLB options */
+  opt_reg_int(odb, "-tlb:mlat",
+	      "inst/data TLB miss latency (in cycles)",
+	      &tlb_miss_lat, /* default */30,
+	      /* print */TRUE, /* format */NULL);
+
+  /* memory latency */
+  opt_reg_int(odb, "-mem:hlat", "memory access latency",
+	      &mem_lat, /* default */70,
+	      /* print */TRUE, /* format */NULL);
+
+  /* fetch options */
+  opt_reg_int(odb, "-fetch:width", "instruction fetch queue size (in insts)",
+	      &fetch_width, /* default */4,
+	      /* print */TRUE, /* format */NULL);
+
+  opt_reg_int(odb, "-fetch:bpred:width",
+	      "branch prediction bandwidth (branch / cycle, 0 = no limit)",
+	      &fetch_bpred_width, /* default */POWER_DEFAULT(2),
+	      /* print */TRUE, /* format */NULL);
+
+  opt_reg_int(odb, "-fetch:ifq:size", "instruction fetch queue size (in insts)",
+	      &IFQ.size, /* default */4,
+	      /* print */TRUE, /* format */NULL);
+
+  opt_reg_int(odb, "-fetch:lat",
+	      "number of pipeline stages in fetch",
+	      &fetch_lat, /* default */1,
+	      /* print */TRUE, /* format */NULL);
+
+#ifndef SIM_R10K_REGCACHE
+  /* the register cache build sizes the register file with
+     -l1_pregfile:size and -l2_pregfile:size */
+  opt_reg_int(odb, "-rename:pregs:num",
+	      "number of physical registers",
+	      &rename_pregs_num, /* default */256,
+	      /* print */TRUE, /* format */NULL);
+
+  opt_reg_int(odb, "-pregfile:size",
+	      "number of physical registers, same as -rename:pregs:num",
+	      &rename_pregs_num, /* default */256,
+	      /* !print */FALSE, /* format */NULL);
+
+  opt_reg_int(odb, "-pregfile:rwidth",
+	      "number of physical register file read ports (0 = no limit)",
+	      &pregfile_rwidth, /* default */POWER_DEFAULT(8),
+	      /* print */TRUE, /* format */NULL);
+
+  opt_reg_int(odb, "-pregfile:wwidth",
+	      "number of physical register file write ports (0 = no limit)",
+	      &pregfile_wwidth, /* default */POWER_DEFAULT(4),
+	      /* print */TRUE, /* format */NULL);
+
+  opt_reg_int(odb, "-pregfile:lat",
+	      "physical register file read latency",
+	      &pregfile_lat, /* default */POWER_DEFAULT(2),
+	      /* print */TRUE, /* format */NULL);
+#endif /* !SIM_R10K_REGCACHE */
+
+  opt_reg_int(odb, "-rename:lat",
+	      "rename latency",
+	      &rename_lat, /* default */1,
+	      /* print */TRUE, /* format */NULL);
+
+  opt_reg_int(odb, "-rename:width",
+	      "rename width",
+	      &rename_width, /* default */4,
+	      /* print */TRUE, /* format */NULL);
+
+  /* sched options */
+
+#ifndef SIM_R10K_CPR
+  opt_reg_int(odb, "-sched:rob:size",
+	      "re-order buffer size",
+	      &ROB.size, /* default */64,
+	      /* print */TRUE, /* format */NULL);
+#endif /* !SIM_R10K_CPR */
+
+  opt_reg_int(odb, "-sched:ldq:size",
+	      "load queue size",
+	      &LSQ.lsize, /* default */16,
+	      /* print */TRUE, /* format */NULL);
+
+  opt_reg_int(odb, "-sched:stq:size",
+	      "store queue size",
+	      &LSQ.ssize, /* default */8,
+	      /* print */TRUE, /* format */NULL);
+
+  opt_reg_int(odb, "-sched:rs:size",
+	      "number of reservation stations",
+	      &sched_rs_num, /* default */40,
+	      /* print */TRUE, /* format */NULL);
+
+  opt_reg_int(odb, "-sched:size",
+	      "number of reservation stations, same as -sched:rs:size",
+	      &sched_rs_num, /* default */40,
+	      /* !print */FALSE, /* format */NULL);
+
+  opt_reg_int(odb, "-sched:int:width",
+	      "instruction issue B/W (insts/cycle)",
+	      &sched_width[sclass_INT], /* default */4,
+	      /* print */TRUE, /* format */NULL);
+
+  opt_reg_int(odb, "-sched:fp:width",
+	      "instruction issue B/W (insts/cycle)",
+	      &sched_width[sclass_FP], /* default */4,
+	      /* print */TRUE, /* format */NULL);
+
+  opt_reg_int(odb, "-sched:store:width",
+	      "instruction issue B/W (insts/cycle)",
+	      &sched_width[sclass_STORE], /* default */4,
+	      /* print */TRUE, /* format */NULL);
+
+  opt_reg_int(odb, "-sched:load:width",
+	      "instruction issue B/W (insts/cycle)",
+	      &sched_width[sclass_LOAD], /* default */4,
+	      /* print */TRUE, /* format */NULL);
+
+  opt_reg_int(odb, "-sched:total:width",
+	      "instruction issue B/W (insts/cycle)",
+	      &sched_width[sclass_TOTAL], /* default */4,
+	      /* print */TRUE, /* format */NULL);
+
+  opt_reg_int(odb, "-sched:lat",
+	      "number of pipeline stages in issue",
+	      &sched_lat, /* default */1,
+	      /* print */TRUE, /* format */NULL);
+
+  opt_reg_int(odb, "-sched:agen:lat",
+	      "address generation latency",
+	      &sched_agen_lat, /* default */1,
+	      /* print */TRUE, /* format */NULL);
+
+  opt_reg_int(odb, "-sched:fwd:lat",
+	      "address generation latency",
+	      &sched_fwd_lat, /* default */1,
+	      /* print */TRUE, /* format */NULL);
+
+  opt_reg_flag(odb, "-sched:inorder", "schedule in-order",
+	       &sched_inorder, /* default */FALSE,
+	       /* print */TRUE, /* format */NULL);
+
+  opt_reg_flag(odb, "-sched:spec",
+	       "schedule instructions down wrong execution paths",
+	       &sched_spec, /* default */TRUE,
+	       /* print */TRUE, /* format */NULL);
+
+  opt_reg_string(odb, "-sched:adisambig",
+		 "load address disambiguation policy {conservative|opportunistic|perfect|<cht_sets>:<cht_ways>|storesets:<ssit_size>:<lfst_size>[:<clear_cycles>]}",
+		 &sched_adisambig_opt.opt, /* default */"conservative",
+		 /* print */TRUE, /* format */NULL);
+
+  /* scheduler options */
+  respool_reg_options(odb, &respool_opt);
+
+#ifdef SIM_R10K_REGCACHE
+  /* Pregfile Scheme Options */
+  opt_reg_flag(odb, "-pregfile:cache",
+	       "L1 Physical Register Cache Scheme",
+	       &l1_pregfile_cache, /* default */FALSE,
+	       /* print */TRUE, /* format */NULL);
+
+  opt_reg_string(odb, "-pregfile:repl",
+		 "L1 Physical Register Cache replacement {lru|usecount|nobypass}",
+		 &regcache_repl_opt, /* default */"lru",
+		 /* print */TRUE, /* format */NULL);
+
+  opt_reg_flag(odb, "-pregfile:prefetch",
+	       "L1 Physical Register Cache fill of L2 resident source operands at rename",
+	       &regcache_prefetch, /* default */FALSE,
+	       /* print */TRUE, /* format */NULL);
+
+  /* L1 Pregfile Options */
+  opt_reg_uint(odb, "-l1_pregfile:size",
+	       "Number of L1 Physical Registers",
+	       &l1_pregfile_size, /* default */256,
+	       /* print */TRUE, /* format */NULL);
+
+  opt_reg_uint(odb, "-l1_pregfile:rwidth",
+	       "Number of L1 Physical Register Read Ports",
+	       &l1_pregfile_rwidth, /* default */ 4,
+	       /* print */TRUE, /* format */NULL);
+
+  opt_reg_uint(odb, "-l1_pregfile:wwidth",
+	       "Number of L1 Physical Registers Write Ports",
+	       &l1_pregfile_wwidth, /* default */ 4,
+	       /* print */TRUE, /* format */NULL);
+
+  opt_reg_uint(odb, "-l1_pregfile:lat",
+	       "L1 Physical Register Latency",
+	       &l1_pregfile_lat, /* default */ 1,
+	       /* print */TRUE, /* format */NULL);
+
+  /* L2 Pregfile Options */
+  opt_reg_uint(odb, "-l2_pregfile:size",
+	       "Number of L2 Physical Registers",
+	       &l2_pregfile_size, /* default */0,
+	       /* print */TRUE, /* format */NULL);
+
+  opt_reg_uint(odb, "-l2_pregfile:rwidth",
+	       "Number of L2 Physical Register Read Ports",
+	       &l2_pregfile_rwidth, /* default */4,
+	       /* print */TRUE, /* format */NULL);
+
+  opt_reg_uint(odb, "-l2_pregfile:wwidth",
+	       "Number of L2 Physical Registers Write Ports",
+	       &l2_pregfile_wwidth, /* default */4,
+	       /* print */TRUE, /* format */NULL);
+
+  opt_reg_uint(odb, "-l2_pregfile:lat",
+	       "L2 Physical Register Latency",
+	       &l2_pregfile_lat, /* default */1,
+	       /* print */TRUE, /* format */NULL);
+#endif /* SIM_R10K_REGCACHE */
+
+#ifndef SIM_R10K_CPR
+  /* writeback options */
+  opt_reg_int(odb, "-writeback:width",
+	      "writeback bandwidth (insn / cycle, 0 = no limit)",
+	      &writeback_width, /* default */POWER_DEFAULT(4),
+	      /* print */TRUE, /* format */NULL);
+
+  opt_reg_int(odb, "-writeback:ctrl:width",
+	      "writeback ctrl bandwidth (ctrl / cycle, 0 = no limit)",
+	      &writeback_ctrl_width, /* default */POWER_DEFAULT(1),
+	      /* print */TRUE, /* format */NULL);
+#endif /* !SIM_R10K_CPR */
+
+  /* commit options */
+  opt_reg_int(odb, "-commit:width",
+	      "instruction commit B/W (insts/cycle)",
+	      &commit_width, /* default */4,
+	      /* print */TRUE, /* format */NULL);
+
+  opt_reg_int(odb, "-commit:store:width",
+	      "commit cache B/W (re-executed load + store/cycle)",
+	      &commit_store_width, /* default */1,
+	      /* print */TRUE, /* format */NULL);
+
+#ifndef SIM_R10K_CPR
+  opt_reg_int(odb, "-commit:ctrl:width",
+	      "commit ctrl bandwidth (ctrl / cycle, 0 = no limit)",
+	      &commit_ctrl_width, /* default */POWER_DEFAULT(1),
+	      /* print */TRUE, /* format */NULL);
+#endif /* !SIM_R10K_CPR */
+
+  /* recovery options */
+  opt_reg_int(odb, "-recover:width",
+	      "instruction recovery B/W (insns/cycle)",
+	      &recover_width, /* default */4,
+	      /* print */TRUE, /* format */NULL);
+
+#ifdef SIM_R10K_CPR
+  opt_reg_int(odb, "-recover:conf",
+	      "allocate a checkpoint at branches predicted with confidence (0-100) below this",
+	      &recover_conf, /* default */15,
+	      /* print */TRUE, /* format */NULL);
+#endif /* SIM_R10K_CPR */
+
+  /* pre-decode options */
+  predec_reg_options(odb);
+
+#ifdef SIM_R10K_POWER
+  power_reg_options(odb);
+#endif /* SIM_R10K_POWER */
+
+  /* interval time-series */
+  tseries_reg_options(odb);
+
+  /* pipetrace */
+  ptrace_reg_options(odb);
+
+  /* critical path analysis */
+  critpath_reg_options(odb);
+
+  /* histogram options */
+  histo_reg_options(odb);
+}
+
+/* check core timing option values, these may also change in a -sweep
+   child after the memory hierarchy and predictors have been warmed */
+STATIC void
+core_check_options(void)
+{
+  if (fetch_width < 1) fatal("fetch width must be positive");
+  if (fetch_lat < 1) fatal("fetch must be at least 1 pipe stage");
+  if (fetch_bpred_width < 0) fatal("branch prediction width must be non-negative");
+
+  if (rename_width < 1) fatal("rename width must be positive");
+  if (rename_lat < 1) fatal("rename must be at least 1 pipe stage");
+
+#ifdef SIM_R10K_REGCACHE
+  rename_pregs_num = l1_pregfile_size + l2_pregfile_size;
+#else /* !SIM_R10K_REGCACHE */
+  if (pregfile_rwidth < 0 || pregfile_wwidth < 0) fatal("register file ports must be non-negative");
+  if (pregfile_lat < 0) fatal("register file latency must be non-negative");
+#endif /* SIM_R10K_REGCACHE */
+  if (rename_pregs_num < MD_TOTAL_REGS) fatal("need at least %d (MD_TOTAL_REGS + 1) rename registers", MD_TOTAL_REGS + 1);
+    
+  if (sched_width[sclass_TOTAL] < 1) fatal("total scheduling width must be positive");
+  if (sched_width[sclass_INT] < 1 || sched_width[sclass_INT] > sched_width[sclass_TOTAL]) 
+    fatal("int scheduling width must be positive and less than total scheduling width");
+  if (sched_width[sclass_FP] < 1 || sched_width[sclass_FP] > sched_width[sclass_TOTAL]) 
+    fatal("fp scheduling width must be positive and less than total scheduling width");
+  if (sched_width[sclass_LOAD] < 1 || sched_width[sclass_LOAD] > sched_width[sclass_TOTAL]) 
+    fatal("load scheduling width must be positive and less than total scheduling width");
+  if (sched_width[sclass_STORE] < 1 || sched_width[sclass_STORE] > sched_width[sclass_TOTAL]) 
+    fatal("store scheduling width must be positive and less than total scheduling width");
+
+  if (sched_lat < 1) fatal("schedling must be at least 1 pipe stage");
+  if (sched_agen_lat < 1) fatal("agen must be at least 1 pipe stage");
+  if (sched_fwd_lat < 1) fatal("store-forward must be at least 1 pipe stage");
+
+  if (sched_rs_num < 1) fatal("need at least 1 reservation station");
+
+#ifndef SIM_R10K_CPR
+  if (writeback_width < 0 || writeback_ctrl_width < 0) fatal("writeback width must be non-negative");
+#endif /* !SIM_R10K_CPR */
+
+
+  if (IFQ.size < 1)  fatal("inst fetch queue size must be positive");
+#ifndef SIM_R10K_CPR
+  if (ROB.size < 1) fatal("ROB size must be a positive number > 1");
+#endif /* !SIM_R10K_CPR */
+  if (LSQ.lsize < 1) fatal("LSQ size must be a positive number > 1");
+  if (LSQ.ssize < 1) fatal("LSQ size must be a positive number > 1");
+
+  if (commit_width < 1) fatal("commit width must be positive non-zero");
+  if (commit_store_width < 1 || commit_store_width > commit_width) fatal("commit store width must be positive and less than commit width");
+#ifndef SIM_R10K_CPR
+  if (commit_ctrl_width < 0) fatal("commit ctrl width must be non-negative");
+#endif /* !SIM_R10K_CPR */
+
+#ifdef SIM_R10K_POWER
+  /* the power model needs the port counts */
+  if (fetch_bpred_width < 1 || writeback_width < 1 || writeback_ctrl_width < 1 || commit_ctrl_width < 1)
+    fatal("power model needs positive branch prediction, writeback and commit ctrl widths");
+#ifndef SIM_R10K_REGCACHE
+  if (pregfile_rwidth < 1 || pregfile_wwidth < 1)
+    fatal("power model needs positive register file port counts");
+#endif /* !SIM_R10K_REGCACHE */
+#endif /* SIM_R10K_POWER */
+
+  if (recover_width < 1) fatal("recover width must be positive");
+}
+
+/* set up the address disambiguation tables of the -sched:adisambig
+   strategy, a -sweep child replaces its parent's */
+STATIC void
+adisambig_init(void)
+{
+  if (cht)
+    cht_destroy(cht);
+  if (storeset)
+    storeset_destroy(storeset);
+  free(lfst);
+  cht = NULL;
+  storeset = NULL;
+  lfst = NULL;
+
+  adisambig_check_options(&sched_adisambig_opt);
+  if (sched_adisambig_opt.strategy == adisambig_CHT)
+    cht = cht_create(&sched_adisambig_opt);
+  if (sched_adisambig_opt.strategy == adisambig_STORESETS)
+    {
+      storeset = storeset_create(&sched_adisambig_opt);
+      lfst = (struct lfst_ent_t *)mycalloc(sched_adisambig_opt.lfst_size, sizeof(struct lfst_ent_t));
+    }
+}
+
+/* option name prefixes a -sweep configuration may set, the others
+   configure the warm caches, TLBs and predictors */
+static char *sweep_opt_prefix[] = {
+  "-fetch:", "-rename:", "-sched:", "-commit:", "-recover:", "-respool:",
+  "-pregfile:", "-writeback:",
+#ifdef SIM_R10K_REGCACHE
+  "-l1_pregfile:", "-l2_pregfile:",
+#endif /* SIM_R10K_REGCACHE */
+#ifdef SIM_R10K_POWER
+  "-power:",
+#endif /* SIM_R10K_POWER */
+  NULL
+};
+
+STATIC bool_t
+sweep_option_ok(char *name)
+{
+  int i;
+
+  for (i = 0; sweep_opt_prefix[i]; i++)
+    if (!strncmp(name, sweep_opt_prefix[i], strlen(sweep_opt_prefix[i])))
+      return TRUE;
+  return FALSE;
+}
+#ifdef SIM_R10K_REGCACHE
+
+/* check the register cache options, these may also change in a -sweep
+   child */
+STATIC void
+regcache_check_options(void)
+{
+  if (!mystricmp(regcache_repl_opt, "lru"))
+    regcache_repl = regcache_LRU;
+  else if (!mystricmp(regcache_repl_opt, "usecount"))
+    regcache_repl = regcache_USECOUNT;
+  else if (!mystricmp(regcache_repl_opt, "nobypass"))
+    regcache_repl = regcache_NOBYPASS;
+  else
+    fatal("bad register cache replacement policy `%s'", regcache_repl_opt);
+
+  if (l1_pregfile_cache && l1_pregfile_size < 1)
+    fatal("L1 Physical Register Cache needs at least 1 register");
+  if (regcache_prefetch && !l1_pregfile_cache)
+    fatal("-pregfile:prefetch needs the L1 Physical Register Cache (-pregfile:cache)");
+}
+#endif /* SIM_R10K_REGCACHE */
+
+/* check simulator-specific option values */
+void
+sim_check_options(void)        /* command line arguments */
+{
+  core_check_options();
+
+
+  adisambig_init();
+
+  /* memory */
+  if (mem_lat < 1)
+    fatal("all memory access latencies must be greater than zero");
+
+  if (mystricmp(bpred_opt.opt, "none"))
+    {
+      bpred_check_options(&bpred_opt);
+      bpred = bpred_create(&bpred_opt);
+    }
+
+  /* use a level 1 D-cache? */
+  if (mystricmp(cache_dl1_opt.opt, "none"))
+    {
+      cache_check_options(&cache_dl1_opt);
+      cache_dl1 = cache_create(&cache_dl1_opt);
+    }
+
+  /* use a level 1 I-cache? */
+  if (!mystricmp(cache_il1_opt.opt, "dl1"))
+    {
+      if (!cache_dl1)
+	fatal("L1 I-cache cannot access L1 D-cache as it's undefined");
+      cache_il1 = cache_dl1;
+    }
+  else if (mystricmp(cache_il1_opt.opt, "none"))
+    {
+      cache_check_options(&cache_il1_opt);
+      cache_il1 = cache_create(&cache_il1_opt);
+    }
+
+  if (mystricmp(cache_l2_opt.opt, "none"))
+    {
+      if (!cache_il1 && !cache_dl1)
+        fatal("can't have an L2 without an L1 D-cache or I-cache!");
+
+      cache_check_options(&cache_l2_opt);
+      cache_l2 = cache_create(&cache_l2_opt);
+    }
+
+  if (mystricmp(dtlb_opt.opt, "none"))
+    {
+      cache_check_options(&dtlb_opt);
+      dtlb = cache_create(&dtlb_opt);
+    }
+
+  /* use an I-TLB? */
+  if (!mystricmp(itlb_opt.opt, "dtlb"))
+    {
+      if (!dtlb)
+	fatal("I-TLB cannot use D-TLB as it is undefined");
+      itlb = dtlb;
+    }
+  else if (mystricmp(itlb_opt.opt, "none"))
+    {
+      cache_check_options(&itlb_opt);
+      itlb = cache_create(&itlb_opt);
+    }
+
+  /* resource pool */
+  respool_check_options(&respool_opt);
+  respool = respool_create(&respool_opt);
+
+#ifdef SIM_R10K_REGCACHE
+  /* register cache */
+  regcache_check_options();
+#endif /* SIM_R10K_REGCACHE */
+
+  /* check pre-decode options */
+  predec_check_options();
+  
+#ifdef SIM_R10K_POWER
+  power_check_options();
+#endif /* SIM_R10K_POWER */
+
+  /* check interval time-series options */
+  tseries_check_options();
+
+  /* check pipetrace options */
+  ptrace_check_options();
+
+  /* check critical path options */
+  critpath_check_options();
+}
+#ifdef SIM_R10K_POWER
+
+void
+power_init(void)
+{
+  double r_power, w_power, t_r_power, t_w_power, max_power;
+
+  /* calculate power */
+
+  /* I$ */
+  if (cache_il1)
+  {
+    r_power = w_power = t_r_power = t_w_power = 0.0;
+    fprintf(stderr, "\n\n------------------------- IL1 --------------------------\n");
+    cache_onebank_power(/* nsets */cache_il1_opt.nsets,
+			/* assoc */cache_il1_opt.assoc,
+			/* dbits */cache_il1_opt.bsize * 8,
+			/* tbits */MD_PADDR_SIZE - log_base2(cache_il1_opt.bsize * cache_il1_opt.nsets) + /* VALID bit */1,
+			/* nbanks */1,
+			/* rwport */1,
+			/* rport */0,
+			/* wport */0,
+			/* asize */log_base2(cache_il1_opt.bsize * cache_il1_opt.nsets),
+			/* osize */fetch_width * sizeof(md_inst_t) * 8,
+			/* bsize */fetch_width * sizeof(md_inst_t) * 8,
+			/* objective function params */ NULL,
+			/* tag_read_power */&t_r_power,
+			/* tag_write_power */&t_w_power,
+			/* data_read_power */&r_power,
+			/* data_write_power */&w_power);
+    max_power = r_power,
+    power_set_power_nports(ps_IL1_DATA, r_power, w_power, max_power, /* rp */0, /* wp */0, /* rwp */1);
+    max_power = t_r_power;
+    power_set_power_nports(ps_IL1_TAG, t_r_power, t_w_power, max_power, /* rp */0, /* wp */0, /* rwp */1);
+  }
+
+  /* ITLB */
+  if (itlb)
+  {
+    r_power = w_power = t_r_power = t_w_power = 0.0;
+    cam_array_power(itlb_opt.nsets, MD_VADDR_SIZE - log_base2(itlb_opt.bsize),
+		    /* rport */1, /* wport */1, &t_r_power, &t_w_power);
+    simple_array_power(itlb_opt.nsets, MD_PADDR_SIZE - log_base2(itlb_opt.bsize),
+		       /* rport */1, /* wport */1, /* cache? */FALSE,
+		       &r_power, &w_power);
+    max_power = (r_power + t_r_power) * 1 + (w_power + t_w_power) * 1;
+    power_set_power_nports(ps_ITLB, r_power + t_r_power, w_power + t_w_power, max_power, 1, 1, 0);
+  }
+
+  /* D$ */
+  if (cache_dl1)
+  {
+    fprintf(stderr, "\n\n------------------------- DL1 --------------------------\n");
+    cache_onebank_power(/* nsets */cache_dl1_opt.nsets,
+			/* assoc */cache_dl1_opt.assoc,
+			/* dbits */cache_dl1_opt.bsize * 8,
+			/* tbits */MD_PADDR_SIZE - log_base2(cache_dl1_opt.bsize * cache_dl1_opt.nsets) + /* VALID/DIRTY bits */2,
+			/* nbanks */1,
+			/* rwport */0,
+			/* rport */sched_width[sclass_LOAD],
+			/* wport */commit_store_width,
+			/* abits */log_base2(cache_dl1_opt.bsize * cache_dl1_opt.nsets), 
+			/* obits */MD_VADDR_SIZE * 8,
+			/* bbits */MD_VADDR_SIZE * 8,
+			/* objective function params */ NULL,
+			/* tag_read_power */&t_r_power,
+			/* tag_write_power */&t_w_power,
+			/* data_read_power */&r_power,
+			/* data_write_power */&w_power);
+    max_power = (r_power * sched_width[sclass_LOAD]) + (w_power * commit_store_width);
+    power_set_power_nports(ps_DL1_DATA, r_power, w_power, max_power, sched_width[sclass_LOAD], commit_store_width, 0);
+    max_power = t_r_power * (sched_width[sclass_LOAD] + commit_store_width);
+    power_set_power_nports(ps_DL1_TAG, t_r_power, t_w_power, max_power, sched_width[sclass_LOAD] + commit_store_width, 1, 0);
+  }
+
+  /* DTLB */
+  if (dtlb)
+  {
+    r_power = w_power = t_r_power = t_w_power = 0.0;
+
+    cam_array_power(dtlb_opt.nsets, MD_VADDR_SIZE - log_base2(dtlb_opt.bsize), /* rport */sched_width[sclass_LOAD] + commit_store_width, /* wport */1,
+		    &t_r_power, &t_w_power);
+    simple_array_power(dtlb_opt.nsets, MD_PADDR_SIZE - log_base2(dtlb_opt.bsize),
+		       /* rport */sched_width[sclass_LOAD] + commit_store_width, /* wport */1, /* cache? */FALSE,
+		       &r_power, &w_power);
+    max_power = (r_power + t_r_power) * (sched_width[sclass_LOAD] + commit_store_width) + (w_power + t_w_power); 
+    power_set_power_nports(ps_DTLB, r_power + t_r_power, w_power + t_w_power, max_power, sched_width[sclass_LOAD] + commit_store_width, 1, 0);
+  }
+
+  /* L2 */
+  if (cache_l2)
+  {
+    fprintf(stderr, "\n\n------------------------- L2 --------------------------\n");
+    cache_onebank_power(/* nsets */cache_l2_opt.nsets,
+			/* assoc */cache_l2_opt.assoc,
+			/* dbits */cache_l2_opt.bsize * 8,
+			/* tbits */MD_PADDR_SIZE - log_base2(cache_l2_opt.bsize * cache_l2_opt.nsets) + /* VALID/DIRTY bits */2,
+			/* nbanks */1,
+			/* rwport */1,
+			/* rport */0,
+			/* wport */0,
+			/* asize */log_base2(cache_l2_opt.bsize * cache_l2_opt.nsets),
+			/* osize */MD_VADDR_SIZE * 8,
+			/* bbits */MD_VADDR_SIZE * 8,
+			/* objective function params */ NULL,
+			/* tag_read_power */&t_r_power,
+			/* tag_write_power */&t_w_power,
+			/* data_read_power */&r_power,
+			/* data_write_power */&w_power);
+    max_power = r_power;
+    power_set_power_nports(ps_L2_DATA, r_power, w_power, max_power, /* rp */0, /* wp */0, /* rwp */1);
+    max_power = t_r_power;
+    power_set_power_nports(ps_L2_TAG, t_r_power, t_w_power, max_power, /* rp */0, /* wp */0, /* rwp */1);
+  }
+
+  /* BPRED */
+  if (bpred)
+  {
+    r_power = w_power = 0.0;
+
+    if (bpred_opt.dir1_opt.size != 0)
+    {
+      t_r_power = t_w_power = 0.0;
+      array_power(/* rows */bpred_opt.dir1_opt.size, /* cols */bpred_opt.dir1_opt.pbits,
+		  /* rport */fetch_bpred_width, /* wport */commit_ctrl_width, /* cache? */TRUE,
+		  &t_r_power, &t_w_power);
+      r_power += t_r_power;
+      w_power += t_w_power;
+    }
+
+    if (bpred_opt.dir2_opt.size != 0)
+    {
+      t_r_power = t_w_power = 0.0;
+      array_power(/* rows */ bpred_opt.dir2_opt.size, /* cols */ bpred_opt.dir2_opt.pbits,
+		  /* rport */fetch_bpred_width, /* wport */commit_ctrl_width, /* cache? */TRUE,
+		  &t_r_power, &t_w_power);
+      r_power += t_r_power;
+      w_power += t_w_power;
+    }
+    if (bpred_opt.chooser_opt.size != 0)
+    {
+      t_r_power = t_w_power = 0.0;
+      array_power(/* rows */ bpred_opt.chooser_opt.size, /* cols */ bpred_opt.chooser_opt.pbits,
+		  /* rport */fetch_bpred_width, /* wport */commit_ctrl_width, /* cache? */TRUE,
+		  &t_r_power, &t_w_power);
+      r_power += t_r_power;
+      w_power += t_w_power;
+    }
+
+    max_power = (fetch_bpred_width * r_power) + (commit_ctrl_width * w_power);
+
+    power_set_power_nports(ps_DIRPRED, r_power, w_power, max_power, fetch_bpred_width, commit_ctrl_width, 0);
+
+    if (bpred_opt.btb_opt.nsets)
+    {
+      r_power = w_power = 0.0;
+      fprintf(stderr, "\n\n------------------------- BTB -------------------------\n");
+      cache_onebank_power(/* nsets */DIV_ROUND_UP(bpred_opt.btb_opt.nsets, /* nbanks */1),
+			  /* assoc */bpred_opt.btb_opt.assoc,
+			  /* dbits */bpred_opt.btb_opt.dbits,
+			  /* tbits */bpred_opt.btb_opt.tbits,
+			  /* nbanks */1,
+			  /* rwport */MAX(fetch_bpred_width, writeback_ctrl_width),
+			  /* rport */0,
+			  /* wport */0, 
+			  /* asize */log_base2(bpred_opt.btb_opt.nsets * /* nbanks */1) + bpred_opt.btb_opt.tbits,
+			  /* osize */bpred_opt.btb_opt.dbits,
+			  /* bbits */bpred_opt.btb_opt.dbits,
+			  /* objective function params */ NULL,
+			  /* tag_read_power */&t_r_power,
+			  /* tag_write_power */&t_w_power,
+			  /* data_read_power */&r_power,
+			  /* data_write_power */&w_power);
+      max_power = MAX(fetch_bpred_width, writeback_ctrl_width) * (r_power + t_r_power);
+      power_set_power_nports(ps_BTB, r_power + t_r_power, w_power + t_w_power, max_power, /* rp */0, /* wp */0, /* rwp */MAX(fetch_bpred_width, writeback_ctrl_width));
+    }
+
+    if (bpred_opt.ras_opt.size)
+    {
+      r_power = w_power = 0.0;
+      simple_array_power(/* rows */bpred_opt.ras_opt.size, /* cols */MD_VADDR_SIZE,
+			 /* rport */fetch_bpred_width, /* wport */fetch_bpred_width, /* cache? */FALSE,
+			 &r_power, &w_power);
+      max_power = (r_power * fetch_bpred_width) + (w_power * fetch_bpred_width);
+      power_set_power_nports(ps_RAS, r_power, w_power, max_power, fetch_bpred_width, fetch_bpred_width, /* rwp */0);
+    }
+  }
+
+  /* DECODE */
+  r_power = w_power = 0.0;
+  r_power = array_decoder_power(/* opcode size */8, /* cols */1, /* port */1);
+  max_power = r_power * rename_width;
+  power_set_power_nports(ps_DECODE, r_power, /* w_power */0.0, max_power, rename_width, /* wp */0, /* rwp */0);
+
+  /* RENAME */
+  {
+    r_power = w_power = 0.0;
+    rat_array_power(/* rows */MD_TOTAL_REGS, /* cols */ceil_log_base2(rename_pregs_num),
+		    /* rport */rename_width * 2, /* wport */rename_width,
+		    &r_power, &w_power);
+    /* Two RAT lookups per instruction */
+    r_power *= 2; 
+    /* dependence check logic comparators: per renamed insn */
+    r_power += (rename_width-1) * comparator_power(ceil_log_base2(MD_TOTAL_REGS));
+    /* dependence check logic priority encoders: per renamed insn */
+    r_power += 2 * arbiter_power(rename_width - 1);
+
+    max_power = (r_power * rename_width) + (w_power * rename_width);
+    power_set_power_nports(ps_RENAME, r_power, w_power, max_power, rename_width, rename_width, /* rwp */0);
+  }
+
+  /* FREELIST */
+  {
+    r_power = w_power = 0.0;
+    rat_array_power(/* rows */DIV_ROUND_UP(rename_pregs_num, rename_width), /* cols */ceil_log_base2(rename_pregs_num) * rename_width,
+		    /* rport */1, /* wport */1,
+		    &r_power, &w_power);
+    max_power = r_power + w_power;
+    power_set_power_nports(ps_FREELIST, r_power, w_power, max_power, 1, 1, /* rwp */0);
+  }
+
+  /* ROB */
+  {
+    r_power = w_power = 0.0;
+    array_power(/* rows */ROB.size, /* cols */2 * ceil_log_base2(rename_pregs_num) + ceil_log_base2(MD_TOTAL_REGS) + 5, 
+		/* rport */commit_width, /* wport */rename_width, /* cache? */FALSE,
+		&r_power, &w_power);
+    max_power = (r_power * commit_width) + (w_power * rename_width);
+    power_set_power_nports(ps_ROB, r_power, w_power, max_power, commit_width, rename_width, /* rwp */0);
+  }
+
+  if (sched_adisambig_opt.strategy == adisambig_OPPORTUNISTIC ||
+      sched_adisambig_opt.strategy == adisambig_CHT ||
+      sched_adisambig_opt.strategy == adisambig_STORESETS)
+    {
+      /* LQADDR */
+      cam_array_power(/* rows */LSQ.lsize, /* cols */MD_VADDR_SIZE,
+		      /* mports */sched_width[sclass_STORE], /* wports */sched_width[sclass_LOAD],
+		      &r_power, &w_power);
+      max_power = (r_power * sched_width[sclass_STORE]) + (w_power * sched_width[sclass_LOAD]);
+      power_set_power_nports(ps_LQADDR, r_power, w_power, max_power, sched_width[sclass_STORE], sched_width[sclass_LOAD], /* rwp */0);
+      
+      /* LQDATA */
+      array_power(/* rows */LSQ.lsize, /* cols */MD_VADDR_SIZE,
+		  /* rports */sched_width[sclass_STORE], /* wports */sched_width[sclass_LOAD], /* cache? */FALSE,
+		  &r_power, &w_power);
+      max_power = (r_power * sched_width[sclass_STORE]) + (w_power * sched_width[sclass_LOAD]);
+      power_set_power_nports(ps_LQDATA, r_power, w_power, max_power, sched_width[sclass_STORE], sched_width[sclass_LOAD], /* rwp */0);
+    }
+
+  /* SQADDR */
+  /* AR: How do you model a CAM with conventional read ports?
+     Currently, we are treating the store-commit read ports as
+     load-execute match ports (probably the wrong thing to do) */
+  cam_array_power(/* rows */LSQ.ssize, /* cols */MD_VADDR_SIZE,
+		  /* mports */sched_width[sclass_LOAD], /* wports */sched_width[sclass_STORE] + /* rports */ commit_store_width,
+		  &r_power, &w_power);
+  max_power = (r_power * sched_width[sclass_LOAD]) + (w_power * (sched_width[sclass_STORE] + commit_store_width));
+  power_set_power_nports(ps_SQADDR, r_power, w_power, max_power, sched_width[sclass_LOAD], sched_width[sclass_STORE] + commit_store_width, /* rwp */0);
+
+  /* SQDATA */
+  array_power(/* rows */LSQ.ssize, /* cols */MD_VADDR_SIZE,
+	      /* rports */sched_width[sclass_LOAD] + commit_store_width, /* wports */sched_width[sclass_STORE], /* cache? */FALSE,
+	      &r_power, &w_power);
+  max_power = (r_power * sched_width[sclass_LOAD]) + (w_power * (sched_width[sclass_STORE] + commit_store_width));
+  power_set_power_nports(ps_SQDATA, r_power, w_power, max_power, sched_width[sclass_LOAD] + commit_store_width, sched_width[sclass_STORE], /* rwp */0);
+
+  /* WAKEUP */
+  cam_array_power(/* rows */sched_rs_num, /* cols */ceil_log_base2(rename_pregs_num),
+		  /* rport */writeback_width, /* wport */0,
+		  &r_power, &w_power);
+  max_power = r_power * 2 * writeback_width;
+  power_set_power_nports(ps_WAKEUP, r_power * 2, /* w_power */0.0, max_power, writeback_width, 0, /* rwp */0);
+
+  /* SELECT */
+  r_power = arbiter_power(sched_rs_num);
+  max_power = r_power * sched_width[sclass_TOTAL];
+  power_set_power_nports(ps_SELECT, r_power, /* w_power */0.0, max_power, sched_width[sclass_TOTAL], 0, /* rwp */0);
+
+  /* RSTATION */
+  array_power(/* rows */sched_rs_num, /* cols */3 * ceil_log_base2(rename_pregs_num) + 16 + ceil_log_base2(ROB.size) + /* opsize */8,
+	      /* rports */sched_width[sclass_TOTAL], /* wports */rename_width, /* cache? */FALSE,
+	      &r_power, &w_power);
+  max_power = (r_power * sched_width[sclass_TOTAL]) + (w_power * rename_width);
+  power_set_power_nports(ps_RSTATION, r_power, w_power, max_power, sched_width[sclass_TOTAL], rename_width, /* rwp */0);
+
+  /* REGFILE */
+#ifdef SIM_R10K_REGCACHE
+  /* the L2 register file, and the L1 register file or register cache
+     in front of it */
+  if (l2_pregfile_size > 0)
+  {
+    array_power(/* rows */l2_pregfile_size, /* cols */MD_VADDR_SIZE,
+		/* rport */l2_pregfile_rwidth, /* wport */l2_pregfile_wwidth, /* cache? */FALSE,
+		&r_power, &w_power);
+    max_power = (r_power * l2_pregfile_rwidth) + (w_power * l2_pregfile_wwidth);
+    power_set_power_nports(ps_REGFILE, r_power, w_power, max_power, l2_pregfile_rwidth, l2_pregfile_wwidth, /* rwp */0);
+  }
+
+  if (l1_pregfile_size > 0)
+  {
+    array_power(/* rows */l1_pregfile_size, /* cols */MD_VADDR_SIZE,
+		/* rport */l1_pregfile_rwidth, /* wport */l1_pregfile_wwidth, /* cache? */l1_pregfile_cache,
+		&r_power, &w_power);
+    if (l1_pregfile_cache)
+    {
+      /* register cache entries are tagged with their physical register */
+      cam_array_power(/* rows */l1_pregfile_size, /* cols */ceil_log_base2(rename_pregs_num),
+		      /* rport */l1_pregfile_rwidth, /* wport */l1_pregfile_wwidth,
+		      &t_r_power, &t_w_power);
+      r_power += t_r_power;
+      w_power += t_w_power;
+    }
+    max_power = (r_power * l1_pregfile_rwidth) + (w_power * l1_pregfile_wwidth);
+    power_set_power_nports(ps_REGCACHE, r_power, w_power, max_power, l1_pregfile_rwidth, l1_pregfile_wwidth, /* rwp */0);
+  }
+#else /* !SIM_R10K_REGCACHE */
+  {
+    array_power(/* rows */rename_pregs_num, /* cols */MD_VADDR_SIZE,
+		/* rport */pregfile_rwidth, /* wport */pregfile_wwidth, /* cache? */FALSE, 
+		&r_power, &w_power);
+    max_power = (r_power * pregfile_rwidth) + (w_power * pregfile_wwidth);
+    power_set_power_nports(ps_REGFILE, r_power, w_power, max_power, pregfile_rwidth, pregfile_wwidth, /* rwp */0);
+  }
+#endif /* SIM_R10K_REGCACHE */
+
+  /* IALU */
+  {
+    max_power = sched_width[sclass_INT] * ialu_power();
+    power_set_power_nports(ps_IALU, ialu_power(), 0.0, max_power, sched_width[sclass_INT], 0, /* rwp */0);
+  }
+
+  /* FALU */
+  /* not so well modelled - the machine has more functional units than sched_width*/
+  {
+    int port = respool_opt.res_num[resclass_FPALU] + respool_opt.res_num[resclass_FPMULT];
+    max_power = port * falu_power();
+    power_set_power_nports(ps_FALU, falu_power(), 0.0, max_power, port, 0, /* rwp */0);
+  }
+
+  {
+    int port = sched_width[sclass_LOAD] + sched_width[sclass_STORE];
+    max_power = port * 0.5 * ialu_power();
+    power_set_power_nports(ps_AGEN, 0.5 * ialu_power(), 0.0, max_power, port, 0, /* rwp */0);
+  }
+
+  /* RESULTBUS */
+  {
+    r_power = resultbus_power(rename_pregs_num,
+			      sched_width[sclass_TOTAL] * 3,
+			      sched_width[sclass_INT],
+			      MD_VADDR_SIZE);
+    max_power = r_power * writeback_width;
+    power_set_power_nports(ps_RESULTBUS, r_power, 0.0, max_power, writeback_width, 0, /* rwp */0);
+  }
+   
+  /* CLOCK: must be last */
+  {
+    unsigned int npiperegs = 0;
+    /* fetch stage */
+    npiperegs += (fetch_lat - 1) * (2 * MD_VADDR_SIZE);
+    /* decode/rename stage */
+    npiperegs += (rename_lat) * (rename_width * (sizeof(md_inst_t) * 8 + 16) + MD_VADDR_SIZE);
+    /* schedule stage */
+#ifdef SIM_R10K_REGCACHE
+    npiperegs += (sched_lat + l1_pregfile_lat) * (sched_width[sclass_TOTAL] * (8 + 3 * ceil_log_base2(rename_pregs_num)));
+#else /* !SIM_R10K_REGCACHE */
+    npiperegs += (sched_lat + pregfile_lat) * (sched_width[sclass_TOTAL] * (8 + 3 * ceil_log_base2(rename_pregs_num)));
+#endif /* SIM_R10K_REGCACHE */
+
+    r_power = clock_power(npiperegs,
+			  sched_width[sclass_INT],
+			  sched_width[sclass_FP],
+			  0.09);
+    max_power = r_power;
+    power_set_power_nports(ps_CLOCK, r_power, 0.0, max_power, 1, 0, /* rwp */0);
+  }
+
+  /* TOTAL */
+  total_power();
+}
+#endif /* SIM_R10K_POWER */
+
+/* print simulator-specific configuration information */
+void
+sim_aux_config(FILE *stream)            /* output stream */
+{
+  /* nada */
+#ifdef SIM_R10K_POWER
+  power_aux_config(stream);
+#endif /* SIM_R10K_POWER */
+}
+
+/* register simulator-specific statistics */
+void
+sim_stats(FILE *stream)   /* stats database */
+{
+  /* simulation time */
+  print_counter(stream, "sim_elapsed_time", sim_elapsed_time, "simulation time in seconds");
+
+  /* register baseline stats */
+  print_counter(stream, "sim_num_insn_sim", sim_num_insn, "instructions simulated (functional and timing)");
+
+  print_counter(stream, "sim_num_insn", n_insn_commit_sum, "instructions committed");
+  print_formula(stream, "sim_insn_rate", 1.0, "sim_num_insn", "sim_elapsed_time", "insn/s", "simulation speed (insts/sec)");
+  print_counter(stream, "sim_num_load", n_insn_commit[ic_load], "loads committed");
+  print_counter(stream, "sim_num_store", n_insn_commit[ic_store], "stores committed");
+  print_counter(stream, "sim_num_branch", n_insn_commit[ic_ctrl], "branches committed");
+  print_counter(stream, "sim_num_fp", n_insn_commit[ic_fcomp] + n_insn_commit[ic_fcomplong], "floating point operations commmitted");
+  print_counter(stream, "sim_num_prefetch", n_insn_commit[ic_prefetch], "prefetches committed (encountered)");
+  print_counter(stream, "sim_num_sys", n_insn_commit[ic_sys], "system-calls committed");
+
+  print_counter(stream, "sim_fetch_insn",   n_insn_fetch, "instructions fetched");
+  print_counter(stream, "sim_rename_insn",   n_insn_rename, "instructions fetched");
+  print_counter(stream, "sim_exec_insn", ICVEC_ICSUM(n_insn_exec), "instructions executed");
+
+  /* performance stats */
+  print_counter(stream, "sim_cycle", sim_cycle, "cycles");
+  print_formula(stream, "sim_IPC", 1.0, "sim_num_insn", "sim_cycle", "insn/cycle", "committed instructions per cycle");
+
+  print_counter(stream, "sim_num_branch_misp", n_branch_misp, "branch mispredictions");
+  print_counter(stream, "sim_load_squash", n_load_squash, "load squashes");
+  print_formula(stream, "sim_load_squash_rate", 1.0, "sim_load_squash", "sim_num_load", "squash/load", "load squashes per committed load");
+  print_counter(stream, "sim_load_dep_stall", n_load_dep_stall, "load stall cycles on a predicted store dependence");
+  print_counter(stream, "sim_load_false_dep_stall", n_load_false_dep_stall, "load stall cycles on a predicted store dependence perfect disambiguation would not wait for (decided at the first stall)");
+
+#ifdef SIM_R10K_REGCACHE
+  print_counter(stream, "n_reg_read", n_reg_read, "reads");
+  print_counter(stream, "n_reg_read_miss", n_reg_read_miss, "misses");
+  print_formula(stream, "sim_reg_read_miss_rate", 1.0, "n_reg_read_miss", "n_reg_read", "miss/read", "rate of read register cache miss");
+  print_counter(stream, "n_reg_evict", n_reg_evict, "register cache evictions");
+  print_counter(stream, "n_reg_prefetch", n_reg_prefetch, "register cache fills at rename");
+  print_counter(stream, "n_reg_prefetch_useful", n_reg_prefetch_useful, "prefetched registers read from the register cache");
+  print_counter(stream, "n_reg_prefetch_useless", n_reg_prefetch_useless, "prefetched registers evicted or freed unread");
+  print_formula(stream, "sim_reg_prefetch_accuracy", 1.0, "n_reg_prefetch_useful", "n_reg_prefetch", "read/prefetch", "fraction of register cache prefetches read");
+
+  print_counter(stream, "n_reg_writes", n_reg_writes, "writes");
+  print_counter(stream, "n_reg_writes_miss", n_reg_writes_miss, "misses");
+  print_formula(stream, "sim_reg_write_miss_rate", 1.0, "n_reg_writes_miss", "n_reg_writes", "miss/write", "rate of wrote register cache miss");
+#endif /* SIM_R10K_REGCACHE */
+
+  cpi_stats(stream);
+  histo_stats(stream);
+  respool_stats(respool, stream, sim_cycle);
+  critpath_stats(stream);
+}
+
+/* forward declarations */
+STATIC void regs_init(void);
+STATIC void INSN_init(void);
+STATIC void LDST_init(void);
+#ifdef SIM_R10K_CPR
+
+/* checkpoints in use, for the time-series */
+static counter_t
+chkpt_occupancy(void *arg)
+{
+  return CHECK_buffer.tail;
+}
+#endif /* SIM_R10K_CPR */
+
+/* occupancy and latency histograms */
+static struct histo_t h_ifq, h_ldq, h_stq, h_rs, h_sched, h_pregs, h_load_lat;
+#ifdef SIM_R10K_CPR
+static struct histo_t h_chkpt;
+#else /* !SIM_R10K_CPR */
+static struct histo_t h_rob;
+#endif /* SIM_R10K_CPR */
+#ifdef SIM_R10K_REGCACHE
+static struct histo_t h_l1_regs;
+#endif /* SIM_R10K_REGCACHE */
+
+STATIC void
+occupancy_init(void)
+{
+  histo_init(&h_ifq, "occ_ifq", "IFQ occupancy", IFQ.size);
+#ifndef SIM_R10K_CPR
+  histo_init(&h_rob, "occ_rob", "ROB occupancy", ROB.size);
+#endif /* !SIM_R10K_CPR */
+  histo_init(&h_ldq, "occ_ldq", "LSQ load occupancy", LSQ.lsize);
+  histo_init(&h_stq, "occ_stq", "LSQ store occupancy", LSQ.ssize);
+  histo_init(&h_rs, "occ_rs", "reservation stations in use", sched_rs_num);
+  histo_init(&h_sched, "occ_sched", "scheduler queue length", 0);
+#ifdef SIM_R10K_CPR
+  histo_init(&h_chkpt, "occ_chkpt", "checkpoints in use",
+             sizeof(checkpoint_elements) / sizeof(checkpoint_elements[0]));
+#endif /* SIM_R10K_CPR */
+#ifdef SIM_R10K_REGCACHE
+  if (l1_pregfile_cache)
+    {
+      histo_init(&h_pregs, "occ_pregs", "L2 physical registers in use", l2_pregfile_size);
+      histo_init(&h_l1_regs, "occ_l1_regcache", "L1 register cache entries in use", l1_pregfile_size);
+    }
+  else
+#endif /* SIM_R10K_REGCACHE */
+    histo_init(&h_pregs, "occ_pregs", "physical registers in use", rename_pregs_num);
+  histo_init(&h_load_lat, "lat_load", "load-to-use latency in cycles", 0);
+}
+
+/* sample the occupancies, once per cycle */
+STATIC void
+occupancy_sample(void)
+{
+  histo_sample(&h_ifq, IFQ.num);
+#ifndef SIM_R10K_CPR
+  histo_sample(&h_rob, ROB.num);
+#endif /* !SIM_R10K_CPR */
+  histo_sample(&h_ldq, LSQ.lnum);
+  histo_sample(&h_stq, LSQ.snum);
+  /* rs_num counts down from 0 as stations are allocated */
+  histo_sample(&h_rs, -rs_num);
+  histo_sample(&h_sched, scheduler_num);
+#ifdef SIM_R10K_CPR
+  histo_sample(&h_chkpt, CHECK_buffer.tail);
+  histo_sample(&h_pregs, rename_pregs_num - pregs_flist.num);
+#elif defined(SIM_R10K_REGCACHE)
+  if (l1_pregfile_cache)
+    {
+      histo_sample(&h_pregs, l2_pregfile_size - l2_pregs_flist.num);
+      histo_sample(&h_l1_regs, l1_pregfile_size - l1_pregs_flist.num);
+    }
+  else
+    histo_sample(&h_pregs, rename_pregs_num
+		 - l1_pregs_flist.num - l2_pregs_flist.num);
+#else /* !SIM_R10K_CPR && !SIM_R10K_REGCACHE */
+  histo_sample(&h_pregs, rename_pregs_num - pregs_flist.num);
+#endif
+}
+
+/* initialize the simulator */
+void
+sim_init(void)
+{
+  /* allocate and initialize register file */
+  regs_init();
+
+  /* allocate and initialize memory space */
+  mem = mem_create("mem");
+  mem_init(mem);
+
+  PLINK_init(MAX_PREG_LINKS);
+  INSN_init();
+  LDST_init();
+#ifdef SIM_R10K_CPR
+  CHECK_Init();
+#endif /* SIM_R10K_CPR */
+
+#ifdef SIM_R10K_POWER
+  power_init();
+
+#endif /* SIM_R10K_POWER */
+  /* commit slot accounting */
+  cpi_init(commit_width);
+  if (histo_active)
+    occupancy_init();
+  critpath_check_options();
+
+  /* interval time-series columns */
+  tseries_init(&sim_cycle, &n_insn_commit_sum);
+  tseries_counter("branch_misp", tk_DELTA, &n_branch_misp);
+  tseries_cache("dl1", cache_dl1);
+  tseries_cache("l2", cache_l2);
+#ifdef SIM_R10K_CPR
+  tseries_counter_fn("chkpt_occupancy", tk_SAMPLE, chkpt_occupancy, NULL);
+#endif /* SIM_R10K_CPR */
+#ifdef SIM_R10K_REGCACHE
+  tseries_counter("reg_reads", tk_DELTA, &n_reg_read);
+  tseries_counter("reg_read_misses", tk_DELTA, &n_reg_read_miss);
+  tseries_counter("reg_writes", tk_DELTA, &n_reg_writes);
+  tseries_counter("reg_write_misses", tk_DELTA, &n_reg_writes_miss);
+#endif /* SIM_R10K_REGCACHE */
+  tseries_ratio("IPC", "insns", "cycles", 1.0);
+  tseries_ratio("branch_mpki", "branch_misp", "insns", 1000.0);
+#ifdef SIM_R10K_REGCACHE
+  tseries_ratio("reg_read_miss_rate", "reg_read_misses", "reg_reads", 1.0);
+  tseries_ratio("reg_write_miss_rate", "reg_write_misses", "reg_writes", 1.0);
+#endif /* SIM_R10K_REGCACHE */
+}
+
+/* re-check timing option values in a -sweep child after it applied its
+configuration, caches, TLBs and predictors keep their warm state */
+void
+sim_sweep_options(int argc, char **argv)	/* sweep configuration options */
+{
+  int i;
+
+  /* the warm caches, TLBs and predictors cannot be reconfigured */
+  for (i = 1; i < argc; i++)
+    if (argv[i][0] == '-' && opt_find_option(sim_odb, argv[i])
+	&& !sweep_option_ok(argv[i]))
+      fatal("option `%s' cannot change in a -sweep configuration", argv[i]);
+
+  if (tseries_enabled())
+    fatal("-sweep cannot be combined with -tseries");
+  if (ptrace_enabled())
+    fatal("-sweep cannot be combined with -ptrace");
+
+  core_check_options();
+  adisambig_init();
+#ifdef SIM_R10K_REGCACHE
+  regcache_check_options();
+#endif /* SIM_R10K_REGCACHE */
+#ifdef SIM_R10K_POWER
+  power_check_options();
+#endif /* SIM_R10K_POWER */
+  cpi_init(commit_width);
+  if (histo_active)
+    occupancy_init();
+
+  /* rebuild the (empty) physical register file at its new size */
+  free(pregs);
+  free(lregs);
+  memset(&pregs_flist, 0, sizeof(pregs_flist));
+#ifdef SIM_R10K_REGCACHE
+  memset(&l1_pregs_flist, 0, sizeof(l1_pregs_flist));
+  memset(&l2_pregs_flist, 0, sizeof(l2_pregs_flist));
+  memset(&l1_regcache_lru, 0, sizeof(l1_regcache_lru));
+#endif /* SIM_R10K_REGCACHE */
+  regs_init();
+
+  /* instruction and load/store stations for the new queue sizes */
+  INSN_init();
+  LDST_init();
+
+  /* fresh functional units */
+  respool_check_options(&respool_opt);
+  respool = respool_create(&respool_opt);
+#ifdef SIM_R10K_POWER
+
+  /* power model of the resized structures */
+  power_init();
+#endif /* SIM_R10K_POWER */
+}
+
+/* load program into simulated state */
+void
+sim_load_prog(char *fname,		/* program to load */
+	      int argc, char **argv,	/* program arguments */
+	      char **envp)		/* program environment */
+{
+  /* load program text and data, set up environment, memory, and regs */
+  ld_load_prog(fname, argc, argv, envp, &regs, mem, TRUE);
+
+  /* init predecoded instruction cache */
+  predec_init();
+}
+
+/* dump simulator-specific auxiliary simulator statistics */
+void
+sim_aux_stats(FILE *stream)             /* output stream */
+{
+  sim_stats(stream);
+  
+  if (bpred)
+    bpred_stats_print(bpred, n_insn_commit_sum, stream);
+
+  if (cache_dl1)
+    cache_stats_print(cache_dl1, stream);
+  if (cache_l2)
+    cache_stats_print(cache_l2, stream);
+  if (dtlb)
+    cache_stats_print(dtlb, stream);
+  if (cache_il1 && cache_il1 != cache_dl1)
+    cache_stats_print(cache_il1, stream);
+  if (itlb && itlb != dtlb)
+    cache_stats_print(itlb, stream);
+
+  predec_stats(stream);
+
+#ifdef SIM_R10K_POWER
+  power_stats_print(sim_cycle, stream);
+#endif /* SIM_R10K_POWER */
+}
+
+/* fill in the running totals of the timing model */
+void
+sim_sample_totals(struct sim_sample_t *totals)
+{
+  totals->n_insn = n_insn_commit_sum;
+  totals->n_cycle = sim_cycle;
+  totals->n_dl1_access = totals->n_dl1_miss = 0;
+  if (cache_dl1)
+    cache_totals(cache_dl1, &totals->n_dl1_access, &totals->n_dl1_miss);
+}
+
+/* un-initialize the simulator */
+void
+sim_uninit(void)
+{
+  tseries_close();
+  ptrace_close();
+}
+
+
+/* a register update unit (RUU) station, this record is contained in the
+   processors RUU, which serves as a collection of ordered reservations
+   stations.  The reservation stations capture register results and await
+   the time when all operands are ready, at which time the instruction is
+   issued to the functional units; the RUU is an order circular queue, in which
+   instructions are inserted in fetch (program) order, results are stored in
+   the RUU buffers, and later when an RUU entry is the oldest entry in the
+   machines, it and its instruction's value is retired to the architectural
+   register file in program order, NOTE: the RUU and LSQ share the same
+   structure, this is useful because loads and stores are split into two
+   operations: an effective address add and a load/store, the add is inserted
+   into the RUU and the load/store inserted into the LSQ, allowing the add
+   to wake up the load/store when effective address computation has finished */
+
+#define OPERANDS_READY(IS)                                              \
+  (((IS)->idep_ready[DEP_I1] && (IS)->time_ready[DEP_I1] != 0 && (IS)->time_ready[DEP_I1] <= sim_cycle) && \
+   ((IS)->idep_ready[DEP_I2] && (IS)->time_ready[DEP_I2] != 0 && (IS)->time_ready[DEP_I2] <= sim_cycle) && \
+   ((IS)->idep_ready[DEP_I3] && (IS)->time_ready[DEP_I3] != 0 && (IS)->time_ready[DEP_I3] <= sim_cycle))
+
+/* physical register and renaming management functions */
+
+/* assert that all logical registers are mapped */
+STATIC void
+regs_assert(void)
+{
+  regnum_t lreg;
+  for (lreg = 0; lreg < MD_TOTAL_REGS; lreg++)
+    assert(lregs[lreg] >= 0 && lregs[lreg] < rename_pregs_num);
+}
+ 
+/* allocate a new physical register from the free list */
+STATIC INLINE regnum_t 
+regs_alloc(void)
+{
+#ifdef SIM_R10K_REGCACHE
+  struct preg_t *preg = NULL;
+
+  /* Remove from free list */
+  if (l1_pregs_flist.num > 0 && !l1_pregfile_cache)
+    {
+      preg = l1_pregs_flist.head;
+      LE_UNCHAIN(preg, flist, &l1_pregs_flist);
+    }
+  else if (l2_pregs_flist.num > 0)
+    {
+      preg = l2_pregs_flist.head;
+      LE_UNCHAIN(preg, flist, &l2_pregs_flist);
+    }
+  else
+    {
+      panic("regs_alloc() - Out of registers!");
+    }
+#else /* !SIM_R10K_REGCACHE */
+  struct preg_t *preg = pregs_flist.head;
+
+  LE_UNCHAIN(preg, flist, &pregs_flist);
+#endif /* SIM_R10K_REGCACHE */
+
+  if (preg->f_allocated)
+    panic("register already allocated!");
+
+  preg->fault = md_fault_none;
+  preg->f_allocated = TRUE;
+  preg->when_written = 0;
+#ifdef SIM_R10K_REGCACHE
+  preg->bypassValue = FALSE;
+  preg->regCache = -1;
+  preg->dirty = FALSE;
+  preg->f_prefetch = FALSE;
+#endif /* SIM_R10K_REGCACHE */
+
+  return preg->pregnum;
+}
+#ifdef SIM_R10K_REGCACHE
+
+/* the register cache functions below are static inline, not STATIC
+   INLINE: STATIC is empty in this file, and an inline function that is
+   not static may not use the file-scope register cache state */
+
+/* consumers of PREG that have not issued yet, i.e. that will still
+   read it */
+static INLINE int
+regcache_uses(struct preg_t *preg)
+{
+  struct PREG_link_t *link;
+  int uses = 0;
+
+  for (link = preg->odeps_head; link; link = link->next)
+    if (PLINK_valid(link) && link->preg->is && !link->preg->is->when.issued)
+      uses++;
+
+  return uses;
+}
+
+/* L1 register cache entries compared by the usecount policy */
+#define REGCACHE_USECOUNT_WAYS	4
+
+/* L1 register cache entry to replace: the least recently used one, or
+   for usecount the one with the fewest remaining consumers among the
+   REGCACHE_USECOUNT_WAYS least recently used, so the cost per access
+   does not grow with the cache */
+static INLINE struct preg_t *
+regcache_victim(void)
+{
+  struct preg_t *slot, *victim = l1_regcache_lru.head;
+  int i, uses, min_uses;
+
+  if (regcache_repl != regcache_USECOUNT)
+    return victim;
+
+  min_uses = regcache_uses(&pregs[victim->regCache]);
+  for (i = 1, slot = victim->lru.next;
+       slot && i < REGCACHE_USECOUNT_WAYS && min_uses > 0;
+       i++, slot = slot->lru.next)
+    {
+      uses = regcache_uses(&pregs[slot->regCache]);
+      if (uses < min_uses)
+	{
+	  min_uses = uses;
+	  victim = slot;
+	}
+    }
+
+  return victim;
+}
+
+/* L1 register cache entry SLOT was used */
+#define REGCACHE_TOUCH(SLOT) \
+  { LE_UNCHAIN(SLOT, lru, &l1_regcache_lru); LE_CHAIN(SLOT, lru, &l1_regcache_lru); }
+
+/* PREG leaves the register cache or is freed, unread if prefetched */
+static INLINE void
+regcache_prefetch_drop(struct preg_t *preg)
+{
+  if (preg->f_prefetch)
+    {
+      preg->f_prefetch = FALSE;
+      n_reg_prefetch_useless++;
+    }
+}
+
+#ifdef SIM_R10K_POWER
+/* charge this cycle's L1 register cache and L2 register file accesses
+   to the power model, the port counters already bound them */
+static INLINE void
+regcache_power_count(void)
+{
+  int n;
+
+  for (n = 0; n < l1_preg_readNum; n++)
+    power_count_access(ps_REGCACHE, /* write_f */FALSE, /* hard_count_f */FALSE);
+  for (n = 0; n < l1_preg_writeNum; n++)
+    power_count_access(ps_REGCACHE, /* write_f */TRUE, /* hard_count_f */FALSE);
+  for (n = 0; n < l2_preg_readNum; n++)
+    power_count_access(ps_REGFILE, /* write_f */FALSE, /* hard_count_f */FALSE);
+  for (n = 0; n < l2_preg_writeNum; n++)
+    power_count_access(ps_REGFILE, /* write_f */TRUE, /* hard_count_f */FALSE);
+}
+#endif /* SIM_R10K_POWER */
+
+/* allocate a new physical register from the free list */
+static INLINE void
+cache_regs_alloc(struct preg_t* l2_preg, struct INSN_station_t *parent_is)
+{
+  struct preg_t *l1_preg = NULL;
+
+  if (l2_preg == NULL)
+    panic("NULL Register L2!");
+
+  /* Remove from free list */
+  if (l1_pregs_flist.num > 0)
+    {
+      l1_preg = l1_pregs_flist.head;
+      LE_UNCHAIN(l1_preg, flist, &l1_pregs_flist);
+    }
+  else
+    {
+      struct PREG_link_t *link;
+      struct preg_t *victim;
+      struct preg_t *lru_preg = regcache_victim();
+
+      victim =  &pregs[lru_preg->regCache];
+
+      if ((victim->dirty && l2_preg_writeNum  >= l2_pregfile_wwidth || l1_preg_readNum >= l2_pregfile_rwidth))
+	{
+	  l2_preg->regCache = -1;
+	  return;
+	}
+
+      if (victim->pregnum < l1_pregfile_size)
+	{
+	  panic("Register Victim from L1!");
+	}
+      else
+	{
+	  victim->regCache = -1;
+	  victim->latency  = l1_pregfile_lat + l2_pregfile_lat;
+	  victim->regFile  = L2_PREG_FILE;
+
+	  if (victim->is != NULL)
+	    victim->is->regWriteLatency[DEP_O1] = l2_pregfile_lat;
+
+	  if (victim->dirty)
+	    {
+	      victim->dirty = FALSE;
+	      parent_is->insnStall = l2_pregfile_lat;
+	      l2_preg_writeNum++;
+	      l1_preg_readNum++;
+	    }
+
+	  for (link = victim->odeps_head; link; link = link->next)
+	    {
+	      struct preg_t *opreg;
+	      struct INSN_station_t *ois;
+
+	      if (!PLINK_valid(link))
+		continue;
+
+	      opreg = link->preg;
+	      ois = opreg->is;
+	      ois->regReadLatency[link->x.opnum] = victim->latency;
+	    }
+
+	  regcache_prefetch_drop(victim);
+	  LE_UNCHAIN(lru_preg, lru, &l1_regcache_lru);
+	  n_reg_evict++;
+	  l1_preg = lru_preg;
+	}
+    }
+
+  if (l1_preg != NULL)
+    {
+      struct PREG_link_t *link;
+
+      if (l1_preg->pregnum >= l1_pregfile_size)
+	{
+	  panic("RegisterCache from L2!");
+	}
+
+      LE_CHAIN(l1_preg, lru, &l1_regcache_lru);
+      l1_preg->regCache                    = l2_preg->pregnum;
+
+      l2_preg->regCache                    = l1_preg->pregnum;
+      l2_preg->latency                     = l1_pregfile_lat;
+      l2_preg->regFile                     = L1_PREG_FILE;
+
+      if (l2_preg->is != NULL)
+	l2_preg->is->regWriteLatency[DEP_O1] = l2_preg->latency;
+
+      for (link = l2_preg->odeps_head; link; link = link->next)
+	{
+	  struct preg_t *opreg;
+	  struct INSN_station_t *ois;
+
+	  if (!PLINK_valid(link))
+	    continue;
+
+	  opreg = link->preg;
+	  ois = opreg->is;
+	  ois->regReadLatency[link->x.opnum] = l2_preg->latency;
+	}
+    }
+}
+#endif /* SIM_R10K_REGCACHE */
+#ifdef SIM_R10K_CPR
+
+// code_added function to add a physical register to the free list.
+STATIC INLINE void
+REGS_add_regs_free_list (int checkpoint)
+{
+  // for every physical register, check for mapings to a logical register.
+  // If any, thats the latest. let that be. If no, check the checkpoint and number of readers. Add it to the free list if checkpoint has been committed and no readers left.
+
+  regnum_t pregnum;
+  regnum_t lregnum;
+  int mapping = 0;
+
+  for (pregnum = 0; pregnum < rename_pregs_num; pregnum++)
+  {
+    struct preg_t *preg = &pregs[pregnum];
+
+    //if ( (pregs[pregnum]->f_allocated) & (pregs[pregnum]->read_counter == 0) & (pregs[pregnum]->checkpoint == checkpoint) )
+    if ( (preg->f_allocated) & (preg->read_counter == 0) & (preg->checkpoint == checkpoint) )
+
+    {
+      //check here if there is a latest mapping in the map table. if not, make f_allocated false and add to free list.
+      mapping = 0;
+      for(lregnum = 0; lregnum < MD_TOTAL_REGS; lregnum ++)
+      {
+        if( (lregs[lregnum] = pregnum) & (mapping!= 1) )
+        {
+          mapping = 1;
+        }
+      }
+
+      if (mapping == 0) //mapping is 0, free the reg
+      {
+        preg->f_allocated = FALSE;
+        // free output dependence tree
+        PLINK_free_list(preg->odeps_head);
+        preg->odeps_head = preg->odeps_tail = NULL;
+
+        // Add to free list
+        LE_CHAIN(preg, flist, &pregs_flist);
+
+        preg->tag++;
+      }
+    }
+  }
+}
+
+STATIC INLINE void
+REGS_update_regs_checkpoint (int checkpoint)
+{
+  // for every physical register tht has a mapping to a logical register, update the checkpoint number associated with the physical register.
+
+  regnum_t pregnum;
+  regnum_t lregnum;
+  int mapping = 0;
+
+  for (pregnum = 0; pregnum < rename_pregs_num; pregnum++)
+  {
+    struct preg_t *preg = &pregs[pregnum];
+
+    //check here if there is a mapping in the map table. if so, update checkpoint field of the register.
+    mapping = 0;
+    for(lregnum = 0; lregnum < MD_TOTAL_REGS; lregnum ++)
+    {
+      if(lregs[lregnum] == pregnum)
+      {
+        preg->checkpoint = checkpoint;
+      }
+    }
+  }
+}
+
+STATIC INLINE void
+REGS_revert_checkpoint (int checkpoint, regnum_t *map_table)
+{
+  //check for eveyr checkpoint if it is in use. If not in use, all the physical registers in its map table must be freed.
+  //Revert the current map table back to the checkpoint which is being reverted back to.
+
+  //loop through all map table entries and change all lregs.
+
+  int lregnum;
+  for(lregnum = 0; lregnum < MD_TOTAL_REGS; lregnum ++)
+  {
+    lregs[lregnum] = map_table[lregnum];
+  }
+
+  // loop through all physical regs and free those not in an active checkpoint.
+
+  int pregnum;
+  for (pregnum = 0; pregnum < rename_pregs_num; pregnum++)
+  {
+    struct preg_t *preg = &pregs[pregnum];
+    if(!(CHECK_isInUse(preg->checkpoint)) && preg->f_allocated)
+    {
+      //this preg belongs to a checkpoint not in use. The reg must be added to the free list.
+      preg->f_allocated = FALSE;
+      preg->checkpoint = -1;
+      preg->read_counter = 0;
+      // free output dependence tree
+      PLINK_free_list(preg->odeps_head);
+      preg->odeps_head = preg->odeps_tail = NULL;
+
+      // Add to free list
+      LE_CHAIN(preg, flist, &pregs_flist);
+
+      preg->tag++;
+    }
+  }
+}
+
+STATIC INLINE void
+REGS_removeReader(struct INSN_station_t *is){
+
+  int i;
+  for (i=0; i<DEP_NUM; i++){
+    if (is->pregnums[i]!=regnum_NONE){
+      pregs[is->pregnums[i]].read_counter--;
+    }
+  }
+
+}
+#endif /* SIM_R10K_CPR */
+
+/* return register to free list */
+static INLINE void
+regs_free(regnum_t fregnum)
+{
+  struct preg_t *preg = &pregs[fregnum];
+
+  if (!preg->f_allocated) panic("freeing an unallocated register!");
+  if (preg->is) panic("preg has an IS attached!");
+
+  preg->f_allocated = FALSE;
+
+#ifdef SIM_R10K_REGCACHE
+  regcache_prefetch_drop(preg);
+#endif /* SIM_R10K_REGCACHE */
+
+  /* free output dependence tree */
+  PLINK_free_list(preg->odeps_head);
+  preg->odeps_head = preg->odeps_tail = NULL;
+
+#ifdef SIM_R10K_REGCACHE
+  if (l1_pregfile_cache)
+    {
+      if (preg->pregnum >= l1_pregfile_size && preg->regFile == L1_PREG_FILE)
+	{
+	  /* release its register cache entry, lru keeps the
+	     entry pointing at the dead register until it is the
+	     victim, as before -pregfile:repl */
+	  if (regcache_repl != regcache_LRU)
+	    {
+	      struct preg_t *slot = &pregs[preg->regCache];
+
+	      LE_UNCHAIN(slot, lru, &l1_regcache_lru);
+	      slot->regCache = -1;
+	      LE_CHAIN(slot, flist, &l1_pregs_flist);
+	    }
+
+	  preg->regCache = -1;
+	  preg->latency  = l1_pregfile_lat + l2_pregfile_lat;
+	  preg->regFile  = L2_PREG_FILE;
+	}
+    }
+  /* Add to free list */
+  if (preg->regFile == L1_PREG_FILE)
+    {
+      LE_CHAIN(preg, flist, &l1_pregs_flist);
+    }
+  else if (preg->regFile == L2_PREG_FILE)
+    {
+      LE_CHAIN(preg, flist, &l2_pregs_flist);
+    }
+  else
+    panic("regs_free() - register not in a register type!");
+#else /* !SIM_R10K_REGCACHE */
+  /* Add to free list */
+  LE_CHAIN(preg, flist, &pregs_flist);
+#endif /* SIM_R10K_REGCACHE */
+
+  preg->tag++;
+}
+
+/* set a mapping in the map table, return the previous mapping (used
+   later in recovery and freeing) */
+STATIC INLINE regnum_t
+regs_connect(regnum_t lregnum, 
+	     regnum_t pregnum)
+{
+  regnum_t fregnum;
+
+  if (!REG_ISDEP(lregnum))
+    panic("shouldn't happen anymore!");
+
+  fregnum = lregs[lregnum];
+  lregs[lregnum] = pregnum;
+
+  return fregnum;
+}
+ 
+STATIC INLINE void
+regs_unlink(regnum_t pregnum,
+	    regnum_t pregnum_unlink)
+{
+  struct PREG_link_t *link, *plink;
+  struct preg_t *preg, *preg_unlink;
+
+  if (pregnum == regnum_NONE || pregnum_unlink == regnum_NONE)
+    return;
+
+  preg = &pregs[pregnum];
+  preg_unlink = &pregs[pregnum_unlink];
+
+  for (plink = NULL, link = preg->odeps_head; link; plink = link, link = link->next)
+    if (link->preg == preg_unlink)
+      break;
+
+  if (!link)
+    return;
+
+  if (!plink)
+    preg->odeps_head = link->next;
+  else
+    plink->next = link->next;
+
+  if (link == preg->odeps_tail) 
+    preg->odeps_tail = plink;
+
+  PLINK_free(link);
+}
+
+STATIC INLINE regnum_t
+regs_rename(regnum_t lregnum)
+{
+  if (lregnum == regnum_NONE)
+    panic("shouldn't be renaming this register!");
+#ifdef SIM_R10K_CPR
+  struct preg_t *pregWork = pregs;
+  pregWork[lregs[lregnum]].read_counter++;
+#endif /* SIM_R10K_CPR */
+
+  return lregs[lregnum];
+}
+
+STATIC INLINE void
+regs_commit(regnum_t pregnum)
+{
+  struct preg_t *preg = &pregs[pregnum];
+
+  if (!preg->f_allocated)
+    panic("committing an unallocated register!");
+
+#ifdef SIM_R10K_REGCACHE
+  preg->bypassValue = FALSE;
+#endif /* SIM_R10K_REGCACHE */
+  /* free output dependence tree */
+  PLINK_free_list(preg->odeps_head);
+  preg->odeps_head = preg->odeps_tail = NULL;
+}
+
+STATIC INLINE void
+regs_recover(regnum_t lregnum,
+	     regnum_t pregnum,
+	     regnum_t rregnum)
+{
+  struct preg_t *rreg = &pregs[rregnum];
+  /* these are constant mappings */
+  /* roll back mapping */
+  if (!rreg->f_allocated) panic("rolling back an unallocated register!");
+  lregs[lregnum] = rregnum;
+}
+
+STATIC void
+regs_tosyscall(void)
+{
+  int i;
+
+  /* Copy values from physical registers to architectural registers */
+  for (i = 0; i < MD_TOTAL_REGS; i++)
+    {
+      regs.regs[i].q = pregs[lregs[i]].val.q;
+      regs_free(lregs[i]);
+      lregs[i] = regnum_NONE;
+    }
+}
+
+STATIC void
+regs_fromsyscall(void)
+{
+  int i;
+
+  /* Allocated brand new registers */
+  for (i = 0; i < MD_TOTAL_REGS; i++)
+    {
+      lregs[i] = regs_alloc();
+      pregs[lregs[i]].when_written = sim_cycle;
+      pregs[lregs[i]].val.q = regs.regs[i].q;
+    }
+}
+
+STATIC void
+regs_func2timing(void)
+{
+  regs_fromsyscall();
+
+  fetch_PC = regs.PC;
+  assert(valid_text_address(mem, fetch_PC));
+}
+
+STATIC void
+regs_timing2func(void)
+{
+  regs_tosyscall();
+
+  regs.PC = commit_NPC;
+  regs.NPC = regs.PC + sizeof(md_inst_t);
+}
+STATIC void
+regs_init(void)
+{
+  regnum_t pregnum;
+
+  /* allocate physical registers */
+  pregs = (struct preg_t *)mycalloc(rename_pregs_num, sizeof(struct preg_t));
+
+#ifdef SIM_R10K_REGCACHE
+  for (pregnum = 0; pregnum < l1_pregfile_size; pregnum++)
+    {
+      struct preg_t *preg = &pregs[pregnum];
+      preg->pregnum = pregnum;
+      preg->latency = l1_pregfile_lat;
+      preg->regFile = L1_PREG_FILE;
+      LE_CHAIN(preg, flist, &l1_pregs_flist);
+    }
+
+  for (pregnum = l1_pregfile_size; pregnum < rename_pregs_num; pregnum++)
+    {
+      struct preg_t *preg = &pregs[pregnum];
+      preg->pregnum = pregnum;
+      if (l1_pregfile_cache)
+	preg->latency = l1_pregfile_lat + l2_pregfile_lat;
+      else
+	preg->latency = l2_pregfile_lat;
+
+      preg->regFile = L2_PREG_FILE;
+      LE_CHAIN(preg, flist, &l2_pregs_flist);
+    }
+#else /* !SIM_R10K_REGCACHE */
+  for (pregnum = 0; pregnum < rename_pregs_num; pregnum++)
+    {
+      struct preg_t *preg = &pregs[pregnum];
+      preg->pregnum = pregnum;
+#ifdef SIM_R10K_CPR
+      //code_added to initialize the checkpoint associated with the physical register
+      preg->checkpoint = -1;
+#endif /* SIM_R10K_CPR */
+      LE_CHAIN(preg, flist, &pregs_flist);
+    }
+#endif /* SIM_R10K_REGCACHE */
+
+  /* allocate logical registers */
+  lregs = (regnum_t *)mycalloc(MD_TOTAL_REGS, sizeof(regnum_t));
+}
+
+
+#define LOAD_ADDR_READY(RS)             ((RS)->idep_ready[DEP_ADDR] && (RS)->time_ready[DEP_ADDR] != 0 && (RS)->time_ready[DEP_ADDR] <= sim_cycle)
+#define STORE_ADDR_READY(RS)            ((RS)->idep_ready[DEP_ADDR] && (RS)->time_ready[DEP_ADDR] != 0 && (RS)->time_ready[DEP_ADDR] <= sim_cycle)
+#define STORE_DATA_READY(RS)            ((RS)->idep_ready[DEP_STORE_DATA] && (RS)->time_ready[DEP_STORE_DATA] != 0 && (RS)->time_ready[DEP_STORE_DATA] <= sim_cycle))
+
+
+/* Instruction execution functions */
+
+STATIC enum md_fault_t
+stq_load(struct mem_t *mem,	/* memory space to access */
+	 enum mem_cmd_t cmd,	/* Read or Write access cmd */
+	 md_addr_t addr,		/* virtual address of access */
+	 void *p,			/* input/output buffer */
+	 int nbytes)		/* number of bytes to access */
+{
+  struct LDST_station_t *store;
+  
+  /* check alignments, even speculative this test should always pass */
+  if (!IS_POWEROFTWO(nbytes) != 0 || (addr & (nbytes-1)) != 0)
+    return md_fault_alignment;
+
+  /* check permissions */
+  if (!((addr >= ld_text_base && addr < (ld_text_base+ld_text_size)
+	 && cmd == mc_READ)
+	|| MD_VALID_ADDR(addr)))
+    {
+#ifdef MD_ACCESS_FAULTS
+      return md_fault_access;
+#else /* !MD_ACCESS_FAULTS */
+      *(quad_t*)p = 0;
+      return md_fault_none;
+#endif /* MD_ACCESS_FAULTS */
+    }
+
+  for (store = LSQ.tail; store; store = store->prev)
+    {
+      if (store->is->pdi->iclass != ic_store)
+	continue;
+      
+      /* not the same address */
+      if (MD_ALIGN_ADDR(addr) != MD_ALIGN_ADDR(store->addr))
+	continue;
+      
+      /* same address => bypass */
+      *(quad_t*)p = 0;
+      READ_QUAD(p, &store->val.q, MD_ADDR_OFFSET(addr), nbytes);
+      return md_fault_none;
+    }
+	  
+  return mem_access(mem, cmd, addr, p, nbytes);
+}
+
+STATIC enum md_fault_t
+stq_store(struct mem_t *mem,	/* memory space to access */
+	  enum mem_cmd_t cmd,	/* Read or Write access cmd */
+	  md_addr_t addr,		/* virtual address of access */
+	  void *p,			/* input/output buffer */
+	  int nbytes)		/* number of bytes to access */
+{
+  struct LDST_station_t *store = NULL;
+  bool_t partial = FALSE;
+      
+  /* check alignments, even speculative this test should always pass */
+  if (!IS_POWEROFTWO(nbytes) != 0 || (addr & (nbytes-1)) != 0)
+    return md_fault_alignment;
+
+  /* check permissions */
+  if (!((addr >= ld_text_base && addr < (ld_text_base+ld_text_size)
+	 && cmd == mc_READ)
+	|| MD_VALID_ADDR(addr)))
+    {
+#ifdef MD_ACCESS_FAULTS
+      return md_fault_access;
+#else /* !MD_ACCESS_FAULTS */
+      return md_fault_none;
+#endif /* MD_ACCESS_FAULTS */
+    }
+
+  for (store = LSQ.tail->prev; store; store = store->prev)
+    {
+      if (store->is->pdi->iclass != ic_store)
+	continue;
+      
+      /* combine partials */
+      if (MD_ALIGN_ADDR(addr) == MD_ALIGN_ADDR(store->addr))
+	{
+	  partial = TRUE;
+	  LSQ.tail->val.q = store->val.q;
+	  break;
+	}
+    }
+      
+  /* read the entire line so that we can merge partials */
+  if (!partial)
+    mem_access(mem, mc_READ, MD_ALIGN_ADDR(addr), 
+	       &(LSQ.tail->val.q), MD_DATAPATH_WIDTH);
+  
+  /* merge partrial */
+  WRITE_QUAD(p, &LSQ.tail->val.q, MD_ADDR_OFFSET(addr), nbytes);
+  return md_fault_none;
+}
+
+
+#define IR1 DEP_I1
+#define IR2 DEP_I2
+#define IR3 DEP_I3
+#define OR1 DEP_O1
+
+/* program counters */
+#define CPC                     (is->pdi->poi.PC)
+#define SET_NPC(EXPR)           (is->NPC = (EXPR))
+#define SET_TPC(EXPR)		(is->TPC = (EXPR))
+
+/* general purpose register accessors */
+#define READ_REG_Q(N)           (pregs[is->pregnums[(N)]].val.q)
+#define WRITE_REG_Q(N,EXPR)     (pregs[is->pregnums[(N)]].val.q = (EXPR))
+#define READ_REG_F(N)           (pregs[is->pregnums[(N)]].val.d)
+#define WRITE_REG_F(N,EXPR)     (pregs[is->pregnums[(N)]].val.d = (EXPR))
+
+/* set address/address mask */
+#define SET_ADDR_DSIZE(ADDR,DSIZE)   \
+  (is->ls->addr = (ADDR), is->ls->dsize = (DSIZE))
+
+#define READ(ADDR, PVAL, SIZE) stq_load(mem, mc_READ, (ADDR), (PVAL), (SIZE))
+#define WRITE(ADDR, PVAL, SIZE) stq_store(mem, mc_WRITE, (ADDR), (PVAL), (SIZE))
+
+/* system call handler macro */
+#define SYSCALL(INST)							\
+  {/* only execute system calls in non-speculative mode */		\
+     regs_tosyscall();                                                 \
+     if (fdump && sim_num_insn >= insn_dumpbegin && sim_num_insn < insn_dumpend) \
+        md_print_regs(&regs, fdump);                                    \
+     HPROF_CALL(hp_SYSCALL, sys_syscall(&regs, mem_access, mem, INST, TRUE));         \
+     if (fdump && sim_num_insn >= insn_dumpbegin && sim_num_insn < insn_dumpend) \
+        md_print_regs(&regs, fdump);                                    \
+     regs_fromsyscall();                                               \
+     is->NPC = regs.NPC; is->TPC = regs.TPC;                        \
+  }
+
+STATIC void 
+exec_insn(struct INSN_station_t *is)
+{
+  md_inst_t inst = is->pdi->inst;
+  
+  regs.PC = is->pdi->poi.PC;
+  /* compute default next PC */
+  regs.NPC = is->NPC = is->pdi->poi.PC + sizeof(md_inst_t);
+	  
+  /* maintain $r0 semantics (in spec and non-spec space) */
+  pregs[lregs[MD_REG_ZERO]].val.q = 0; 
+  pregs[lregs[MD_FREG_ZERO]].val.d = 0.0; 
+
+  /* set default fault - none */
+  pregs[is->pregnums[DEP_O1]].fault = md_fault_none;
+
+#undef DECLARE_FAULT
+#define DECLARE_FAULT(FAULT) pregs[is->pregnums[DEP_O1]].fault = (FAULT)
+
+  /* execute the instruction */
+  switch (is->pdi->poi.op)
+    {
+#define DEFINST(OP,MSK,NAME,OPFORM,RES,CLASS,O1,O2,I1,I2,I3)		\
+	case OP:							\
+	  /* execute the instruction */					\
+	  SYMCAT(OP,_IMPL);						\
+	  break;
+#define DEFLINK(OP,MSK,NAME,MASK,SHIFT)					\
+	case OP:							\
+	  /* could speculatively decode a bogus inst, convert to NOP */	\
+	  /* no EXPR */							\
+	  break;
+#define CONNECT(OP)	/* nada... */
+#include "machine.def"
+    default:
+      /* can speculatively decode a bogus inst, convert to a NOP */
+      break;
+    }
+  /* operation sets next PC */
+}
+
+/* undef instruction execution engine */
+#undef SET_NPC
+#undef SET_TPC
+#undef SET_TPC
+#undef CPC
+#undef READ_REG_Q
+#undef WRITE_REG_Q
+#undef READ_REG_F
+#undef WRITE_REF_F
+#undef SET_ADDR_DSIZE
+#undef READ
+#undef WRITE
+#undef SYSCALL
+#undef IR1
+#undef IR2
+#undef IR3
+#undef OR1
+
+/* recover instruction trace generator state to precise state state immediately
+   before the first mis-predicted branch; this is accomplished by resetting
+   all register value copied-on-write bitmasks are reset, and the speculative
+   memory hash table is cleared */
+STATIC void
+IFQ_recover(struct INSN_station_t *recover_is)
+{
+  struct INSN_station_t *is;
+
+  /* reset trace generation mode */
+  f_wrong_path = recover_is->f_wrong_path;
+  
+  /* squash everything in IFQ */
+  while ((is = IFQ.head))
+    {
+      INSN_remove(&IFQ, is);
+      INSN_free(is);
+    }
+
+  if (IFQ.num)
+    panic("should have cleaned this guy out!");
+
+  /* reset IFETCH state */
+  fetch_PC = recover_is->NPC;
+  fetch_resume = sim_cycle + 1;
+
+  /* special case: recovering to a mispredicted branch which has
+     not yet resolved */
+  if (recover_is->f_bmisp)
+    {
+      f_wrong_path = TRUE;
+      fetch_PC = recover_is->PPC;
+    }
+
+  assert(recover_is->f_wrong_path || valid_text_address(mem, fetch_PC));
+}
+
+void 
+IFQ_cleanup(void)
+{
+  struct INSN_station_t *is;
+
+  /* squash everything in IFQ */
+  while ((is = IFQ.head))
+    {
+      INSN_remove(&IFQ, is);
+      INSN_free(is);
+    }
+
+  f_wrong_path = 0;
+  fetch_PC = 0;
+  fetch_resume = 0;
+  rename_resume = 0;
+}
+
+#ifndef SIM_R10K_CPR
+/* recover processor microarchitecture state back to point of the
+   mis-predicted branch at RUU[BRANCH_INDEX] */
+STATIC void
+ROB_recover(struct INSN_station_t *recover_is,
+	    bool_t f_bmisp)
+{
+  int n_recover = 0;
+  /* recover from the tail of the RUU towards the head until the branch index
+     is reached, this direction ensures that the LSQ can be synchronized with
+     the RUU */
+
+  if (!ROB.tail)
+    panic("empty RUU");
+
+  /* traverse to older insts until the mispredicted branch is encountered */
+  while (ROB.tail && ROB.tail != recover_is)
+    {
+      struct INSN_station_t *is = ROB.tail;
+      struct preg_t *preg = &pregs[is->pregnums[DEP_O1]];
+
+      assert(preg->pregnum == is->pregnums[DEP_O1] && preg->is == is);
+
+      /* is this operation an effective addr calc for a load or store? */
+      if (is->pdi->iclass == ic_store || is->pdi->iclass == ic_load || is->pdi->iclass == ic_prefetch)
+	{
+	  struct LDST_station_t *ls = LSQ.tail;
+	  assert(is->ls == ls && ls->is == is);
+	  LDST_remove(&LSQ, ls, is->pdi->iclass == ic_store);
+	  LDST_free(ls);
+	}
+
+      if (is->f_rs)
+	{
+	  is->f_rs = FALSE;
+	  rs_num++;
+	  SCHED_LEAVE(is);
+	}
+
+      preg->is = NULL;
+      regs_free(is->pregnums[DEP_O1]);
+      regs_recover(is->pdi->lregnums[DEP_O1], is->pregnums[DEP_O1], is->fregnum);
+
+      INSN_remove(&ROB, is);
+      INSN_free(is);
+
+      n_recover++;
+    }
+
+  rename_resume = sim_cycle + DIV_ROUND_UP(n_recover, recover_width);
+}
+
+STATIC void
+ROB_cleanup(void)
+{
+  /* recover from the tail of the RUU towards the head until the branch index
+     is reached, this direction ensures that the LSQ can be synchronized with
+     the RUU */
+
+  /* traverse to older insts until the mispredicted branch is encountered */
+  while (ROB.tail)
+    {
+      struct INSN_station_t *is = ROB.tail;
+      struct preg_t *preg = &pregs[is->pregnums[DEP_O1]];
+
+      assert(preg->is == is);
+
+      /* is this operation an effective addr calc for a load or store? */
+      if (is->pdi->iclass == ic_store || is->pdi->iclass == ic_load)
+	{
+	  struct LDST_station_t *ls = LSQ.tail;
+	  assert(is->ls == ls && ls->is == is);
+	  LDST_remove(&LSQ, ls, is->pdi->iclass == ic_store);
+	  LDST_free(ls);
+	}
+
+      if (is->f_rs)
+	{
+	  is->f_rs = FALSE;
+	  rs_num++;
+	  SCHED_LEAVE(is);
+	}
+
+      preg->is = NULL;
+      regs_free(is->pregnums[DEP_O1]);
+      regs_recover(is->pdi->lregnums[DEP_O1], is->pregnums[DEP_O1], is->fregnum);
+
+      INSN_remove(&ROB, is);
+      INSN_free(is);
+    }
+}
+#endif /* !SIM_R10K_CPR */
+
+/*
+ * the ready instruction queue implementation follows, the ready instruction
+ * queue indicates which instruction have all of there *register* dependencies
+ * satisfied, instruction will issue when 1) all memory dependencies for
+ * the instruction have been satisfied (see lsq_refresh() for details on how
+ * this is accomplished) and 2) resources are available; ready queue is fully
+ * constructed each cycle before any operation is issued from it -- this
+ * ensures that instruction issue priorities are properly observed; NOTE:
+ * IS_LINK nodes are used for the event queue list so that it need not be
+ * updated during squash events
+ */
+
+/* insert ready node into the ready list using ready instruction scheduling
+   policy; currently the following scheduling policy is enforced:
+
+   memory and long latency operands, and branch instructions first
+
+   then
+
+   all other instructions, oldest instructions first
+
+   this policy works well because branches pass through the machine quicker
+   which works to reduce branch misprediction latencies, and very long latency
+   instructions (such loads and multiplies) get priority since they are very
+   likely on the program's critical path */
+STATIC void
+scheduler_enqueue(struct preg_t *preg) 		/* IS to enqueue */
+{
+  struct PREG_link_t *pnode, *node, *nnode, *new_node;
+
+  if (!OPERANDS_READY(preg->is))
+    return;
+
+  /* locate insertion point */
+  for (pnode = NULL, node = scheduler_queue;
+       node;
+       node = nnode)
+    {
+      nnode = node->next;
+      HPROF_WORK(hp_SCHED_ENQUEUE, 1);
+
+      /* Deal with invalid nodes */
+      if (!PLINK_valid(node))
+	{
+	  if (pnode) pnode->next = nnode;
+	  else scheduler_queue = nnode;
+
+	  PLINK_free(node);
+	  continue;
+	}
+
+      /* already on scheduler's list */
+      if (preg->is->seq == node->preg->is->seq)
+	return;
+
+      /* put it here */
+      if (preg->is->seq < node->preg->is->seq)
+	break;
+
+      pnode = node;
+    }
+
+  /* get a free ready list node */
+  new_node = PLINK_new();
+  PLINK_set(new_node, preg);
+  new_node->x.seq = preg->is->seq;
+
+  if (pnode)
+    {
+      /* insert middle or end */
+      new_node->next = pnode->next;
+      pnode->next = new_node;
+    }
+  else
+    {
+      /* insert at beginning */
+      new_node->next = scheduler_queue;
+      scheduler_queue = new_node;
+    }
+
+  if (histo_active && !preg->is->f_sched)
+    {
+      preg->is->f_sched = TRUE;
+      scheduler_num++;
+    }
+  preg->is->when.ready = MAX(preg->is->when.regread, sim_cycle);
+}
+#ifdef SIM_R10K_CPR
+
+/* a checkpoint revert drops scheduler queue nodes without their
+   instructions leaving their reservation stations: unmark the queued
+   instructions before the revert, and re-mark and recount the ones still
+   queued after it */
+STATIC void
+scheduler_mark(bool_t f_sched)
+{
+  struct PREG_link_t *node;
+
+  scheduler_num = 0;
+  for (node = scheduler_queue; node; node = node->next)
+    if (PLINK_valid(node) && node->preg->is)
+    {
+      node->preg->is->f_sched = f_sched;
+      if (f_sched)
+        scheduler_num++;
+    }
+}
+#endif /* SIM_R10K_CPR */
+
+STATIC void
+scheduler_cleanup(void)
+{
+  while (scheduler_queue)
+    {
+      struct PREG_link_t *plink = scheduler_queue;
+      scheduler_queue = plink->next;
+      PLINK_free(plink);
+    }
+}
+
+/* commit store to data cache if there are free ports, used in commit_stage */
+
+STATIC bool_t
+commit_store(struct INSN_station_t *is)
+{
+  struct LDST_station_t *store = LSQ.head;
+
+  assert(is->ls == store);
+
+  /* go to the data cache */
+  if (cache_dl1)
+    cache_access(cache_dl1, mc_WRITE, 
+		 MD_ALIGN_ADDR(store->addr), MD_DATAPATH_WIDTH, 
+		 sim_cycle, NULL, dl1_miss_handler);
+  
+  /* all loads and stores must access D-TLB */
+  if (dtlb)
+    cache_access(dtlb, mc_READ, 
+		 MD_ALIGN_ADDR(store->addr), MD_DATAPATH_WIDTH, 
+		 sim_cycle, NULL, dtlb_miss_handler);
+  
+  /* Write store value to memory */
+  mem_access(mem, mc_WRITE, MD_ALIGN_ADDR(store->addr), 
+	     (byte_t *)&store->val.q, MD_DATAPATH_WIDTH);
+
+  return TRUE;
+}
+#ifdef SIM_R10K_CPR
+
+/* committed instruction count at the last commit slot accounting */
+static counter_t cpi_commit_mark = 0;
+#endif /* SIM_R10K_CPR */
+#ifdef SIM_R10K_CPR
+
+/* CPI stack cause of a commit stall: instructions commit in bulk with
+   their checkpoint (CHECK_tryCommit()), so the oldest memory operation
+   stands in for the head */
+STATIC enum cpi_cause_t
+commit_stall_cause(void)
+{
+  struct INSN_station_t *is;
+  int i, n_inflight = 0;
+
+  for (i = 0; i < CHECK_buffer.tail; i++)
+    n_inflight += checkpoint_elements[CHECK_buffer.buffer[i]].numberOfInstructions;
+
+  if (n_inflight == 0 && !LSQ.head)
+    return cpi_frontend();
+
+  if (LSQ.head)
+  {
+    is = LSQ.head->is;
+    if (is->pdi->iclass != ic_prefetch &&
+        pregs[is->pregnums[DEP_O1]].when_written == 0)
+    {
+      if (is->f_dmiss)
+        return cpi_DCACHE;
+      return cpi_backend(cpi_FU);
+    }
+  }
+
+  if (cpi_rename_stall != cpi_NUM)
+    return cpi_rename_stall;
+  return cpi_FU;
+}
+#else /* !SIM_R10K_CPR */
+
+/* CPI stack cause of a commit stall behind incomplete head IS */
+STATIC enum cpi_cause_t
+commit_stall_cause(struct INSN_station_t *is)
+{
+#ifdef SIM_R10K_REGCACHE
+  struct preg_t *ipreg;
+  int i;
+
+#endif /* SIM_R10K_REGCACHE */
+  if (is->f_bmisp)
+    return cpi_BMISP;
+  if (is->f_dmiss)
+    return cpi_DCACHE;
+
+#ifdef SIM_R10K_REGCACHE
+  /* operand ready but still being read from the L2 register file */
+  if (!is->when.issued)
+    {
+      for (i = DEP_I1; i <= DEP_I3; i++)
+	{
+	  if (!LREG_ISDEP(is->pdi->lregnums[i]))
+	    continue;
+
+	  ipreg = &pregs[is->pregnums[i]];
+	  if (!ipreg->bypassValue && is->regReadLatency[i] > 0 && ipreg->regFile == L2_PREG_FILE)
+	    return cpi_REGCACHE;
+	}
+    }
+
+#endif /* SIM_R10K_REGCACHE */
+  return cpi_backend(cpi_FU);
+}
+#endif /* SIM_R10K_CPR */
+#ifdef SIM_R10K_CPR
+
+/* this function commits the results of the oldest completed entries from the
+   RUU and LSQ. Stores in the LSQ commit their data to the data cache */
+STATIC void
+commit_stage(void)
+{
+  int commit_n = 0, commit_store_n = 0;
+  /* all values must be retired to the architected reg file in
+     program order */
+
+  while (LSQ.head &&
+      commit_n < commit_width)
+  {
+    struct INSN_station_t *is = LSQ.head->is;
+    struct preg_t *preg = &pregs[is->pregnums[DEP_O1]];
+    struct preg_t *freg = &pregs[is->fregnum];
+
+    if(!is->ls->commit)
+    	break;
+
+    /* at least RUU entry must be complete.  BTW, complete
+   means complete last cycle */
+    if (is->f_wrong_path){
+      fprintf(stdout, "WRONG PATH INSN: %d CHECKPOINT: %d PC: %d\n", is->pdi->iclass, is->checkpoint, is->PC);
+      CHECK_dump();
+      panic("committing a wrong-path insn!");
+    }
+
+    if (preg->fault != md_fault_none)
+      panic("committing faulting instruction!");
+
+    if (/* prefetches are automatically complete */
+        is->pdi->iclass != ic_prefetch &&
+        is->pdi->iclass != ic_sys &&
+        preg->when_written == 0)
+      break;
+
+    if (is->pdi->iclass == ic_store)
+    {
+      if (commit_store_n == commit_store_width)
+        break;
+
+      if (!commit_store(is))
+        break;
+
+      commit_store_n++;
+    }
+
+    /* all right, we're committing this guy */
+    n_insn_commit[is->pdi->iclass]++;
+    n_insn_commit_sum++;
+    sim_num_insn++;
+
+    //FIXME: Move some of this to the writeback stage!
+    /*
+      if (is->pdi->iclass == ic_sys)
+  {
+    //This preg will be freed.  We will need to allocate a new one
+    preg->is = NULL;
+    //Do the syscall
+    HPROF_CALL(hp_EXEC, exec_insn(is));
+    //Allocate new physical register
+    is->pregnums[DEP_O1] = lregs[is->pdi->lregnums[DEP_O1]];
+    preg = &pregs[is->pregnums[DEP_O1]];
+
+    preg->is = is;
+    preg->when_written = sim_cycle;
+  }*/
+
+    /*
+      else if (is->pdi->iclass == ic_ctrl)
+  {
+    //Update branch predictor
+    if (bpred)
+      bpred_update(bpred,
+       //branch address
+          is->PC,
+       //instruction
+          is->pdi->poi.op,
+       //actual target address
+          is->NPC,
+       //target address
+          is->TPC,
+       //predicted target address
+          is->PPC,wp
+       //update info
+          &is->bp_pre_state);
+
+    if (is->NPC != is->PPC)
+      n_branch_misp++;
+  }*/
+
+    if (fdump)
+    {
+      if (sim_num_insn >= insn_dumpbegin && sim_num_insn < insn_dumpend)
+      {
+        fprintf(fdump, "%-9u: 0x%08x ",
+            (word_t)sim_num_insn,
+            (word_t)is->PC);
+        if (LREG_ISDEP(is->pdi->lregnums[DEP_O1]))
+          myfprintf(fdump, " O1: %016p", pregs[is->pregnums[DEP_O1]].val.q);
+        if (is->pdi->iclass == ic_load || is->pdi->iclass == ic_store || is->pdi->iclass == ic_prefetch)
+          myfprintf(fdump, ", addr: %016p", is->ls->addr);
+        fprintf(fdump, "\n");
+        fflush(fdump);
+      }
+      else if (sim_num_insn == insn_dumpend)
+      {
+        fclose(fdump);
+      }
+    }
+
+    if (is->pdi->iclass == ic_load || is->pdi->iclass == ic_store || is->pdi->iclass == ic_prefetch)
+    {
+
+      /* remove from LSQ */
+      struct LDST_station_t *ls = LSQ.head;
+      assert(ls == is->ls && is == ls->is);
+      LDST_remove(&LSQ, ls, is->pdi->iclass == ic_store);
+      LDST_free(ls);
+    }
+
+    /*
+    if (is->f_rs)
+    {
+      if (is->pdi->iclass != ic_prefetch)
+        panic("non-prefetch with RS at retirement!");
+
+      is->f_rs = FALSE;
+      rs_num++;
+      SCHED_LEAVE(is);
+    }
+
+    regs_commit(is->pregnums[DEP_O1]);
+     */
+
+    //committing now
+    is->when.committed = sim_cycle;
+    if (critpath_window)
+      INSN_critpath(is);
+    fprintf(stdout, "COMMIT_STAGE COMMIT\n");
+    fprintf(stdout, "INSTRUCTION: %d FROM CHECKPOINT: %d COMMITTED PC: %d\n", is->pdi->iclass, is->checkpoint, is->PC);
+
+    /* free over-written register */
+    /*if (freg->is) panic("what is this guy still doing with an IS?");
+
+    regs_free(is->fregnum);*/
+
+    /* Reclaim resources of committing register */
+    /* Only for "original instance" */
+    if (!preg->is)
+      panic("what is this guy doing without an IS?");
+    preg->is = NULL;
+
+    /* external per-instruction instance counter, occasionally useful */
+    commit_NPC = is->NPC;
+
+    //INSN_remove(&ROB, is);
+    INSN_free(is);
+
+    /* one more instruction committed to architected state */
+    commit_n++;
+  }
+
+  struct preg_t *sys_preg;
+
+  if (hasSystemCall)
+  {
+    sys_preg = &pregs[systemCallAddress->pregnums[DEP_O1]];
+    //This preg will be freed.  We will need to allocate a new one
+    sys_preg->is = NULL;
+    //Do the syscall
+    HPROF_CALL(hp_EXEC, exec_insn(systemCallAddress));
+    //Allocate new physical register
+    systemCallAddress->pregnums[DEP_O1] = lregs[systemCallAddress->pdi->lregnums[DEP_O1]];
+    sys_preg = &pregs[systemCallAddress->pregnums[DEP_O1]];
+
+    sys_preg->is = systemCallAddress;
+    sys_preg->when_written = sim_cycle;
+
+    systemCallAddress = NULL;
+    hasSystemCall = FALSE;
+  }
+
+  /* charge the unused commit slots, counting the checkpoint commits
+     since the last cycle */
+  cpi_cycle((int)(n_insn_commit_sum - cpi_commit_mark), commit_stall_cause());
+  cpi_commit_mark = n_insn_commit_sum;
+}
+#else /* !SIM_R10K_CPR */
+
+/* this function commits the results of the oldest completed entries from the
+   RUU and LSQ. Stores in the LSQ commit their data to the data cache */
+STATIC void
+commit_stage(void)
+{
+#ifdef SIM_R10K_REGCACHE
+  static unsigned int registerStall = 0;
+  static bool_t calcStall  = TRUE;
+
+#endif /* SIM_R10K_REGCACHE */
+  int commit_n = 0, commit_store_n = 0, commit_ctrl_n = 0;
+  enum cpi_cause_t stall = cpi_OTHER;
+#ifdef SIM_R10K_REGCACHE
+
+  int i = 0, maxLatency = 1;
+  struct INSN_station_t *t_is = ROB.head;
+  struct preg_t *t_preg       = NULL;
+
+  for (i=0; i<commit_width; i++)
+    {
+      if (t_is == NULL)
+	break;
+
+      t_preg = &pregs[t_is->pregnums[DEP_O1]];
+      /* nobypass: a value all of whose consumers have read it (most
+	 through the bypass) is written to the L2 only */
+      if (l1_pregfile_cache && t_preg->regFile == L2_PREG_FILE
+	  && (regcache_repl != regcache_NOBYPASS || regcache_uses(t_preg) > 0))
+	{
+	  cache_regs_alloc(t_preg, t_is);
+	  if (t_preg->regCache < 0)
+	    {
+	      break;
+	    }
+	  else
+	    {
+	      n_reg_writes_miss++;
+	    }
+	}
+      else if (l1_pregfile_cache && t_preg->pregnum < l1_pregfile_size)
+	panic("Using Pure L1 Register!");
+
+      if (t_is->regWriteLatency[DEP_O1] > 0)
+	{
+	  if (t_preg->regFile == L1_PREG_FILE)
+	    {
+	      if (l1_preg_writeNum >= l1_pregfile_wwidth)
+		{
+		  break;
+		}
+	      else
+		{
+		  l1_preg_writeNum++;
+		}
+	    }
+	  else if (t_preg->regFile == L2_PREG_FILE)
+	    {
+	      if (l2_preg_writeNum >= l2_pregfile_wwidth)
+		{
+		  break;
+		}
+	      else
+		{
+		  l2_preg_writeNum++;
+		}
+	    }
+
+	  t_is->regWriteLatency[DEP_O1]--;
+	}
+
+      t_is = t_is->next;
+    }
+#endif /* SIM_R10K_REGCACHE */
+
+  /* all values must be retired to the architected reg file in
+     program order */
+  while (ROB.head && 
+	 commit_n < commit_width)
+    {
+      struct INSN_station_t *is = ROB.head;
+      struct preg_t *preg = &pregs[is->pregnums[DEP_O1]];
+      struct preg_t *freg = &pregs[is->fregnum];
+      
+      /* at least RUU entry must be complete.  BTW, complete
+	 means complete last cycle */
+      if (is->f_wrong_path)
+	panic("committing a wrong-path insn!");
+      
+      if (preg->fault != md_fault_none)
+	panic("committing faulting instruction!");
+      
+      if (/* prefetches are automatically complete */
+	  is->pdi->iclass != ic_prefetch &&
+	  is->pdi->iclass != ic_sys &&
+	  preg->when_written == 0)
+	{
+	  stall = commit_stall_cause(is);
+	  break;
+	}
+	  
+      if (is->pdi->iclass == ic_store)
+	{
+	  if (commit_store_n == commit_store_width)
+	    break;
+	  
+	  if (!commit_store(is))
+	    {
+	      stall = cpi_DCACHE;
+	      break;
+	    }
+	  
+	  commit_store_n++;
+
+#ifdef SIM_R10K_POWER
+	  power_count_access(ps_SQDATA, /* write_f */FALSE, /* hard_count_f */TRUE);
+	  /* This is a trick, we are using write_f == TRUE to model a conventional read port */
+	  power_count_access(ps_SQADDR, /* write_f */TRUE, /* hard_count_f */TRUE);
+	  power_count_access(ps_DL1_TAG, /* write_f */FALSE, /* hard_count_f */FALSE);
+	  power_count_access(ps_DL1_DATA, /* write_f */TRUE, /* hard_count_f */FALSE);
+	  power_count_access(ps_DTLB, /* write_f */FALSE, /* hard_count_f */TRUE);
+#endif /* SIM_R10K_POWER */
+	}
+      
+      else if (is->pdi->iclass == ic_ctrl)
+	{
+	  if (commit_ctrl_width && commit_ctrl_n == commit_ctrl_width)
+	    break;
+
+	  commit_ctrl_n++;
+	}
+
+#ifdef SIM_R10K_REGCACHE
+      if (is->regWriteLatency[DEP_O1] > 0)
+	{
+	  stall = cpi_REGCACHE;
+	  break;
+	}
+
+#endif /* SIM_R10K_REGCACHE */
+      /* all right, we're committing this guy */
+#ifdef SIM_R10K_REGCACHE
+      if (l1_pregfile_cache)
+	{
+	  t_preg->dirty = TRUE;
+	  n_reg_writes++;
+	}
+
+#endif /* SIM_R10K_REGCACHE */
+      n_insn_commit[is->pdi->iclass]++;
+      n_insn_commit_sum++;
+      sim_num_insn++;
+      
+      if (is->pdi->iclass == ic_sys)
+	{
+	  /* This preg will be freed.  We will need to allocate a new one */
+	  preg->is = NULL;
+	  /* Do the syscall */
+	  HPROF_CALL(hp_EXEC, exec_insn(is));
+	  /* Allocate new physical register */
+	  is->pregnums[DEP_O1] = lregs[is->pdi->lregnums[DEP_O1]];
+	  preg = &pregs[is->pregnums[DEP_O1]];
+	  
+	  preg->is = is;
+	  preg->when_written = sim_cycle;
+	}
+
+      else if (is->pdi->iclass == ic_ctrl)
+	{
+	  /* Update branch predictor */
+	  if (bpred)
+	    bpred_update(bpred,
+			 /* branch address */is->PC,
+			 /* instruction */is->pdi->poi.op,
+			 /* actual target address */is->NPC,
+			 /* target address */is->TPC,
+			 /* predicted target address */is->PPC,
+			 /* update info */&is->bp_pre_state);
+
+#ifdef SIM_R10K_POWER
+	  if (MD_OP_HASFLAGS(is->pdi->poi.op, F_COND)) 
+	    power_count_access(ps_DIRPRED, /* write_f */TRUE, /* hard_count_f */TRUE);	  
+#endif /* SIM_R10K_POWER */
+
+	  if (is->NPC != is->PPC)
+	    {
+	      n_branch_misp++;
+	      PCSTAT_INC(is->pdi, pc_MISP);
+	    }
+	}
+	  
+      if (fdump)
+	{
+	  if (sim_num_insn >= insn_dumpbegin && sim_num_insn < insn_dumpend)
+	    {
+	      fprintf(fdump, "%-9u: 0x%08x ",
+		      (word_t)sim_num_insn, 
+		      (word_t)is->PC);
+	      if (LREG_ISDEP(is->pdi->lregnums[DEP_O1]))
+		myfprintf(fdump, " O1: %016p", pregs[is->pregnums[DEP_O1]].val.q);
+	      if (is->pdi->iclass == ic_load || is->pdi->iclass == ic_store || is->pdi->iclass == ic_prefetch)
+		myfprintf(fdump, ", addr: %016p", is->ls->addr);
+	      fprintf(fdump, "\n");
+	      fflush(fdump);
+	    }
+	  else if (sim_num_insn == insn_dumpend)
+	    {
+	      fclose(fdump);
+	    }
+	}
+      
+      if (is->pdi->iclass == ic_load || is->pdi->iclass == ic_store || is->pdi->iclass == ic_prefetch)
+	{
+	  /* remove from LSQ */
+	  struct LDST_station_t *ls = LSQ.head;
+	  assert(ls == is->ls && is == ls->is);
+	  LDST_remove(&LSQ, ls, is->pdi->iclass == ic_store);
+	  LDST_free(ls);
+	}
+      
+      if (is->f_rs)
+	{
+	  if (is->pdi->iclass != ic_prefetch)
+	    panic("non-prefetch with RS at retirement!");
+
+	  is->f_rs = FALSE;
+	  rs_num++;
+	  SCHED_LEAVE(is);
+	}
+
+#ifdef SIM_R10K_POWER
+      power_count_access(ps_ROB, /* write_f */FALSE, /* hard_count_f */TRUE);
+#endif /* SIM_R10K_POWER */
+
+      regs_commit(is->pregnums[DEP_O1]);
+      
+      /* committing now */
+      is->when.committed = sim_cycle;
+      if (critpath_window)
+	INSN_critpath(is);
+      
+      /* free over-written register */
+      if (freg->is) panic("what is this guy still doing with an IS?");
+
+      regs_free(is->fregnum);
+      
+      /* Reclaim resources of committing register */
+      /* Only for "original instance" */
+      if (!preg->is)
+	panic("what is this guy doing without an IS?");
+      preg->is = NULL;
+      
+      /* external per-instruction instance counter, occasionally useful */
+      commit_NPC = is->NPC;
+      
+      INSN_remove(&ROB, is);
+      INSN_free(is);
+      
+      /* one more instruction committed to architected state */
+      commit_n++;
+    }
+#ifdef SIM_R10K_REGCACHE
+  calcStall = TRUE;
+#endif /* SIM_R10K_REGCACHE */
+
+#ifdef SIM_R10K_POWER
+  if (commit_n)
+    power_count_access(ps_FREELIST, /* write_f */TRUE, /* hard_count_f */TRUE);
+#endif /* SIM_R10K_POWER */
+
+  /* charge the unused commit slots */
+  if (!ROB.head)
+    stall = cpi_frontend();
+  cpi_cycle(commit_n, stall);
+}
+#endif /* SIM_R10K_CPR */
+
+/* writeback stage implementation */
+
+
+/* insert an event for PREG into the writeback queue, event queue is sorted from
+   earliest to latest event, event and associated side-effects will be
+   apparent at the start of cycle WHEN */
+STATIC void
+writeback_enqueue(struct preg_t *preg,
+		  tick_t when)
+{
+  struct PREG_link_t *prev, *ev, *new_ev;
+
+  if (when <= sim_cycle)
+    panic("event occurred in the past");
+
+  for (ev = writeback_queue; ev; ev = ev->next)
+    if (PLINK_valid(ev) && ev->preg == preg) 
+      panic("already a writeback event for this register!");
+
+  /* get a free event record */
+  new_ev = PLINK_new();
+  PLINK_set(new_ev, preg);
+  new_ev->x.when = when;
+
+  /* locate insertion point */
+  for (prev=NULL, ev=writeback_queue;
+       ev && ev->x.when < when;
+       prev=ev, ev=ev->next);
+
+  if (prev)
+    {
+      /* insert middle or end */
+      new_ev->next = prev->next;
+      prev->next = new_ev;
+    }
+  else
+    {
+      /* insert at beginning */
+      new_ev->next = writeback_queue;
+      writeback_queue = new_ev;
+    }
+}
+#ifdef SIM_R10K_CPR
+
+/* return the next event that has already occurred, returns NULL when no
+   remaining events or all remaining events are in the future */
+STATIC struct preg_t *
+writeback_next(void)
+{
+  while (writeback_queue && writeback_queue->x.when <= sim_cycle)
+  {
+    struct PREG_link_t *ev = writeback_queue;
+    struct preg_t *preg = ev->preg;
+    bool_t valid = PLINK_valid(ev);
+
+    /* unlink and return first event on priority list */
+    writeback_queue = ev->next;
+
+    PLINK_free(ev);
+
+    if (valid)
+      return preg;
+  }
+
+  return NULL;
+}
+#endif /* SIM_R10K_CPR */
+
+STATIC void
+writeback_cleanup(void)
+{
+  while (writeback_queue)
+    {
+      struct PREG_link_t *plink = writeback_queue;
+      writeback_queue = plink->next;
+      PLINK_free(plink);
+    }
+}
+#ifdef SIM_R10K_CPR
+
+/* writeback completed operation results from the functional units to RUU,
+   at this point, the output dependency chains of completing instructions
+   are also walked to determine if any dependent instruction now has all
+   of its register operands, if so the (nearly) ready instruction is inserted
+   into the ready instruction queue */
+STATIC void
+writeback_stage(void)
+{
+  struct preg_t *preg;
+
+  /* service all completed events */
+  while ((preg = writeback_next()) != NULL)
+  {
+    struct PREG_link_t *link;
+    struct INSN_station_t *is = preg->is;
+
+    /* if link is not valid (instruction has been squashed), delete and skip */
+//		if (!PLINK_valid(preg->) || !preg->is)
+//		{
+//			if (pnode) pnode->next = nnode;
+//			else scheduler_queue = nnode;
+//			PLINK_free(node);
+//			continue;
+//		}
+
+    /* IS has completed execution and (possibly) produced a result */
+    if (!is->when.regread || !is->when.ready || !is->when.issued)
+      panic("written back insn !regread, !ready, or !issued");
+
+    if (is->when.completed != 0 && is->when.completed != sim_cycle)
+      panic("insn completion timing mismatch!");
+
+    if (!preg->f_allocated)
+      panic("physical register not allocated!");
+
+    preg->when_written = is->when.completed;
+
+    /* load-to-use latency */
+    if (is->pdi->iclass == ic_load && !is->f_wrong_path)
+      if (histo_active)
+        histo_sample(&h_load_lat, is->when.completed - is->when.issued);
+
+    /* Are we resolving a mis-predicted branch? */
+    if (is->f_bmisp)
+    {
+
+      if (is->pdi->iclass != ic_ctrl && is->pdi->poi.op != PAL_CALLSYS)
+        panic("mis-predicted non-branch?!?!?");
+
+      /* Mark this instruction as no longer mispredicting */
+      is->f_bmisp = FALSE;
+      is->when.resolved = sim_cycle;
+
+      /* recover ROB and IFQ, and steer fetch to correct path */
+      //ROB_recover(is, /* f_bmisp */TRUE);
+      IFQ_recover(is);
+      CPI_FETCH_STALL(cpi_BMISP, seq);
+
+
+
+      /* recover branch predictor state */
+      if (bpred)
+        bpred_recover(bpred, is->PC, is->pdi->poi.op, is->NPC, &is->bp_pre_state);
+
+      if (is->pdi->iclass == ic_ctrl)
+      {
+        //Update branch predictor
+        if (bpred)
+          bpred_update(bpred,
+              //branch address
+              is->PC,
+              //instruction
+              is->pdi->poi.op,
+              //actual target address
+              is->NPC,
+              //target address
+              is->TPC,
+              //predicted target address
+              is->PPC,
+              //update info
+              &is->bp_pre_state);
+
+        if (is->NPC != is->PPC)
+        {
+          n_branch_misp++;
+          PCSTAT_INC(is->pdi, pc_MISP);
+        }
+      }
+
+      ///////////////////////////////////////////////////////////////////////////
+      /* 			RECOVER A CHECKPOINT ON THE BRANCH MISPREDICTION 	   */
+      ///////////////////////////////////////////////////////////////////////////
+      fprintf(stdout, "CHECKPOINT REVERT - MISPREDICTED BRANCH\n");
+      fprintf(stdout, "BRANCH: %d CHECKPOINT: %d PC: %d\n", is->pdi->iclass, is->checkpoint, is->PC);
+      if (histo_active)
+        scheduler_mark(FALSE);
+      CHECK_revert(is->checkpoint);
+      if (histo_active)
+        scheduler_mark(TRUE);
+      PCSTAT_INC(is->pdi, pc_REVERT);
+      //CHECK_RemoveInstruction(is->checkpoint, is->pdi->iclass);
+
+      continue;
+
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    /* TODO:			 REMOVE INSTRUCTION FROM THE CHECKPOINT 			   */
+    ///////////////////////////////////////////////////////////////////////////
+    fprintf(stdout, "WRITEBACK STAGE INSTRUCTION: %d CHECKPOINT: %d\n", is->pdi->iclass, is->checkpoint);
+    //CHECK_dump();
+    //LDST_print(&LSQ);
+    REGS_removeReader(is);
+    /* wakeup ready instructions */
+    /* walk output list, queue up ready operations */
+    for (link = preg->odeps_head; link; link = link->next)
+    {
+      struct preg_t *opreg;
+      struct INSN_station_t *ois;
+
+      if (!PLINK_valid(link))
+        continue;
+
+      opreg = link->preg;
+      ois = opreg->is;
+
+      if (ois->idep_ready[link->x.opnum])
+        panic("output dependence already satisfied");
+
+      /* input is now ready */
+      ois->idep_ready[link->x.opnum] = TRUE;
+
+      /* try and schedule this instruction the next time around */
+      if (!ois->pdi->iclass == ic_nop){
+        //fprintf(stdout, "NOP!!!!!!!!");
+        HPROF_CALL(hp_SCHED_ENQUEUE, scheduler_enqueue(opreg));
+      }
+    }
+
+    if (is->f_rs)
+    {
+      if (is->pdi->iclass != ic_prefetch)
+        panic("non-prefetch with RS at retirement!");
+
+      is->f_rs = FALSE;
+      rs_num++;
+      SCHED_LEAVE(is);
+    }
+
+    regs_commit(is->pregnums[DEP_O1]);
+
+    /* committing now */
+    is->when.committed = sim_cycle;
+    if (critpath_window)
+      INSN_critpath(is);
+    fprintf(stdout, "WRITEBACK STAGE COMMIT\n");
+    fprintf(stdout, "INSN: %d CHECKPOINT: %d PC: %d\n", is->pdi->iclass, is->checkpoint, is->PC);
+    CHECK_RemoveInstruction(is->checkpoint, is->pdi->iclass);
+    CHECK_dump();
+
+    if (is->pdi->iclass == ic_ctrl)
+    {
+      //Update branch predictor
+      if (bpred)
+        bpred_update(bpred,
+            //branch address
+            is->PC,
+            //instruction
+            is->pdi->poi.op,
+            //actual target address
+            is->NPC,
+            //target address
+            is->TPC,
+            //predicted target address
+            is->PPC,
+            //update info
+            &is->bp_pre_state);
+
+      if (is->NPC != is->PPC)
+      {
+        n_branch_misp++;
+        PCSTAT_INC(is->pdi, pc_MISP);
+      }
+    }
+
+    if(is->pdi->iclass != ic_load && is->pdi->iclass != ic_store && is->pdi->iclass != ic_prefetch && is->pdi->iclass != ic_sys)
+      INSN_free(is);
+
+  }  /* for all writeback events */
+}
+#else /* !SIM_R10K_CPR */
+
+/* writeback completed operation results from the functional units to RUU,
+   at this point, the output dependency chains of completing instructions
+   are also walked to determine if any dependent instruction now has all
+   of its register operands, if so the (nearly) ready instruction is inserted
+   into the ready instruction queue */
+STATIC void
+writeback_stage(void)
+{
+  int writeback_n = 0, writeback_ctrl_n = 0;
+#ifndef SIM_R10K_REGCACHE
+  int pregfile_wn = 0;
+#endif /* !SIM_R10K_REGCACHE */
+
+  while (writeback_queue && writeback_queue->x.when <= sim_cycle)
+    {
+      struct PREG_link_t *link = NULL, *tmp = writeback_queue;
+      struct preg_t *preg = writeback_queue->preg;
+      bool_t valid = PLINK_valid(writeback_queue);
+      struct INSN_station_t *is = NULL;
+      
+      if (!valid)
+	{
+	  writeback_queue = writeback_queue->next;
+	  PLINK_free(tmp);
+	  continue;
+	}
+      
+      is = preg->is;
+
+      /* IS has completed execution and (possibly) produced a result */
+      if (!is->when.regread || !is->when.ready || !is->when.issued)
+	panic("written back insn !regread, !ready, or !issued");
+    
+      if (is->when.completed != 0 && is->when.completed > sim_cycle)
+	panic("insn completion timing mismatch!");
+    
+      if (!preg->f_allocated)
+	panic("physical register not allocated!");
+    
+      if (writeback_width && writeback_n == writeback_width)
+	break;
+    
+      if ((is->pdi->iclass == ic_ctrl || is->pdi->iclass == ic_sys)
+	  && writeback_ctrl_width && writeback_ctrl_n == writeback_ctrl_width)
+	break;
+    
+#ifndef SIM_R10K_REGCACHE
+      if (LREG_ISDEP(is->pdi->lregnums[DEP_O1])
+	  && pregfile_wwidth && pregfile_wn == pregfile_wwidth)
+	break;
+#endif /* !SIM_R10K_REGCACHE */
+    
+      writeback_n++;
+      preg->when_written = is->when.completed;
+
+      /* load-to-use latency */
+      if (is->pdi->iclass == ic_load && !is->f_wrong_path)
+	if (histo_active)
+	  histo_sample(&h_load_lat, is->when.completed - is->when.issued);
+#ifdef SIM_R10K_REGCACHE
+      /* used to determine if the value is accessed via the bypass network
+	 or via the register file */
+      preg->bypassValue = TRUE;
+#endif /* SIM_R10K_REGCACHE */
+    
+      if (is->pdi->iclass == ic_ctrl || is->pdi->iclass == ic_sys)
+	{
+	  writeback_ctrl_n++;
+	
+	  /* Are we resolving a mis-predicted branch? */
+	  if (is->f_bmisp)
+	    {
+	      if (is->pdi->iclass != ic_ctrl && is->pdi->poi.op != PAL_CALLSYS)
+		panic("mis-predicted non-branch?!?!?");
+	    
+	      /* Mark this instruction as no longer mispredicting */
+	      is->f_bmisp = FALSE;
+	      is->when.resolved = sim_cycle;
+	    
+	      /* recover ROB and IFQ, and steer fetch to correct path */
+	      ROB_recover(is, /* f_bmisp */TRUE);
+	      IFQ_recover(is);
+	      CPI_FETCH_STALL(cpi_BMISP, seq);
+
+	      /* recover branch predictor state */
+	      if (bpred)
+		bpred_recover(bpred, is->PC, is->pdi->poi.op, is->NPC, &is->bp_pre_state);
+	      
+#ifdef SIM_R10K_POWER
+	      if ((is->NPC != (is->PPC + sizeof(md_inst_t))) && (is->PPC != is->TPC))
+		power_count_access(ps_BTB, /* write_f */TRUE, /* hard_count_f */TRUE);
+#endif /* SIM_R10K_POWER */
+	    }
+	}
+
+    
+      if (LREG_ISDEP(is->pdi->lregnums[DEP_O1]))
+	{
+#ifndef SIM_R10K_REGCACHE
+	  pregfile_wn++;
+#endif /* !SIM_R10K_REGCACHE */
+	
+#ifdef SIM_R10K_POWER
+	  power_count_access(ps_RESULTBUS, /* write_f */FALSE, /* hard_count_f */TRUE);
+#ifndef SIM_R10K_REGCACHE
+	  /* the register cache build counts its register file accesses
+	     in regcache_power_count() */
+	  power_count_access(ps_REGFILE, /* write_f */TRUE, /* hard_count_f */TRUE);
+#endif /* !SIM_R10K_REGCACHE */
+	  power_count_access(ps_WAKEUP, /* write_f */FALSE, /* hard_count_f */TRUE);
+#endif /* SIM_R10K_POWER */
+	
+	  /* wakeup ready instructions */
+	  /* walk output list, queue up ready operations */
+	  for (link = preg->odeps_head; link; link = link->next)
+	    {
+	      struct preg_t *opreg;
+	      struct INSN_station_t *ois;
+	    
+	      if (!PLINK_valid(link))
+		continue;
+	    
+	      opreg = link->preg;
+	      ois = opreg->is;
+	    
+	      if (ois->idep_ready[link->x.opnum])
+		panic("output dependence already satisfied");
+	    
+	      /* input is now ready */
+	      ois->idep_ready[link->x.opnum] = TRUE;
+	      /* bypassed, so the value is ready this cycle */
+	      ois->time_ready[link->x.opnum] = sim_cycle;
+	    
+	      /* try and schedule this instruction the next time around */
+	      if (!ois->pdi->iclass == ic_nop)
+		HPROF_CALL(hp_SCHED_ENQUEUE, scheduler_enqueue(opreg));
+	    }
+	}  
+
+      writeback_queue = writeback_queue->next;
+      PLINK_free(tmp);
+    } /* for all writeback events */
+}
+#endif /* SIM_R10K_CPR */
+
+
+
+STATIC bool_t
+schedule_load(struct INSN_station_t *is)
+{
+  int cache_lat = 1, tlb_lat = 1;
+  bool_t miss_info[ct_NUM] = { FALSE };
+
+  /* invalid load */
+  if (!MD_VALID_ADDR(is->ls->addr))
+    {
+      cache_lat = tlb_lat = sched_agen_lat + sched_fwd_lat;
+    }
+  else /* valid */
+    {
+      enum mem_cmd_t cmd = is->pdi->iclass == ic_load ? mc_READ : mc_PREFETCH;
+      cache_lat = tlb_lat = sched_agen_lat + sched_fwd_lat;
+      
+      if (cache_dl1)
+	  cache_lat = sched_agen_lat + 
+	    cache_access(cache_dl1, cmd, MD_ALIGN_ADDR(is->ls->addr), MD_DATAPATH_WIDTH, 
+			 sim_cycle + sched_agen_lat, miss_info, dl1_miss_handler);
+      
+      /* access the D-DLB, NOTE: this code will
+	 initiate speculative TLB misses */
+      if (dtlb)
+	  tlb_lat = sched_agen_lat + 
+	    cache_access(dtlb, cmd, MD_ALIGN_ADDR(is->ls->addr), MD_DATAPATH_WIDTH, 
+			 sim_cycle + sched_agen_lat, miss_info, dtlb_miss_handler);
+    }       
+  
+  /* This guy has issued */
+  is->when.issued = sim_cycle;
+  is->when.completed = sim_cycle + MAX(cache_lat, tlb_lat);
+  is->f_dmiss = miss_info[ct_L1] || miss_info[ct_L2] || miss_info[ct_TLB];
+  if (!is->f_wrong_path)
+    {
+      if (miss_info[ct_L1])
+	PCSTAT_INC(is->pdi, pc_DL1_MISS);
+      if (miss_info[ct_L2])
+	PCSTAT_INC(is->pdi, pc_L2_MISS);
+    }
+  
+  return TRUE;
+}
+
+
+/* register and memory scheduler */
+STATIC void
+schedule_stage(void)
+{
+  struct PREG_link_t *node = NULL, *pnode = NULL, *nnode = NULL;
+  int sched_n[sclass_NUM];
+  int pregfile_rn = 0;
+
+  memset((byte_t*)sched_n, 0, sclass_NUM * sizeof(int));
+
+  /* store sets forget their false dependences now and then */
+  if (storeset && sched_adisambig_opt.clear_interval
+      && sim_cycle % sched_adisambig_opt.clear_interval == 0)
+    storeset_clear(storeset);
+
+  /* walk over list of ready un-scheduled instructions, issue the N
+     oldest possible ones */
+  for (pnode = NULL, node = scheduler_queue;
+       node && sched_n[sclass_TOTAL] < sched_width[sclass_TOTAL];
+       node = nnode)
+    {
+      struct preg_t *preg = node->preg;
+      struct INSN_station_t *is;
+      /* register file reads, the register cache build counts its reads
+	 with the L1/L2 port counters instead */
+      int pregfile_r = 0;
+#ifdef SIM_R10K_POWER
+      int r;
+#endif /* SIM_R10K_POWER */
+#ifdef SIM_R10K_REGCACHE
+      int i;
+      bool_t regStall  = 0;
+#endif /* SIM_R10K_REGCACHE */
+
+      nnode = node->next;
+
+      /* if link is not valid (instruction has been squashed), delete and skip */
+      if (!PLINK_valid(node) || !preg->is)
+	{
+	  if (pnode) pnode->next = nnode;
+	  else scheduler_queue = nnode;
+	  PLINK_free(node);
+	  continue;
+	}
+
+      is = preg->is;
+
+      /* Enforce in-order issue? */
+      if (sched_inorder && is->prev && !is->prev->when.issued)
+	break;
+
+      /* Instruction is not ready yet => skip */
+      if (is->when.ready > sim_cycle)
+	{
+	  pnode = node;
+	  continue;
+	}
+
+#ifdef SIM_R10K_CPR
+      fprintf(stdout, "/****REMOVED FROM SCHEDULE QUEUE****/ INSTRUCTION: %d CHECKPOINT: %d PC: %d\n", is->pdi->iclass, is->checkpoint, is->PC);
+#endif /* SIM_R10K_CPR */
+
+#ifdef SIM_R10K_REGCACHE
+      for (i=DEP_I1; i<=DEP_I3; i++)
+	{
+	  if (!LREG_ISDEP(is->pdi->lregnums[i]))
+	    continue;
+
+	  if (!(&pregs[is->pregnums[i]])->bypassValue && is->time_ready[i] < sim_cycle && is->regReadLatency[i] > 0)
+	    {
+	      if ((&pregs[is->pregnums[i]])->regFile == L1_PREG_FILE &&  l1_preg_readNum  < l1_pregfile_rwidth)
+		{
+		  l1_preg_readNum++;
+		  is->regReadLatency[i]--;
+
+		}
+	      else if ((&pregs[is->pregnums[i]])->regFile == L2_PREG_FILE &&  l2_preg_readNum  < l2_pregfile_rwidth)
+		{
+		  if (l1_pregfile_cache && l1_preg_writeNum < l1_pregfile_wwidth)
+		    {
+		      l1_preg_writeNum++;
+		      l2_preg_readNum++;
+		      is->regReadLatency[i]--;
+		    }
+		  else
+		    {
+		      l2_preg_readNum++;
+		      is->regReadLatency[i]--;
+		    }
+		}
+	    }
+	}
+
+      if (LREG_ISDEP(is->pdi->lregnums[DEP_I1]) && !(&pregs[is->pregnums[DEP_I1]])->bypassValue && is->regReadLatency[DEP_I1] > 0)
+	{
+	  pnode = node;
+	  continue;
+	}
+      if (LREG_ISDEP(is->pdi->lregnums[DEP_I2]) && !(&pregs[is->pregnums[DEP_I2]])->bypassValue && is->regReadLatency[DEP_I2] > 0)
+	{
+	  pnode = node;
+	  continue;
+	}
+      if (LREG_ISDEP(is->pdi->lregnums[DEP_I3]) && !(&pregs[is->pregnums[DEP_I3]])->bypassValue && is->regReadLatency[DEP_I3] > 0)
+	{
+	  pnode = node;
+	  continue;
+	}
+
+      if (l1_pregfile_cache)
+	{
+	  for (i=DEP_I1; i<=DEP_I3; i++)
+	    {
+	      if (!LREG_ISDEP(is->pdi->lregnums[i]) || (&pregs[is->pregnums[i]])->bypassValue)
+		continue;
+
+	      struct preg_t *t_preg = &pregs[is->pregnums[i]];
+	      if (t_preg->regFile == L2_PREG_FILE)
+		{
+		  cache_regs_alloc(t_preg, is);
+		  if (t_preg->regCache < 0)
+		    {
+		      regStall = TRUE;
+		    }
+		  else
+		    {
+		      n_reg_read++;
+		      n_reg_read_miss++;
+		    }
+		}
+	      else
+		{
+		  n_reg_read++;
+		  REGCACHE_TOUCH(&pregs[t_preg->regCache]);
+		  if (t_preg->f_prefetch)
+		    {
+		      t_preg->f_prefetch = FALSE;
+		      n_reg_prefetch_useful++;
+		    }
+		}
+	    }
+	}
+
+      if (regStall)
+	{
+	  pnode = node;
+	  continue;
+	}
+#else /* !SIM_R10K_REGCACHE */
+      /* operands that are not bypassed are read from the register file */
+      if (LREG_ISDEP(is->pdi->lregnums[DEP_I1]) && is->time_ready[DEP_I1] < sim_cycle) pregfile_r++;
+      if (LREG_ISDEP(is->pdi->lregnums[DEP_I2]) && is->time_ready[DEP_I2] < sim_cycle) pregfile_r++;
+      if (LREG_ISDEP(is->pdi->lregnums[DEP_I3]) && is->time_ready[DEP_I3] < sim_cycle) pregfile_r++;
+
+      /* no register file read ports => skip */
+      if (pregfile_rwidth && pregfile_rn + pregfile_r > pregfile_rwidth)
+	{
+	  pnode = node;
+	  continue;
+	}
+#endif /* SIM_R10K_REGCACHE */
+
+      /* Special actions for stores */
+      if (is->pdi->iclass == ic_store)
+	{
+	  bool_t f_shadow_store = FALSE;
+	  struct LDST_station_t *store = is->ls;
+	  struct LDST_station_t *load = NULL;
+	  unsigned int store_dist = 1;
+
+	  /* No store scheduling slot => skip */
+	  if (sched_n[sclass_STORE] == sched_width[sclass_STORE])
+	    {
+	      pnode = node;
+	      continue;
+	    }
+
+	  /* stores of a store set issue in order */
+	  if (storeset && STORESET_WAIT(store))
+	    {
+	      pnode = node;
+	      continue;
+	    }
+
+	  is->when.issued = is->when.completed = preg->when_written = sim_cycle;
+#ifdef SIM_R10K_REGCACHE
+	  preg->bypassValue = TRUE;
+#endif /* SIM_R10K_REGCACHE */
+#ifdef SIM_R10K_CPR
+	  CHECK_RemoveInstruction(is->checkpoint, is->pdi->iclass);
+#endif /* SIM_R10K_CPR */
+
+	  /* consume store scheduling slot */
+	  n_insn_exec[is->pdi->iclass]++;
+	  sched_n[sclass_STORE]++;
+	  sched_n[sclass_TOTAL]++;
+
+	  /* free reservation station */
+	  is->f_rs = FALSE;
+	  rs_num++;
+	  SCHED_LEAVE(is);
+
+	  /* remove node from scheduler queue */
+	  if (pnode) pnode->next = nnode;
+	  else scheduler_queue = nnode;
+	  PLINK_free(node);
+
+	  pregfile_rn += pregfile_r;
+#ifdef SIM_R10K_POWER
+	  power_count_access(ps_SELECT, /* write_f */FALSE, /* hard_count_f */TRUE);
+	  power_count_access(ps_RSTATION, /* write_f */FALSE, /* hard_count_f */TRUE);
+	  for (r = 0; r < pregfile_r; r++)
+	    power_count_access(ps_REGFILE, /* write_f */FALSE, /* hard_count_f */TRUE);
+	  power_count_access(ps_AGEN, /* write_f */FALSE, /* hard_count_f */TRUE);
+	  power_count_access(ps_SQADDR, /* write_f */TRUE, /* hard_count_f */TRUE);
+	  power_count_access(ps_SQDATA, /* write_f */TRUE, /* hard_count_f */TRUE);
+
+	  /* speculative disambiguation searches the load queue */
+	  if (sched_adisambig_opt.strategy == adisambig_OPPORTUNISTIC ||
+	      sched_adisambig_opt.strategy == adisambig_CHT ||
+	      sched_adisambig_opt.strategy == adisambig_STORESETS)
+	    {
+	      power_count_access(ps_LQADDR, /* write_f */FALSE, /* hard_count_f */TRUE);
+	      power_count_access(ps_LQDATA, /* write_f */FALSE, /* hard_count_f */TRUE);
+	    }
+#endif /* SIM_R10K_POWER */
+
+	  /* the current store is store #1 */
+	  store_dist = 1;
+	  f_shadow_store = FALSE;
+	  for (load = store->next; load; load = load->next)
+	    {
+	      quad_t qs, ql;
+	      struct INSN_station_t *lis = load->is;
+	      struct INSN_station_t *lis_prev = lis->prev;
+	      struct preg_t *lpreg = &pregs[lis->pregnums[DEP_O1]];
+
+	      if (lis->pdi->iclass == ic_store)
+		{
+		  /* shadow store */
+		  if (address_collision(load, store))
+		    {
+		      f_shadow_store = TRUE;
+		      break;
+		    }
+
+		  store_dist++;
+		  continue;
+		}
+
+	      if (lis->pdi->iclass == ic_prefetch)
+		continue;
+
+	      if (lis->when.issued == 0)
+		continue;
+
+	      /* Address collision */
+	      if (!address_collision(load, store))
+		continue;
+
+	      /* Compare values before we squash */
+	      qs = ql = 0;
+
+	      /* some messed up thing with LDS (which loads a word
+		 and converts it to a floating-point quad) */
+	      if (lis->pdi->poi.op == LDS)
+		{
+		  READ_QUAD(&qs, &store->val.q, MD_ADDR_OFFSET(load->addr), load->dsize);
+		  ITOFS(qs,qs);
+		  ql = lpreg->val.q;
+		}
+	      else
+		{
+		  READ_QUAD(&qs, &store->val.q, MD_ADDR_OFFSET(load->addr), load->dsize);
+		  READ_QUAD(&ql, &lpreg->val.q, 0, load->dsize);
+		}
+
+	      /* Everything is cool */
+	      if (qs == ql)
+		continue;
+
+	      /* Load mis-specualtion => normal squash */
+	      n_load_squash++;
+	      PCSTAT_INC(lis->pdi, pc_SQUASH);
+
+	      /* Try not to do this squash again */
+	      if (sched_adisambig_opt.strategy == adisambig_CHT)
+		cht_enter(cht, lis->PC, store_dist);
+	      else if (sched_adisambig_opt.strategy == adisambig_STORESETS)
+		storeset_enter(storeset, lis->PC, is->PC);
+
+	      /* recover ROB, IFQ, and branch predictor starting from lis */
+#ifdef SIM_R10K_CPR
+	      IFQ_recover(lis_prev);
+
+	      ///////////////////////////////////////////////////////////////////////////
+	      /* TODO:			  RECOVER A CHECKPOINT ON STORE PROBLEM 		   	   */
+	      ///////////////////////////////////////////////////////////////////////////
+	      fprintf(stdout, "CHECKPOINT REVERT - STORE ISSUES\n");
+	      if (histo_active)
+		scheduler_mark(FALSE);
+	      CHECK_revert(lis->checkpoint);
+	      if (histo_active)
+		scheduler_mark(TRUE);
+	      PCSTAT_INC(lis->pdi, pc_REVERT);
+#else /* !SIM_R10K_CPR */
+	      ROB_recover(lis_prev, /* f_bmisp */FALSE);
+	      IFQ_recover(lis_prev);
+#endif /* SIM_R10K_CPR */
+
+	      if (bpred)
+		bpred_recover(bpred, lis_prev->PC, lis_prev->pdi->poi.op,
+			      lis_prev->NPC, &lis_prev->bp_pre_state);
+
+	      /* one recovery (the first) per store */
+	      break;
+	    }
+	}
+      /* Special scheduling for loads */
+      else if (is->pdi->iclass == ic_load)
+	{
+	  struct LDST_station_t *load = is->ls;
+	  struct LDST_station_t *store = NULL;
+	  int store_dist = 0;
+
+	  /* no load scheduling slot => skip */
+	  if (sched_n[sclass_LOAD] == sched_width[sclass_LOAD])
+	    {
+	      pnode = node;
+	      continue;
+	    }
+
+	  /* check for conservative/cht stalls */
+	  if (sched_adisambig_opt.strategy == adisambig_CONSERVATIVE)
+	    {
+	      for (store = load->prev; store; store = store->prev)
+		{
+		  struct INSN_station_t *sis = store->is;
+#ifdef SIM_R10K_CPR
+		  fprintf(stdout, "LOADS: %d\n", LSQ.lnum);
+		  fprintf(stdout, "STORES: %d\n", LSQ.snum);
+		  fprintf(stdout, "LOAD CHECKPOINT: %d\n", load->is->checkpoint);
+		  fprintf(stdout, "SIS CHECKPOINT: %d\n", sis->checkpoint);
+#endif /* SIM_R10K_CPR */
+
+		  if (sis->pdi->iclass != ic_store)
+		    continue;
+
+		  /* Store has not issued and address is not ready */
+		  if (sis->f_rs && !STORE_ADDR_READY(sis))
+		    break;
+		}
+
+	      if (store)
+		{
+		  n_load_dep_stall++;
+		  if (load_false_dep(load))
+		    n_load_false_dep_stall++;
+
+		  load->f_stall = TRUE;
+		  pnode = node;
+		  continue;
+		}
+	    }
+
+	  else if (sched_adisambig_opt.strategy == adisambig_CHT)
+	    {
+	      int collision_dist = cht_lookup(cht, is->PC);
+	      if (collision_dist > 0)
+		{
+		  store_dist = 0;
+		  for (store = load->prev; store; store = store->prev)
+		    {
+		      struct INSN_station_t *sis = store->is;
+
+		      if (sis->pdi->iclass != ic_store)
+			continue;
+
+		      store_dist++;
+
+		      if (store_dist < collision_dist)
+			continue;
+
+		      /* store has not issued */
+		      if (sis->f_rs)
+			break;
+		    }
+
+		  if (store)
+		    {
+		      n_load_dep_stall++;
+		      if (load_false_dep(load))
+			n_load_false_dep_stall++;
+
+		      load->f_stall = TRUE;
+		      pnode = node;
+		      continue;
+		    }
+		}
+	    }
+
+	  /* wait for the last fetched store of the load's store set */
+	  else if (sched_adisambig_opt.strategy == adisambig_STORESETS)
+	    {
+	      if (STORESET_WAIT(load))
+		{
+		  n_load_dep_stall++;
+		  if (load_false_dep(load))
+		    n_load_false_dep_stall++;
+
+		  load->f_stall = TRUE;
+		  pnode = node;
+		  continue;
+		}
+	    }
+
+	  store_dist = 0;
+	  for (store = load->prev; store; store = store->prev)
+	    {
+	      struct INSN_station_t *sis = store->is;
+
+	      if (sis->pdi->iclass != ic_store)
+		continue;
+
+	      store_dist++;
+
+	      if (!address_collision(store, load))
+		continue;
+
+	      /* store address and data both known => bypass with no penalty */
+	      if (!sis->f_rs)
+		{
+		  READ_QUAD(&load->val.q, &store->val.q, MD_ADDR_OFFSET(load->addr), load->dsize);
+
+		  is->when.issued = sim_cycle;
+		  is->when.completed = sim_cycle + sched_agen_lat + sched_fwd_lat;
+
+		  n_insn_exec[is->pdi->iclass]++;
+
+		  is->f_rs = FALSE;
+		  rs_num++;
+		  SCHED_LEAVE(is);
+
+		  writeback_enqueue(preg, is->when.completed);
+
+		  sched_n[sclass_LOAD]++;
+		  sched_n[sclass_TOTAL]++;
+
+		  pregfile_rn += pregfile_r;
+#ifdef SIM_R10K_POWER
+		  power_count_access(ps_SELECT, /* write_f */FALSE, /* hard_count_f */TRUE);
+		  power_count_access(ps_RSTATION, /* write_f */FALSE, /* hard_count_f */TRUE);
+		  for (r = 0; r < pregfile_r; r++)
+		    power_count_access(ps_REGFILE, /* write_f */FALSE, /* hard_count_f */TRUE);
+		  power_count_access(ps_AGEN, /* write_f */FALSE, /* hard_count_f */TRUE);
+
+		  if (sched_adisambig_opt.strategy == adisambig_OPPORTUNISTIC ||
+		      sched_adisambig_opt.strategy == adisambig_CHT ||
+		      sched_adisambig_opt.strategy == adisambig_STORESETS)
+		    {
+		      power_count_access(ps_LQADDR, /* write_f */TRUE, /* hard_count_f */TRUE);
+		      power_count_access(ps_LQDATA, /* write_f */TRUE, /* hard_count_f */TRUE);
+		    }
+
+		  power_count_access(ps_SQADDR, /* write_f */FALSE, /* hard_count_f */TRUE);
+		  power_count_access(ps_SQDATA, /* write_f */FALSE, /* hard_count_f */TRUE);
+		  power_count_access(ps_DL1_TAG, /* write_f */FALSE, /* hard_count_f */FALSE);
+		  power_count_access(ps_DL1_DATA, /* write_f */FALSE, /* hard_count_f */FALSE);
+		  power_count_access(ps_DTLB, /* write_f */FALSE, /* hard_count_f */TRUE);
+#endif /* SIM_R10K_POWER */
+
+		  /* load has been scheduled */
+		  if (pnode) pnode->next = nnode;
+		  else scheduler_queue = nnode;
+		  PLINK_free(node);
+		  break;
+		}
+	      /* store address known, but data not ready => wait */
+	      else if (STORE_ADDR_READY(sis))
+		{
+		  load->f_stall = TRUE;
+		  pnode = node;
+		  break;
+		}
+	      /* perfect memory disambiguation => stall */
+	      else if (sched_adisambig_opt.strategy == adisambig_PERFECT)
+		{
+		  load->f_stall = TRUE;
+		  pnode = node;
+		  break;
+		}
+	      /* either address or data of colliding store is not
+		 known */
+	      else
+		{
+		  continue;
+		}
+	    }
+
+	  if (store)
+	    continue;
+
+	  /* no collisions => cache access is valid */
+	  if (schedule_load(is))
+	    {
+	      mem_access(mem, mc_READ, load->addr, &load->val.q, load->dsize);
+
+	      writeback_enqueue(preg, is->when.completed);
+
+	      n_insn_exec[is->pdi->iclass]++;
+	      sched_n[sclass_LOAD]++;
+	      sched_n[sclass_TOTAL]++;
+
+	      /* free reservation station */
+	      is->f_rs = FALSE;
+	      rs_num++;
+	      SCHED_LEAVE(is);
+
+	      pregfile_rn += pregfile_r;
+#ifdef SIM_R10K_POWER
+	      power_count_access(ps_SELECT, /* write_f */FALSE, /* hard_count_f */TRUE);
+	      power_count_access(ps_RSTATION, /* write_f */FALSE, /* hard_count_f */TRUE);
+	      for (r = 0; r < pregfile_r; r++)
+		power_count_access(ps_REGFILE, /* write_f */FALSE, /* hard_count_f */TRUE);
+	      power_count_access(ps_AGEN, /* write_f */FALSE, /* hard_count_f */TRUE);
+
+	      if (sched_adisambig_opt.strategy == adisambig_OPPORTUNISTIC ||
+		  sched_adisambig_opt.strategy == adisambig_CHT ||
+		  sched_adisambig_opt.strategy == adisambig_STORESETS)
+		{
+		  power_count_access(ps_LQADDR, /* write_f */TRUE, /* hard_count_f */TRUE);
+		  power_count_access(ps_LQDATA, /* write_f */TRUE, /* hard_count_f */TRUE);
+		}
+
+	      power_count_access(ps_SQADDR, /* write_f */FALSE, /* hard_count_f */TRUE);
+	      power_count_access(ps_SQDATA, /* write_f */FALSE, /* hard_count_f */TRUE);
+	      power_count_access(ps_DL1_TAG, /* write_f */FALSE, /* hard_count_f */FALSE);
+	      power_count_access(ps_DL1_DATA, /* write_f */FALSE, /* hard_count_f */FALSE);
+	      power_count_access(ps_DTLB, /* write_f */FALSE, /* hard_count_f */TRUE);
+#endif /* SIM_R10K_POWER */
+
+	      /* remove from scheduling queue */
+	      if (pnode) pnode->next = nnode;
+	      else scheduler_queue = nnode;
+	      PLINK_free(node);
+	    }
+	  else
+	    {
+	      /* stall load, try to schedule next instruction */
+	      load->f_stall = TRUE;
+	      pnode = node;
+	      continue;
+	    }
+	}
+      else if (is->pdi->iclass == ic_prefetch)
+	{
+	  if (schedule_load(is))
+	    {
+	      n_insn_exec[is->pdi->iclass]++;
+	      sched_n[sclass_LOAD]++;
+	      sched_n[sclass_TOTAL]++;
+
+	      /* free reservation station */
+	      is->f_rs = FALSE;
+	      rs_num++;
+	      SCHED_LEAVE(is);
+
+	      pregfile_rn += pregfile_r;
+#ifdef SIM_R10K_POWER
+	      power_count_access(ps_SELECT, /* write_f */FALSE, /* hard_count_f */TRUE);
+	      power_count_access(ps_RSTATION, /* write_f */FALSE, /* hard_count_f */TRUE);
+	      for (r = 0; r < pregfile_r; r++)
+		power_count_access(ps_REGFILE, /* write_f */FALSE, /* hard_count_f */TRUE);
+	      power_count_access(ps_AGEN, /* write_f */FALSE, /* hard_count_f */TRUE);
+
+	      power_count_access(ps_DL1_TAG, /* write_f */FALSE, /* hard_count_f */FALSE);
+	      power_count_access(ps_DTLB, /* write_f */FALSE, /* hard_count_f */TRUE);
+#endif /* SIM_R10K_POWER */
+
+	      /* remove from scheduling queue */
+	      if (pnode) pnode->next = nnode;
+	      else scheduler_queue = nnode;
+	      PLINK_free(node);
+	    }
+	  else
+	    {
+	      pnode = node;
+	      continue;
+	    }
+	}
+
+      /* not a load or a store */
+      else
+	{
+	  int execlat = 1;
+	  enum fuclass_t fuclass = MD_OP_FUCLASS(is->pdi->poi.op);
+	  struct res_t *fu = NULL;
+	  enum sched_class_t sclass = sclass_NUM;
+
+	  if (fuclass >= fuclass_IALU && fuclass <= fuclass_IDIV)
+	    sclass = sclass_INT;
+	  else if (fuclass >= fuclass_FADD && fuclass <= fuclass_FSQRT)
+	    sclass = sclass_FP;
+
+	  if (sclass != sclass_NUM)
+	    {
+	      if (sched_n[sclass] == sched_width[sclass])
+		{
+		  pnode = node;
+		  continue;
+		}
+
+	      fu = respool_get_res(respool, fuclass, sim_cycle);
+	      if (!fu)
+		{
+		  pnode = node;
+		  continue;
+		}
+	      execlat = fu->execlat;
+	    }
+
+	  is->when.issued = sim_cycle;
+	  is->when.completed = sim_cycle + execlat;
+	  n_insn_exec[is->pdi->iclass]++;
+
+	  /* free reservation station */
+	  is->f_rs = FALSE;
+	  rs_num++;
+	  SCHED_LEAVE(is);
+
+	  writeback_enqueue(preg, is->when.completed);
+
+	  pregfile_rn += pregfile_r;
+#ifdef SIM_R10K_POWER
+	  power_count_access(ps_SELECT, /* write_f */FALSE, /* hard_count_f */TRUE);
+	  power_count_access(ps_RSTATION, /* write_f */FALSE, /* hard_count_f */TRUE);
+	  for (r = 0; r < pregfile_r; r++)
+	    power_count_access(ps_REGFILE, /* write_f */FALSE, /* hard_count_f */TRUE);
+
+	  if (sclass == sclass_INT)
+	    power_count_access(ps_IALU, /* write_f */FALSE, /* hard_count_f */TRUE);
+	  else if (sclass == sclass_FP)
+	    power_count_access(ps_FALU, /* write_f */FALSE, /* hard_count_f */TRUE);
+#endif /* SIM_R10K_POWER */
+
+	  /* remove from scheduling queue */
+	  if (pnode) pnode->next = nnode;
+	  else scheduler_queue = nnode;
+	  PLINK_free(node);
+
+	  if (sclass != sclass_NUM)
+	    sched_n[sclass]++;
+
+	  sched_n[sclass_TOTAL]++;
+	}
+    }
+}
+
+static void
+preg_connect_deps(struct preg_t *preg)
+{
+  struct INSN_station_t *is = preg->is;
+  int dep;
+
+  for (dep = DEP_I1; dep <= DEP_I3; dep++)
+    {
+      struct preg_t *preg_dep;
+      struct PREG_link_t *plink;
+
+      is->idep_ready[dep] = TRUE;
+      is->time_ready[dep] = sim_cycle;
+
+      if (!LREG_ISDEP(is->pdi->lregnums[dep]))
+	continue;
+
+      preg_dep = &pregs[is->pregnums[dep]];
+      if (preg_dep->when_written)
+	continue;
+
+      /* dependence not ready */
+      is->idep_ready[dep] = FALSE;
+      is->time_ready[dep] = 0;
+
+      plink = PLINK_new();
+      PLINK_set(plink, preg);
+      plink->x.opnum = dep;
+
+      /* link these in program order */
+      if (preg_dep->odeps_tail)
+	preg_dep->odeps_tail->next = plink;
+      else
+	preg_dep->odeps_head = plink;
+
+      preg_dep->odeps_tail = plink;
+    }
+}
+
+/* dispatch instructions from the IFETCH -> DISPATCH queue: instructions are
+   first decoded, then they allocated RUU (and LSQ for load/stores) resources
+   and input and output dependence chains are updated accordingly */
+
+STATIC void
+rename_stage(void)
+{
+  int rename_n = 0;
+
+  cpi_rename_stall = cpi_NUM;
+
+  while (/* instruction decode B/W left? */
+	 rename_n < rename_width
+	 /* insts still available from fetch unit? */
+	 && IFQ.head)
+    {
+      /* get the next instruction from the IFETCH -> DISPATCH queue */
+      struct INSN_station_t *is = IFQ.head;
+      struct preg_t *preg = NULL;
+      int dep = 0;
+#ifdef SIM_R10K_REGCACHE
+      struct preg_t *input_preg = NULL;
+#endif /* SIM_R10K_REGCACHE */
+#ifdef SIM_R10K_CPR
+      int decode_checkpoint = -1;
+#endif /* SIM_R10K_CPR */
+      
+      /* un-acceptable path */
+      if (!sched_spec && f_wrong_path)
+	{
+	  cpi_rename_stall = cpi_BMISP;
+	  break;
+	}
+      
+#ifndef SIM_R10K_CPR
+      /* ROB full */
+      if (ROB.num == ROB.size)
+	{
+	  cpi_rename_stall = cpi_ROB;
+	  break;
+	}
+#endif /* !SIM_R10K_CPR */
+      
+      /* LDQ full */
+      if ((is->pdi->iclass == ic_load || is->pdi->iclass == ic_prefetch) && LSQ.lnum == LSQ.lsize)
+	{
+	  cpi_rename_stall = cpi_LSQ;
+	  break;
+	}
+      
+      /* STQ full */
+      if (is->pdi->iclass == ic_store && LSQ.snum == LSQ.ssize)
+	{
+	  cpi_rename_stall = cpi_LSQ;
+	  break;
+	}
+      
+      /* no more reservation stations */
+      if (is->pdi->iclass != ic_sys && sched_rs_num == rs_num)
+	{
+	  cpi_rename_stall = cpi_RS;
+	  break;
+	}
+
+      /* don't let anyone come in if a syscall is in the machine */
+#ifdef SIM_R10K_CPR
+      if (hasSystemCall)
+#else /* !SIM_R10K_CPR */
+      if (ROB.num > 0 && ROB.tail->pdi->iclass == ic_sys)
+#endif /* SIM_R10K_CPR */
+	{
+	  cpi_rename_stall = cpi_OTHER;
+	  break;
+	}
+
+#ifdef SIM_R10K_CPR
+      ///////////////////////////////////////////////////////////////////////////
+      /* 				TRY ADDING INSTRUCTION TO CHECKPOINT				   */
+      ///////////////////////////////////////////////////////////////////////////
+      ///////////////////////////////////////////////////////////////////////////
+      /* ALLOCATE CHECKPOINT IF LOW-CONFIDENCE BRANCH OR 256 INSTRUCTION LFIMIT */
+      ///////////////////////////////////////////////////////////////////////////
+      //TODO: MODIFY FOR CORRECTNESS
+      if (is->allocate && is->pdi->iclass == ic_ctrl)
+	{
+	  if (CHECK_Allocate(lregs, is->PC) == FALSE)
+	    {
+	      //TODO: STALL
+	      fprintf(stdout, "OUT OF CHECKPOINTS - BRANCH\n");
+	    }
+	  fprintf(stdout, "SUCCESSFUL BRANCH CHECKPOINT ALLOCATE - FROM BRANCH\n");
+	}
+
+      if ((decode_checkpoint = CHECK_AddInstruction(is->pdi->iclass, is)) == -1)
+	{
+	  if (CHECK_Allocate(lregs, is->PC) == FALSE)
+	    {
+	      //TODO: STALL
+	      fprintf(stdout, "OUT OF CHECKPOINTS - INSTR\n");
+	      cpi_rename_stall = cpi_CHKPT;
+	      break;
+	    }
+	  else
+	    {
+	      decode_checkpoint = CHECK_AddInstruction(is->pdi->iclass, is);
+	      fprintf(stdout, "SUCCESSFUL INSTR CHECKPOINT ALLOCATE - FROM INSTRUCTION QUOTA\n");
+	    }
+	}
+
+#endif /* SIM_R10K_CPR */
+      
+      rename_n++;
+      CPI_RENAMED(is->seq);
+      n_insn_rename++;
+      
+#ifdef SIM_R10K_CPR
+      is->checkpoint = decode_checkpoint;
+#endif /* SIM_R10K_CPR */
+      /* move insn from IFQ to ROB */
+      INSN_remove(&IFQ, is);
+#ifndef SIM_R10K_CPR
+      INSN_enqueue(&ROB, is);
+#endif /* !SIM_R10K_CPR */
+
+      /* timing stats */
+      is->f_wrong_path = f_wrong_path;
+#ifdef SIM_R10K_CPR
+      fprintf(stdout, "INSTRUCTION WRONG PATH: %d\n", is->f_wrong_path);
+#endif /* SIM_R10K_CPR */
+      is->when.renamed = sim_cycle + 1;
+#ifdef SIM_R10K_REGCACHE
+      /* the register cache build charges its read latency per operand */
+      is->when.regread = is->when.renamed + sched_lat;
+#else /* !SIM_R10K_REGCACHE */
+      is->when.regread = is->when.renamed + sched_lat + pregfile_lat;
+#endif /* SIM_R10K_REGCACHE */
+      is->when.ready = is->when.issued = is->when.completed = is->when.resolved = is->when.committed = 0;
+      is->f_bmisp = FALSE;
+      is->f_mispredicted = FALSE;
+      is->f_dmiss = FALSE;
+      is->ls = NULL;
+      
+#ifdef SIM_R10K_POWER
+      power_count_access(ps_DECODE, /* write_f */FALSE, /* hard_count_f */TRUE);
+      power_count_access(ps_RENAME, /* write_f */FALSE, /* hard_count_f */TRUE);
+      if (LREG_ISDEP(is->pdi->lregnums[DEP_O1]))
+	power_count_access(ps_RENAME, /* write_f */TRUE, /* hard_count_f */TRUE);
+      power_count_access(ps_ROB, /* write_f */TRUE, /* hard_count_f */TRUE);
+#endif /* SIM_R10K_POWER */
+
+      /* allocate LSQ entry for ld/st */
+      if (is->pdi->iclass == ic_store || is->pdi->iclass == ic_load || is->pdi->iclass == ic_prefetch)
+	{
+	  /* Create LSQ entry, link to ROB, and vice versa */
+	  is->ls = LDST_alloc();
+	  is->ls->is = is;
+	  LDST_enqueue(&LSQ, is->ls, is->pdi->iclass == ic_store);
+
+	  if (storeset && is->pdi->iclass != ic_prefetch)
+	    storeset_rename(is->ls);
+	}
+      
+      /* rename the input registers */
+      for (dep = DEP_I1; dep < DEP_INUM; dep++)
+	{
+	  if (is->pdi->lregnums[dep] != regnum_NONE)
+	    {
+	      is->pregnums[dep] = regs_rename(is->pdi->lregnums[dep]);
+#ifdef SIM_R10K_REGCACHE
+	      input_preg = &(pregs[is->pregnums[dep]]);
+
+	      /* prefetch a written, L2 resident operand into the L1
+		 register cache, with a free L2 read and L1 write port */
+	      if (regcache_prefetch && input_preg->regFile == L2_PREG_FILE
+		  && input_preg->when_written
+		  && l2_preg_readNum < l2_pregfile_rwidth
+		  && l1_preg_writeNum < l1_pregfile_wwidth)
+		{
+		  cache_regs_alloc(input_preg, is);
+		  if (input_preg->regCache >= 0)
+		    {
+		      l2_preg_readNum++;
+		      l1_preg_writeNum++;
+		      input_preg->f_prefetch = TRUE;
+		      n_reg_prefetch++;
+		    }
+		}
+
+	      is->regReadLatency[dep] = input_preg->latency;
+#endif /* SIM_R10K_REGCACHE */
+	    }
+	}
+
+      /* producers still in flight, for the critical path analysis */
+      if (critpath_window)
+	for (dep = DEP_I1; dep < DEP_INUM; dep++)
+	  if (is->pdi->lregnums[dep] != regnum_NONE && pregs[is->pregnums[dep]].is)
+	    is->dep_seq[dep] = pregs[is->pregnums[dep]].is->seq;
+      
+      /* allocate a new output physical register */
+      is->pregnums[DEP_O1] = regs_alloc();
+      /* register previously mapped to lregnums[DEP_O1] must be freed when this instruction retires */
+      is->fregnum = regs_connect(is->pdi->lregnums[DEP_O1], is->pregnums[DEP_O1]);
+
+      preg = &pregs[is->pregnums[DEP_O1]];
+      preg->is = is;
+#ifdef SIM_R10K_REGCACHE
+      is->regWriteLatency[DEP_O1] = preg->latency;
+#endif /* SIM_R10K_REGCACHE */
+
+      if (is->pdi->iclass == ic_sys)
+	{
+	  is->when.ready = is->when.issued = is->when.resolved = is->when.completed = preg->when_written = sim_cycle;
+	  continue;
+	}
+
+      /* Allocate a reservation station */
+      is->f_rs = TRUE;
+      rs_num--;
+
+#ifdef SIM_R10K_POWER
+      power_count_access(ps_RSTATION, /* write_f */TRUE, /* hard_count_f */TRUE);
+#endif /* SIM_R10K_POWER */
+
+      /* execute the instruction. Actual instruction execution happens
+         here, schedule stage only computes latencies */
+      HPROF_CALL(hp_EXEC, exec_insn(is));
+      if (!is->f_wrong_path)
+	PCSTAT_INC(is->pdi, pc_EXEC);
+      
+      /* connect register dependences.  Put on scheduling queue if instruction is ready */
+      preg_connect_deps(preg);
+#ifdef SIM_R10K_CPR
+      fprintf(stdout, "PREG: %p\n", preg);
+      fprintf(stdout, "/****ADDED TO SCHEDULE QUEUE****/ INSTRUCTION: %d CHECKPOINT: %d PC: %d\n", is->pdi->iclass, is->checkpoint, is->PC);
+#endif /* SIM_R10K_CPR */
+      HPROF_CALL(hp_SCHED_ENQUEUE, scheduler_enqueue(preg));
+      
+      /* this may be a mispredicted branch or jump.  Note,
+	 must test this for F_TRAP also because of longjmp */
+      if (!is->f_wrong_path && 
+	  MD_OP_HASANYFLAGS(is->pdi->poi.op, F_CTRL|F_TRAP))
+	{
+	  /* is the trace generator trasitioning into
+	     mis-speculation mode? */
+	  if (is->PPC != is->NPC)
+	    {
+	      /* entering mis-speculation mode, save PC */
+#ifdef SIM_R10K_CPR
+	      fprintf(stdout, "SETTING WRONG PATH\n");
+#endif /* SIM_R10K_CPR */
+	      f_wrong_path = TRUE;
+	      is->f_bmisp = TRUE;
+	      is->f_mispredicted = TRUE;
+	    }
+	}
+    }
+
+#ifdef SIM_R10K_POWER
+  if (rename_n)
+    power_count_access(ps_FREELIST, /* write_f */FALSE, /* hard_count_f */TRUE);
+#endif /* SIM_R10K_POWER */
+}
+
+/* fetch up as many instruction as one branch prediction and one cache line
+   acess will support without overflowing the IFETCH -> DISPATCH QUEUE */
+STATIC void
+fetch_stage(void)
+{
+  int fetch_n = 0, fetch_ctrl_n = 0;
+
+  if (fetch_resume > sim_cycle)
+    return;
+
+  for (fetch_n = 0;
+       /* fetch up to as many instruction as the DISPATCH
+	  stage can decode */
+       fetch_n < fetch_width &&
+       /* fetch until IFETCH -> DISPATCH queue fills */
+       INSN_flist &&
+       IFQ.num < IFQ.size  &&
+       /* valid text address */
+       valid_text_address(mem, fetch_PC);
+       )
+    {
+      md_inst_t inst;
+      struct INSN_station_t *is = NULL;
+      struct predec_insn_t *pdi = NULL;
+      int cache_lat = 1, tlb_lat = 1;
+
+      pdi = predec_lookup(fetch_PC);
+      if (!pdi)
+	{
+	  mem_access(mem, mc_READ, fetch_PC, &inst, sizeof(md_inst_t));
+	  pdi = predec_enter(fetch_PC, inst);
+	}
+      inst = pdi->inst;
+
+      /* pretend like we are not fetching nops */
+      if (pdi->iclass == ic_nop)
+	{
+	  fetch_PC += sizeof(md_inst_t);
+	  continue;
+	}
+
+      /* address is within program text, read instruction from memory */
+      if (cache_il1)
+	cache_lat =
+	    cache_access(cache_il1, mc_READ, fetch_PC, sizeof(md_inst_t),
+			 sim_cycle, NULL, il1_miss_handler);
+
+      if (itlb)
+	tlb_lat =
+	    cache_access(itlb, mc_READ, fetch_PC, sizeof(md_inst_t),
+			 sim_cycle, NULL, itlb_miss_handler);
+
+      /* I-cache/I-TLB miss? assumes I-cache hit >= I-TLB hit */
+      if (MAX(tlb_lat, cache_lat) != 1)
+	{
+	  /* I-cache miss, block fetch until it is resolved */
+	  fetch_resume = sim_cycle + MAX(tlb_lat, cache_lat) - 1;
+	  CPI_FETCH_STALL(cpi_ICACHE, seq);
+	  break;
+	}
+
+      /* I-cache and I-tlb hit here */
+      is = INSN_alloc();
+
+      is->PC = fetch_PC;
+      is->seq = ++seq;
+      is->pdi = pdi;
+      is->when.fetched = sim_cycle + fetch_lat;
+
+      /* How many cycles is fetch supposed to take? */
+
+      /* adjust instruction fetch queue */
+      INSN_enqueue(&IFQ, is);
+
+#ifdef SIM_R10K_CPR
+      /////////////////////////////////////////////////////////////////
+      /* TODO: SET BRANCH CONFIDENCE FOR INSTRUCTION                 */
+      /////////////////////////////////////////////////////////////////
+      is->allocate = FALSE;
+
+#endif /* SIM_R10K_CPR */
+
+      /* get the next predicted fetch address; only use branch predictor
+	 result for branches (assumes pre-decode bits) */
+      is->PPC = fetch_PC = is->PC + sizeof(md_inst_t);
+      if (bpred)
+	{
+	  HPROF_CALL(hp_BPRED, is->PPC = fetch_PC =
+		     bpred_lookup(bpred, is->PC, is->pdi->poi.op, &is->bp_pre_state));
+
+	  is->when.predicted = sim_cycle;
+
+#ifdef SIM_R10K_CPR
+	  /* low confidence branches get a checkpoint, predictors without a
+	     confidence estimate report 0 */
+	  if (bpred_confidence(bpred, &is->bp_pre_state) < recover_conf)
+	    is->allocate = TRUE;
+
+#endif /* SIM_R10K_CPR */
+	  /* out of branch prediction bandwidth => break until next cycle,
+	     a width of 0 never matches */
+	  if (is->pdi->iclass == ic_ctrl && ++fetch_ctrl_n == fetch_bpred_width)
+	    break;
+
+	  /* discontinuous fetch => break until next cycle */
+	  if (is->PPC != is->PC + sizeof(md_inst_t))
+	    break;
+	}
+
+      fetch_n++;
+      n_insn_fetch++;
+    }
+
+#ifdef SIM_R10K_POWER
+  if (fetch_n)
+  {
+    if (cache_il1)
+      {
+	power_count_access(ps_IL1_TAG, /* write_f */FALSE, /* hard_count_f */FALSE);
+	power_count_access(ps_IL1_DATA, /* write_f */FALSE, /* hard_count_f */FALSE);
+      }
+    if (itlb)
+      power_count_access(ps_ITLB, /* write_f */FALSE, /* hard_count_f */TRUE);
+
+    if (bpred)
+      {
+	power_count_access(ps_DIRPRED, /* write_f */FALSE, /* hard_count_f */TRUE);
+	power_count_access(ps_BTB, /* write_f */FALSE, /* hard_count_f */TRUE);
+	power_count_access(ps_RAS, /* write_f */FALSE, /* hard_count_f */TRUE);
+	if (fetch_ctrl_n > 1)
+	  {
+	    int i;
+	    for (i = 1; i < fetch_ctrl_n; i++)
+	      {
+		power_count_access(ps_DIRPRED, /* write_f */FALSE, /* hard_count_f */TRUE);
+		power_count_access(ps_BTB, /* write_f */FALSE, /* hard_count_f */TRUE);
+		power_count_access(ps_RAS, /* write_f */FALSE, /* hard_count_f */TRUE);
+	      }
+	  }
+      }
+  }
+#endif /* SIM_R10K_POWER */
+
+  /* helps with managing fetch policy */
+  fetch_resume = sim_cycle + 1;
+}
+
+STATIC void
+cleanup_assert(void)
+{
+  if (INSN_num != 0)
+    panic("%d INSN's left unreclaimed!", INSN_num);
+
+  if (LDST_num != 0)
+    panic("%d LDST's left unreclaimed!", LDST_num);
+
+  if (plink_num != 0)
+    panic("%d plink's left unreclaimed!", plink_num);
+}
+
+bool_t
+sim_sample_off(unsigned long long n_insn)
+{
+  sample_mode = sample_OFF;
+#ifdef SIM_R10K_POWER
+  power_set_sample(FALSE);
+#endif /* SIM_R10K_POWER */
+  fprintf(stderr, "sim: ** starting functional simulation -- fast-forwarding %llu instructions **\n", n_insn);
+
+  return sim_fastfwd(&regs, mem, n_insn, NULL);
+}
+
+bool_t
+sim_sample_warmup(unsigned long long n_insn)
+{
+  sample_mode = sample_WARM;
+#ifdef SIM_R10K_POWER
+  power_set_sample(FALSE);
+#endif /* SIM_R10K_POWER */
+  fprintf(stderr, "sim: ** starting functional simulation -- warming up for %llu instructions **\n", n_insn);
+
+  return sim_fastfwd(&regs, mem, n_insn, warmup_handler);
+}
+
+bool_t
+sim_sample_on(unsigned long long n_insn)
+{
+  counter_t n_insn_commit_sum_beg = n_insn_commit_sum;
+
+  sample_mode = sample_ON;
+#ifdef SIM_R10K_POWER
+  power_set_sample(TRUE);
+#endif /* SIM_R10K_POWER */
+
+  fprintf(stderr, "sim: ** starting timing simulation");
+
+  if (n_insn != 0)
+    {
+      fprintf(stderr, " -- simulating %llu instructions", n_insn);
+    }
+
+  fprintf(stderr, " **\n");
+
+  regs_func2timing();
+  tseries_resume();
+  hprof_resume();
+
+  /* set up timing simulation entry state */
+  fetch_PC = regs.PC;
+
+  /* main simulator loop, NOTE: the pipe stages are traverse in reverse order
+     to eliminate this/next state synchronization and relaxation problems */
+  while (n_insn == 0 ||  n_insn_commit_sum < n_insn_commit_sum_beg + n_insn)
+    {
+      /* commit entries from RUU/LSQ to architected register file */
+      HPROF_CALL(hp_COMMIT, commit_stage());
+
+      /* service result completions, also readies dependent operations */
+      /* ==> inserts operations into ready queue --> register deps resolved */
+      HPROF_CALL(hp_WRITEBACK, writeback_stage());
+
+      /* invoke scheduler to schedule ready or partially ready events.
+	 The two schedulers act in parallel but are written separately
+	 for clarity */
+      HPROF_CALL(hp_SCHEDULE, schedule_stage());
+
+      /* decode and dispatch new operations */
+      /* ==> insert ops w/ no deps or all regs ready --> reg deps resolved */
+      HPROF_CALL(hp_RENAME, rename_stage());
+
+      /* call instruction fetch unit if it is not blocked */
+      HPROF_CALL(hp_FETCH, fetch_stage());
+
+      if (insn_limit != 0 && n_insn_commit_sum >= insn_limit)
+	{
+	  myfprintf(stderr, "Reached instruction limit: %u\n", insn_limit);
+	  return FALSE;
+	}
+
+      /* dump progress stats */
+      if (insn_progress > 0 && n_insn_commit_sum >= insn_progress)
+	{
+	  sim_print_progress(stderr);
+	  fflush(stderr);
+	  while (n_insn_commit_sum >= insn_progress)
+	    insn_progress += insn_progress_update;
+	}
+
+      /* interval time-series */
+      TSERIES_TICK(sim_cycle, n_insn_commit_sum);
+
+      /* pipetrace range */
+      PTRACE_TICK(sim_cycle, n_insn_commit_sum);
+
+      /* queue occupancy */
+      if (histo_active)
+	occupancy_sample();
+
+      /* go to next cycle */
+#if defined(SIM_R10K_REGCACHE) && defined(SIM_R10K_POWER)
+      regcache_power_count();
+#endif /* SIM_R10K_REGCACHE && SIM_R10K_POWER */
+      sim_cycle++;
+#ifdef SIM_R10K_REGCACHE
+      l1_preg_readNum = 0; l2_preg_readNum = 0;
+      l1_preg_writeNum = 0; l2_preg_writeNum = 0;
+#endif /* SIM_R10K_REGCACHE */
+#ifdef SIM_R10K_POWER
+      power_count_access_new_cycle();
+#endif /* SIM_R10K_POWER */
+    }
+
+  /* blow away all transient state */
+#ifndef SIM_R10K_CPR
+  ROB_cleanup();
+#endif /* !SIM_R10K_CPR */
+  IFQ_cleanup();
+  PLINK_purge();
+
+  cleanup_assert();
+
+  hprof_pause();
+  tseries_pause();
+  regs_timing2func();
+
+  /* have we executed enough instructions? */
+  return (n_insn_commit_sum - n_insn_commit_sum_beg >= n_insn);
+}
+
+/* start simulation, program loaded, processor precise state initialized */
+void
+sim_start(void)
+{
+  /* ignore any floating point exceptions, they may occur on mis-speculated
+     execution paths */
+  signal(SIGFPE, SIG_IGN);
+
+  /* set up program entry state */
+  regs.PC = ld_prog_entry;
+  regs.NPC = regs.PC + sizeof(md_inst_t);
+}
+
+
+#endif /* SIM_R10K_CORE_H */
@@ -0,0 +1,210 @@
+#ifndef SIM_R10K_LSQ_H
+#define SIM_R10K_LSQ_H
+
+/* load/store queue and memory dependence prediction shared by the
+   sim-R10K timing simulators (sim-R10K, sim-R10K-reg, sim-R10K-power,
+   sim-R10K-reg-power).
+
+   the simulators keep their state in file-scope statics, so this is
+   not a separately compiled module: sim-R10K-core.h includes it once,
+   after the union val_t and struct INSN_station_t (which must provide
+   pdi, PC and f_rs), and gets its own LSQ stations, LSQ, station free
+   list and store set tables.
+
+   build time features, see sim-R10K-core.h:
+
+     SIM_R10K_CPR	checkpoint (CPR) commit, stations carry a commit flag */
+
+/* LDST_station_t are the entries in the load store queue (LSQ).  They
+   hold information used in scheduling memory operations. */
+struct LDST_station_t
+{
+  struct LDST_station_t *next, *prev, *fnext;
+
+  struct INSN_station_t *is;    /* contains the address and opcode */
+  union val_t val;              /* value, for forwarding */
+  tag_t tag;                    /* tag used to squash entry */
+
+  md_addr_t addr;
+  int dsize;
+
+  bool_t f_stall;
+
+  /* stalled on a predicted store dependence, and would perfect
+     disambiguation not have waited (see load_false_dep) */
+  bool_t f_dep_stall, f_false_dep;
+
+#ifdef SIM_R10K_CPR
+  bool_t commit;
+#endif /* SIM_R10K_CPR */
+
+  /* store sets: the last fetched store of the set at rename, valid
+     while its tag matches */
+  struct LDST_station_t *ss_dep;
+  tag_t ss_dep_tag;
+};
+
+/* store sets last fetched store table entry */
+struct lfst_ent_t
+{
+  struct LDST_station_t *ls;
+  tag_t tag;
+};
+
+/* Queue of LDST_station_t: used to implement the LSQ */
+struct LDST_queue_t
+{
+  struct LDST_station_t *head, *tail;
+  int snum, ssize, lnum, lsize;
+  counter_t scount, lcount;
+};
+
+/* LDST_station_t freelist (simulator only, does not exist in actual processor) */
+static struct LDST_station_t *LDST_flist = NULL;
+static int LDST_num = 0;
+
+/* load-store queue (LSQ) */
+static struct LDST_queue_t LSQ;
+
+/* address disambiguation store sets and their last fetched stores */
+static struct storeset_t *storeset = NULL;
+static struct lfst_ent_t *lfst = NULL;
+
+/* LDST_station_t freelist management functions */
+STATIC void
+LDST_init(void)
+{
+  int i;
+  int LDST_size = LSQ.ssize + LSQ.lsize;
+
+  LDST_flist = (struct LDST_station_t *)mycalloc(LDST_size, sizeof(struct LDST_station_t));
+  for (i = 0; i < LDST_size - 1; i++)
+    LDST_flist[i].fnext = &LDST_flist[i+1];
+}
+
+STATIC INLINE struct LDST_station_t *
+LDST_alloc(void)
+{
+  struct LDST_station_t *ls = LDST_flist;
+
+  if (ls)
+  {
+    LDST_flist = ls->fnext;
+    ls->fnext = NULL;
+    LDST_num++;
+  }
+
+  ls->addr = ls->dsize = 0;
+  return ls;
+}
+
+STATIC INLINE void
+LDST_free(struct LDST_station_t *ls)
+{
+  tag_t tag = ls->tag;
+  assert(ls->next == NULL && ls->prev == NULL);
+  memset((byte_t *)ls, 0, sizeof(struct LDST_station_t));
+  ls->tag = tag+1; /* squash */
+  ls->fnext = LDST_flist;
+  LDST_flist = ls;
+  LDST_num--;
+}
+
+STATIC INLINE void
+LDST_enqueue(struct LDST_queue_t *q,
+    struct LDST_station_t *ls,
+    bool_t f_store)
+{
+  ls->prev = q->tail;
+  if (q->tail) q->tail->next = ls;
+  else         q->head = ls;
+
+  q->tail = ls;
+
+  if (f_store) q->snum++;
+  else q->lnum++;
+}
+
+STATIC INLINE void
+LDST_remove(struct LDST_queue_t *q,
+    struct LDST_station_t *ls,
+    bool_t f_store)
+{
+  if (ls->prev) ls->prev->next = ls->next;
+  if (ls->next) ls->next->prev = ls->prev;
+
+  if (q->head == ls) q->head = ls->next;
+  if (q->tail == ls) q->tail = ls->prev;
+
+  ls->prev = ls->next = NULL;
+
+  if (f_store) q->snum--;
+  else q->lnum--;
+}
+
+bool_t
+address_collision(const struct LDST_station_t *ls1,
+    const struct LDST_station_t *ls2)
+{
+  return
+      ((ls1->addr >= ls2->addr) && (ls1->addr < (ls2->addr + ls2->dsize))) ||
+      ((ls2->addr >= ls1->addr) && (ls2->addr < (ls1->addr + ls1->dsize)));
+}
+
+/* would perfect disambiguation make LOAD wait, i.e. is the nearest
+   older store it collides with unissued? */
+STATIC bool_t
+load_true_dep(const struct LDST_station_t *load)
+{
+  struct LDST_station_t *store;
+
+  for (store = load->prev; store; store = store->prev)
+    if (store->is->pdi->iclass == ic_store && address_collision(store, load))
+      return store->is->f_rs;
+
+  return FALSE;
+}
+
+/* is LOAD's stall on a predicted store dependence one perfect
+   disambiguation would not make?  decided once, at its first such stall,
+   so the LSQ walk is not repeated every cycle the load stays stalled */
+STATIC bool_t
+load_false_dep(struct LDST_station_t *load)
+{
+  if (!load->f_dep_stall)
+  {
+    load->f_dep_stall = TRUE;
+    load->f_false_dep = !load_true_dep(load);
+  }
+  return load->f_false_dep;
+}
+
+/* store sets: LS waits for the last fetched store of its set, and a
+   store becomes the last fetched store of its set */
+STATIC void
+storeset_rename(struct LDST_station_t *ls)
+{
+  int ssid = storeset_lookup(storeset, ls->is->PC);
+  struct lfst_ent_t *last;
+
+  if (ssid < 0)
+    return;
+
+  last = &lfst[ssid];
+  if (last->ls && last->ls->tag == last->tag)
+  {
+    ls->ss_dep = last->ls;
+    ls->ss_dep_tag = last->tag;
+  }
+  if (ls->is->pdi->iclass == ic_store)
+  {
+    last->ls = ls;
+    last->tag = ls->tag;
+  }
+}
+
+/* LS must wait for its store set predecessor to issue */
+#define STORESET_WAIT(LS)						\
+  ((LS)->ss_dep && (LS)->ss_dep->tag == (LS)->ss_dep_tag && (LS)->ss_dep->is->f_rs)
+
+#endif /* SIM_R10K_LSQ_H */
@@ -0,0 +1,120 @@
+/*
+ * sim-outorder.c - sample out-of-order issue perf simulator implementation
+ *
+ * This file is a part of the SimpleScalar tool suite written by
+ * Todd M. Austin as a part of the Multiscalar Research Project.
+ *  
+ * The tool suite is currently maintained by Doug Burger and Todd M. Austin.
+ * 
+ * Copyright (C) 1994, 1995, 1996, 1997, 1998 by Todd M. Austin
+ *
+ * This source file is distributed "as is" in the hope that it will be
+ * useful.  The tool set comes with no warranty, and no author or
+ * distributor accepts any responsibility for the consequences of its
+ * use. 
+ * 
+ * Everyone is granted permission to copy, modify and redistribute
+ * this tool set under the following conditions:
+ * 
+ *    This source code is distributed for non-commercial use only. 
+ *    Please contact the maintainer for restrictions applying to 
+ *    commercial use.
+ *
+ *    Permission is granted to anyone to make or distribute copies
+ *    of this source code, either as received or modified, in any
+ *    medium, provided that all copyright notices, permission and
+ *    nonwarranty notices are preserved, and that the distributor
+ *    grants the recipient permission for further redistribution as
+ *    permitted by this document.
+ *
+ *    Permission is granted to distribute this file in compiled
+ *    or executable form under the same conditions that apply for
+ *    source code, provided that either:
+ *
+ *    A. it is accompanied by the corresponding machine-readable
+ *       source code,
+ *    B. it is accompanied by a written offer, with no time limit,
+ *       to give anyone a machine-readable copy of the corresponding
+ *       source code in return for reimbursement of the cost of
+ *       distribution.  This written offer must permit verbatim
+ *       duplication by anyone, or
+ *    C. it is distributed by someone who received only the
+ *       executable form, and is accompanied by a copy of the
+ *       written offer of source code that they received concurrently.
+ *
+ * In other words, you are welcome to use, share and improve this
+ * source file.  You are forbidden to forbid anyone else to use, share
+ * and improve what you give them.
+ *
+ * INTERNET: dburger@cs.wisc.edu
+ * US Mail:  1210 W. Dayton Street, Madison, WI 53706
+ *
+ * $Id: sim-outorder.c,v 1.5 1998/08/27 16:27:48 taustin Exp taustin $
+ *
+ * $Log: sim-outorder.c,v $
+ * Revision 1.5  1998/08/27 16:27:48  taustin
+ * implemented host interface description in host.h
+ * added target interface support
+ * added support for register and memory contexts
+ * instruction predecoding moved to loader module
+ * Alpha target support added
+ * added support for quadword's
+ * added fault support
+ * added option ("-max:inst") to limit number of instructions analyzed
+ * explicit BTB sizing option added to branch predictors, use
+ *       "-btb" option to configure BTB
+ * added queue statistics for IFQ, RUU, and LSQ; all terms of Little's
+ *       law are measured and reports; also, measures fraction of cycles
+ *       in which queue is full
+ * added fast forward option ("-fastfwd") that skips a specified number
+ *       of instructions (using functional simulation) before starting timing
+ *       simulation
+ * sim-outorder speculative loads no longer allocate memory pages,
+ *       this significantly reduces memory requirements for programs with
+ *       lots of mispeculation (e.g., cc1)
+ * branch predictor updates can now optionally occur in ID, WB,
+ *       or CT
+ * added target-dependent myprintf() support
+ * fixed speculative quadword store bug (missing most significant word)
+ * sim-outorder now computes correct result when non-speculative register
+ *       operand is first defined speculative within the same inst
+ * speculative fault handling simplified
+ * dead variable "no_ea_dep" removed
+ *
+ * Revision 1.4  1997/04/16  22:10:23  taustin
+ * added -commit:width support (from kskadron)
+ * fixed "bad l2 D-cache parms" fatal string
+ *
+ * Revision 1.3  1997/03/11  17:17:06  taustin
+ * updated copyright
+ * `-pcstat' option support added
+ * long/int tweaks made for ALPHA target support
+ * better defaults defined for caches/TLBs
+ * "mstate" command supported added for DLite!
+ * supported added for non-GNU C compilers
+ * buglet fixed in speculative trace generation
+ * multi-level cache hierarchy now supported
+ * two-level predictor supported added
+ * I/D-TLB supported added
+ * many comments added
+ * options package supported added
+ * stats package support added
+ * resource configuration options extended
+ * pipetrace support added
+ * DLite! support added
+ * writeback throttling now supported
+ * decode and issue B/W now decoupled
+ * new and improved (and more precise) memory scheduler added
+ * cruft for TLB paper removed
+ *
+ * Revision 1.1  1996/12/05  18:52:32  taustin
+ * Initial revision
+ *
+ *
+ */
+
+/* build time features, see sim-R10K-core.h */
+#define SIM_R10K_REGCACHE	/* two level register file with an L1 register cache */
+#define SIM_R10K_POWER		/* power accounting */
+
+#include "sim-R10K-core.h"
@@ -0,0 +1,441 @@
+/* sim-bench.c - simulator throughput benchmark
+ *
+ * usage: sim-bench [-n <insn>] [-r <reps>] [-sims <list>] [-bench <list>]
+ *                  [-simdir <dir>] [-benchdir <dir>] [-o <file>]
+ *                  [-baseline <file>] [-threshold <pct>] [-nopin]
+ *
+ * Runs every simulator in -sims (comma separated, default sim-R10K,
+ * sim-R10K-reg, sim-R10K-power, sim-cache, sim-func and sim-DLX) over the
+ * first -n instructions (default 10000000) of every benchmark in -bench
+ * (default every <benchdir>/<bench>.eio) and records the host speed of
+ * each run into the CSV file -o (default bench.csv):
+ *
+ *   sim,bench,status,insn,wall_sec,startup_sec,KIPS,maxrss_KB
+ *
+ * startup_sec is the wall time of a one instruction run (loading the
+ * trace and building the machine), KIPS counts the instructions the
+ * simulator reports as sim_num_insn over the remaining wall time, and
+ * maxrss_KB is the peak resident set size of the run.  Each run is
+ * repeated -r times (default 1) and the fastest kept.  Runs execute one
+ * at a time, pinned to one CPU unless -nopin, so they do not disturb
+ * each other.
+ *
+ * With -baseline, a results file of an earlier run (e.g. a copy of
+ * bench.csv), every run is compared against its baseline; one that is
+ * more than -threshold percent (default 5) slower, or larger in peak RSS,
+ * is reported as a regression and sim-bench exits with status 1.
+ *
+ * build: cc -o sim-bench sim-bench.c misc.c -lz -lm
+ */
+
+#ifdef __linux__
+#define _GNU_SOURCE
+#include <sched.h>
+#endif /* __linux__ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <sys/types.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#include "host.h"
+#include "misc.h"
+
+#define MAX_LIST		64
+
+/* one benchmark run */
+struct bench_run_t
+{
+  char *sim;
+  char *bench;
+  int f_ok;				/* all repetitions exited cleanly */
+  counter_t insn;			/* reported sim_num_insn */
+  double wall;				/* seconds */
+  double startup;			/* seconds */
+  double kips;
+  long maxrss;				/* KB */
+};
+
+static char *def_sims =
+  "sim-R10K,sim-R10K-reg,sim-R10K-power,sim-cache,sim-func,sim-DLX";
+
+static char *sims[MAX_LIST];
+static int n_sims = 0;
+static char *benches[MAX_LIST];
+static int n_benches = 0;
+
+static char *sim_dir = ".";
+static char *bench_dir = "../benchmarks";
+static char *log_name = "sim-bench.log";
+static int f_pin = TRUE;
+
+static void
+usage(char *prog)
+{
+  fprintf(stderr,
+	  "usage: %s [-n <insn>] [-r <reps>] [-sims <list>] [-bench <list>]\n"
+	  "       [-simdir <dir>] [-benchdir <dir>] [-o <file>]\n"
+	  "       [-baseline <file>] [-threshold <pct>] [-nopin]\n",
+	  prog);
+  exit(1);
+}
+
+/* split comma separated LIST into VEC, returns the number of entries */
+static int
+split_list(char *list, char **vec)
+{
+  char *p, *t = mystrdup(list);
+  int n = 0;
+
+  for (p = strtok(t, ","); p; p = strtok(NULL, ","))
+    {
+      if (n == MAX_LIST)
+	fatal("too many entries in `%s'", list);
+      vec[n++] = p;
+    }
+  return n;
+}
+
+static int
+str_cmp(const void *a, const void *b)
+{
+  return strcmp(*(char **)a, *(char **)b);
+}
+
+/* every <bench>.eio in bench_dir, sorted */
+static void
+scan_benches(void)
+{
+  DIR *dir;
+  struct dirent *ent;
+  int len;
+
+  dir = opendir(bench_dir);
+  if (!dir)
+    fatal("could not open benchmark directory `%s'", bench_dir);
+
+  while ((ent = readdir(dir)) != NULL)
+    {
+      len = strlen(ent->d_name);
+      if (len <= 4 || strcmp(ent->d_name + len - 4, ".eio"))
+	continue;
+      if (n_benches == MAX_LIST)
+	fatal("too many benchmarks in `%s'", bench_dir);
+      benches[n_benches] = mystrdup(ent->d_name);
+      benches[n_benches++][len - 4] = '\0';
+    }
+  closedir(dir);
+
+  if (n_benches == 0)
+    fatal("no .eio traces in `%s'", bench_dir);
+  qsort(benches, n_benches, sizeof(char *), str_cmp);
+}
+
+static double
+now_sec(void)
+{
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1.0e6;
+}
+
+/* run simulator SIM over N_INSN instructions of BENCH, its output goes to
+   the log; returns TRUE if it exited cleanly, and its wall time, peak
+   RSS and reported instruction count */
+static int
+run_sim(char *sim, char *bench, unsigned long long n_insn,
+	double *wall, long *maxrss, counter_t *insn)
+{
+  char path[1024], trace[1024], limit[32], line[1024], name[256];
+  char *argv[8];
+  struct rusage ru;
+  long long val;
+  double start;
+  int fd, status;
+  pid_t pid;
+  FILE *log;
+
+  sprintf(path, "%s/%s", sim_dir, sim);
+  sprintf(trace, "%s/%s.eio", bench_dir, bench);
+  sprintf(limit, "%llu", n_insn);
+  argv[0] = path;
+  argv[1] = "-insn:limit";
+  argv[2] = limit;
+  argv[3] = trace;
+  argv[4] = NULL;
+
+  start = now_sec();
+  pid = fork();
+  if (pid < 0)
+    fatal("could not fork simulator run");
+
+  if (pid == 0)
+    {
+#ifdef __linux__
+      if (f_pin)
+	{
+	  cpu_set_t mask;
+
+	  CPU_ZERO(&mask);
+	  CPU_SET(0, &mask);
+	  sched_setaffinity(0, sizeof(mask), &mask);
+	}
+#endif /* __linux__ */
+
+      /* simulator and simulated program output both go to the log */
+      fd = open(log_name, O_WRONLY|O_CREAT|O_TRUNC, 0666);
+      if (fd < 0)
+	{
+	  fprintf(stderr, "sim-bench: could not create log `%s'\n", log_name);
+	  _exit(127);
+	}
+      dup2(fd, 1);
+      dup2(fd, 2);
+      close(fd);
+
+      execv(path, argv);
+      fprintf(stderr, "sim-bench: could not execute `%s'\n", path);
+      _exit(127);
+    }
+
+  if (wait4(pid, &status, 0, &ru) < 0)
+    fatal("lost simulator run `%s %s'", sim, bench);
+  *wall = now_sec() - start;
+  *maxrss = ru.ru_maxrss;
+
+  *insn = 0;
+  if ((log = fopen(log_name, "r")) != NULL)
+    {
+      while (fgets(line, sizeof(line), log))
+	if (sscanf(line, "%255s %lld", name, &val) == 2
+	    && !strcmp(name, "sim_num_insn"))
+	  *insn = (counter_t)val;
+      fclose(log);
+    }
+
+  return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+/* benchmark SIM on BENCH, keeping the fastest of N_REPS repetitions */
+static void
+bench_one(struct bench_run_t *run, char *sim, char *bench,
+	  unsigned long long n_insn, int n_reps)
+{
+  double wall, startup;
+  long maxrss;
+  counter_t insn;
+  int rep;
+
+  run->sim = sim;
+  run->bench = bench;
+  run->f_ok = TRUE;
+  run->wall = run->startup = 0.0;
+  run->maxrss = 0;
+  run->insn = 0;
+
+  for (rep = 0; rep < n_reps && run->f_ok; rep++)
+    {
+      if (!run_sim(sim, bench, 1, &startup, &maxrss, &insn)
+	  || !run_sim(sim, bench, n_insn, &wall, &maxrss, &insn))
+	{
+	  run->f_ok = FALSE;
+	  break;
+	}
+
+      if (rep == 0 || wall < run->wall)
+	{
+	  run->wall = wall;
+	  run->insn = insn;
+	  run->maxrss = maxrss;
+	}
+      if (rep == 0 || startup < run->startup)
+	run->startup = startup;
+    }
+
+  if (!run->f_ok)
+    {
+      fprintf(stderr, "sim-bench: %s %s failed, see `%s'\n",
+	      sim, bench, log_name);
+      return;
+    }
+
+  /* simulation speed, without the fixed startup cost */
+  run->kips = (double)run->insn / 1000.0
+    / (run->wall > run->startup ? run->wall - run->startup : run->wall);
+
+  fprintf(stderr, "%-16s %-20s %12.1f KIPS %8.2f s %6.2f s startup %8ld KB\n",
+	  sim, bench, run->kips, run->wall, run->startup, run->maxrss);
+}
+
+static void
+write_results(char *fname, struct bench_run_t *runs, int n_runs)
+{
+  FILE *fd;
+  int i;
+
+  fd = fopen(fname, "w");
+  if (!fd)
+    fatal("could not create results file `%s'", fname);
+
+  fprintf(fd, "sim,bench,status,insn,wall_sec,startup_sec,KIPS,maxrss_KB\n");
+  for (i = 0; i < n_runs; i++)
+    {
+      if (runs[i].f_ok)
+	fprintf(fd, "%s,%s,ok,%lld,%.3f,%.3f,%.1f,%ld\n",
+		runs[i].sim, runs[i].bench, (long long)runs[i].insn,
+		runs[i].wall, runs[i].startup, runs[i].kips, runs[i].maxrss);
+      else
+	fprintf(fd, "%s,%s,failed,,,,,\n", runs[i].sim, runs[i].bench);
+    }
+  fclose(fd);
+
+  fprintf(stderr, "sim-bench: results in `%s'\n", fname);
+}
+
+/* compare RUNS against baseline results FNAME, returns the number of
+   regressions beyond THRESHOLD percent */
+static int
+compare_baseline(char *fname, double threshold,
+		 struct bench_run_t *runs, int n_runs)
+{
+  FILE *fd;
+  char line[1024], sim[256], bench[256], status[32];
+  long long insn;
+  double wall, startup, kips, log_sum;
+  long maxrss;
+  int i, s, n, n_regress = 0;
+  double *base_kips = (double *)mycalloc(n_runs, sizeof(double));
+  long *base_rss = (long *)mycalloc(n_runs, sizeof(long));
+
+  fd = fopen(fname, "r");
+  if (!fd)
+    fatal("could not open baseline `%s'", fname);
+
+  while (fgets(line, sizeof(line), fd))
+    {
+      if (sscanf(line, "%255[^,],%255[^,],%31[^,],%lld,%lf,%lf,%lf,%ld",
+		 sim, bench, status, &insn, &wall, &startup, &kips, &maxrss) != 8
+	  || strcmp(status, "ok"))
+	continue;
+      for (i = 0; i < n_runs; i++)
+	if (!strcmp(runs[i].sim, sim) && !strcmp(runs[i].bench, bench))
+	  {
+	    base_kips[i] = kips;
+	    base_rss[i] = maxrss;
+	  }
+    }
+  fclose(fd);
+
+  for (i = 0; i < n_runs; i++)
+    {
+      if (!runs[i].f_ok || base_kips[i] <= 0.0)
+	continue;
+
+      if (runs[i].kips < base_kips[i] * (1.0 - threshold / 100.0))
+	{
+	  fprintf(stderr, "REGRESSION %s %s: %.1f KIPS, baseline %.1f (%+.1f%%)\n",
+		  runs[i].sim, runs[i].bench, runs[i].kips, base_kips[i],
+		  100.0 * (runs[i].kips / base_kips[i] - 1.0));
+	  n_regress++;
+	}
+      if (runs[i].maxrss > base_rss[i] * (1.0 + threshold / 100.0))
+	{
+	  fprintf(stderr, "REGRESSION %s %s: %ld KB peak RSS, baseline %ld KB\n",
+		  runs[i].sim, runs[i].bench, runs[i].maxrss, base_rss[i]);
+	  n_regress++;
+	}
+    }
+
+  /* per simulator geometric mean speedup over the baseline */
+  for (s = 0; s < n_sims; s++)
+    {
+      for (log_sum = 0.0, n = 0, i = 0; i < n_runs; i++)
+	if (runs[i].sim == sims[s] && runs[i].f_ok && base_kips[i] > 0.0)
+	  {
+	    log_sum += log(runs[i].kips / base_kips[i]);
+	    n++;
+	  }
+      if (n > 0)
+	fprintf(stderr, "%-16s %5.3fx baseline speed over %d benchmarks\n",
+		sims[s], exp(log_sum / n), n);
+    }
+
+  free(base_kips);
+  free(base_rss);
+  return n_regress;
+}
+
+int
+main(int argc, char **argv)
+{
+  struct bench_run_t *runs;
+  char *out_name = "bench.csv", *base_name = NULL;
+  unsigned long long n_insn = 10000000;
+  double threshold = 5.0;
+  int i, s, b, n_runs, n_reps = 1, n_failed = 0, n_regress = 0;
+
+  for (i = 1; i < argc; i++)
+    {
+      if (!strcmp(argv[i], "-n") && i + 1 < argc)
+	n_insn = strtoull(argv[++i], NULL, 0);
+      else if (!strcmp(argv[i], "-r") && i + 1 < argc)
+	n_reps = atoi(argv[++i]);
+      else if (!strcmp(argv[i], "-sims") && i + 1 < argc)
+	n_sims = split_list(argv[++i], sims);
+      else if (!strcmp(argv[i], "-bench") && i + 1 < argc)
+	n_benches = split_list(argv[++i], benches);
+      else if (!strcmp(argv[i], "-simdir") && i + 1 < argc)
+	sim_dir = argv[++i];
+      else if (!strcmp(argv[i], "-benchdir") && i + 1 < argc)
+	bench_dir = argv[++i];
+      else if (!strcmp(argv[i], "-o") && i + 1 < argc)
+	out_name = argv[++i];
+      else if (!strcmp(argv[i], "-baseline") && i + 1 < argc)
+	base_name = argv[++i];
+      else if (!strcmp(argv[i], "-threshold") && i + 1 < argc)
+	threshold = atof(argv[++i]);
+      else if (!strcmp(argv[i], "-nopin"))
+	f_pin = FALSE;
+      else
+	usage(argv[0]);
+    }
+  if (n_insn < 2 || n_reps < 1 || threshold < 0.0)
+    usage(argv[0]);
+
+  if (n_sims == 0)
+    n_sims = split_list(def_sims, sims);
+  if (n_benches == 0)
+    scan_benches();
+
+  n_runs = n_sims * n_benches;
+  runs = (struct bench_run_t *)mycalloc(n_runs, sizeof(struct bench_run_t));
+
+  fprintf(stderr, "sim-bench: %d simulators x %d benchmarks, %llu insts, "
+	  "%d repetitions\n", n_sims, n_benches, n_insn, n_reps);
+
+  for (i = 0, s = 0; s < n_sims; s++)
+    for (b = 0; b < n_benches; b++, i++)
+      {
+	bench_one(&runs[i], sims[s], benches[b], n_insn, n_reps);
+	if (!runs[i].f_ok)
+	  n_failed++;
+      }
+
+  write_results(out_name, runs, n_runs);
+
+  if (base_name)
+    n_regress = compare_baseline(base_name, threshold, runs, n_runs);
+
+  fprintf(stderr, "sim-bench: %d runs, %d failed, %d regressions\n",
+	  n_runs, n_failed, n_regress);
+
+  return (n_failed > 0 || n_regress > 0) ? 1 : 0;
+}
@@ -317,15 +317,22 @@ sim_aux_config(FILE *stream)		/* output stream */
   /* nada */
 }
 
+/* re-check timing options in a -sweep child */
+void
+sim_sweep_options(int argc, char **argv)	/* sweep configuration options */
+{
+  fatal("-sweep is not supported by this simulator");
+}
+
 /* dump simulator-specific auxiliary simulator statistics */
 void
 sim_aux_stats(FILE *stream)		/* output stream */
 {
   /* nada */
   print_counter(stream, "sim_elapsed_time", sim_elapsed_time, "simulation time in seconds");
-  print_rate(stream, "sim_insn_rate", (double)sim_num_insn/sim_elapsed_time, "simulation speed (insts/sec)");
 
   print_counter(stream, "sim_num_insn", sim_num_insn, "instructions simulated (fast-forwarding included)");
+  print_formula(stream, "sim_insn_rate", 1.0, "sim_num_insn", "sim_elapsed_time", "insn/s", "simulation speed (insts/sec)");
   print_counter(stream, "sim_sample_insn", sim_sample_insn, "instructions (in sample)");
   print_counter(stream, "sim_sample_int", sim_sample_insn_split[ic_icomp] + sim_sample_insn_split[ic_icomplong], "integer operations");
   print_counter(stream, "sim_sample_load", sim_sample_insn_split[ic_load], "loads");
@@ -348,6 +355,17 @@ sim_aux_stats(FILE *stream)		/* output stream */
     cache_stats_print(cache_l2, stream);
 }
 
+/* fill in the running totals of the timing model */
+void
+sim_sample_totals(struct sim_sample_t *totals)
+{
+  totals->n_insn = sim_num_insn;
+  totals->n_cycle = 0;
+  totals->n_dl1_access = totals->n_dl1_miss = 0;
+  if (cache_dl1)
+    cache_totals(cache_dl1, &totals->n_dl1_access, &totals->n_dl1_miss);
+}
+
 void
 sim_start(void)
 {
@@ -527,7 +545,7 @@ sim_sample(unsigned int n_insn)
       
       if (insn_progress && sim_sample_insn >= insn_progress)
 	{
-	  sim_print_stats(stderr);
+	  sim_print_progress(stderr);
 	  fflush(stderr);
 	  while (sim_sample_insn >= insn_progress)
 	    insn_progress += insn_progress_update;
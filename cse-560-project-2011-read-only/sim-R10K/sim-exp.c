@@ -0,0 +1,607 @@
+/* sim-exp.c - parallel experiment runner
+ *
+ * usage: sim-exp [-j <jobs>] [-nopin] [-retry <n>] [-o <dir>] <spec>
+ *
+ * Expands an experiment spec into simulator runs, executes them on all host
+ * cores and collects the requested stats of every run into one CSV table,
+ * <dir>/results.csv.  The spec is line oriented, `#' starts a comment:
+ *
+ *   stat        sim_IPC sim_CPI        stats to collect (default sim_IPC)
+ *   benchdir    benchmarks             where <bench>.eio lives
+ *
+ *   experiment  Experiment2-Latency    starts a new experiment
+ *   sim         sim-R10K/sim-R10K-reg  simulator binary
+ *   args        -insn:limit 60000000   arguments common to all runs
+ *   bench       ammp bzip2 gcc         benchmarks to run
+ *   param       -l1_pregfile:lat 1..10
+ *
+ * A param value is a range `<lo>..<hi> [step <n>]', a comma separated list
+ * or a single value.  Several option/value pairs on one param line move in
+ * lock step and must have the same number of values, separate param lines
+ * are crossed.  Each run logs to <dir>/<experiment>/<sim>_<bench>_<tag>.log;
+ * the log is only put in place when the simulator exits cleanly, so
+ * re-running the same spec skips the finished runs and retries the rest.
+ *
+ * build: cc -o sim-exp sim-exp.c misc.c -lz
+ */
+
+#ifdef __linux__
+#define _GNU_SOURCE
+#include <sched.h>
+#endif /* __linux__ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include "host.h"
+#include "misc.h"
+
+#define MAX_ARGS		256
+#define MAX_STATS		32
+#define MAX_PARAMS		16
+#define MAX_ZIP			8
+
+/* one param line: options that move in lock step over N_VAL values */
+struct exp_param_t
+{
+  int n_opt;
+  char *opt[MAX_ZIP];
+  char **val[MAX_ZIP];
+  int n_val;
+};
+
+/* job status */
+enum exp_status_t { es_PENDING, es_RUNNING, es_DONE, es_FAILED };
+
+/* one simulator run */
+struct exp_job_t
+{
+  char *exp;				/* experiment name */
+  char *sim;				/* simulator binary */
+  char *bench;				/* benchmark name */
+  char *params;				/* "opt=val ..." for the results table */
+  char *argv[MAX_ARGS];			/* simulator command line */
+  char *log;				/* log file name */
+  enum exp_status_t status;
+  int tries;
+  pid_t pid;
+  int slot;				/* worker slot, pinned to a CPU */
+  time_t start;
+};
+
+static struct exp_job_t *jobs = NULL;
+static int n_jobs = 0, max_jobs = 0;
+
+static char *stats[MAX_STATS];
+static int n_stats = 0;
+
+static char *out_dir = NULL;
+
+/* experiment block being parsed */
+static char *cur_exp = NULL, *cur_sim = NULL, *cur_benchdir = "benchmarks";
+static char *cur_args[MAX_ARGS];
+static int n_cur_args = 0;
+static char *cur_bench[MAX_ARGS];
+static int n_cur_bench = 0;
+static struct exp_param_t cur_params[MAX_PARAMS];
+static int n_cur_params = 0;
+
+static void
+usage(char *prog)
+{
+  fprintf(stderr,
+	  "usage: %s [-j <jobs>] [-nopin] [-retry <n>] [-o <dir>] <spec>\n",
+	  prog);
+  exit(1);
+}
+
+/* create directory DIR if it does not exist */
+static void
+make_dir(char *dir)
+{
+  if (mkdir(dir, 0777) < 0 && errno != EEXIST)
+    fatal("could not create directory `%s'", dir);
+}
+
+/* copy of S usable in a file name */
+static char *
+file_safe(char *s)
+{
+  char *p, *t = mystrdup(*s == '-' ? s + 1 : s);
+
+  for (p = t; *p; p++)
+    if (*p == '/' || *p == ':' || *p == ' ')
+      *p = '_';
+  return t;
+}
+
+/* expand param value spec SPEC into *VALS, returns the number of values */
+static int
+expand_values(char *spec, char *step, char ***vals)
+{
+  char *dots, *tok, buf[64];
+  long lo, hi, inc, v;
+  int n = 0;
+
+  *vals = (char **)mycalloc(MAX_ARGS, sizeof(char *));
+
+  if ((dots = strstr(spec, "..")) != NULL)
+    {
+      lo = strtol(spec, NULL, 0);
+      hi = strtol(dots + 2, NULL, 0);
+      inc = step ? strtol(step, NULL, 0) : 1;
+      if (inc <= 0 || hi < lo)
+	fatal("bad param range `%s'", spec);
+      for (v = lo; v <= hi; v += inc)
+	{
+	  if (n == MAX_ARGS)
+	    fatal("param range `%s' is too large", spec);
+	  sprintf(buf, "%ld", v);
+	  (*vals)[n++] = mystrdup(buf);
+	}
+    }
+  else
+    {
+      for (tok = strtok(spec, ","); tok; tok = strtok(NULL, ","))
+	{
+	  if (n == MAX_ARGS)
+	    fatal("param list `%s' is too large", spec);
+	  (*vals)[n++] = mystrdup(tok);
+	}
+    }
+  return n;
+}
+
+/* parse the option/value pairs of a param line */
+static void
+parse_param(char **tok, int n_tok)
+{
+  struct exp_param_t *p;
+  char *step;
+  int i, n;
+
+  if (n_cur_params == MAX_PARAMS)
+    fatal("too many params in experiment `%s'", cur_exp);
+  p = &cur_params[n_cur_params++];
+  p->n_opt = 0;
+
+  for (i = 0; i < n_tok; )
+    {
+      if (i + 1 >= n_tok)
+	fatal("param `%s' has no value", tok[i]);
+      if (p->n_opt == MAX_ZIP)
+	fatal("too many lock step options on one param line");
+
+      step = NULL;
+      if (i + 2 < n_tok && !strcmp(tok[i + 2], "step"))
+	{
+	  if (i + 3 >= n_tok)
+	    fatal("param `%s' step has no value", tok[i]);
+	  step = tok[i + 3];
+	}
+
+      p->opt[p->n_opt] = mystrdup(tok[i]);
+      n = expand_values(tok[i + 1], step, &p->val[p->n_opt]);
+      if (p->n_opt > 0 && n != p->n_val)
+	fatal("lock step params `%s' and `%s' have different value counts",
+	      p->opt[0], p->opt[p->n_opt]);
+      p->n_val = n;
+      p->n_opt++;
+
+      i += step ? 4 : 2;
+    }
+}
+
+/* add the jobs of the current experiment, crossing params from index P */
+static void
+add_jobs(int p, int *sel)
+{
+  struct exp_job_t *job;
+  char buf[1024], tag[1024], params[1024], *s;
+  int b, i, j, n;
+
+  if (p < n_cur_params)
+    {
+      for (sel[p] = 0; sel[p] < cur_params[p].n_val; sel[p]++)
+	add_jobs(p + 1, sel);
+      return;
+    }
+
+  for (b = 0; b < n_cur_bench; b++)
+    {
+      if (n_jobs == max_jobs)
+	{
+	  max_jobs = max_jobs ? 2 * max_jobs : 256;
+	  jobs = (struct exp_job_t *)
+	    realloc(jobs, max_jobs * sizeof(struct exp_job_t));
+	  if (!jobs)
+	    fatal("out of virtual memory");
+	}
+      job = &jobs[n_jobs++];
+      memset(job, 0, sizeof(*job));
+
+      job->exp = cur_exp;
+      job->sim = cur_sim;
+      job->bench = cur_bench[b];
+      job->status = es_PENDING;
+
+      n = 0;
+      job->argv[n++] = cur_sim;
+      for (i = 0; i < n_cur_args; i++)
+	job->argv[n++] = cur_args[i];
+
+      tag[0] = params[0] = '\0';
+      for (i = 0; i < n_cur_params; i++)
+	for (j = 0; j < cur_params[i].n_opt; j++)
+	  {
+	    if (n + 3 >= MAX_ARGS)
+	      fatal("too many arguments in experiment `%s'", cur_exp);
+	    job->argv[n++] = cur_params[i].opt[j];
+	    job->argv[n++] = cur_params[i].val[j][sel[i]];
+
+	    s = file_safe(cur_params[i].opt[j]);
+	    sprintf(tag + strlen(tag), "_%s-%s", s, cur_params[i].val[j][sel[i]]);
+	    free(s);
+	    sprintf(params + strlen(params), "%s%s=%s", params[0] ? " " : "",
+		    cur_params[i].opt[j], cur_params[i].val[j][sel[i]]);
+	  }
+      job->params = mystrdup(params);
+
+      sprintf(buf, "%s/%s.eio", cur_benchdir, cur_bench[b]);
+      job->argv[n++] = mystrdup(buf);
+      job->argv[n] = NULL;
+
+      s = file_safe(tag);
+      sprintf(buf, "%s/%s/%s_%s%s.log", out_dir, cur_exp,
+	      strrchr(cur_sim, '/') ? strrchr(cur_sim, '/') + 1 : cur_sim,
+	      cur_bench[b], s);
+      free(s);
+      job->log = mystrdup(buf);
+    }
+}
+
+/* expand the experiment block parsed so far into jobs */
+static void
+end_experiment(void)
+{
+  int sel[MAX_PARAMS];
+  char buf[1024];
+
+  if (!cur_exp)
+    return;
+  if (!cur_sim)
+    fatal("experiment `%s' has no simulator", cur_exp);
+  if (n_cur_bench == 0)
+    fatal("experiment `%s' has no benchmarks", cur_exp);
+
+  sprintf(buf, "%s/%s", out_dir, cur_exp);
+  make_dir(buf);
+
+  add_jobs(0, sel);
+
+  cur_exp = cur_sim = NULL;
+  n_cur_args = n_cur_bench = n_cur_params = 0;
+}
+
+/* read experiment spec FNAME */
+static void
+read_spec(char *fname)
+{
+  FILE *fd;
+  char line[4096], *p, *tok[MAX_ARGS];
+  int i, n_tok, line_num = 0;
+
+  fd = fopen(fname, "r");
+  if (!fd)
+    fatal("could not open experiment spec `%s'", fname);
+
+  while (fgets(line, sizeof(line), fd))
+    {
+      line_num++;
+      if ((p = strchr(line, '#')) != NULL)
+	*p = '\0';
+
+      for (n_tok = 0, p = strtok(line, " \t\r\n"); p; p = strtok(NULL, " \t\r\n"))
+	{
+	  if (n_tok == MAX_ARGS)
+	    fatal("%s:%d: line too long", fname, line_num);
+	  tok[n_tok++] = mystrdup(p);
+	}
+      if (n_tok == 0)
+	continue;
+
+      if (!strcmp(tok[0], "experiment") && n_tok == 2)
+	{
+	  end_experiment();
+	  cur_exp = tok[1];
+	}
+      else if (!strcmp(tok[0], "stat"))
+	{
+	  for (i = 1; i < n_tok; i++)
+	    {
+	      if (n_stats == MAX_STATS)
+		fatal("%s:%d: too many stats", fname, line_num);
+	      stats[n_stats++] = tok[i];
+	    }
+	}
+      else if (!strcmp(tok[0], "benchdir") && n_tok == 2)
+	cur_benchdir = tok[1];
+      else if (!cur_exp)
+	fatal("%s:%d: `%s' outside of an experiment", fname, line_num, tok[0]);
+      else if (!strcmp(tok[0], "sim") && n_tok == 2)
+	cur_sim = tok[1];
+      else if (!strcmp(tok[0], "args"))
+	{
+	  for (i = 1; i < n_tok; i++)
+	    {
+	      if (n_cur_args == MAX_ARGS)
+		fatal("%s:%d: too many arguments", fname, line_num);
+	      cur_args[n_cur_args++] = tok[i];
+	    }
+	}
+      else if (!strcmp(tok[0], "bench"))
+	{
+	  for (i = 1; i < n_tok; i++)
+	    {
+	      if (n_cur_bench == MAX_ARGS)
+		fatal("%s:%d: too many benchmarks", fname, line_num);
+	      cur_bench[n_cur_bench++] = tok[i];
+	    }
+	}
+      else if (!strcmp(tok[0], "param"))
+	parse_param(tok + 1, n_tok - 1);
+      else
+	fatal("%s:%d: bad directive `%s'", fname, line_num, tok[0]);
+    }
+  end_experiment();
+  fclose(fd);
+
+  if (n_stats == 0)
+    stats[n_stats++] = "sim_IPC";
+}
+
+/* start JOB in worker slot SLOT */
+static void
+start_job(struct exp_job_t *job, int slot, int f_pin)
+{
+  char tmp[1024];
+  int fd;
+
+  sprintf(tmp, "%s.tmp", job->log);
+
+  job->slot = slot;
+  job->tries++;
+  job->start = time((time_t *)NULL);
+  job->status = es_RUNNING;
+
+  job->pid = fork();
+  if (job->pid < 0)
+    fatal("could not fork simulator run");
+
+  if (job->pid == 0)
+    {
+#ifdef __linux__
+      if (f_pin)
+	{
+	  cpu_set_t mask;
+
+	  CPU_ZERO(&mask);
+	  CPU_SET(slot, &mask);
+	  sched_setaffinity(0, sizeof(mask), &mask);
+	}
+#endif /* __linux__ */
+
+      /* simulator and simulated program output both go to the log */
+      fd = open(tmp, O_WRONLY|O_CREAT|O_TRUNC, 0666);
+      if (fd < 0)
+	{
+	  fprintf(stderr, "sim-exp: could not create log `%s'\n", tmp);
+	  _exit(127);
+	}
+      dup2(fd, 1);
+      dup2(fd, 2);
+      close(fd);
+
+      execv(job->sim, job->argv);
+      fprintf(stderr, "sim-exp: could not execute `%s'\n", job->sim);
+      _exit(127);
+    }
+}
+
+/* write the stats of every finished job to <out_dir>/results.csv */
+static void
+write_results(void)
+{
+  FILE *fd, *log;
+  char buf[1024], line[1024], name[256], val[256], **vals;
+  int i, s;
+
+  sprintf(buf, "%s/results.csv", out_dir);
+  fd = fopen(buf, "w");
+  if (!fd)
+    fatal("could not create results table `%s'", buf);
+
+  fprintf(fd, "experiment,sim,bench,params,status");
+  for (s = 0; s < n_stats; s++)
+    fprintf(fd, ",%s", stats[s]);
+  fprintf(fd, "\n");
+
+  vals = (char **)mycalloc(n_stats, sizeof(char *));
+  for (i = 0; i < n_jobs; i++)
+    {
+      for (s = 0; s < n_stats; s++)
+	vals[s] = NULL;
+
+      if (jobs[i].status == es_DONE && (log = fopen(jobs[i].log, "r")) != NULL)
+	{
+	  while (fgets(line, sizeof(line), log))
+	    {
+	      if (sscanf(line, "%255s %255s", name, val) != 2)
+		continue;
+	      for (s = 0; s < n_stats; s++)
+		if (!strcmp(name, stats[s]))
+		  {
+		    if (vals[s])
+		      free(vals[s]);
+		    vals[s] = mystrdup(val);
+		  }
+	    }
+	  fclose(log);
+	}
+
+      fprintf(fd, "%s,%s,%s,\"%s\",%s", jobs[i].exp, jobs[i].sim,
+	      jobs[i].bench, jobs[i].params,
+	      jobs[i].status == es_DONE ? "ok" : "failed");
+      for (s = 0; s < n_stats; s++)
+	{
+	  fprintf(fd, ",%s", vals[s] ? vals[s] : "");
+	  if (vals[s])
+	    free(vals[s]);
+	}
+      fprintf(fd, "\n");
+    }
+  fclose(fd);
+
+  fprintf(stderr, "sim-exp: results in `%s'\n", buf);
+}
+
+int
+main(int argc, char **argv)
+{
+  struct exp_job_t **slots, *job;
+  char *spec, *p, tmp[1024];
+  int i, n_slots, n_cpus, f_pin = TRUE, max_tries = 1;
+  int next = 0, n_running = 0, n_done = 0, n_failed = 0, n_skipped = 0;
+  int status;
+  pid_t pid;
+  struct stat st;
+
+#ifdef _SC_NPROCESSORS_ONLN
+  n_cpus = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#else
+  n_cpus = 1;
+#endif
+  if (n_cpus < 1)
+    n_cpus = 1;
+  n_slots = n_cpus;
+
+  for (i = 1; i < argc && argv[i][0] == '-'; i++)
+    {
+      if (!strcmp(argv[i], "-j") && i + 1 < argc)
+	n_slots = atoi(argv[++i]);
+      else if (!strcmp(argv[i], "-nopin"))
+	f_pin = FALSE;
+      else if (!strcmp(argv[i], "-retry") && i + 1 < argc)
+	max_tries = 1 + atoi(argv[++i]);
+      else if (!strcmp(argv[i], "-o") && i + 1 < argc)
+	out_dir = argv[++i];
+      else
+	usage(argv[0]);
+    }
+  if (i != argc - 1 || n_slots < 1 || max_tries < 1)
+    usage(argv[0]);
+  spec = argv[i];
+
+  /* default output directory: <spec>-output */
+  if (!out_dir)
+    {
+      p = strrchr(spec, '/') ? strrchr(spec, '/') + 1 : spec;
+      out_dir = (char *)mycalloc(strlen(p) + 8, sizeof(char));
+      sprintf(out_dir, "%s-output", p);
+      if ((p = strstr(out_dir, ".spec-output")) != NULL)
+	strcpy(p, "-output");
+    }
+  make_dir(out_dir);
+
+  read_spec(spec);
+
+  /* resume: runs with a complete log are already done */
+  for (i = 0; i < n_jobs; i++)
+    if (stat(jobs[i].log, &st) == 0)
+      {
+	jobs[i].status = es_DONE;
+	n_skipped++;
+      }
+
+  fprintf(stderr, "sim-exp: %d runs, %d already done, %d workers%s\n",
+	  n_jobs, n_skipped, n_slots, f_pin && n_slots <= n_cpus ? " (pinned)" : "");
+  if (n_slots > n_cpus)
+    f_pin = FALSE;
+
+  slots = (struct exp_job_t **)mycalloc(n_slots, sizeof(struct exp_job_t *));
+  for (;;)
+    {
+      /* fill the idle worker slots */
+      for (i = 0; i < n_slots; i++)
+	{
+	  if (slots[i])
+	    continue;
+	  while (next < n_jobs && jobs[next].status != es_PENDING)
+	    next++;
+	  if (next == n_jobs)
+	    break;
+	  slots[i] = &jobs[next];
+	  start_job(&jobs[next], i, f_pin);
+	  n_running++;
+	}
+      if (n_running == 0)
+	break;
+
+      pid = wait(&status);
+      if (pid < 0)
+	fatal("lost track of the simulator runs");
+
+      for (i = 0; i < n_slots; i++)
+	if (slots[i] && slots[i]->pid == pid)
+	  break;
+      if (i == n_slots)
+	continue;
+
+      job = slots[i];
+      slots[i] = NULL;
+      n_running--;
+
+      sprintf(tmp, "%s.tmp", job->log);
+      if (WIFEXITED(status) && WEXITSTATUS(status) == 0)
+	{
+	  if (rename(tmp, job->log) < 0)
+	    fatal("could not rename `%s'", tmp);
+	  job->status = es_DONE;
+	  n_done++;
+	}
+      else if (job->tries < max_tries)
+	{
+	  /* requeue, NEXT may have moved past it */
+	  job->status = es_PENDING;
+	  if (job - jobs < next)
+	    next = job - jobs;
+	}
+      else
+	{
+	  job->status = es_FAILED;
+	  n_failed++;
+	}
+
+      fprintf(stderr, "[%d/%d] %s %s %s %s: %s (%lds)\n",
+	      n_done + n_failed, n_jobs - n_skipped, job->exp, job->sim,
+	      job->bench, job->params,
+	      job->status == es_DONE ? "ok"
+	      : (job->status == es_PENDING ? "retry" : "FAILED, see .tmp log"),
+	      (long)(time((time_t *)NULL) - job->start));
+    }
+
+  write_results();
+
+  fprintf(stderr, "sim-exp: %d done, %d failed, %d skipped\n",
+	  n_done, n_failed, n_skipped);
+
+  return n_failed ? 1 : 0;
+}
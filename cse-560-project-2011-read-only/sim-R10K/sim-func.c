@@ -106,6 +106,8 @@
 #include "stats.h"
 #include "sim.h"
 #include "predec.h"
+#include "simpoint.h"
+#include "btrace.h"
 
 #include "fastfwd.h"
 
@@ -139,13 +141,17 @@ sim_reg_options(struct opt_odb_t *odb)
 "for all instruction errors, and the implementation is crafted for clarity\n"
 "rather than speed.\n"
 		 );
+
+  simpoint_reg_profile_options(odb);
+  btrace_reg_options(odb);
 }
 
 /* check simulator-specific option values */
 void
 sim_check_options(void)
 {
-  /* nada */
+  simpoint_check_profile_options();
+  btrace_check_options();
 }
 
 /* register simulator-specific statistics */
@@ -184,15 +190,22 @@ sim_aux_config(FILE *stream)		/* output stream */
   /* nothing currently */
 }
 
+/* re-check timing options in a -sweep child */
+void
+sim_sweep_options(int argc, char **argv)	/* sweep configuration options */
+{
+  fatal("-sweep is not supported by this simulator");
+}
+
 /* dump simulator-specific auxiliary simulator statistics */
 void
 sim_aux_stats(FILE *stream)		/* output stream */
 {
   /* simulation time */
   print_counter(stream, "sim_elapsed_time", sim_elapsed_time, "simulation time in seconds");
-  print_rate(stream, "sim_insn_rate", (double)sim_num_insn/sim_elapsed_time, "simulation speed (insts/sec)");
 
   print_counter(stream, "sim_num_insn", sim_num_insn, "instructions simulated (fast-forwarding included)");
+  print_formula(stream, "sim_insn_rate", 1.0, "sim_num_insn", "sim_elapsed_time", "insn/s", "simulation speed (insts/sec)");
   print_counter(stream, "sim_sample_insn", sim_sample_insn, "instructions (in sample)");
   print_counter(stream, "sim_sample_int", sim_sample_insn_split[ic_icomp] + sim_sample_insn_split[ic_icomplong], "integer operations");
   print_counter(stream, "sim_sample_load", sim_sample_insn_split[ic_load], "loads");
@@ -207,11 +220,21 @@ sim_aux_stats(FILE *stream)		/* output stream */
   
 }
 
+/* fill in the running totals of the timing model */
+void
+sim_sample_totals(struct sim_sample_t *totals)
+{
+  totals->n_insn = sim_num_insn;
+  totals->n_cycle = 0;
+  totals->n_dl1_access = totals->n_dl1_miss = 0;
+}
+
 /* un-initialize simulator-specific state */
 void
 sim_uninit(void)
 {
-  /* nada */
+  simpoint_finish();
+  btrace_close();
 }
 
 
@@ -231,7 +254,7 @@ sim_uninit(void)
 /* program counter */
 #define CPC			(regs.PC)
 #define SET_NPC(EXPR)		(regs.NPC = (EXPR))
-#define SET_TPC(EXPR)
+#define SET_TPC(EXPR)		(regs.TPC = (EXPR))
 
 /* general purpose registers */
 #define READ_REG_Q(N)		(regs.regs[N].q)
@@ -302,6 +325,9 @@ sim_sample_on(unsigned long long n_insn)
 	  sim_num_insn++;
 	  sim_sample_insn++;
 	  sim_sample_insn_split[pdi->iclass]++;
+
+	  if (simpoint_profiling)
+	    simpoint_insn(pdi);
 	}
 
       fdumpinsn = fdump && sim_num_insn >= insn_dumpbegin && sim_num_insn < insn_dumpend; 
@@ -367,6 +393,9 @@ sim_sample_on(unsigned long long n_insn)
       if (fault != md_fault_none)
 	fatal("fault (%d) detected @ 0x%08p", fault, regs.PC);
 
+      if (btrace_enabled())
+	btrace_insn(pdi, regs.PC, regs.NPC, regs.TPC);
+
       if (verbose)
 	{
 	  myfprintf(stderr, "%10n [xor: 0x%08x] @ 0x%08p: ",
@@ -391,7 +420,7 @@ sim_sample_on(unsigned long long n_insn)
       /* dump progress stats */
       if (insn_progress > 0 && sim_sample_insn >= insn_progress)
 	{
-	  sim_print_stats(stderr);
+	  sim_print_progress(stderr);
 	  fflush(stderr);
 	  while (sim_sample_insn >= insn_progress)
 	    insn_progress += insn_progress_update;
@@ -404,6 +433,13 @@ sim_sample_on(unsigned long long n_insn)
 }
 
 
+/* record warmup instructions in the branch trace */
+static void
+btrace_warmup(const struct predec_insn_t *pdi)
+{
+  btrace_insn(pdi, regs.PC, regs.NPC, regs.TPC);
+}
+
 bool_t
 sim_sample_off(unsigned long long n_insn)
 {
@@ -417,7 +453,7 @@ sim_sample_warmup(unsigned long long n_insn)
 {
   sample_mode = sample_WARM;
   fprintf(stderr, "** sim -- fast-forwarding %u instructions **\n", n_insn);
-  return sim_fastfwd(&regs, mem, n_insn, NULL);
+  return sim_fastfwd(&regs, mem, n_insn, btrace_enabled() ? btrace_warmup : NULL);
 }
 
 /* start simulation, program loaded, processor precise state initialized */
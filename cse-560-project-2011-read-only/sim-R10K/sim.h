@@ -114,6 +114,7 @@ extern struct stat_sdb_t *sim_sdb;
 extern char *sim_eio_fname;
 extern char *sim_chkpt_fname;
 extern FILE *sim_eio_fd;
+extern int sim_eio_prefetch;
 
 /* redirected program/simulator output file names */
 extern FILE *sim_progfd;
@@ -151,6 +152,24 @@ void sim_reg_options(struct opt_odb_t *odb);
 /* check simulator-specific option values */
 void sim_check_options(void);
 
+/* running totals of the timing model, sampled by the sampling
+   controller in main() around every measured sample */
+struct sim_sample_t
+{
+  counter_t n_insn;		/* committed instructions */
+  counter_t n_cycle;		/* cycles, 0 if the simulator has no timing */
+  counter_t n_dl1_access;	/* L1 D-cache accesses */
+  counter_t n_dl1_miss;		/* L1 D-cache misses */
+};
+
+/* fill in the running totals of the timing model */
+void sim_sample_totals(struct sim_sample_t *totals);
+
+/* re-check timing option values in a -sweep child after it applied the
+   configuration options ARGV, caches, TLBs and predictors keep their
+   warm state so options that would rebuild them are rejected */
+void sim_sweep_options(int argc, char **argv);
+
 /* initialize the simulator */
 void sim_init(void);
 
@@ -173,6 +192,9 @@ void sim_uninit(void);
 /* print all simulator stats */
 void sim_print_stats(FILE *fd);		/* output stream */
 
+/* print the -insn:progress stats */
+void sim_print_progress(FILE *fd);		/* output stream */
+
 void sim_start(void);
 bool_t sim_sample_off(unsigned long long n_insn);
 bool_t sim_sample_warmup(unsigned long long n_insn);
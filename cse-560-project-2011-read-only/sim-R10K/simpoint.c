@@ -0,0 +1,519 @@
+/* simpoint.c - basic block vector profiling and region-driven simulation */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "host.h"
+#include "misc.h"
+#include "machine.h"
+#include "options.h"
+#include "stats.h"
+#include "predec.h"
+#include "sim.h"
+#include "simpoint.h"
+
+/* options */
+static char *simpoint_bbv_fname;
+static int simpoint_maxk;
+static int simpoint_dim;
+static char *simpoint_regions_fname;
+static unsigned long long simpoint_interval;
+static unsigned long long simpoint_warm;
+
+bool_t simpoint_profiling = FALSE;
+bool_t simpoint_driven = FALSE;
+
+/*
+ * BBV profiling
+ */
+
+/* basic block, identified by its leading PC */
+struct simpoint_bb_t
+{
+  struct simpoint_bb_t *next;		/* hash chain */
+  struct simpoint_bb_t *tnext;		/* touched in this interval */
+  md_addr_t PC;
+  int id;
+  counter_t count;			/* instructions in this interval */
+};
+
+#define SIMPOINT_HASH_SIZE		65536
+#define SIMPOINT_HASH(PC)		MOD((PC) >> 2, SIMPOINT_HASH_SIZE)
+
+static struct simpoint_bb_t *bb_hash[SIMPOINT_HASH_SIZE];
+static struct simpoint_bb_t *bb_touched = NULL;
+static struct simpoint_bb_t *bb_cur = NULL;
+static counter_t bb_len = 0;
+static int bb_num = 0;
+
+static FILE *bbv_fd = NULL;
+static counter_t interval_len = 0;
+
+/* randomly projected, normalized BBV of every complete interval */
+static double *proj = NULL;
+static int proj_num = 0, proj_size = 0;
+static double *proj_cur = NULL;
+
+void
+simpoint_reg_profile_options(struct opt_odb_t *odb)
+{
+  opt_reg_string(odb, "-simpoint:bbv",
+		 "write per-interval basic block vectors to <fname>, simulation points go to <fname>.simpoints {<fname>|none}",
+		 &simpoint_bbv_fname, /* default */"none", /* print */TRUE, /* format */NULL);
+  opt_reg_int(odb, "-simpoint:maxk",
+	      "maximum number of clusters (simulation points)",
+	      &simpoint_maxk, /* default */10, /* print */TRUE, /* format */NULL);
+  opt_reg_int(odb, "-simpoint:dim",
+	      "dimensions of the randomly projected BBVs",
+	      &simpoint_dim, /* default */15, /* print */TRUE, /* format */NULL);
+}
+
+void
+simpoint_check_profile_options(void)
+{
+  if (!mystricmp(simpoint_bbv_fname, "none"))
+    return;
+
+  if (simpoint_maxk < 1)
+    fatal("need at least 1 simulation point");
+  if (simpoint_dim < 1)
+    fatal("BBV projection needs at least 1 dimension");
+  if (simpoint_interval < 1)
+    fatal("simulation point interval must be positive");
+
+  bbv_fd = fopen(simpoint_bbv_fname, "w");
+  if (!bbv_fd)
+    fatal("could not open BBV file `%s'", simpoint_bbv_fname);
+
+  proj_cur = (double *)mycalloc(simpoint_dim, sizeof(double));
+  simpoint_profiling = TRUE;
+}
+
+/* random projection matrix element for block ID, dimension D, in [-1,1],
+   computed from a hash so the matrix need not be stored */
+static double
+simpoint_rp(int id, int d)
+{
+  unsigned int h = (unsigned int)id * 2654435761u ^ (unsigned int)(d + 1) * 40503u;
+
+  h ^= h >> 15;
+  h *= 2246822519u;
+  h ^= h >> 13;
+
+  return (double)(h & 0xffff) / 32767.5 - 1.0;
+}
+
+static struct simpoint_bb_t *
+simpoint_bb_lookup(md_addr_t PC)
+{
+  struct simpoint_bb_t *bb;
+  int index = SIMPOINT_HASH(PC);
+
+  for (bb = bb_hash[index]; bb; bb = bb->next)
+    if (bb->PC == PC)
+      return bb;
+
+  bb = (struct simpoint_bb_t *)mycalloc(1, sizeof(struct simpoint_bb_t));
+  bb->PC = PC;
+  bb->id = ++bb_num;
+  bb->next = bb_hash[index];
+  bb_hash[index] = bb;
+
+  return bb;
+}
+
+/* add LEN instructions to block BB */
+static void
+simpoint_bb_count(struct simpoint_bb_t *bb, counter_t len)
+{
+  if (len == 0)
+    return;
+
+  if (bb->count == 0)
+    {
+      bb->tnext = bb_touched;
+      bb_touched = bb;
+    }
+  bb->count += len;
+}
+
+/* write the BBV of the current interval and project it */
+static void
+simpoint_interval_end(bool_t f_complete)
+{
+  struct simpoint_bb_t *bb;
+  int d;
+
+  /* split the open block at the interval boundary */
+  if (bb_cur)
+    {
+      simpoint_bb_count(bb_cur, bb_len);
+      bb_len = 0;
+    }
+
+  if (!bb_touched)
+    return;
+
+  fprintf(bbv_fd, "T");
+  for (d = 0; d < simpoint_dim; d++)
+    proj_cur[d] = 0.0;
+
+  for (bb = bb_touched; bb; bb = bb->tnext)
+    {
+      fprintf(bbv_fd, ":%d:%lld ", bb->id, (long long)bb->count);
+      for (d = 0; d < simpoint_dim; d++)
+	proj_cur[d] += ((double)bb->count / interval_len) * simpoint_rp(bb->id, d);
+      bb->count = 0;
+    }
+  fprintf(bbv_fd, "\n");
+  bb_touched = NULL;
+
+  /* partial (last) intervals are not candidates */
+  if (f_complete)
+    {
+      if (proj_num == proj_size)
+	{
+	  proj_size = proj_size ? 2 * proj_size : 1024;
+	  proj = (double *)realloc(proj, proj_size * simpoint_dim * sizeof(double));
+	  if (!proj)
+	    fatal("out of virtual memory");
+	}
+      memcpy(&proj[proj_num * simpoint_dim], proj_cur, simpoint_dim * sizeof(double));
+      proj_num++;
+    }
+
+  interval_len = 0;
+}
+
+/* count one executed instruction in the current interval's BBV */
+void
+simpoint_insn(const struct predec_insn_t *pdi)
+{
+  if (!bb_cur)
+    bb_cur = simpoint_bb_lookup(pdi->poi.PC);
+
+  bb_len++;
+  interval_len++;
+
+  /* control instructions end the block */
+  if (pdi->iclass == ic_ctrl)
+    {
+      simpoint_bb_count(bb_cur, bb_len);
+      bb_cur = NULL;
+      bb_len = 0;
+    }
+
+  if (interval_len == (counter_t)simpoint_interval)
+    simpoint_interval_end(TRUE);
+}
+
+/* squared distance between two projected BBVs */
+static double
+simpoint_dist(const double *a, const double *b)
+{
+  double dist = 0.0;
+  int d;
+
+  for (d = 0; d < simpoint_dim; d++)
+    dist += (a[d] - b[d]) * (a[d] - b[d]);
+
+  return dist;
+}
+
+/* k-means over the projected BBVs, fills ASSIGN and CENTERS, returns the
+   BIC score of the clustering */
+static double
+simpoint_kmeans(int k, int *assign, double *centers, int *size)
+{
+  int i, c, d, iter, best;
+  bool_t f_changed;
+  double dist, best_dist, sse, var, loglike;
+  int R = proj_num, M = simpoint_dim;
+
+  /* initial centers: one random interval from each of K equal slices of
+     the run, so the centers are distinct and spread over the phases */
+  for (c = 0; c < k; c++)
+    {
+      i = (c * R) / k + myrand() % MAX(R / k, 1);
+      memcpy(&centers[c * M], &proj[i * M], M * sizeof(double));
+    }
+  for (i = 0; i < R; i++)
+    assign[i] = -1;
+
+  for (iter = 0; iter < 100; iter++)
+    {
+      /* assign every interval to its closest center */
+      f_changed = FALSE;
+      for (i = 0; i < R; i++)
+	{
+	  best = 0;
+	  best_dist = simpoint_dist(&proj[i * M], &centers[0]);
+	  for (c = 1; c < k; c++)
+	    {
+	      dist = simpoint_dist(&proj[i * M], &centers[c * M]);
+	      if (dist < best_dist)
+		{
+		  best = c;
+		  best_dist = dist;
+		}
+	    }
+	  if (assign[i] != best)
+	    {
+	      assign[i] = best;
+	      f_changed = TRUE;
+	    }
+	}
+      if (!f_changed)
+	break;
+
+      /* move the centers */
+      for (c = 0; c < k; c++)
+	{
+	  size[c] = 0;
+	  for (d = 0; d < M; d++)
+	    centers[c * M + d] = 0.0;
+	}
+      for (i = 0; i < R; i++)
+	{
+	  size[assign[i]]++;
+	  for (d = 0; d < M; d++)
+	    centers[assign[i] * M + d] += proj[i * M + d];
+	}
+      for (c = 0; c < k; c++)
+	for (d = 0; d < M; d++)
+	  if (size[c] > 0)
+	    centers[c * M + d] /= size[c];
+    }
+
+  for (c = 0; c < k; c++)
+    size[c] = 0;
+  for (sse = 0.0, i = 0; i < R; i++)
+    {
+      size[assign[i]]++;
+      sse += simpoint_dist(&proj[i * M], &centers[assign[i] * M]);
+    }
+
+  /* BIC of a spherical Gaussian mixture (Pelleg and Moore, X-means) */
+  if (R <= k)
+    return -HUGE_VAL;
+  var = MAX(sse / (R - k), 1e-12);
+  for (loglike = 0.0, c = 0; c < k; c++)
+    {
+      if (size[c] == 0)
+	continue;
+      loglike += (-size[c] / 2.0 * log(2.0 * M_PI)
+		  - size[c] * M / 2.0 * log(var)
+		  - (size[c] - k) / 2.0
+		  + size[c] * log((double)size[c])
+		  - size[c] * log((double)R));
+    }
+
+  return loglike - ((k - 1) + M * k + 1) / 2.0 * log((double)R);
+}
+
+/* cluster the collected BBVs and write the chosen simulation points */
+void
+simpoint_finish(void)
+{
+  int i, k, c, best_k, maxk, *assign, *size, *point;
+  double *centers, *bic, bic_min, bic_max, dist, *best_dist;
+  char *fname;
+  FILE *fd;
+  int M = simpoint_dim;
+
+  if (!simpoint_profiling)
+    return;
+  simpoint_profiling = FALSE;
+
+  simpoint_interval_end(FALSE);
+  fclose(bbv_fd);
+
+  if (proj_num == 0)
+    {
+      warn("no complete %llu instruction interval, no simulation points",
+	   simpoint_interval);
+      return;
+    }
+
+  maxk = MIN(simpoint_maxk, proj_num);
+  assign = (int *)mycalloc(proj_num, sizeof(int));
+  size = (int *)mycalloc(maxk, sizeof(int));
+  point = (int *)mycalloc(maxk, sizeof(int));
+  best_dist = (double *)mycalloc(maxk, sizeof(double));
+  centers = (double *)mycalloc(maxk * M, sizeof(double));
+  bic = (double *)mycalloc(maxk + 1, sizeof(double));
+
+  /* score every K, pick the smallest one within 90% of the best BIC */
+  bic_min = HUGE_VAL;
+  bic_max = -HUGE_VAL;
+  for (k = 1; k <= maxk; k++)
+    {
+      bic[k] = simpoint_kmeans(k, assign, centers, size);
+      if (bic[k] == -HUGE_VAL)
+	continue;
+      bic_min = MIN(bic_min, bic[k]);
+      bic_max = MAX(bic_max, bic[k]);
+    }
+  for (best_k = 1; best_k < maxk; best_k++)
+    if (bic[best_k] != -HUGE_VAL
+	&& bic[best_k] >= bic_min + 0.9 * (bic_max - bic_min))
+      break;
+
+  /* re-cluster with the chosen K, the interval closest to each center
+     represents its cluster */
+  simpoint_kmeans(best_k, assign, centers, size);
+  for (c = 0; c < best_k; c++)
+    point[c] = -1;
+  for (i = 0; i < proj_num; i++)
+    {
+      c = assign[i];
+      dist = simpoint_dist(&proj[i * M], &centers[c * M]);
+      if (point[c] == -1 || dist < best_dist[c])
+	{
+	  point[c] = i;
+	  best_dist[c] = dist;
+	}
+    }
+
+  fname = (char *)mycalloc(strlen(simpoint_bbv_fname) + 16, sizeof(char));
+  sprintf(fname, "%s.simpoints", simpoint_bbv_fname);
+  fd = fopen(fname, "w");
+  if (!fd)
+    fatal("could not open simulation points file `%s'", fname);
+
+  /* ascending interval order, as the region driver expects */
+  for (i = 0; i < proj_num; i++)
+    for (c = 0; c < best_k; c++)
+      if (point[c] == i && size[c] > 0)
+	fprintf(fd, "%d %.6f\n", i, (double)size[c] / proj_num);
+  fclose(fd);
+
+  fprintf(stderr, "sim: %d intervals of %llu insts, %d simulation points -> %s\n",
+	  proj_num, simpoint_interval, best_k, fname);
+}
+
+/*
+ * region-driven simulation
+ */
+
+/* simulation region: interval index and weight */
+struct simpoint_region_t
+{
+  counter_t interval;
+  double weight;
+};
+
+/* weighted totals of the simulated regions */
+static int region_num = 0;
+static double region_weight = 0.0;
+static double region_cpi = 0.0;
+static double region_miss_rate = 0.0;
+
+void
+simpoint_reg_options(struct opt_odb_t *odb)
+{
+  opt_reg_ulonglong(odb, "-simpoint:interval",
+		    "simulation point interval length (insts)",
+		    &simpoint_interval, /* default */10*1000*1000,
+		    /* print */TRUE, /* format */NULL);
+  opt_reg_string(odb, "-simpoint:regions",
+		 "simulate the regions of a simulation points file {<fname>|none}",
+		 &simpoint_regions_fname, /* default */"none",
+		 /* print */TRUE, /* format */NULL);
+  opt_reg_ulonglong(odb, "-simpoint:warm",
+		    "warmup before each simulated region (insts)",
+		    &simpoint_warm, /* default */1000*1000,
+		    /* print */TRUE, /* format */NULL);
+}
+
+void
+simpoint_check_options(void)
+{
+  if (!mystricmp(simpoint_regions_fname, "none"))
+    return;
+
+  if (simpoint_interval < 1)
+    fatal("simulation point interval must be positive");
+
+  simpoint_driven = TRUE;
+}
+
+/* simulate each region of the simulation points file, replaces the
+   sampling loop of sim_main() */
+void
+simpoint_run(void)
+{
+  FILE *fd;
+  struct simpoint_region_t region;
+  struct sim_sample_t before, after;
+  long long interval;
+  counter_t start, warm_start, n_insn, n_cycle, n_access;
+  bool_t f_more;
+
+  fd = fopen(simpoint_regions_fname, "r");
+  if (!fd)
+    fatal("could not open simulation points file `%s'", simpoint_regions_fname);
+
+  while (fscanf(fd, "%lld %lf", &interval, &region.weight) == 2)
+    {
+      region.interval = (counter_t)interval;
+      start = region.interval * (counter_t)simpoint_interval;
+      warm_start = MAX(start - (counter_t)simpoint_warm, 0);
+
+      if (start < sim_num_insn)
+	fatal("simulation points must be in ascending, non-overlapping order");
+
+      fprintf(stderr, "sim: region %d, interval %lld, weight %.4f\n",
+	      region_num, interval, region.weight);
+
+      if (warm_start > sim_num_insn
+	  && !sim_sample_off(warm_start - sim_num_insn))
+	break;
+      if (start > sim_num_insn
+	  && !sim_sample_warmup(start - sim_num_insn))
+	break;
+
+      sim_sample_totals(&before);
+      f_more = sim_sample_on(simpoint_interval);
+      sim_sample_totals(&after);
+
+      n_insn = after.n_insn - before.n_insn;
+      n_cycle = after.n_cycle - before.n_cycle;
+      n_access = after.n_dl1_access - before.n_dl1_access;
+      if (n_insn > 0 && n_cycle > 0)
+	{
+	  region_num++;
+	  region_weight += region.weight;
+	  region_cpi += region.weight * (double)n_cycle / n_insn;
+	  if (n_access > 0)
+	    region_miss_rate += region.weight
+	      * (double)(after.n_dl1_miss - before.n_dl1_miss) / n_access;
+	}
+
+      if (!f_more)
+	break;
+    }
+  fclose(fd);
+}
+
+/* print the weighted region-driven simulation stats */
+void
+simpoint_stats(FILE *stream)
+{
+  double cpi;
+
+  if (!simpoint_driven || region_weight <= 0.0)
+    return;
+
+  /* renormalize in case some regions were not reached */
+  cpi = region_cpi / region_weight;
+
+  print_counter(stream, "simpoint_num", region_num, "simulated regions");
+  print_rate(stream, "simpoint_weight", region_weight, "total weight of the simulated regions");
+  print_rate(stream, "simpoint_CPI", cpi, "weighted CPI of the simulated regions");
+  print_rate(stream, "simpoint_IPC", 1.0 / cpi, "IPC from the weighted CPI");
+  print_rate(stream, "simpoint_dl1_miss_rate", region_miss_rate / region_weight, "weighted L1 D-cache miss rate");
+}
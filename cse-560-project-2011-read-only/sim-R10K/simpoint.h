@@ -0,0 +1,35 @@
+#ifndef SIMPOINT_H
+#define SIMPOINT_H
+
+/* SimPoint support: basic block vector (BBV) profiling with k-means/BIC
+   selection of representative intervals (sim-func), and region-driven
+   simulation of the selected intervals (all simulators) */
+
+/* profiling, collecting BBVs? */
+extern bool_t simpoint_profiling;
+
+/* region-driven simulation? */
+extern bool_t simpoint_driven;
+
+/* register/check the BBV profiling options (sim-func only) */
+void simpoint_reg_profile_options(struct opt_odb_t *odb);
+void simpoint_check_profile_options(void);
+
+/* count one executed instruction in the current interval's BBV */
+void simpoint_insn(const struct predec_insn_t *pdi);
+
+/* cluster the collected BBVs and write the chosen simulation points */
+void simpoint_finish(void);
+
+/* register/check the region-driven simulation options */
+void simpoint_reg_options(struct opt_odb_t *odb);
+void simpoint_check_options(void);
+
+/* simulate each region of the simulation points file, replaces the
+   sampling loop of sim_main() */
+void simpoint_run(void);
+
+/* print the weighted region-driven simulation stats */
+void simpoint_stats(FILE *stream);
+
+#endif /* SIMPOINT_H */
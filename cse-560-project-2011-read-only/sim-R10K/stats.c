@@ -1,19 +1,306 @@
 /* external definitions */
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
 
 #include "host.h"
 #include "machine.h"
 #include "misc.h"
+#include "options.h"
 /* interface definitions */
 #include "stats.h"
 
+/* stats output options */
+static int stats_format = sf_TEXT;
+static char *stats_fname = NULL;
+static int stats_delta = FALSE;
+
+static char *stats_format_str[sf_NUM] = { "text", "json", "csv" };
+
+/* structured output stream, NULL: the dump's stream */
+static FILE *stats_fd = NULL;
+
+/* stat kinds */
+enum stat_kind_t { sk_COUNTER, sk_INT, sk_RATE, sk_FORMULA, sk_ADDR, sk_DIST };
+
+/* registered stat */
+struct stat_ent_t
+{
+  struct stat_ent_t *next;		/* hash chain */
+  char *name;
+  enum stat_kind_t kind;
+  char *desc;
+  int n;				/* number of values */
+  counter_t *last;			/* values at the last progress dump */
+
+  char *unit;				/* unit of a formula, or NULL */
+  char *formula;			/* "[scale *] num / den", or NULL */
+
+  counter_t val;			/* counter value in dump DUMP */
+  int dump;
+
+  bool_t f_described;			/* unit and formula emitted? */
+  struct stat_ent_t *dnext;		/* to describe at the dump's end */
+};
+
+#define STATS_HASH_SIZE			1024
+
+static struct stat_ent_t *stats_hash[STATS_HASH_SIZE];
+
+/* current dump */
+static bool_t dump_active = FALSE;
+static bool_t dump_delta = FALSE;
+static int dump_num = 0;
+static bool_t dump_first = TRUE;
+static bool_t csv_header = FALSE;
+
+/* stats of the current dump whose unit and formula go out with it */
+static struct stat_ent_t *dump_describe = NULL;
+
+void
+stats_reg_options(struct opt_odb_t *odb)
+{
+  opt_reg_enum(odb, "-stats:format", "stats output format {text|json|csv}",
+	       &stats_format, /* default */"text",
+	       stats_format_str, /* eval */NULL, sf_NUM,
+	       /* print */TRUE, /* format */NULL);
+  opt_reg_string(odb, "-stats:file",
+		 "json/csv stats output file {<fname>|none}",
+		 &stats_fname, /* default */"none", /* print */TRUE, /* format */NULL);
+  opt_reg_flag(odb, "-stats:delta",
+	       "report counters in -insn:progress dumps as intervals",
+	       &stats_delta, /* default */FALSE, /* print */TRUE, /* format */NULL);
+}
+
+void
+stats_check_options(void)
+{
+  if (!mystricmp(stats_fname, "none"))
+    return;
+
+  if (stats_format == sf_TEXT)
+    fatal("-stats:file needs -stats:format json or csv");
+
+  stats_fd = fopen(stats_fname, "w");
+  if (!stats_fd)
+    fatal("could not open stats file `%s'", stats_fname);
+}
+
+static unsigned int
+stats_hash_name(const char *name)
+{
+  unsigned int h = 0;
+
+  while (*name)
+    h = h * 31 + (unsigned char)*name++;
+  return h & (STATS_HASH_SIZE - 1);
+}
+
+/* find stat NAME, NULL if it was never printed */
+static struct stat_ent_t *
+stats_find(const char *name)
+{
+  struct stat_ent_t *ent;
+
+  for (ent = stats_hash[stats_hash_name(name)]; ent; ent = ent->next)
+    if (!strcmp(ent->name, name))
+      return ent;
+  return NULL;
+}
+
+/* find stat NAME, registering it the first time it is printed */
+static struct stat_ent_t *
+stats_lookup(const char *name, enum stat_kind_t kind, const char *desc, int n)
+{
+  struct stat_ent_t *ent;
+  unsigned int index = stats_hash_name(name);
+
+  for (ent = stats_hash[index]; ent; ent = ent->next)
+    if (!strcmp(ent->name, name))
+      {
+	/* a name reused for a differently shaped stat starts over */
+	if (ent->kind != kind || ent->n != n)
+	  {
+	    free(ent->last);
+	    ent->kind = kind;
+	    ent->n = n;
+	    ent->last = (counter_t *)mycalloc(n, sizeof(counter_t));
+	  }
+	return ent;
+      }
+
+  ent = (struct stat_ent_t *)mycalloc(1, sizeof(struct stat_ent_t));
+  ent->name = mystrdup(name);
+  ent->kind = kind;
+  ent->desc = mystrdup(desc);
+  ent->n = n;
+  ent->last = (counter_t *)mycalloc(n, sizeof(counter_t));
+  ent->next = stats_hash[index];
+  stats_hash[index] = ent;
+
+  return ent;
+}
+
+/* value of counter element I of ENT in the current dump */
+static counter_t
+stats_value(struct stat_ent_t *ent, int i, counter_t val)
+{
+  counter_t prev;
+
+  if (!dump_delta)
+    return val;
+
+  prev = ent->last[i];
+  ent->last[i] = val;
+  return val - prev;
+}
+
+/* structured output stream of the current dump */
+static FILE *
+stats_out(FILE *stream)
+{
+  return stats_fd ? stats_fd : stream;
+}
+
+/* emit one structured value VAL of stat NAME, in UNIT if not NULL */
+static void
+stats_emit(FILE *stream, const char *name, const char *val,
+	   const char *unit, const char *desc)
+{
+  FILE *out = stats_out(stream);
+  const char *p;
+
+  if (stats_format == sf_JSON)
+    {
+      fprintf(out, "%s\"%s\":%s", dump_first ? "" : ",", name, val);
+    }
+  else
+    {
+      fprintf(out, "%d,%s,%s,%s,%s,\"", dump_num,
+	      dump_delta ? "delta" : "total", name, val, unit ? unit : "");
+      for (p = desc; *p; p++)
+	{
+	  if (*p == '"')
+	    fputc('"', out);
+	  fputc(*p, out);
+	}
+      fprintf(out, "\"\n");
+    }
+  dump_first = FALSE;
+}
+
+/* structured stats wanted? */
+#define STATS_STRUCTURED	(dump_active && stats_format != sf_TEXT)
+
+void
+stats_dump_begin(FILE *stream, const char *title, bool_t f_progress)
+{
+  FILE *out = stats_out(stream);
+  time_t now;
+  char *s;
+
+  now = time((time_t *)NULL);
+  s = ctime(&now);
+  if (s[strlen(s)-1] == '\n')
+    s[strlen(s)-1] = '\0';
+
+  dump_active = TRUE;
+  dump_delta = f_progress && stats_delta;
+  dump_first = TRUE;
+  dump_describe = NULL;
+
+  switch (stats_format)
+    {
+    case sf_TEXT:
+      fprintf(stream, "\nsim: ** %s @ %s **\n", title, s);
+      break;
+
+    case sf_JSON:
+      /* JSON Lines, one object per dump */
+      fprintf(out, "{\"dump\":%d,\"title\":\"%s\",\"time\":\"%s\","
+	      "\"delta\":%s,\"stats\":{",
+	      dump_num, title, s, dump_delta ? "true" : "false");
+      break;
+
+    case sf_CSV:
+      if (!csv_header)
+	{
+	  fprintf(out, "dump,type,name,value,unit,description\n");
+	  csv_header = TRUE;
+	}
+      break;
+
+    default:
+      panic("bogus stats format");
+    }
+}
+
+/* emit the units and formulas of the stats first seen in this dump */
+static void
+stats_describe(FILE *out)
+{
+  struct stat_ent_t *ent;
+  bool_t first;
+
+  fprintf(out, ",\"units\":{");
+  for (first = TRUE, ent = dump_describe; ent; ent = ent->dnext)
+    if (ent->unit)
+      {
+	fprintf(out, "%s\"%s\":\"%s\"", first ? "" : ",", ent->name, ent->unit);
+	first = FALSE;
+      }
+  fprintf(out, "},\"formulas\":{");
+  for (first = TRUE, ent = dump_describe; ent; ent = ent->dnext)
+    if (ent->formula)
+      {
+	fprintf(out, "%s\"%s\":\"%s\"", first ? "" : ",", ent->name, ent->formula);
+	first = FALSE;
+      }
+  fprintf(out, "}");
+}
+
+void
+stats_dump_end(FILE *stream)
+{
+  FILE *out = stats_out(stream);
+
+  if (stats_format == sf_TEXT)
+    fprintf(stream, "\n");
+  else if (stats_format == sf_JSON)
+    {
+      fprintf(out, "}");
+      if (dump_describe)
+	stats_describe(out);
+      fprintf(out, "}\n");
+    }
+  fflush(out);
+
+  dump_active = FALSE;
+  dump_delta = FALSE;
+  dump_num++;
+}
+
 void 
 print_counter(FILE *stream, 
 	      const char *name, 
 	      counter_t counter, 
 	      const char *desc)
 {
+  struct stat_ent_t *ent = stats_lookup(name, sk_COUNTER, desc, 1);
+  char buf[64];
+
+  counter = stats_value(ent, 0, counter);
+  ent->val = counter;
+  ent->dump = dump_num;
+  if (STATS_STRUCTURED)
+    {
+      sprintf(buf, "%lld", (long long)counter);
+      stats_emit(stream, name, buf, NULL, desc);
+      return;
+    }
+
   fprintf(stream, "%-30s", name);
   myfprintf(stream, "%12lu", counter);
   fprintf(stream, " # %s\n", desc);
@@ -25,6 +312,16 @@ print_int(FILE *stream,
 	  int i, 
 	  const char *desc)
 {
+  char buf[64];
+
+  stats_lookup(name, sk_INT, desc, 1);
+  if (STATS_STRUCTURED)
+    {
+      sprintf(buf, "%d", i);
+      stats_emit(stream, name, buf, NULL, desc);
+      return;
+    }
+
   fprintf(stream, "%-30s%10d # %s\n", name, i, desc);
 }
 
@@ -34,6 +331,68 @@ print_rate(FILE *stream,
 	   double rate,
 	   const char *desc)
 {
+  char buf[64];
+
+  stats_lookup(name, sk_RATE, desc, 1);
+  if (STATS_STRUCTURED)
+    {
+      /* 0/0 rates have no JSON/CSV representation */
+      if (isnan(rate) || isinf(rate))
+	strcpy(buf, stats_format == sf_JSON ? "null" : "");
+      else
+	sprintf(buf, "%.6g", rate);
+      stats_emit(stream, name, buf, NULL, desc);
+      return;
+    }
+
+  fprintf(stream, "%-30s%10.4f # %s\n", name, rate, desc);
+}
+
+void
+print_formula(FILE *stream,
+	      const char *name,
+	      double scale,
+	      const char *num,
+	      const char *den,
+	      const char *unit,
+	      const char *desc)
+{
+  struct stat_ent_t *ent = stats_lookup(name, sk_FORMULA, desc, 1);
+  struct stat_ent_t *num_ent = stats_find(num), *den_ent = stats_find(den);
+  double rate;
+  char buf[256];
+
+  if (!num_ent || num_ent->kind != sk_COUNTER || num_ent->dump != dump_num
+      || !den_ent || den_ent->kind != sk_COUNTER || den_ent->dump != dump_num)
+    panic("formula `%s' needs counters `%s' and `%s' printed before it",
+	  name, num, den);
+
+  if (!ent->formula)
+    {
+      if (scale != 1.0)
+	sprintf(buf, "%g * %s / %s", scale, num, den);
+      else
+	sprintf(buf, "%s / %s", num, den);
+      ent->formula = mystrdup(buf);
+      ent->unit = mystrdup(unit);
+    }
+
+  /* the components already are interval values in delta dumps */
+  rate = den_ent->val ? scale * (double)num_ent->val / den_ent->val : 0.0;
+
+  if (STATS_STRUCTURED)
+    {
+      if (!ent->f_described)
+	{
+	  ent->f_described = TRUE;
+	  ent->dnext = dump_describe;
+	  dump_describe = ent;
+	}
+      sprintf(buf, "%.6g", rate);
+      stats_emit(stream, name, buf, ent->unit, desc);
+      return;
+    }
+
   fprintf(stream, "%-30s%10.4f # %s\n", name, rate, desc);
 }
 
@@ -43,8 +402,81 @@ print_addr(FILE *stream,
 	   md_addr_t addr,
 	   const char *desc)
 {
+  char buf[64];
+
+  stats_lookup(name, sk_ADDR, desc, 1);
+  if (STATS_STRUCTURED)
+    {
+      sprintf(buf, "%llu", (unsigned long long)addr);
+      stats_emit(stream, name, buf, NULL, desc);
+      return;
+    }
+
   fprintf(stream, "%-30s", name);
   myfprintf(stream, "%10p", addr);
   fprintf(stream, " # %s\n", desc);
 }
 
+void
+print_dist(FILE *stream,
+	   const char *name,
+	   const counter_t *dist,
+	   int n,
+	   const char *desc)
+{
+  struct stat_ent_t *ent = stats_lookup(name, sk_DIST, desc, n);
+  counter_t *val, sum;
+  char *buf, *p;
+  int i;
+
+  val = (counter_t *)mycalloc(n, sizeof(counter_t));
+  for (sum = 0, i = 0; i < n; i++)
+    {
+      val[i] = stats_value(ent, i, dist[i]);
+      sum += val[i];
+    }
+
+  if (STATS_STRUCTURED && stats_format == sf_JSON)
+    {
+      buf = (char *)mycalloc(n * 24 + 4, sizeof(char));
+      p = buf;
+      *p++ = '[';
+      for (i = 0; i < n; i++)
+	p += sprintf(p, "%s%lld", i ? ", " : "", (long long)val[i]);
+      strcpy(p, "]");
+      stats_emit(stream, name, buf, NULL, desc);
+      free(buf);
+    }
+  else if (STATS_STRUCTURED)
+    {
+      buf = (char *)mycalloc(strlen(name) + 16, sizeof(char));
+      for (i = 0; i < n; i++)
+	{
+	  char vbuf[32];
+
+	  sprintf(buf, "%s[%d]", name, i);
+	  sprintf(vbuf, "%lld", (long long)val[i]);
+	  stats_emit(stream, buf, vbuf, NULL, desc);
+	}
+      free(buf);
+    }
+  else
+    {
+      fprintf(stream, "%-30s%12s # %s\n", name, "", desc);
+      for (i = 0; i < n; i++)
+	{
+	  fprintf(stream, "  %-28d", i);
+	  myfprintf(stream, "%12lu", val[i]);
+	  fprintf(stream, " %6.2f%%\n", sum ? 100.0 * val[i] / sum : 0.0);
+	}
+    }
+
+  free(val);
+}
+
+void
+print_separator(FILE *stream)
+{
+  if (!STATS_STRUCTURED)
+    fprintf(stream, "----------------\n");
+}
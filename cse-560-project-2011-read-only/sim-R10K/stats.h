@@ -1,6 +1,31 @@
 #ifndef _STATS_H
 #define _STATS_H
 
+/* stats output: every print_*() call below registers its stat by name the
+   first time it is seen, and emits it in the selected -stats:format.  text
+   is the traditional "name value # description" form; json and csv are
+   meant for post-processing, and go to -stats:file when one is given.
+   json is JSON Lines, one object per dump, whose "units" and "formulas"
+   describe the formula stats first seen in that dump; csv has one
+   "dump,type,name,value,unit,description" row per value */
+
+struct opt_odb_t;
+
+/* stats output formats */
+enum stats_format_t { sf_TEXT, sf_JSON, sf_CSV, sf_NUM };
+
+/* register/check the stats output options */
+void stats_reg_options(struct opt_odb_t *odb);
+void stats_check_options(void);
+
+/* begin one stats dump to STREAM titled TITLE; in F_PROGRESS dumps under
+   -stats:delta, counters and distributions are reported as the difference
+   to the previous progress dump, so -insn:progress gives interval data */
+void stats_dump_begin(FILE *stream, const char *title, bool_t f_progress);
+
+/* end the current stats dump */
+void stats_dump_end(FILE *stream);
+
 void 
 print_counter(FILE *stream, 
 	      const char *name, 
@@ -19,12 +44,36 @@ print_rate(FILE *stream,
 	   double rate,
 	   const char *desc);
 
+/* print the rate NAME = SCALE * NUM / DEN (0 when DEN is 0) in UNIT, NUM
+   and DEN are counters printed before it in the same dump.  unlike
+   print_rate(), the rate of a -stats:delta dump covers the interval */
+void
+print_formula(FILE *stream,
+	      const char *name,
+	      double scale,
+	      const char *num,
+	      const char *den,
+	      const char *unit,
+	      const char *desc);
+
 void
 print_addr(FILE *stream, 
 	   const char *name,
 	   md_addr_t addr,
 	   const char *desc);
 
+/* print the N element distribution DIST */
+void
+print_dist(FILE *stream,
+	   const char *name,
+	   const counter_t *dist,
+	   int n,
+	   const char *desc);
+
+/* print a group separator (text format only) */
+void
+print_separator(FILE *stream);
+
 #define BDVEC_BDSUM(BDVEC) \
    ((BDVEC)[FALSE] + \
     (BDVEC)[TRUE])
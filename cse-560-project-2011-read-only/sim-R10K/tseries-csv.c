@@ -0,0 +1,183 @@
+/* tseries-csv.c - export a -tseries time-series file as CSV
+ *
+ * usage: tseries-csv <file>
+ *
+ * Prints one line per interval: its index, the cycle and committed
+ * instruction count at its end, every recorded column and every ratio
+ * (empty when its denominator is 0).  The file format is described in
+ * tseries.h.
+ *
+ * build: cc -o tseries-csv tseries-csv.c misc.c -lz
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "host.h"
+#include "misc.h"
+#include "tseries.h"
+
+static FILE *fd;
+static char *fname;
+
+/* read an N byte little endian value, FALSE at end-of-file */
+static int
+get(unsigned long long *val, int n)
+{
+  unsigned char buf[8];
+  int i, nread;
+
+  nread = fread(buf, 1, n, fd);
+  if (nread == 0)
+    return FALSE;
+  if (nread != n)
+    fatal("`%s' is truncated", fname);
+
+  for (*val = 0, i = n - 1; i >= 0; i--)
+    *val = (*val << 8) | buf[i];
+  return TRUE;
+}
+
+static unsigned long long
+must_get(int n)
+{
+  unsigned long long val;
+
+  if (!get(&val, n))
+    fatal("`%s' is truncated", fname);
+  return val;
+}
+
+static char *
+get_str(void)
+{
+  int len = (int)must_get(2);
+  char *s = (char *)mycalloc(len + 1, sizeof(char));
+
+  if (len > 0 && fread(s, 1, len, fd) != len)
+    fatal("`%s' is truncated", fname);
+  return s;
+}
+
+int
+main(int argc, char **argv)
+{
+  unsigned long long val, period, unit, n_rec, size, z;
+  int n_cols, n_ratios, c, r, i, shift;
+  char **col_name, **ratio_name;
+  int *ratio_num, *ratio_den;
+  double *ratio_scale;
+  union { double d; unsigned long long q; } scale;
+  counter_t **col_val, prev, end_cycle = 0, end_insn = 0, interval = 0;
+  unsigned char *buf, *p;
+
+  if (argc != 2)
+    {
+      fprintf(stderr, "usage: %s <file>\n", argv[0]);
+      exit(1);
+    }
+  fname = argv[1];
+
+  fd = fopen(fname, "rb");
+  if (!fd)
+    fatal("could not open time-series file `%s'", fname);
+
+  if (!get(&val, 4) || val != TSERIES_MAGIC)
+    fatal("`%s' is not a time-series file", fname);
+  if (must_get(4) != TSERIES_VERSION)
+    fatal("`%s' has an unsupported version", fname);
+  period = must_get(8);
+  unit = must_get(4);
+  n_cols = (int)must_get(4);
+  n_ratios = (int)must_get(4);
+  if (n_cols < 2)
+    fatal("`%s' has no interval columns", fname);
+
+  col_name = (char **)mycalloc(n_cols, sizeof(char *));
+  col_val = (counter_t **)mycalloc(n_cols, sizeof(counter_t *));
+  for (c = 0; c < n_cols; c++)
+    {
+      must_get(1);
+      col_name[c] = get_str();
+      col_val[c] = (counter_t *)mycalloc(TSERIES_BLOCK, sizeof(counter_t));
+    }
+
+  ratio_name = (char **)mycalloc(n_ratios + 1, sizeof(char *));
+  ratio_num = (int *)mycalloc(n_ratios + 1, sizeof(int));
+  ratio_den = (int *)mycalloc(n_ratios + 1, sizeof(int));
+  ratio_scale = (double *)mycalloc(n_ratios + 1, sizeof(double));
+  for (r = 0; r < n_ratios; r++)
+    {
+      ratio_name[r] = get_str();
+      ratio_num[r] = (int)must_get(4);
+      ratio_den[r] = (int)must_get(4);
+      scale.q = must_get(8);
+      ratio_scale[r] = scale.d;
+      if (ratio_num[r] >= n_cols || ratio_den[r] >= n_cols)
+	fatal("`%s' has a bad ratio `%s'", fname, ratio_name[r]);
+    }
+
+  fprintf(stderr, "%s: %d columns, %d ratios, %llu %s intervals\n",
+	  fname, n_cols, n_ratios, period,
+	  unit == tu_INSN ? "instruction" : "cycle");
+
+  printf("interval,end_cycle,end_insn");
+  for (c = 0; c < n_cols; c++)
+    printf(",%s", col_name[c]);
+  for (r = 0; r < n_ratios; r++)
+    printf(",%s", ratio_name[r]);
+  printf("\n");
+
+  while (get(&n_rec, 4))
+    {
+      if (n_rec == 0 || n_rec > TSERIES_BLOCK)
+	fatal("`%s' has a corrupt block", fname);
+
+      /* decode the block, column by column */
+      for (c = 0; c < n_cols; c++)
+	{
+	  size = must_get(4);
+	  buf = (unsigned char *)mycalloc(size + 1, sizeof(unsigned char));
+	  if (size > 0 && fread(buf, 1, size, fd) != size)
+	    fatal("`%s' is truncated", fname);
+
+	  for (p = buf, prev = 0, i = 0; i < (int)n_rec; i++)
+	    {
+	      for (z = 0, shift = 0; ; shift += 7)
+		{
+		  if (p >= buf + size)
+		    fatal("`%s' has a corrupt column", fname);
+		  z |= (unsigned long long)(*p & 0x7f) << shift;
+		  if (!(*p++ & 0x80))
+		    break;
+		}
+	      prev += (counter_t)((z >> 1) ^ (~(z & 1) + 1));
+	      col_val[c][i] = prev;
+	    }
+	  free(buf);
+	}
+
+      for (i = 0; i < (int)n_rec; i++)
+	{
+	  end_cycle += col_val[0][i];
+	  end_insn += col_val[1][i];
+	  printf("%lld,%lld,%lld", (long long)interval++,
+		 (long long)end_cycle, (long long)end_insn);
+	  for (c = 0; c < n_cols; c++)
+	    printf(",%lld", (long long)col_val[c][i]);
+	  for (r = 0; r < n_ratios; r++)
+	    {
+	      if (col_val[ratio_den[r]][i] == 0)
+		printf(",");
+	      else
+		printf(",%.6g", ratio_scale[r] * (double)col_val[ratio_num[r]][i]
+		       / (double)col_val[ratio_den[r]][i]);
+	    }
+	  printf("\n");
+	}
+    }
+  fclose(fd);
+
+  return 0;
+}
@@ -0,0 +1,400 @@
+/* tseries.c - interval time-series stats */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "host.h"
+#include "misc.h"
+#include "machine.h"
+#include "options.h"
+#include "memory.h"
+#include "cache.h"
+#include "tseries.h"
+
+/* largest counter value, no boundary is ever reached */
+#define TSERIES_NEVER		((counter_t)(~0ULL >> 1))
+
+#define TSERIES_MAX_COLS	64
+#define TSERIES_MAX_RATIOS	32
+
+/* options */
+static char *tseries_fname;
+static unsigned long long tseries_cycles;
+static unsigned long long tseries_insn;
+
+counter_t tseries_next = TSERIES_NEVER;
+int tseries_unit = tu_CYCLES;
+
+static FILE *tseries_fd = NULL;
+static counter_t tseries_period = 0;
+
+/* a recorded column */
+struct tseries_col_t
+{
+  char *name;
+  enum tseries_kind_t kind;
+  counter_t *ctr;			/* source counter, or */
+  counter_t (*fn)(void *arg);		/* source function */
+  void *arg;
+  counter_t last;			/* value at the last interval end */
+  counter_t pending;			/* delta accrued before a pause */
+  counter_t *buf;			/* values of the current block */
+};
+
+/* a derived column, computed by the reader */
+struct tseries_ratio_t
+{
+  char *name;
+  int num, den;
+  double scale;
+};
+
+static struct tseries_col_t cols[TSERIES_MAX_COLS];
+static int n_cols = 0;
+static struct tseries_ratio_t ratios[TSERIES_MAX_RATIOS];
+static int n_ratios = 0;
+
+static int n_rec = 0;
+static counter_t n_rec_total = 0;
+static bool_t f_header = FALSE;
+static bool_t f_paused = TRUE;
+
+void
+tseries_reg_options(struct opt_odb_t *odb)
+{
+  opt_reg_string(odb, "-tseries",
+		 "record interval stats time-series to <fname> {<fname>|none}",
+		 &tseries_fname, /* default */"none", /* print */TRUE, /* format */NULL);
+  opt_reg_ulonglong(odb, "-tseries:cycles",
+		    "time-series interval in cycles (0 = use -tseries:insn)",
+		    &tseries_cycles, /* default */0, /* print */TRUE, /* format */NULL);
+  opt_reg_ulonglong(odb, "-tseries:insn",
+		    "time-series interval in committed instructions",
+		    &tseries_insn, /* default */100000, /* print */TRUE, /* format */NULL);
+}
+
+void
+tseries_check_options(void)
+{
+  if (!mystricmp(tseries_fname, "none"))
+    return;
+
+  if (tseries_cycles > 0)
+    {
+      tseries_unit = tu_CYCLES;
+      tseries_period = (counter_t)tseries_cycles;
+    }
+  else if (tseries_insn > 0)
+    {
+      tseries_unit = tu_INSN;
+      tseries_period = (counter_t)tseries_insn;
+    }
+  else
+    fatal("time-series interval must be positive");
+
+  tseries_fd = fopen(tseries_fname, "wb");
+  if (!tseries_fd)
+    fatal("could not open time-series file `%s'", tseries_fname);
+}
+
+bool_t
+tseries_enabled(void)
+{
+  return tseries_fd != NULL;
+}
+
+/* write the N byte little endian value VAL */
+static void
+tseries_put(unsigned long long val, int n)
+{
+  int i;
+
+  for (i = 0; i < n; i++, val >>= 8)
+    fputc((int)(val & 0xff), tseries_fd);
+}
+
+/* write string S, u16 length prefixed */
+static void
+tseries_put_str(char *s)
+{
+  tseries_put(strlen(s), 2);
+  fwrite(s, 1, strlen(s), tseries_fd);
+}
+
+static void
+tseries_add_col(char *name, enum tseries_kind_t kind, counter_t *ctr,
+		counter_t (*fn)(void *arg), void *arg)
+{
+  struct tseries_col_t *col;
+
+  if (!tseries_fd)
+    return;
+  if (n_rec_total > 0)
+    panic("time-series column `%s' registered after the first record", name);
+  if (n_cols == TSERIES_MAX_COLS)
+    fatal("too many time-series columns");
+
+  col = &cols[n_cols++];
+  col->name = mystrdup(name);
+  col->kind = kind;
+  col->ctr = ctr;
+  col->fn = fn;
+  col->arg = arg;
+  col->buf = (counter_t *)mycalloc(TSERIES_BLOCK, sizeof(counter_t));
+}
+
+void
+tseries_init(counter_t *cycle, counter_t *insn)
+{
+  if (n_cols != 0)
+    panic("time-series already initialized");
+
+  tseries_add_col("cycles", tk_DELTA, cycle, NULL, NULL);
+  tseries_add_col("insns", tk_DELTA, insn, NULL, NULL);
+}
+
+void
+tseries_counter(char *name, enum tseries_kind_t kind, counter_t *ctr)
+{
+  tseries_add_col(name, kind, ctr, NULL, NULL);
+}
+
+void
+tseries_counter_fn(char *name, enum tseries_kind_t kind,
+		   counter_t (*fn)(void *arg), void *arg)
+{
+  tseries_add_col(name, kind, NULL, fn, arg);
+}
+
+static counter_t
+tseries_cache_accesses(void *arg)
+{
+  counter_t lookups, misses;
+
+  cache_totals((struct cache_t *)arg, &lookups, &misses);
+  return lookups;
+}
+
+static counter_t
+tseries_cache_misses(void *arg)
+{
+  counter_t lookups, misses;
+
+  cache_totals((struct cache_t *)arg, &lookups, &misses);
+  return misses;
+}
+
+void
+tseries_cache(char *name, struct cache_t *cp)
+{
+  char acc[128], miss[128], rate[128];
+
+  if (!cp)
+    return;
+
+  sprintf(acc, "%s_accesses", name);
+  sprintf(miss, "%s_misses", name);
+  sprintf(rate, "%s_miss_rate", name);
+
+  tseries_counter_fn(acc, tk_DELTA, tseries_cache_accesses, cp);
+  tseries_counter_fn(miss, tk_DELTA, tseries_cache_misses, cp);
+  tseries_ratio(rate, miss, acc, 1.0);
+}
+
+static int
+tseries_col_index(char *name)
+{
+  int i;
+
+  for (i = 0; i < n_cols; i++)
+    if (!strcmp(cols[i].name, name))
+      return i;
+
+  panic("unknown time-series column `%s'", name);
+  return -1;
+}
+
+void
+tseries_ratio(char *name, char *num, char *den, double scale)
+{
+  struct tseries_ratio_t *r;
+
+  if (!tseries_fd)
+    return;
+  if (n_rec_total > 0)
+    panic("time-series ratio `%s' registered after the first record", name);
+  if (n_ratios == TSERIES_MAX_RATIOS)
+    fatal("too many time-series ratios");
+
+  r = &ratios[n_ratios++];
+  r->name = mystrdup(name);
+  r->num = tseries_col_index(num);
+  r->den = tseries_col_index(den);
+  r->scale = scale;
+}
+
+static counter_t
+tseries_read(struct tseries_col_t *col)
+{
+  return col->ctr ? *col->ctr : col->fn(col->arg);
+}
+
+/* current position in the interval unit */
+static counter_t
+tseries_now(void)
+{
+  return tseries_read(&cols[tseries_unit == tu_INSN ? 1 : 0]);
+}
+
+static void
+tseries_write_header(void)
+{
+  union { double d; unsigned long long q; } scale;
+  int i;
+
+  tseries_put(TSERIES_MAGIC, 4);
+  tseries_put(TSERIES_VERSION, 4);
+  tseries_put(tseries_period, 8);
+  tseries_put(tseries_unit, 4);
+  tseries_put(n_cols, 4);
+  tseries_put(n_ratios, 4);
+  for (i = 0; i < n_cols; i++)
+    {
+      tseries_put(cols[i].kind, 1);
+      tseries_put_str(cols[i].name);
+    }
+  for (i = 0; i < n_ratios; i++)
+    {
+      tseries_put_str(ratios[i].name);
+      tseries_put(ratios[i].num, 4);
+      tseries_put(ratios[i].den, 4);
+      scale.d = ratios[i].scale;
+      tseries_put(scale.q, 8);
+    }
+  f_header = TRUE;
+}
+
+/* write the records of the current block, column by column */
+static void
+tseries_flush(void)
+{
+  unsigned char *buf, *p;
+  unsigned long long z;
+  counter_t prev, diff;
+  int c, i;
+
+  if (!f_header)
+    tseries_write_header();
+  if (n_rec == 0)
+    return;
+
+  /* at most 10 varint bytes per value */
+  buf = (unsigned char *)mycalloc(n_rec * 10, sizeof(unsigned char));
+
+  tseries_put(n_rec, 4);
+  for (c = 0; c < n_cols; c++)
+    {
+      /* successive interval values are close, code their differences */
+      for (p = buf, prev = 0, i = 0; i < n_rec; i++)
+	{
+	  diff = cols[c].buf[i] - prev;
+	  prev = cols[c].buf[i];
+	  z = ((unsigned long long)diff << 1) ^ (unsigned long long)(diff >> 63);
+	  while (z >= 0x80)
+	    {
+	      *p++ = (unsigned char)(z | 0x80);
+	      z >>= 7;
+	    }
+	  *p++ = (unsigned char)z;
+	}
+      tseries_put(p - buf, 4);
+      fwrite(buf, 1, p - buf, tseries_fd);
+    }
+  free(buf);
+
+  n_rec = 0;
+}
+
+void
+tseries_resume(void)
+{
+  int c;
+
+  if (!tseries_fd || !f_paused)
+    return;
+
+  for (c = 0; c < n_cols; c++)
+    if (cols[c].kind == tk_DELTA)
+      cols[c].last = tseries_read(&cols[c]) - cols[c].pending;
+  f_paused = FALSE;
+
+  if (tseries_next == TSERIES_NEVER)
+    tseries_next = tseries_now() + tseries_period;
+}
+
+void
+tseries_pause(void)
+{
+  int c;
+
+  if (!tseries_fd || f_paused)
+    return;
+
+  for (c = 0; c < n_cols; c++)
+    if (cols[c].kind == tk_DELTA)
+      cols[c].pending = tseries_read(&cols[c]) - cols[c].last;
+  f_paused = TRUE;
+}
+
+void
+tseries_record(void)
+{
+  struct tseries_col_t *col;
+  counter_t val, now;
+  int c;
+
+  for (c = 0; c < n_cols; c++)
+    {
+      col = &cols[c];
+      val = tseries_read(col);
+      if (col->kind == tk_DELTA)
+	{
+	  col->buf[n_rec] = val - col->last;
+	  col->last = val;
+	  col->pending = 0;
+	}
+      else
+	col->buf[n_rec] = val;
+    }
+  n_rec_total++;
+  if (++n_rec == TSERIES_BLOCK)
+    tseries_flush();
+
+  now = tseries_now();
+  while (tseries_next <= now)
+    tseries_next += tseries_period;
+}
+
+void
+tseries_close(void)
+{
+  if (!tseries_fd)
+    return;
+
+  /* the partial interval since the last record */
+  tseries_pause();
+  if (n_cols >= 2 && (cols[0].pending > 0 || cols[1].pending > 0))
+    {
+      tseries_resume();
+      tseries_record();
+    }
+
+  tseries_flush();
+  fclose(tseries_fd);
+  tseries_fd = NULL;
+  tseries_next = TSERIES_NEVER;
+
+  fprintf(stderr, "sim: %lld time-series intervals -> %s\n",
+	  (long long)n_rec_total, tseries_fname);
+}
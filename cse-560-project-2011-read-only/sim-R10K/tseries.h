@@ -0,0 +1,88 @@
+#ifndef TSERIES_H
+#define TSERIES_H
+
+/* interval time-series stats: selected counters are recorded every
+   -tseries:cycles cycles or -tseries:insn committed instructions into a
+   compact binary columnar file, tseries-csv exports it as CSV.
+
+   file format, all values little endian:
+
+     header   "TSER", version (u32), period (u64), unit (u32, 0 cycles
+	      1 insts), n_col (u32), n_ratio (u32), then per column its
+	      kind (u8, 0 delta 1 sample) and name (u16 length + bytes), per
+	      ratio its name, numerator and denominator column (u32 each)
+	      and scale (double, as 8 byte IEEE bits)
+     blocks   n_rec (u32), then per column its byte size (u32) and the
+	      zigzag varint coded differences of its N_REC values
+
+   columns 0 and 1 are always the interval's cycles and committed insts */
+
+#define TSERIES_MAGIC			0x52455354	/* "TSER" */
+#define TSERIES_VERSION			1
+
+/* records per columnar block */
+#define TSERIES_BLOCK			4096
+
+/* column kinds */
+enum tseries_kind_t {
+  tk_DELTA,		/* counter, recorded as its change over the interval */
+  tk_SAMPLE		/* gauge, recorded as its value at the interval end */
+};
+
+/* interval units */
+enum tseries_unit_t { tu_CYCLES, tu_INSN };
+
+struct opt_odb_t;
+struct cache_t;
+
+/* next interval boundary (in the interval unit), the maximum counter
+   value when no time-series is recorded */
+extern counter_t tseries_next;
+extern int tseries_unit;
+
+/* register/check the time-series options */
+void tseries_reg_options(struct opt_odb_t *odb);
+void tseries_check_options(void);
+
+/* recording a time-series? */
+bool_t tseries_enabled(void);
+
+/* start the column list with the interval's cycles and committed insts,
+   read from *CYCLE and *INSN */
+void tseries_init(counter_t *cycle, counter_t *insn);
+
+/* register a column reading counter *CTR */
+void tseries_counter(char *name, enum tseries_kind_t kind, counter_t *ctr);
+
+/* register a column reading FN(ARG) */
+void tseries_counter_fn(char *name, enum tseries_kind_t kind,
+			counter_t (*fn)(void *arg), void *arg);
+
+/* register NAME_accesses and NAME_misses columns for cache CP, and a
+   NAME_miss_rate ratio */
+void tseries_cache(char *name, struct cache_t *cp);
+
+/* register ratio NAME = SCALE * NUM / DEN over the named columns, the
+   reader computes it per interval */
+void tseries_ratio(char *name, char *num, char *den, double scale);
+
+/* bracket each stretch of timing simulation, so activity while
+   fast-forwarding or warming up is not charged to an interval */
+void tseries_resume(void);
+void tseries_pause(void);
+
+/* record the interval ending now */
+void tseries_record(void);
+
+/* record the last, partial interval, flush and close the file */
+void tseries_close(void);
+
+/* check for an interval boundary, once per simulated cycle */
+#define TSERIES_TICK(CYCLE, INSN)					\
+  do {									\
+    if ((tseries_unit == tu_INSN ? (counter_t)(INSN) : (counter_t)(CYCLE))\
+	>= tseries_next)						\
+      tseries_record();							\
+  } while (0)
+
+#endif /* TSERIES_H */